@@ -9,6 +9,7 @@
 #include "../Data/LanguageManager/LanguageManager.h"
 #include "../Data/SoundboardManager.h"
 #include "../AudioEngine/SoundPlayer.h"
+#include "../AudioEngine/PluginReaper.h"
 #include <algorithm> // This is still required for std::max
 
 //==============================================================================
@@ -97,7 +98,14 @@ public:
 //==============================================================================
 void idolLiveAudioApplication::initialise(const juce::String& commandLine)
 {
-    juce::ignoreUnused(commandLine);
+    // Child processes started by PluginScanner scan one plugin file and quit.
+    if (PluginScanner::isWorkerCommandLine(commandLine))
+    {
+        isPluginScanWorker = true;
+        setApplicationReturnValue(PluginScanner::runWorker(getCommandLineParameterArray()));
+        quit();
+        return;
+    }
 
     splashWindow = std::make_unique<SplashWindow>();
     const auto startTime = juce::Time::getMillisecondCounter();
@@ -145,7 +153,7 @@ void idolLiveAudioApplication::initialise(const juce::String& commandLine)
                         const auto& slot = getSharedSoundboardProfileManager().getCurrentSlots().getReference(slotIndex);
                         if (!slot.isEmpty())
                         {
-                            soundPlayer.play(slot.audioFile, slotIndex);
+                            soundPlayer.play(slot, slotIndex);
                         }
                     }
                 };
@@ -173,6 +181,9 @@ void idolLiveAudioApplication::initialise(const juce::String& commandLine)
 
 void idolLiveAudioApplication::shutdown()
 {
+    if (isPluginScanWorker)
+        return;
+
 #if JUCE_WINDOWS
     if (globalHotkeyManager != nullptr)
     {
@@ -197,6 +208,10 @@ void idolLiveAudioApplication::shutdown()
     mainWindow = nullptr;
     presetManagerWindow = nullptr;
     pluginManagerWindow = nullptr;
+
+    // Finish off plugins the engine handed to the reaper while the formats still exist.
+    PluginReaper::getInstance().shutdown();
+
     presetManager = nullptr;
     pluginManager = nullptr;
     splashWindow = nullptr;
@@ -12,10 +12,6 @@ class PluginManagerWindow;
 class MainComponent;
 class SplashWindow;
 
-// --- FORWARD DECLARATION of our helper function ---
-PluginManager& getSharedPluginManager();
-PresetManager& getSharedPresetManager();
-
 //==============================================================================
 class idolLiveAudioApplication : public juce::JUCEApplication
 {
@@ -64,4 +60,6 @@ private:
     std::unique_ptr<MainWindow> mainWindow;
     std::unique_ptr<PresetManagerWindow> presetManagerWindow;
     std::unique_ptr<PluginManagerWindow> pluginManagerWindow;
+
+    bool isPluginScanWorker = false;
 };
\ No newline at end of file
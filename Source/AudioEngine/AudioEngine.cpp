@@ -9,30 +9,55 @@
 
 #include "AudioEngine.h"
 #include "../Data/AppState.h"
-#include "../GUI/Layout/TrackComponent.h"
-#include "../GUI/Layout/MasterUtilityComponent.h"
 #include "juce_audio_devices/juce_audio_devices.h"
 #include "SoundPlayer.h"
-#include "../GUI/Components/TrackPlayerComponent.h"
+#include "../Diagnostics/TraceRecorder.h"
+#include "../Diagnostics/RealtimeChecker.h"
 
 AudioEngine::AudioEngine(juce::AudioDeviceManager& manager)
     : deviceManager(manager),
     vocalFxChain(Identifiers::VocalFx1State, Identifiers::VocalFx2State, Identifiers::VocalFx3State, Identifiers::VocalFx4State),
-    musicFxChain(Identifiers::MusicFx1State, Identifiers::MusicFx2State, Identifiers::MusicFx3State, Identifiers::MusicFx4State)
+    musicFxChain(Identifiers::MusicFx1State, Identifiers::MusicFx2State, Identifiers::MusicFx3State, Identifiers::MusicFx4State),
+    callbackDuration(MetricsRegistry::getInstance().addHistogram("idol_callback_duration_seconds",
+        "Time the audio callback took.",
+        { 0.00025, 0.0005, 0.001, 0.0015, 0.002, 0.003, 0.004, 0.006, 0.008, 0.010, 0.015, 0.020, 0.030, 0.050, 0.100 }))
 {
     formatManager.registerBasicFormats();
+    backingTrackQueue = std::make_unique<BackingTrackQueue>(formatManager);
+    musicRenderCache = std::make_unique<TimePitchRenderCache>(formatManager);
+    vocalRemover = std::make_unique<VocalRemover>(formatManager);
+    peakCache = std::make_unique<PeakCache>(formatManager);
+    musicPitchShifter.prepare(TimePitchShifter::Quality::Preview, 2);
     audioRecorder = std::make_unique<AudioRecorder>(formatManager, "");
     vocalTrackRecorder = std::make_unique<AudioRecorder>(formatManager, "Vocal");
     musicTrackRecorder = std::make_unique<AudioRecorder>(formatManager, "Music");
     rawVocalRecorder = std::make_unique<AudioRecorder>(formatManager, "Projects");
     rawMusicRecorder = std::make_unique<AudioRecorder>(formatManager, "Projects");
     soundPlayer = std::make_unique<IdolAZ::SoundPlayer>();
-    soundboardMixer.addInputSource(soundPlayer.get(), false);
+    presetLoader = std::make_unique<PresetLoader>();
+    overrunWatchdog = std::make_unique<OverrunWatchdog>(getAllProcessors());
+
+    // Build the waveform overview of every recording as soon as it is closed.
+    for (auto* recorder : { audioRecorder.get(), vocalTrackRecorder.get(), musicTrackRecorder.get(),
+                            rawVocalRecorder.get(), rawMusicRecorder.get() })
+        recorder->onRecordingFinished = [this](const juce::File& file) { peakCache->requestBuild(file); };
     directOutputMixer.addInputSource(&playbackSource, false);
+
+    lastCallbackDuration = callbackDuration.getSnapshot();
+    metricsCollectorId = MetricsRegistry::getInstance().addCollector([this] { collectMetrics(); });
+    metricsExporter = std::make_unique<MetricsExporter>();
 }
 
 AudioEngine::~AudioEngine()
 {
+    metricsExporter.reset();
+    MetricsRegistry::getInstance().removeCollector(metricsCollectorId);
+
+   #if IDOL_ENABLE_REALTIME_CHECKS
+    // The tools report these themselves; in the app they are only seen here.
+    if (RealtimeChecker::getInstance().getNumViolations() > 0)
+        DBG(RealtimeChecker::getInstance().getReport());
+   #endif
 }
 
 void AudioEngine::prepareAllProcessors(double sampleRate, int samplesPerBlock)
@@ -48,17 +73,20 @@ void AudioEngine::prepareAllProcessors(double sampleRate, int samplesPerBlock)
     masterProcessor.prepare(stereoSpec);
     for (auto& fxProc : vocalFxChain.processors) fxProc.prepare(stereoSpec);
     for (auto& fxProc : musicFxChain.processors) fxProc.prepare(stereoSpec);
-    soundboardMixer.prepareToPlay(samplesPerBlock, sampleRate);
+    soundPlayer->prepareToPlay(samplesPerBlock, sampleRate);
     directOutputMixer.prepareToPlay(samplesPerBlock, sampleRate);
     playbackSource.prepareToPlay(samplesPerBlock, sampleRate);
     vocalTrackSource.prepareToPlay(samplesPerBlock, sampleRate);
     musicTrackSource.prepareToPlay(samplesPerBlock, sampleRate);
+    backingTrackQueue->prepareToPlay(samplesPerBlock, sampleRate);
     vocalBuffer.setSize(2, samplesPerBlock);
     musicStereoBuffer.setSize(2, samplesPerBlock);
     mixBuffer.setSize(2, samplesPerBlock);
     soundboardBuffer.setSize(2, samplesPerBlock);
     directOutputBuffer.setSize(2, samplesPerBlock);
     fxSendBuffer.setSize(2, samplesPerBlock);
+    vocalPlayerBuffer.setSize(2, samplesPerBlock);
+    musicPlayerBuffer.setSize(2, samplesPerBlock);
     for (auto& buffer : vocalFxReturnBuffers) buffer.setSize(2, samplesPerBlock);
     for (auto& buffer : musicFxReturnBuffers) buffer.setSize(2, samplesPerBlock);
     vocalProcessor.reset();
@@ -68,10 +96,31 @@ void AudioEngine::prepareAllProcessors(double sampleRate, int samplesPerBlock)
     for (auto& fxProc : musicFxChain.processors) fxProc.reset();
 }
 
+void AudioEngine::setWorkingBlockSize(int numSamples)
+{
+    // Shorter blocks reuse the buffers made for stableBlockSize; nothing is reallocated.
+    for (auto* buffer : { &vocalBuffer, &musicStereoBuffer, &mixBuffer, &soundboardBuffer,
+                          &directOutputBuffer, &fxSendBuffer, &vocalPlayerBuffer, &musicPlayerBuffer })
+        buffer->setSize(2, numSamples, false, false, true);
+    for (auto& buffer : vocalFxReturnBuffers) buffer.setSize(2, numSamples, false, false, true);
+    for (auto& buffer : musicFxReturnBuffers) buffer.setSize(2, numSamples, false, false, true);
+    currentBlockSize = numSamples;
+}
+
+bool AudioEngine::needsReading(const juce::AudioTransportSource& transport, bool& wasPlaying) noexcept
+{
+    const bool playing = transport.isPlaying();
+    const bool result = playing || wasPlaying;
+    wasPlaying = playing;
+    return result;
+}
 
 void AudioEngine::audioDeviceAboutToStart(juce::AudioIODevice* device)
 {
     prepareAllProcessors(device->getCurrentSampleRate(), device->getCurrentBufferSizeSamples());
+    for (auto* recorder : { audioRecorder.get(), vocalTrackRecorder.get(), musicTrackRecorder.get(),
+                            rawVocalRecorder.get(), rawMusicRecorder.get() })
+        recorder->prepare(device->getCurrentSampleRate());
     if (onDeviceStarted)
         juce::MessageManager::callAsync(onDeviceStarted);
 }
@@ -83,11 +132,12 @@ void AudioEngine::audioDeviceStopped()
     masterProcessor.reset();
     for (auto& fxProc : vocalFxChain.processors) fxProc.reset();
     for (auto& fxProc : musicFxChain.processors) fxProc.reset();
-    soundboardMixer.releaseResources();
+    soundPlayer->releaseResources();
     directOutputMixer.releaseResources();
     playbackSource.releaseResources();
     vocalTrackSource.releaseResources();
     musicTrackSource.releaseResources();
+    backingTrackQueue->releaseResources();
     currentSampleRate = 0.0;
     currentBlockSize = 0;
     vocalInputChannel.store(-1);
@@ -100,12 +150,23 @@ void AudioEngine::audioDeviceStopped()
 void AudioEngine::audioDeviceIOCallbackWithContext(const float* const* inputChannelData, int numInputChannels, float* const* outputChannelData, int numOutputChannels, int numSamples, const juce::AudioIODeviceCallbackContext& context)
 {
     juce::ignoreUnused(context);
+    IDOL_TRACE_THREAD_NAME("Audio callback");
+    IDOL_TRACE_SCOPE("audio", "Callback");
+    IDOL_REALTIME_SCOPE();
     if (auto* currentDevice = deviceManager.getCurrentAudioDevice())
     {
-        if (numSamples != currentBlockSize || currentDevice->getCurrentSampleRate() != currentSampleRate)
+        // Only a new rate or a block longer than the processors were prepared for needs
+        // a full (allocating) prepare; a shorter block just shortens the buffers.
+        if (numSamples > stableBlockSize || currentDevice->getCurrentSampleRate() != currentSampleRate)
             prepareAllProcessors(currentDevice->getCurrentSampleRate(), numSamples);
     }
+    if (numSamples != currentBlockSize && numSamples <= stableBlockSize)
+        setWorkingBlockSize(numSamples);
     juce::ScopedNoDenormals noDenormals;
+    const double blockSeconds = currentSampleRate > 0 ? numSamples / currentSampleRate : 0.0;
+    const auto callbackStartTicks = juce::Time::getHighResolutionTicks();
+    auto stageStartTicks = callbackStartTicks;
+    StageTimes stageSeconds{};
     vocalBuffer.clear();
     musicStereoBuffer.clear();
     mixBuffer.clear();
@@ -113,26 +174,46 @@ void AudioEngine::audioDeviceIOCallbackWithContext(const float* const* inputChan
     directOutputBuffer.clear();
     for (auto& buffer : vocalFxReturnBuffers) buffer.clear();
     for (auto& buffer : musicFxReturnBuffers) buffer.clear();
-    vocalPlayerBuffer.setSize(2, numSamples);
-    musicPlayerBuffer.setSize(2, numSamples);
     vocalPlayerBuffer.clear();
     musicPlayerBuffer.clear();
-    juce::AudioSourceChannelInfo vocalPlayerInfo(&vocalPlayerBuffer, 0, numSamples);
-    vocalTrackSource.getNextAudioBlock(vocalPlayerInfo);
-    juce::AudioSourceChannelInfo musicPlayerInfo(&musicPlayerBuffer, 0, numSamples);
-    musicTrackSource.getNextAudioBlock(musicPlayerInfo);
+    const bool recordProjectStems = projectStemsArmed.load();
+    {
+        IDOL_TRACE_SCOPE("transport", "Read track players");
+        if (needsReading(vocalTrackSource, vocalTrackWasPlaying))
+        {
+            juce::AudioSourceChannelInfo vocalPlayerInfo(&vocalPlayerBuffer, 0, numSamples);
+            vocalTrackSource.getNextAudioBlock(vocalPlayerInfo);
+        }
+        if (needsReading(musicTrackSource, musicTrackWasPlaying))
+        {
+            juce::AudioSourceChannelInfo musicPlayerInfo(&musicPlayerBuffer, 0, numSamples);
+            musicTrackSource.getNextAudioBlock(musicPlayerInfo);
+        }
+    }
+    if (musicPitchShiftActive.load())
+    {
+        if (musicPitchShifterNeedsReset.exchange(false))
+            musicPitchShifter.reset();
+        musicPitchShifter.process(musicPlayerBuffer, numSamples);
+    }
+    backingTrackQueue->addNextAudioBlock(musicPlayerBuffer, numSamples);
     const int currentVocalIn = vocalInputChannel.load();
     if (juce::isPositiveAndBelow(currentVocalIn, numInputChannels))
     {
         juce::AudioBuffer<float> rawInput(const_cast<float**>(inputChannelData) + currentVocalIn, 1, numSamples);
         vocalBuffer.copyFrom(0, 0, rawInput, 0, 0, numSamples);
         vocalBuffer.copyFrom(1, 0, rawInput, 0, 0, numSamples);
-        rawVocalRecorder->processBlock(vocalBuffer, currentSampleRate);
     }
+    // Silence while no input is selected, so the stems stay the same length.
+    if (recordProjectStems)
+        rawVocalRecorder->processBlock(vocalBuffer);
     vocalBuffer.addFrom(0, 0, vocalPlayerBuffer, 0, 0, numSamples);
     vocalBuffer.addFrom(1, 0, vocalPlayerBuffer, 1, 0, numSamples);
+    endStage(Stage::inputs, stageStartTicks, stageSeconds);
     vocalProcessor.process(vocalBuffer);
-    vocalTrackRecorder->processBlock(vocalBuffer, currentSampleRate);
+    endStage(Stage::vocalChain, stageStartTicks, stageSeconds);
+    vocalTrackRecorder->processBlock(vocalBuffer);
+    endStage(Stage::output, stageStartTicks, stageSeconds);
     const int currentMusicLeftIn = musicInputLeftChannel.load();
     const int currentMusicRightIn = musicInputRightChannel.load();
     if (juce::isPositiveAndBelow(currentMusicLeftIn, numInputChannels) && juce::isPositiveAndBelow(currentMusicRightIn, numInputChannels))
@@ -140,14 +221,22 @@ void AudioEngine::audioDeviceIOCallbackWithContext(const float* const* inputChan
         juce::AudioBuffer<float> rawInput(const_cast<float**>(inputChannelData) + currentMusicLeftIn, 2, numSamples);
         musicStereoBuffer.copyFrom(0, 0, rawInput, 0, 0, numSamples);
         musicStereoBuffer.copyFrom(1, 0, rawInput, 1, 0, numSamples);
-        rawMusicRecorder->processBlock(musicStereoBuffer, currentSampleRate);
     }
+    if (recordProjectStems)
+        rawMusicRecorder->processBlock(musicStereoBuffer);
     musicStereoBuffer.addFrom(0, 0, musicPlayerBuffer, 0, 0, numSamples);
     musicStereoBuffer.addFrom(1, 0, musicPlayerBuffer, 1, 0, numSamples);
+    endStage(Stage::inputs, stageStartTicks, stageSeconds);
     musicProcessor.process(musicStereoBuffer);
-    musicTrackRecorder->processBlock(musicStereoBuffer, currentSampleRate);
-    juce::AudioSourceChannelInfo soundboardChannelInfo(&soundboardBuffer, 0, numSamples);
-    soundboardMixer.getNextAudioBlock(soundboardChannelInfo);
+    endStage(Stage::musicChain, stageStartTicks, stageSeconds);
+    musicTrackRecorder->processBlock(musicStereoBuffer);
+    endStage(Stage::output, stageStartTicks, stageSeconds);
+    {
+        IDOL_TRACE_SCOPE("transport", "Soundboard");
+        juce::AudioSourceChannelInfo soundboardChannelInfo(&soundboardBuffer, 0, numSamples);
+        soundPlayer->getNextAudioBlock(soundboardChannelInfo);
+    }
+    endStage(Stage::inputs, stageStartTicks, stageSeconds);
     for (int i = 0; i < 4; ++i)
     {
         fxSendBuffer.copyFrom(0, 0, vocalBuffer, 0, 0, numSamples);
@@ -168,6 +257,7 @@ void AudioEngine::audioDeviceIOCallbackWithContext(const float* const* inputChan
         musicFxReturnBuffers[i].copyFrom(1, 0, fxSendBuffer, 1, 0, numSamples);
         musicFxReturnBuffers[i].applyGain(musicFxChain.processors[i].getReturnLevel());
     }
+    endStage(Stage::fxChains, stageStartTicks, stageSeconds);
     mixBuffer.clear();
     mixBuffer.copyFrom(0, 0, vocalBuffer, 0, 0, numSamples);
     mixBuffer.copyFrom(1, 0, vocalBuffer, 1, 0, numSamples);
@@ -186,9 +276,15 @@ void AudioEngine::audioDeviceIOCallbackWithContext(const float* const* inputChan
         mixBuffer.addFrom(1, 0, musicFxReturnBuffers[i], 1, 0, numSamples);
     }
     masterProcessor.process(mixBuffer);
-    audioRecorder->processBlock(mixBuffer, currentSampleRate);
-    juce::AudioSourceChannelInfo directOutputChannelInfo(&directOutputBuffer, 0, numSamples);
-    directOutputMixer.getNextAudioBlock(directOutputChannelInfo);
+    endStage(Stage::masterChain, stageStartTicks, stageSeconds);
+    if (auto* listener = tapListener.load())
+        callTapListener(*listener, numSamples);
+    audioRecorder->processBlock(mixBuffer);
+    if (needsReading(playbackSource, playbackWasPlaying))
+    {
+        juce::AudioSourceChannelInfo directOutputChannelInfo(&directOutputBuffer, 0, numSamples);
+        directOutputMixer.getNextAudioBlock(directOutputChannelInfo);
+    }
     const int currentOutputLeft = selectedOutputLeftChannel.load();
     const int currentOutputRight = selectedOutputRightChannel.load();
     for (int i = 0; i < numOutputChannels; ++i)
@@ -203,6 +299,70 @@ void AudioEngine::audioDeviceIOCallbackWithContext(const float* const* inputChan
         juce::FloatVectorOperations::copy(outputChannelData[currentOutputRight], mixBuffer.getReadPointer(1), numSamples);
         juce::FloatVectorOperations::add(outputChannelData[currentOutputRight], directOutputBuffer.getReadPointer(1), numSamples);
     }
+    endStage(Stage::output, stageStartTicks, stageSeconds);
+
+    for (size_t i = 0; i < stageLoads.size(); ++i)
+        stageLoads[i].addMeasurement(stageSeconds[i], blockSeconds);
+
+    const auto callbackSeconds = juce::Time::highResolutionTicksToSeconds(stageStartTicks - callbackStartTicks);
+    callbackLoad.addMeasurement(callbackSeconds, blockSeconds);
+    callbackDuration.observe(callbackSeconds);
+    overrunWatchdog->callbackFinished(callbackSeconds, blockSeconds);
+}
+
+void AudioEngine::endStage(Stage stage, juce::int64& stageStartTicks, StageTimes& stageSeconds) noexcept
+{
+    // Some stages come round more than once per callback; their times add up.
+    const auto now = juce::Time::getHighResolutionTicks();
+    stageSeconds[(size_t)stage] += juce::Time::highResolutionTicksToSeconds(now - stageStartTicks);
+    stageStartTicks = now;
+}
+
+juce::String AudioEngine::getStageName(Stage stage)
+{
+    switch (stage)
+    {
+        case Stage::inputs:      return "Inputs";
+        case Stage::vocalChain:  return "Vocal chain";
+        case Stage::musicChain:  return "Music chain";
+        case Stage::fxChains:    return "FX chains";
+        case Stage::masterChain: return "Master chain";
+        case Stage::output:      return "Output";
+        case Stage::numStages:   break;
+    }
+    return {};
+}
+
+juce::String AudioEngine::getTapName(Tap tap)
+{
+    switch (tap)
+    {
+        case Tap::vocalChain: return "vocal";
+        case Tap::musicChain: return "music";
+        case Tap::vocalFx1:   return "vocalFx1";
+        case Tap::vocalFx2:   return "vocalFx2";
+        case Tap::vocalFx3:   return "vocalFx3";
+        case Tap::vocalFx4:   return "vocalFx4";
+        case Tap::musicFx1:   return "musicFx1";
+        case Tap::musicFx2:   return "musicFx2";
+        case Tap::musicFx3:   return "musicFx3";
+        case Tap::musicFx4:   return "musicFx4";
+        case Tap::master:     return "master";
+        case Tap::numTaps:    break;
+    }
+    return {};
+}
+
+void AudioEngine::callTapListener(TapListener& listener, int numSamples)
+{
+    listener.tapped(Tap::vocalChain, vocalBuffer, numSamples);
+    listener.tapped(Tap::musicChain, musicStereoBuffer, numSamples);
+    for (int i = 0; i < 4; ++i)
+    {
+        listener.tapped((Tap)((int)Tap::vocalFx1 + i), vocalFxReturnBuffers[i], numSamples);
+        listener.tapped((Tap)((int)Tap::musicFx1 + i), musicFxReturnBuffers[i], numSamples);
+    }
+    listener.tapped(Tap::master, mixBuffer, numSamples);
 }
 
 TrackProcessor* AudioEngine::getFxProcessorForVocal(int index)
@@ -318,23 +478,6 @@ void AudioEngine::setSelectedOutputChannelsByName(const juce::String& stereoPair
 int AudioEngine::getSelectedOutputLeftChannel() const { return selectedOutputLeftChannel.load(); }
 int AudioEngine::getSelectedOutputRightChannel() const { return selectedOutputRightChannel.load(); }
 
-void AudioEngine::linkTrackComponents(TrackComponent& vocalTrackComp, TrackComponent& musicTrackComp)
-{
-    vocalProcessor.setLevelSource(vocalTrackComp.getLevelMeter().getLevelSource());
-    musicProcessor.setLevelSource(musicTrackComp.getLevelMeter().getLevelSource());
-    vocalTrackComp.setProcessor(&vocalProcessor);
-    musicTrackComp.setProcessor(&musicProcessor);
-
-    vocalTrackComponent = &vocalTrackComp;
-    musicTrackComponent = &musicTrackComp;
-}
-
-void AudioEngine::linkMasterComponents(MasterUtilityComponent& comp)
-{
-    masterProcessor.setLevelSource(comp.getMasterLevelMeter().getLevelSource());
-    comp.setMasterProcessor(&masterProcessor);
-}
-
 TrackProcessor& AudioEngine::getVocalProcessor() { return vocalProcessor; }
 TrackProcessor& AudioEngine::getMusicProcessor() { return musicProcessor; }
 MasterProcessor& AudioEngine::getMasterProcessor() { return masterProcessor; }
@@ -410,12 +553,22 @@ void AudioEngine::resumePlayback()
     playbackSource.start();
 }
 
-void AudioEngine::startTrackPlayback(TrackPlayerComponent::PlayerType type, const juce::File& file)
+void AudioEngine::startTrackPlayback(TrackPlayerType type, const juce::File& file)
 {
     if (!file.existsAsFile()) return;
 
-    auto* transportToUse = (type == TrackPlayerComponent::PlayerType::Vocal) ? &vocalTrackSource : &musicTrackSource;
-    auto* readerToUse = (type == TrackPlayerComponent::PlayerType::Vocal) ? &vocalTrackReader : &musicTrackReader;
+    if (type == TrackPlayerType::Music)
+    {
+        resetMusicKeyAndTempo();
+        currentMusicFile = file;
+    }
+    else
+    {
+        currentVocalFile = file;
+    }
+
+    auto* transportToUse = (type == TrackPlayerType::Vocal) ? &vocalTrackSource : &musicTrackSource;
+    auto* readerToUse = (type == TrackPlayerType::Vocal) ? &vocalTrackReader : &musicTrackReader;
 
     transportToUse->stop();
     transportToUse->setSource(nullptr);
@@ -429,39 +582,139 @@ void AudioEngine::startTrackPlayback(TrackPlayerComponent::PlayerType type, cons
     }
 }
 
-void AudioEngine::stopTrackPlayback(TrackPlayerComponent::PlayerType type)
+void AudioEngine::stopTrackPlayback(TrackPlayerType type)
 {
-    auto* transportToUse = (type == TrackPlayerComponent::PlayerType::Vocal) ? &vocalTrackSource : &musicTrackSource;
+    auto* transportToUse = (type == TrackPlayerType::Vocal) ? &vocalTrackSource : &musicTrackSource;
     transportToUse->stop();
     transportToUse->setPosition(0);
 }
 
-void AudioEngine::pauseTrackPlayback(TrackPlayerComponent::PlayerType type)
+void AudioEngine::pauseTrackPlayback(TrackPlayerType type)
 {
-    auto* transportToUse = (type == TrackPlayerComponent::PlayerType::Vocal) ? &vocalTrackSource : &musicTrackSource;
+    auto* transportToUse = (type == TrackPlayerType::Vocal) ? &vocalTrackSource : &musicTrackSource;
     transportToUse->stop();
 }
 
-void AudioEngine::resumeTrackPlayback(TrackPlayerComponent::PlayerType type)
+void AudioEngine::resumeTrackPlayback(TrackPlayerType type)
 {
-    auto* transportToUse = (type == TrackPlayerComponent::PlayerType::Vocal) ? &vocalTrackSource : &musicTrackSource;
+    auto* transportToUse = (type == TrackPlayerType::Vocal) ? &vocalTrackSource : &musicTrackSource;
     transportToUse->start();
 }
 
-void AudioEngine::setTrackPlayerMute(TrackPlayerComponent::PlayerType type, bool shouldBeMuted)
+void AudioEngine::setTrackPlayerMute(TrackPlayerType type, bool shouldBeMuted)
 {
-    auto* transportToUse = (type == TrackPlayerComponent::PlayerType::Vocal) ? &vocalTrackSource : &musicTrackSource;
+    auto* transportToUse = (type == TrackPlayerType::Vocal) ? &vocalTrackSource : &musicTrackSource;
     transportToUse->setGain(shouldBeMuted ? 0.0f : 1.0f);
 }
 
-juce::AudioTransportSource& AudioEngine::getTrackTransportSource(TrackPlayerComponent::PlayerType type)
+void AudioEngine::setMusicKeyAndTempo(int semitones, double tempo)
 {
-    return (type == TrackPlayerComponent::PlayerType::Vocal) ? vocalTrackSource : musicTrackSource;
+    semitones = juce::jlimit(-12, 12, semitones);
+    tempo = juce::jlimit(0.5, 2.0, tempo);
+
+    if (isProjectPlaybackMode.load() || !currentMusicFile.existsAsFile())
+        return;
+    if (semitones == musicSemitones && juce::approximatelyEqual(tempo, musicTempo))
+        return;
+
+    // Transport time is always song time divided by the current tempo.
+    const bool wasPlaying = musicTrackSource.isPlaying();
+    const double songPosition = musicTrackSource.getCurrentPosition() * musicTempo;
+
+    musicRenderCache->cancelAll();
+    musicSemitones = semitones;
+    musicTempo = tempo;
+
+    if (semitones == 0 && juce::approximatelyEqual(tempo, 1.0))
+    {
+        musicPitchShiftActive = false;
+        openMusicTrack(currentMusicFile, 1.0, songPosition, wasPlaying);
+        return;
+    }
+
+    if (!musicRenderCache->isCached(currentMusicFile, semitones, tempo))
+    {
+        // Live preview until the render is ready: speed up by resampling the original,
+        // then let the cheap shifter correct the key.
+        musicPitchShifter.setPitchRatio(TimePitchShifter::getPitchRatioFor(semitones, tempo));
+        musicPitchShifterNeedsReset = true;
+        musicPitchShiftActive = true;
+        openMusicTrack(currentMusicFile, tempo, songPosition / tempo, wasPlaying);
+    }
+
+    musicRenderCache->requestRender(currentMusicFile, semitones, tempo,
+        [this, source = currentMusicFile, semitones, tempo, songPosition, wasPlaying](const juce::File& rendered)
+        {
+            if (rendered == juce::File() || source != currentMusicFile || isProjectPlaybackMode.load()
+                || semitones != musicSemitones || !juce::approximatelyEqual(tempo, musicTempo))
+                return;
+
+            // The render is already at the new tempo, so the transport position carries over.
+            const bool previewRunning = musicPitchShiftActive.load();
+            const bool playingNow = previewRunning ? musicTrackSource.isPlaying() : wasPlaying;
+            const double position = previewRunning ? musicTrackSource.getCurrentPosition() : songPosition / tempo;
+
+            musicPitchShiftActive = false;
+            openMusicTrack(rendered, 1.0, position, playingNow);
+        });
+}
+
+void AudioEngine::replaceMusicTrackFile(const juce::File& file)
+{
+    if (isProjectPlaybackMode.load() || !file.existsAsFile())
+        return;
+
+    const bool wasPlaying = musicTrackSource.isPlaying();
+    const double songPosition = musicTrackSource.getCurrentPosition() * musicTempo;
+
+    resetMusicKeyAndTempo();
+    currentMusicFile = file;
+    openMusicTrack(file, 1.0, songPosition, wasPlaying);
+}
+
+void AudioEngine::resetMusicKeyAndTempo()
+{
+    musicRenderCache->cancelAll();
+    musicPitchShiftActive = false;
+    musicSemitones = 0;
+    musicTempo = 1.0;
+}
+
+void AudioEngine::openMusicTrack(const juce::File& file, double speedRatio, double startPosition, bool shouldPlay)
+{
+    musicTrackSource.stop();
+    musicTrackSource.setSource(nullptr);
+    musicTrackReader.reset();
+
+    if (auto* reader = formatManager.createReaderFor(file))
+    {
+        musicTrackReader = std::make_unique<juce::AudioFormatReaderSource>(reader, true);
+        // A faked source rate makes the transport's resampler play faster or slower.
+        musicTrackSource.setSource(musicTrackReader.get(), 0, nullptr, reader->sampleRate * speedRatio);
+        musicTrackSource.setPosition(startPosition);
+        if (shouldPlay)
+            musicTrackSource.start();
+    }
 }
 
-AudioRecorder& AudioEngine::getTrackRecorder(TrackPlayerComponent::PlayerType type)
+juce::AudioTransportSource& AudioEngine::getTrackTransportSource(TrackPlayerType type)
 {
-    return (type == TrackPlayerComponent::PlayerType::Vocal) ? *vocalTrackRecorder : *musicTrackRecorder;
+    return (type == TrackPlayerType::Vocal) ? vocalTrackSource : musicTrackSource;
+}
+
+juce::File AudioEngine::getTrackFile(TrackPlayerType type) const
+{
+    const bool isVocal = (type == TrackPlayerType::Vocal);
+
+    if (isProjectPlaybackMode.load() && loadedProjectVocalFile != juce::File())
+        return isVocal ? loadedProjectVocalFile : loadedProjectMusicFile;
+
+    return isVocal ? currentVocalFile : currentMusicFile;
+}
+
+AudioRecorder& AudioEngine::getTrackRecorder(TrackPlayerType type)
+{
+    return (type == TrackPlayerType::Vocal) ? *vocalTrackRecorder : *musicTrackRecorder;
 }
 
 void AudioEngine::startProjectRecording(const juce::String& projectName)
@@ -479,8 +732,10 @@ void AudioEngine::startProjectRecording(const juce::String& projectName)
     currentVocalRawFile = projectDir.getChildFile(projectName + "_Vocal_RAW.wav");
     currentMusicRawFile = projectDir.getChildFile(projectName + "_Music_RAW.wav");
 
+    // Open both files first, then let the audio thread start them together.
     rawVocalRecorder->startRecording(currentVocalRawFile);
     rawMusicRecorder->startRecording(currentMusicRawFile);
+    projectStemsArmed = true;
 
     isProjectPlaybackMode = true;
 }
@@ -489,6 +744,7 @@ void AudioEngine::stopProjectRecording()
 {
     if (!isProjectPlaybackMode.load()) return;
 
+    projectStemsArmed = false;
     rawVocalRecorder->stop();
     rawMusicRecorder->stop();
 
@@ -533,6 +789,8 @@ void AudioEngine::loadProject(const juce::File& projectJsonFile)
     {
         stopLoadedProject();
         stopPlayback();
+        resetMusicKeyAndTempo();
+        currentMusicFile = juce::File();
 
         vocalTrackSource.setSource(nullptr);
         musicTrackSource.setSource(nullptr);
@@ -551,6 +809,8 @@ void AudioEngine::loadProject(const juce::File& projectJsonFile)
             musicTrackSource.setSource(musicTrackReader.get(), 0, nullptr, reader->sampleRate);
         }
 
+        loadedProjectVocalFile = vocalFile;
+        loadedProjectMusicFile = musicFile;
         isProjectPlaybackMode = true;
         projectState.setProperty(ProjectStateIDs::name, projectJsonFile.getFileNameWithoutExtension(), nullptr);
         projectState.setProperty(ProjectStateIDs::isPlaying, false, nullptr);
@@ -582,6 +842,8 @@ void AudioEngine::stopLoadedProject()
     musicTrackSource.setPosition(0);
 
     isProjectPlaybackMode = false;
+    loadedProjectVocalFile = juce::File();
+    loadedProjectMusicFile = juce::File();
 
     projectState.setProperty(ProjectStateIDs::name, {}, nullptr);
     projectState.setProperty(ProjectStateIDs::isPlaying, false, nullptr);
@@ -645,17 +907,81 @@ juce::ValueTree AudioEngine::getFullState()
     return state;
 }
 
-bool AudioEngine::prepareToLoadState(const juce::ValueTree& newState)
+juce::Array<ProcessorBase*> AudioEngine::getAllProcessors()
 {
-    if (!vocalProcessor.prepareToLoadState(newState)) return false;
-    if (!musicProcessor.prepareToLoadState(newState)) return false;
-    if (!masterProcessor.prepareToLoadState(newState)) return false;
+    juce::Array<ProcessorBase*> processors{ &vocalProcessor, &musicProcessor, &masterProcessor };
     for (int i = 0; i < 4; ++i)
     {
-        if (auto* p = getFxProcessorForVocal(i)) { if (!p->prepareToLoadState(newState)) return false; }
-        if (auto* p = getFxProcessorForMusic(i)) { if (!p->prepareToLoadState(newState)) return false; }
+        if (auto* p = getFxProcessorForVocal(i)) processors.add(p);
+        if (auto* p = getFxProcessorForMusic(i)) processors.add(p);
     }
-    return true;
+    return processors;
+}
+
+void AudioEngine::collectMetrics()
+{
+    auto& registry = MetricsRegistry::getInstance();
+
+    // Percentiles over the interval since the last export, not since startup, so a
+    // bad minute stands out.
+    const auto duration = callbackDuration.getSnapshot();
+    for (auto quantile : { 0.5, 0.95, 0.99 })
+        registry.addGauge("idol_callback_duration_quantile_seconds",
+                          "Callback time percentiles since the previous export, estimated from the histogram.",
+                          "quantile=\"" + juce::String(quantile) + "\"")
+            .set(callbackDuration.getQuantile(lastCallbackDuration, duration, quantile));
+    lastCallbackDuration = duration;
+
+    const auto load = callbackLoad.getSnapshot();
+    registry.addGauge("idol_callback_load", "Average share of the block deadline the callback used (1 = all of it).").set(load.averageLoad);
+    registry.addGauge("idol_callback_peak_load", "Peak share of the block deadline, decaying over two seconds.").set(load.peakLoad);
+    registry.addCounter("idol_callback_overruns_total", "Callbacks that took longer than their block lasts.")
+        .setTotal(overrunWatchdog->getNumOverruns());
+
+    // -1 means the driver doesn't report xruns.
+    const int deviceXRuns = deviceManager.getXRunCount();
+    if (deviceXRuns >= 0)
+        registry.addCounter("idol_device_xruns_total", "Xruns the audio driver reported.").setTotal((juce::uint64)deviceXRuns);
+
+    registry.addGauge("idol_sample_rate_hz", "Sample rate the engine is running at.").set(currentSampleRate);
+    registry.addGauge("idol_block_size_samples", "Block size the engine is running at.").set(currentBlockSize);
+
+    int numPlugins = 0;
+    for (auto* processor : getAllProcessors())
+        numPlugins += processor->getNumPlugins();
+    registry.addGauge("idol_plugins", "Plugins loaded across every chain.").set(numPlugins);
+    registry.addGauge("idol_preset_loading", "1 while a preset is being loaded.").set(presetLoader->isLoading() ? 1.0 : 0.0);
+
+    int numRecording = 0;
+    for (auto* recorder : { audioRecorder.get(), vocalTrackRecorder.get(), musicTrackRecorder.get(),
+                            rawVocalRecorder.get(), rawMusicRecorder.get() })
+        numRecording += recorder->isRecording() ? 1 : 0;
+    registry.addGauge("idol_recorders_active", "Recorders currently writing to disk.").set(numRecording);
+
+    registry.addCounter("idol_transport_underruns_total", "Backing tracks that ended before the next one in the queue was ready.")
+        .setTotal(backingTrackQueue->getNumUnderruns());
+
+    registry.addGauge("idol_peak_cache_open", "Waveform overviews held in memory.").set(peakCache->getNumOpenPyramids());
+    registry.addGauge("idol_peak_cache_pending_builds", "Waveform overviews waiting to be built.").set(peakCache->getNumPendingBuilds());
+
+    const auto renderCache = musicRenderCache->getDiskUsage();
+    registry.addGauge("idol_render_cache_files", "Key/tempo renders in the cache folder.").set(renderCache.numRenders);
+    registry.addGauge("idol_render_cache_bytes", "Size of the key/tempo render cache folder.").set((double)renderCache.totalBytes);
+
+    if (RealtimeChecker::isAvailable())
+        registry.addCounter("idol_realtime_violations_total", "Calls the audio callback made that allocate, lock or block.")
+            .setTotal(RealtimeChecker::getInstance().getNumViolations());
+}
+
+void AudioEngine::markStateSaved()
+{
+    for (auto* processor : getAllProcessors())
+        processor->markStateSaved();
+}
+
+bool AudioEngine::prepareToLoadState(const juce::ValueTree& newState, PresetLoader::Callbacks callbacks)
+{
+    return presetLoader->start(getAllProcessors(), newState, std::move(callbacks));
 }
 
 void AudioEngine::commitStateLoad()
@@ -11,14 +11,22 @@
 #include "TrackProcessor.h"
 #include "MasterProcessor.h"
 #include "AudioRecorder.h"
+#include "BackingTrackQueue.h"
+#include "TimePitchShifter.h"
+#include "TimePitchRenderCache.h"
+#include "VocalRemover.h"
+#include "PeakCache.h"
+#include "PresetLoader.h"
+#include "DspLoadMeter.h"
+#include "OverrunWatchdog.h"
+#include "../Diagnostics/MetricsExporter.h"
+#include "../Diagnostics/MetricsRegistry.h"
 #include "../Data/PresetManager.h"
+#include "TrackPlayerType.h"
 #include <functional>
-#include "../GUI/Components/TrackPlayerComponent.h"
 
 namespace IdolAZ { class SoundPlayer; }
 
-class TrackComponent;
-class MasterUtilityComponent;
 namespace juce { class AudioDeviceManager; }
 
 class AudioEngine : public juce::AudioIODeviceCallback
@@ -47,8 +55,6 @@ public:
     void setSelectedOutputChannelsByName(const juce::String& stereoPairName);
     int getSelectedOutputLeftChannel() const;
     int getSelectedOutputRightChannel() const;
-    void linkTrackComponents(TrackComponent& vocalTrackComp, TrackComponent& musicTrackComp);
-    void linkMasterComponents(MasterUtilityComponent& comp);
     TrackProcessor& getVocalProcessor();
     TrackProcessor& getMusicProcessor();
     MasterProcessor& getMasterProcessor();
@@ -66,13 +72,31 @@ public:
     float getPlaybackGain() const;
 
     // --- Các hàm điều khiển cho Player của từng Track ---
-    void startTrackPlayback(TrackPlayerComponent::PlayerType type, const juce::File& file);
-    void stopTrackPlayback(TrackPlayerComponent::PlayerType type);
-    void pauseTrackPlayback(TrackPlayerComponent::PlayerType type);
-    void resumeTrackPlayback(TrackPlayerComponent::PlayerType type);
-    void setTrackPlayerMute(TrackPlayerComponent::PlayerType type, bool shouldBeMuted);
-    juce::AudioTransportSource& getTrackTransportSource(TrackPlayerComponent::PlayerType type);
-    AudioRecorder& getTrackRecorder(TrackPlayerComponent::PlayerType type);
+    void startTrackPlayback(TrackPlayerType type, const juce::File& file);
+    void stopTrackPlayback(TrackPlayerType type);
+    void pauseTrackPlayback(TrackPlayerType type);
+    void resumeTrackPlayback(TrackPlayerType type);
+    void setTrackPlayerMute(TrackPlayerType type, bool shouldBeMuted);
+    juce::AudioTransportSource& getTrackTransportSource(TrackPlayerType type);
+    AudioRecorder& getTrackRecorder(TrackPlayerType type);
+    BackingTrackQueue& getBackingTrackQueue() { return *backingTrackQueue; }
+
+    // --- Đổi tông / tốc độ cho Music player ---
+    void setMusicKeyAndTempo(int semitones, double tempo);
+    int getMusicSemitones() const { return musicSemitones; }
+    double getMusicTempo() const { return musicTempo; }
+    bool hasMusicTrackLoaded() const { return currentMusicFile.existsAsFile(); }
+    bool isMusicRenderPending() const { return musicRenderCache->isRendering(); }
+    float getMusicRenderProgress() const { return musicRenderCache->getProgress(); }
+    juce::File getCurrentMusicFile() const { return currentMusicFile; }
+    /** Swaps the music player to another version of the same song, keeping its position. */
+    void replaceMusicTrackFile(const juce::File& file);
+    VocalRemover& getVocalRemover() { return *vocalRemover; }
+
+    // --- Waveform ---
+    PeakCache& getPeakCache() { return *peakCache; }
+    /** The file the track player is currently playing (or the loaded project stem). */
+    juce::File getTrackFile(TrackPlayerType type) const;
 
     // --- Các hàm điều khiển Project ---
     void startProjectRecording(const juce::String& projectName);
@@ -101,13 +125,76 @@ public:
 
     // <<< ADDED: New methods for robust state management >>>
     juce::ValueTree getFullState();
-    bool prepareToLoadState(const juce::ValueTree& newState);
+    /** Builds every processor's new chain in the background. Call commitStateLoad()
+        once onFinished reports success; failed or cancelled loads clean up after themselves. */
+    bool prepareToLoadState(const juce::ValueTree& newState, PresetLoader::Callbacks callbacks);
+    bool isLoadingState() const { return presetLoader->isLoading(); }
+    void cancelStateLoad() { presetLoader->cancel(); }
     void commitStateLoad();
     bool tryHotSwapState(const juce::ValueTree& newState);
+    /** Call after getFullState() has been written to a preset. */
+    void markStateSaved();
+
+    // --- DSP load ---
+    /** The parts of the audio callback that are timed separately. */
+    enum class Stage
+    {
+        inputs,         // track players, pitch shifting, backing tracks, soundboard, live inputs
+        vocalChain,
+        musicChain,
+        fxChains,       // all eight sends, chains and returns
+        masterChain,    // mixing down and the master chain
+        output,         // track recorders, direct outputs and the device buffers
+        numStages
+    };
+
+    static juce::String getStageName(Stage stage);
+    DspLoadMeter::Snapshot getStageLoad(Stage stage) const { return stageLoads[(size_t)stage].getSnapshot(); }
+    /** The whole callback against the block deadline. */
+    DspLoadMeter::Snapshot getCallbackLoad() const { return callbackLoad.getSnapshot(); }
+    OverrunWatchdog& getOverrunWatchdog() { return *overrunWatchdog; }
+    MetricsExporter& getMetricsExporter() { return *metricsExporter; }
+
+    // --- Taps ---
+    /** Points in the callback where a test harness can watch the signal. */
+    enum class Tap
+    {
+        vocalChain,     // after the vocal chain
+        musicChain,
+        vocalFx1, vocalFx2, vocalFx3, vocalFx4, // the FX returns, after their return level
+        musicFx1, musicFx2, musicFx3, musicFx4,
+        master,         // after the master chain, before the direct outputs are added
+        numTaps
+    };
+
+    /** Gets every tap's signal once per callback, on the audio thread. */
+    class TapListener
+    {
+    public:
+        virtual ~TapListener() = default;
+        /** The buffer is stereo and holds at least numSamples samples. */
+        virtual void tapped(Tap tap, const juce::AudioBuffer<float>& buffer, int numSamples) = 0;
+    };
+
+    static juce::String getTapName(Tap tap);
+    /** nullptr removes it. The listener must outlive the callback it is called from. */
+    void setTapListener(TapListener* listener) noexcept { tapListener = listener; }
 
 
 private:
     void prepareAllProcessors(double sampleRate, int samplesPerBlock);
+    void setWorkingBlockSize(int numSamples);
+    /** Whether a transport has to be read this block: while it plays, and for the block
+        after it stops, which carries its fade-out. An idle one is skipped, which keeps
+        its callback lock off the audio thread. */
+    static bool needsReading(const juce::AudioTransportSource& transport, bool& wasPlaying) noexcept;
+    void openMusicTrack(const juce::File& file, double speedRatio, double startPosition, bool shouldPlay);
+    void resetMusicKeyAndTempo();
+    juce::Array<ProcessorBase*> getAllProcessors();
+    using StageTimes = std::array<double, (size_t)Stage::numStages>;
+    void endStage(Stage stage, juce::int64& stageStartTicks, StageTimes& stageSeconds) noexcept;
+    void callTapListener(TapListener& listener, int numSamples);
+    void collectMetrics();
 
     juce::AudioDeviceManager& deviceManager;
     double stableSampleRate = 0.0;
@@ -122,28 +209,53 @@ private:
     FXChain vocalFxChain;
     FXChain musicFxChain;
     std::unique_ptr<IdolAZ::SoundPlayer> soundPlayer;
-    juce::MixerAudioSource soundboardMixer;
     juce::MixerAudioSource directOutputMixer;
     juce::AudioBuffer<float> vocalBuffer, musicStereoBuffer, mixBuffer, soundboardBuffer, directOutputBuffer, fxSendBuffer;
     std::array<juce::AudioBuffer<float>, 4> vocalFxReturnBuffers;
     std::array<juce::AudioBuffer<float>, 4> musicFxReturnBuffers;
     juce::AudioBuffer<float> vocalPlayerBuffer, musicPlayerBuffer;
     juce::AudioFormatManager formatManager;
+    std::unique_ptr<BackingTrackQueue> backingTrackQueue;
     std::unique_ptr<AudioRecorder> audioRecorder;
     std::unique_ptr<juce::AudioFormatReaderSource> currentPlaybackReader;
     juce::AudioTransportSource playbackSource;
     std::unique_ptr<juce::AudioFormatReaderSource> vocalTrackReader, musicTrackReader;
     juce::AudioTransportSource vocalTrackSource, musicTrackSource;
+    bool playbackWasPlaying = false, vocalTrackWasPlaying = false, musicTrackWasPlaying = false;  // audio thread only
+    juce::File currentMusicFile;
+    int musicSemitones = 0;
+    double musicTempo = 1.0;
+    TimePitchShifter musicPitchShifter;
+    std::unique_ptr<TimePitchRenderCache> musicRenderCache;
+    std::unique_ptr<VocalRemover> vocalRemover;
+    std::unique_ptr<PeakCache> peakCache;
+    juce::File currentVocalFile, loadedProjectVocalFile, loadedProjectMusicFile;
+    std::atomic<bool> musicPitchShiftActive{ false }, musicPitchShifterNeedsReset{ false };
     std::unique_ptr<AudioRecorder> vocalTrackRecorder, musicTrackRecorder;
     std::unique_ptr<AudioRecorder> rawVocalRecorder;
     std::unique_ptr<AudioRecorder> rawMusicRecorder;
+    // Both raw recorders are fed from the callback that first sees this, so the stems
+    // start on the same sample.
+    std::atomic<bool> projectStemsArmed{ false };
     std::atomic<bool> isProjectPlaybackMode{ false };
     juce::String currentProjectName;
     juce::File currentVocalRawFile;
     juce::File currentMusicRawFile;
     juce::ValueTree projectState{ "ProjectState" };
-    TrackComponent* vocalTrackComponent = nullptr;
-    TrackComponent* musicTrackComponent = nullptr;
+
+    DspLoadMeter callbackLoad;
+    std::atomic<TapListener*> tapListener{ nullptr };
+    std::array<DspLoadMeter, (size_t)Stage::numStages> stageLoads;
+    std::unique_ptr<OverrunWatchdog> overrunWatchdog;
+
+    // Metrics; the registry outlives the engine, so these never dangle.
+    MetricsRegistry::Histogram& callbackDuration;
+    MetricsRegistry::Histogram::Snapshot lastCallbackDuration;
+    int metricsCollectorId = 0;
+    std::unique_ptr<MetricsExporter> metricsExporter;
+
+    // Declared last: its workers touch the processors above and must stop first.
+    std::unique_ptr<PresetLoader> presetLoader;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioEngine)
 };
\ No newline at end of file
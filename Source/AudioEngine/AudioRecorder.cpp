@@ -1,13 +1,33 @@
 #include "AudioRecorder.h"
+#include "../Diagnostics/TraceRecorder.h"
+
+namespace
+{
+    juce::String getRecorderLabel(const juce::String& subDirectoryName)
+    {
+        return "recorder=\"" + (subDirectoryName.isEmpty() ? juce::String("mix") : subDirectoryName.toLowerCase()) + "\"";
+    }
+}
 
 AudioRecorder::AudioRecorder(juce::AudioFormatManager& formatManager, const juce::String& subDirectoryName)
-    : formatManagerToUse(formatManager), subDirectory(subDirectoryName)
+    : formatManagerToUse(formatManager), subDirectory(subDirectoryName),
+      writeSeconds(MetricsRegistry::getInstance().addHistogram("idol_recorder_write_seconds",
+          "Time the audio thread spent handing one block to a recording's writer.",
+          { 0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.002, 0.005, 0.010, 0.020, 0.050 },
+          getRecorderLabel(subDirectoryName))),
+      droppedSamples(MetricsRegistry::getInstance().addCounter("idol_recorder_dropped_samples_total",
+          "Samples lost because the disk writer fell behind.",
+          getRecorderLabel(subDirectoryName))),
+      fifoFill(MetricsRegistry::getInstance().addGauge("idol_recorder_fifo_fill",
+          "Share of the recording's disk-writer FIFO still waiting for the disk (1 = full, blocks are dropped).",
+          getRecorderLabel(subDirectoryName)))
 {
     backgroundThread.startThread();
 }
 
 AudioRecorder::~AudioRecorder()
 {
+    onRecordingFinished = nullptr;
     stop();
     backgroundThread.stopThread(5000);
 }
@@ -28,25 +48,56 @@ juce::File AudioRecorder::getRecordingsDirectory()
     return recordingDir;
 }
 
-// Hàm này chỉ chuẩn bị file và trạng thái
+void AudioRecorder::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+
+    // Recording was started before the device was running.
+    if (active.load() && writer == nullptr)
+        openWriter();
+}
+
 void AudioRecorder::startRecording()
 {
-    stop();
     auto timestamp = juce::Time::getCurrentTime().formatted("%Y-%m-%d_%H-%M-%S");
-    targetFileForNextWrite = getRecordingsDirectory().getChildFile("Rec_" + timestamp + ".wav");
-    active = true;
-    recordingStartTime = juce::Time::getMillisecondCounter();
+    startRecording(getRecordingsDirectory().getChildFile("Rec_" + timestamp + ".wav"));
 }
 
-// Hàm này cũng chỉ chuẩn bị file và trạng thái
-void AudioRecorder::startRecording(const juce::File& targetFile)
+void AudioRecorder::startRecording(const juce::File& fileToRecordTo)
 {
     stop();
-    targetFileForNextWrite = targetFile;
+    targetFile = fileToRecordTo;
+    openWriter();
     active = true;
     recordingStartTime = juce::Time::getMillisecondCounter();
 }
 
+bool AudioRecorder::openWriter()
+{
+    const double rate = sampleRate.load();
+    if (rate <= 0 || targetFile == juce::File() || targetFile.existsAsFile())
+        return false;
+
+    auto* format = formatManagerToUse.findFormatForFileExtension("wav");
+    std::unique_ptr<juce::OutputStream> stream(targetFile.createOutputStream());
+    if (format == nullptr || stream == nullptr)
+        return false;
+
+    std::unique_ptr<juce::AudioFormatWriter> fileWriter(format->createWriterFor(stream.get(), rate, 2, 16, {}, 0));
+    if (fileWriter == nullptr)
+        return false;
+    stream.release();
+
+    samplesQueued = 0;
+    samplesDrained = 0;
+    auto threadedWriter = std::make_unique<juce::AudioFormatWriter::ThreadedWriter>(fileWriter.release(), backgroundThread, writerFifoSamples);
+    threadedWriter->setDataReceiver(this);
+
+    const juce::SpinLock::ScopedLockType sl(writerLock);
+    writer = std::move(threadedWriter);
+    return true;
+}
+
 void AudioRecorder::stop()
 {
     if (active.load())
@@ -54,32 +105,61 @@ void AudioRecorder::stop()
         active = false;
         recordingStartTime = 0;
 
-        const juce::ScopedLock sl(writerCreationLock);
-        writer.reset();
-        targetFileForNextWrite = juce::File();
+        std::unique_ptr<juce::AudioFormatWriter::ThreadedWriter> finishedWriter;
+        {
+            const juce::SpinLock::ScopedLockType sl(writerLock);
+            finishedWriter = std::move(writer);
+        }
+
+        // Flushes whatever is still queued and closes the file.
+        finishedWriter.reset();
+        fifoFill.set(0.0);
+        const auto finishedFile = std::exchange(targetFile, juce::File());
+
+        if (onRecordingFinished != nullptr && finishedFile.existsAsFile())
+            onRecordingFinished(finishedFile);
     }
 }
 
-// <<< LOGIC ĐÚNG NẰM Ở ĐÂY >>>
-void AudioRecorder::processBlock(const juce::AudioBuffer<float>& buffer, double sampleRate)
+void AudioRecorder::processBlock(const juce::AudioBuffer<float>& buffer)
 {
-    if (active.load())
-    {
-        const juce::ScopedLock sl(writerCreationLock);
+    if (!active.load())
+        return;
 
-        // Nếu writer chưa được tạo, hãy tạo nó ngay bây giờ với sampleRate chính xác
-        if (writer == nullptr && sampleRate > 0 && targetFileForNextWrite.existsAsFile() == false)
-        {
-            writer.reset(formatManagerToUse.findFormatForFileExtension("wav")
-                ->createWriterFor(targetFileForNextWrite.createOutputStream().release(),
-                    sampleRate,
-                    buffer.getNumChannels(),
-                    16, {}, 0));
-        }
+    IDOL_TRACE_SCOPE("recorder", "Recorder push");
+
+    // Missing the lock means the writer is being swapped; that block is not worth waiting for.
+    const juce::SpinLock::ScopedTryLockType sl(writerLock);
+    if (!sl.isLocked() || writer == nullptr)
+        return;
 
-        if (writer != nullptr)
-            writer->writeFromAudioSampleBuffer(buffer, 0, buffer.getNumSamples());
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+    if (writer->write(buffer.getArrayOfReadPointers(), buffer.getNumSamples()))
+    {
+        samplesQueued += buffer.getNumSamples();
+        updateFifoFill();
+    }
+    else
+    {
+        droppedSamples.increment((juce::uint64)buffer.getNumSamples());
     }
+    writeSeconds.observe(juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks));
+}
+
+void AudioRecorder::reset(int, double, juce::int64)
+{
+}
+
+void AudioRecorder::addBlock(juce::int64, const juce::AudioBuffer<float>&, int, int numSamples)
+{
+    samplesDrained += numSamples;
+    updateFifoFill();
+}
+
+void AudioRecorder::updateFifoFill() noexcept
+{
+    const auto queued = samplesQueued.load() - samplesDrained.load();
+    fifoFill.set(juce::jlimit(0.0, 1.0, (double)queued / (double)writerFifoSamples));
 }
 
 bool AudioRecorder::isRecording() const
@@ -1,32 +1,63 @@
 #pragma once
 #include <JuceHeader.h>
+#include "../Diagnostics/MetricsRegistry.h"
 
-class AudioRecorder
+/**
+    Records the stereo blocks it is given to a 16-bit WAV file.
+
+    The file is opened on the message thread (or when the device starts, if recording
+    began before it did) and written by a background thread: processBlock() only copies
+    the block into the writer's FIFO, so the audio thread never locks or touches the disk.
+    How full that FIFO is goes to idol_recorder_fifo_fill; it nears 1 before blocks drop.
+*/
+class AudioRecorder : private juce::AudioFormatWriter::ThreadedWriter::IncomingDataReceiver
 {
 public:
     AudioRecorder(juce::AudioFormatManager& formatManager, const juce::String& subDirectoryName);
-    ~AudioRecorder();
+    ~AudioRecorder() override;
+
+    /** The rate recordings are written at; the engine calls it whenever the device starts. */
+    void prepare(double sampleRate);
 
     void startRecording();
     void startRecording(const juce::File& targetFile);
 
     void stop();
-    void processBlock(const juce::AudioBuffer<float>& buffer, double sampleRate);
+    /** Audio thread. */
+    void processBlock(const juce::AudioBuffer<float>& buffer);
     bool isRecording() const;
     double getCurrentRecordingTime() const;
 
     juce::File getRecordingsDirectory();
 
+    /** Called from stop() with the file that was just closed. */
+    std::function<void(const juce::File&)> onRecordingFinished;
+
 private:
+    /** Message thread. Won't write over an existing file. */
+    bool openWriter();
+
+    /** Writer thread: counts what it took out of the FIFO. */
+    void reset(int numChannels, double rate, juce::int64 totalSamplesInSource) override;
+    void addBlock(juce::int64 sampleNumberInSource, const juce::AudioBuffer<float>& newData,
+                  int startOffsetInBuffer, int numSamples) override;
+    void updateFifoFill() noexcept;
+
+    // About 1.4 s at 48 kHz: room for the disk to stall without losing audio.
+    static constexpr int writerFifoSamples = 65536;
+
     juce::AudioFormatManager& formatManagerToUse;
     juce::TimeSliceThread backgroundThread{ "Audio Recorder Thread" };
-    std::unique_ptr<juce::AudioFormatWriter> writer;
+    std::unique_ptr<juce::AudioFormatWriter::ThreadedWriter> writer;
+    juce::SpinLock writerLock;      // only held to swap the writer; the audio thread just tries it
     std::atomic<bool> active{ false };
     std::atomic<int64_t> recordingStartTime{ 0 };
+    std::atomic<double> sampleRate{ 0.0 };
+    std::atomic<juce::int64> samplesQueued{ 0 }, samplesDrained{ 0 };  // ThreadedWriter doesn't report its fill level
 
     juce::String subDirectory;
-
-    // Các biến cần thiết cho logic "trì hoãn tạo writer"
-    juce::File targetFileForNextWrite;
-    juce::CriticalSection writerCreationLock;
-};
\ No newline at end of file
+    juce::File targetFile;
+    MetricsRegistry::Histogram& writeSeconds;
+    MetricsRegistry::Counter& droppedSamples;
+    MetricsRegistry::Gauge& fifoFill;
+};
@@ -0,0 +1,580 @@
+/*
+  ==============================================================================
+
+    BackingTrackQueue.cpp
+
+  ==============================================================================
+*/
+
+#include "BackingTrackQueue.h"
+#include "../Diagnostics/TraceRecorder.h"
+
+namespace QueueIds
+{
+    const juce::Identifier BackingTrackQueue("BACKING_TRACK_QUEUE");
+    const juce::Identifier Track("TRACK");
+    const juce::Identifier path("path");
+    const juce::Identifier crossfade("crossfade");
+    const juce::Identifier currentIndex("currentIndex");
+}
+
+//==============================================================================
+struct BackingTrackQueue::Deck
+{
+    juce::File file;
+    int trackIndex = -1;
+    int generation = 0;
+    double fileSampleRate = 0.0;
+
+    // Declared in pull order so they are destroyed consumer first.
+    std::unique_ptr<juce::AudioFormatReaderSource> readerSource;
+    std::unique_ptr<juce::BufferingAudioSource> buffered;
+    std::unique_ptr<juce::ResamplingAudioSource> resampler;
+
+    juce::int64 lengthInSamples = 0;    // at the device sample rate
+    juce::int64 position = 0;           // audio thread
+    juce::int64 fadeLength = -1;        // decided when the deck reaches its crossfade point
+    std::atomic<juce::int64> reportedPosition{ 0 };
+    bool finished = false;              // guarded by deckLock
+
+    void seek(double seconds, double deviceRate)
+    {
+        position = juce::jlimit((juce::int64)0, lengthInSamples, (juce::int64)(seconds * deviceRate));
+        reportedPosition = position;
+        fadeLength = -1;
+
+        if (buffered != nullptr)
+        {
+            buffered->setNextReadPosition((juce::int64)((double)position * fileSampleRate / deviceRate));
+            resampler->flushBuffers();
+        }
+    }
+};
+
+//==============================================================================
+BackingTrackQueue::BackingTrackQueue(juce::AudioFormatManager& formatManagerToUse)
+    : formatManager(formatManagerToUse)
+{
+    readAheadThread.startThread();
+    startTimerHz(20);
+}
+
+BackingTrackQueue::~BackingTrackQueue()
+{
+    stopTimer();
+    openPool.removeAllJobs(true, 5000);
+
+    {
+        const juce::SpinLock::ScopedLockType sl(deckLock);
+        current = nullptr;
+        next = nullptr;
+    }
+
+    decks.clear();
+    openedDecks.clear();
+    readAheadThread.stopThread(2000);
+}
+
+//==============================================================================
+void BackingTrackQueue::addTracks(const juce::Array<juce::File>& files)
+{
+    for (const auto& file : files)
+        if (file.existsAsFile())
+            tracks.add(file);
+
+    if (currentIndex < 0 && !tracks.isEmpty())
+        currentIndex = 0;
+
+    lastTrackIndex = tracks.size() - 1;
+    sendChangeMessage();
+}
+
+void BackingTrackQueue::clear()
+{
+    playing = false;
+    resetDecks();
+    tracks.clear();
+    lastTrackIndex = -1;
+    currentIndex = -1;
+    pendingStartPosition = 0.0;
+    sendChangeMessage();
+}
+
+void BackingTrackQueue::playFromIndex(int index)
+{
+    if (!juce::isPositiveAndBelow(index, tracks.size()))
+        return;
+
+    resetDecks();
+    currentIndex = index;
+    pendingStartPosition = 0.0;
+    playing = true;
+    timerCallback();
+    sendChangeMessage();
+}
+
+void BackingTrackQueue::play()
+{
+    if (tracks.isEmpty())
+        return;
+
+    if (currentIndex < 0)
+        currentIndex = 0;
+
+    playing = true;
+    timerCallback();
+    sendChangeMessage();
+}
+
+void BackingTrackQueue::pause()
+{
+    playing = false;
+    sendChangeMessage();
+}
+
+void BackingTrackQueue::stop()
+{
+    playing = false;
+    resetDecks();
+    pendingStartPosition = 0.0;
+    sendChangeMessage();
+}
+
+void BackingTrackQueue::skipToNext()
+{
+    {
+        const juce::SpinLock::ScopedLockType sl(deckLock);
+        if (current != nullptr)
+        {
+            // The audio thread cuts over to the next deck, or finishes this one and
+            // lets the timer start the next song as soon as it is open.
+            pushCommand({ Command::Type::Skip, 0.0, current->generation });
+            return;
+        }
+    }
+
+    if (currentIndex + 1 < tracks.size())
+        playFromIndex(currentIndex + 1);
+    else
+        stop();
+}
+
+double BackingTrackQueue::getCurrentPosition() const
+{
+    const double rate = sampleRate.load();
+    const juce::SpinLock::ScopedLockType sl(deckLock);
+
+    if (current != nullptr && rate > 0.0)
+        return (double)current->reportedPosition.load() / rate;
+
+    return pendingStartPosition;
+}
+
+double BackingTrackQueue::getCurrentLength() const
+{
+    const double rate = sampleRate.load();
+    if (rate <= 0.0)
+        return 0.0;
+
+    for (auto* deck : decks)
+        if (deck->trackIndex == currentIndex)
+            return (double)deck->lengthInSamples / rate;
+
+    return 0.0;
+}
+
+void BackingTrackQueue::setCurrentPosition(double seconds)
+{
+    const juce::SpinLock::ScopedLockType sl(deckLock);
+
+    if (current == nullptr)
+        pendingStartPosition = juce::jmax(0.0, seconds);
+    else
+        pushCommand({ Command::Type::Seek, juce::jmax(0.0, seconds), current->generation });
+}
+
+void BackingTrackQueue::setCrossfadeSeconds(double seconds)
+{
+    crossfadeSeconds = juce::jlimit(0.0, 20.0, seconds);
+    sendChangeMessage();
+}
+
+juce::ValueTree BackingTrackQueue::getState() const
+{
+    juce::ValueTree state(QueueIds::BackingTrackQueue);
+    state.setProperty(QueueIds::crossfade, crossfadeSeconds.load(), nullptr);
+    state.setProperty(QueueIds::currentIndex, currentIndex, nullptr);
+
+    for (const auto& file : tracks)
+    {
+        juce::ValueTree track(QueueIds::Track);
+        track.setProperty(QueueIds::path, file.getFullPathName(), nullptr);
+        state.appendChild(track, nullptr);
+    }
+
+    return state;
+}
+
+void BackingTrackQueue::restoreState(const juce::ValueTree& state)
+{
+    if (!state.hasType(QueueIds::BackingTrackQueue))
+        return;
+
+    clear();
+
+    juce::Array<juce::File> files;
+    for (const auto& track : state)
+        files.add(juce::File(track.getProperty(QueueIds::path).toString()));
+
+    addTracks(files);
+    crossfadeSeconds = juce::jlimit(0.0, 20.0, (double)state.getProperty(QueueIds::crossfade, 0.0));
+
+    if (!tracks.isEmpty())
+        currentIndex = juce::jlimit(0, tracks.size() - 1, (int)state.getProperty(QueueIds::currentIndex, 0));
+
+    sendChangeMessage();
+}
+
+//==============================================================================
+void BackingTrackQueue::timerCallback()
+{
+    const double rate = sampleRate.load();
+    if (rate <= 0.0 || currentIndex < 0)
+        return;
+
+    if (preparedSampleRate > 0.0 && !juce::approximatelyEqual(rate, preparedSampleRate))
+    {
+        // Decks resample to the rate they were opened with, so reopen them.
+        const double position = getCurrentPosition();
+        resetDecks();
+        pendingStartPosition = position;
+    }
+    preparedSampleRate = rate;
+
+    // Collect decks opened in the background, keeping them ordered by track.
+    {
+        const juce::ScopedLock sl(openedLock);
+        for (int i = openedDecks.size(); --i >= 0;)
+        {
+            std::unique_ptr<Deck> deck(openedDecks.removeAndReturn(i));
+            if (deck->generation != generation)
+                continue;
+
+            requestedTracks.removeFirstMatchingValue(deck->trackIndex);
+
+            int insertIndex = 0;
+            while (insertIndex < decks.size() && decks[insertIndex]->trackIndex < deck->trackIndex)
+                ++insertIndex;
+
+            decks.insert(insertIndex, deck.release());
+        }
+    }
+
+    bool changed = false;
+    juce::OwnedArray<Deck> retired;
+
+    // With no current deck the audio thread isn't using any of them, so the first
+    // one can be moved to its start position here, before the lock is taken.
+    if (pendingStartPosition > 0.0 && playing.load() && !decks.isEmpty() && decks[0]->trackIndex == currentIndex)
+    {
+        bool isIdle = false;
+        {
+            const juce::SpinLock::ScopedLockType sl(deckLock);
+            isIdle = current == nullptr;
+        }
+
+        if (isIdle)
+        {
+            decks[0]->seek(pendingStartPosition, rate);
+            pendingStartPosition = 0.0;
+        }
+    }
+
+    {
+        const juce::SpinLock::ScopedLockType sl(deckLock);
+
+        // Follow what the audio thread did since the last tick.
+        int advancedTo = currentIndex;
+        for (int i = decks.size(); --i >= 0;)
+        {
+            auto* deck = decks.getUnchecked(i);
+            if (deck->finished || (deck != current && deck != next && deck->trackIndex < currentIndex))
+            {
+                if (deck->finished)
+                    advancedTo = juce::jmax(advancedTo, deck->trackIndex + 1);
+
+                retired.add(decks.removeAndReturn(i));
+            }
+        }
+
+        if (current != nullptr && current->trackIndex != currentIndex)
+        {
+            currentIndex = current->trackIndex;
+            changed = true;
+        }
+        else if (current == nullptr && advancedTo != currentIndex)
+        {
+            currentIndex = advancedTo;
+            changed = true;
+        }
+
+        if (currentIndex >= tracks.size())
+        {
+            // Ran off the end of the queue.
+            playing = false;
+            currentIndex = 0;
+        }
+
+        if (playing.load() && current == nullptr && !decks.isEmpty() && decks[0]->trackIndex == currentIndex)
+        {
+            pendingStartPosition = 0.0;
+            current = decks[0];
+        }
+
+        if (current != nullptr && next == nullptr)
+        {
+            const int index = decks.indexOf(current);
+            if (index >= 0 && index + 1 < decks.size() && decks[index + 1]->trackIndex == current->trackIndex + 1)
+                next = decks[index + 1];
+        }
+    }
+
+    // Retired decks are destroyed here, outside the lock and off the audio thread.
+    retired.clear();
+
+    for (int i = currentIndex; i <= currentIndex + numTracksToPrefetch; ++i)
+        requestDeck(i);
+
+    if (changed)
+        sendChangeMessage();
+}
+
+void BackingTrackQueue::requestDeck(int trackIndex)
+{
+    if (!juce::isPositiveAndBelow(trackIndex, tracks.size()) || requestedTracks.contains(trackIndex))
+        return;
+
+    for (auto* deck : decks)
+        if (deck->trackIndex == trackIndex)
+            return;
+
+    requestedTracks.add(trackIndex);
+
+    const auto file = tracks[trackIndex];
+    const int requestGeneration = generation;
+    const double rate = sampleRate.load();
+    const int expectedBlockSize = juce::jmax(512, blockSize.load());
+
+    openPool.addJob([this, file, trackIndex, requestGeneration, rate, expectedBlockSize]
+        {
+            auto deck = openDeck(file, trackIndex, rate, expectedBlockSize);
+
+            if (deck == nullptr)
+            {
+                // An empty deck is skipped by the audio thread like a zero-length song.
+                DBG("BackingTrackQueue: could not open " << file.getFullPathName());
+                deck = std::make_unique<Deck>();
+                deck->file = file;
+                deck->trackIndex = trackIndex;
+            }
+
+            deck->generation = requestGeneration;
+
+            const juce::ScopedLock sl(openedLock);
+            openedDecks.add(deck.release());
+        });
+}
+
+std::unique_ptr<BackingTrackQueue::Deck> BackingTrackQueue::openDeck(const juce::File& file, int trackIndex, double rate, int expectedBlockSize)
+{
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+    if (reader == nullptr || reader->sampleRate <= 0.0 || reader->lengthInSamples <= 0)
+        return nullptr;
+
+    auto deck = std::make_unique<Deck>();
+    deck->file = file;
+    deck->trackIndex = trackIndex;
+    deck->fileSampleRate = reader->sampleRate;
+    deck->lengthInSamples = (juce::int64)((double)reader->lengthInSamples * rate / reader->sampleRate);
+
+    deck->readerSource = std::make_unique<juce::AudioFormatReaderSource>(reader.release(), true);
+    deck->buffered = std::make_unique<juce::BufferingAudioSource>(deck->readerSource.get(), readAheadThread, false,
+        (int)(readAheadSeconds * deck->fileSampleRate), 2);
+    deck->resampler = std::make_unique<juce::ResamplingAudioSource>(deck->buffered.get(), false, 2);
+    deck->resampler->setResamplingRatio(deck->fileSampleRate / rate);
+
+    // Blocks this worker until the start of the song is buffered; the read-ahead
+    // thread keeps filling up to readAheadSeconds afterwards.
+    deck->resampler->prepareToPlay(expectedBlockSize, rate);
+
+    return deck;
+}
+
+void BackingTrackQueue::resetDecks()
+{
+    {
+        const juce::SpinLock::ScopedLockType sl(deckLock);
+        current = nullptr;
+        next = nullptr;
+    }
+
+    ++generation;
+    decks.clear();
+    requestedTracks.clear();
+
+    const juce::ScopedLock sl(openedLock);
+    openedDecks.clear();
+}
+
+//==============================================================================
+void BackingTrackQueue::prepareToPlay(int samplesPerBlockExpected, double newSampleRate)
+{
+    outgoingBuffer.setSize(2, samplesPerBlockExpected, false, false, true);
+    incomingBuffer.setSize(2, samplesPerBlockExpected, false, false, true);
+    blockSize = samplesPerBlockExpected;
+    sampleRate = newSampleRate;
+}
+
+void BackingTrackQueue::releaseResources()
+{
+}
+
+void BackingTrackQueue::pushCommand(const Command& command)
+{
+    const auto scope = commandFifo.write(1);
+
+    if (scope.blockSize1 > 0)
+        commandBuffer[(size_t)scope.startIndex1] = command;
+    else if (scope.blockSize2 > 0)
+        commandBuffer[(size_t)scope.startIndex2] = command;
+    else
+        DBG("BackingTrackQueue: command queue is full, seek or skip dropped.");
+}
+
+void BackingTrackQueue::handlePendingCommands()
+{
+    const auto scope = commandFifo.read(commandFifo.getNumReady());
+    const double rate = sampleRate.load();
+
+    scope.forEach([this, rate](int index)
+        {
+            const auto& command = commandBuffer[(size_t)index];
+            if (current == nullptr || current->generation != command.generation)
+                return;
+
+            if (command.type == Command::Type::Seek)
+            {
+                current->seek(command.seconds, rate);
+            }
+            else
+            {
+                current->finished = true;
+                current = next;
+                next = nullptr;
+            }
+
+            // Whatever the next deck played of a crossfade is thrown away.
+            if (next != nullptr)
+                next->seek(0.0, rate);
+            else if (command.type == Command::Type::Skip && current != nullptr)
+                current->seek(0.0, rate);
+        });
+}
+
+void BackingTrackQueue::renderDeck(Deck& deck, juce::AudioBuffer<float>& target, int numSamples)
+{
+    if (deck.resampler != nullptr)
+    {
+        juce::AudioSourceChannelInfo info(&target, 0, numSamples);
+        deck.resampler->getNextAudioBlock(info);
+    }
+    else
+    {
+        target.clear(0, numSamples);
+    }
+
+    deck.position += numSamples;
+    deck.reportedPosition = deck.position;
+}
+
+void BackingTrackQueue::addNextAudioBlock(juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    const juce::SpinLock::ScopedLockType sl(deckLock);
+
+    // Seeks made while paused still land.
+    handlePendingCommands();
+
+    if (!playing.load())
+        return;
+
+    IDOL_TRACE_SCOPE("transport", "Backing track queue");
+
+    if (numSamples > outgoingBuffer.getNumSamples())
+    {
+        jassertfalse; // prepareToPlay() was not called with this block size
+        return;
+    }
+
+    const int numChannels = juce::jmin(2, buffer.getNumChannels());
+    const auto wantedFade = (juce::int64)(crossfadeSeconds.load() * sampleRate.load());
+    int done = 0;
+
+    while (done < numSamples && current != nullptr)
+    {
+        auto& deck = *current;
+        const auto remaining = deck.lengthInSamples - deck.position;
+        const auto fadeStart = juce::jmin(wantedFade, deck.lengthInSamples / 2);
+
+        // Decide once per song whether it crossfades: only if the next song is ready.
+        // A short next song shortens the fade, which then starts later.
+        if (deck.fadeLength < 0 && remaining <= fadeStart)
+            deck.fadeLength = (next != nullptr && fadeStart > 0) ? juce::jmin(remaining, next->lengthInSamples / 2) : 0;
+
+        // Render up to the point where the fade starts, then through it.
+        auto limit = remaining;
+        if (deck.fadeLength < 0)
+            limit = remaining - fadeStart;
+        else if (deck.fadeLength > 0 && remaining > deck.fadeLength)
+            limit = remaining - deck.fadeLength;
+
+        const int n = (int)juce::jmin((juce::int64)(numSamples - done), limit);
+        const bool isFading = deck.fadeLength > 0 && remaining <= deck.fadeLength && next != nullptr;
+
+        if (n > 0)
+        {
+            renderDeck(deck, outgoingBuffer, n);
+
+            if (isFading)
+            {
+                const auto fade = (float)deck.fadeLength;
+                const float startGain = juce::jlimit(0.0f, 1.0f, (float)remaining / fade);
+                const float endGain = juce::jlimit(0.0f, 1.0f, (float)(remaining - n) / fade);
+
+                renderDeck(*next, incomingBuffer, n);
+
+                for (int ch = 0; ch < numChannels; ++ch)
+                {
+                    buffer.addFromWithRamp(ch, done, outgoingBuffer.getReadPointer(ch), n, startGain, endGain);
+                    buffer.addFromWithRamp(ch, done, incomingBuffer.getReadPointer(ch), n, 1.0f - startGain, 1.0f - endGain);
+                }
+            }
+            else
+            {
+                for (int ch = 0; ch < numChannels; ++ch)
+                    buffer.addFrom(ch, done, outgoingBuffer, ch, 0, n);
+            }
+
+            done += n;
+        }
+
+        if (deck.position >= deck.lengthInSamples)
+        {
+            // Gapless hand-over: the rest of this block comes from the next song.
+            deck.finished = true;
+            if (next == nullptr && deck.trackIndex < lastTrackIndex.load())
+                numUnderruns.fetch_add(1, std::memory_order_relaxed);
+            current = next;
+            next = nullptr;
+        }
+    }
+}
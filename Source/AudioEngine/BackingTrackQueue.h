@@ -0,0 +1,132 @@
+/*
+  ==============================================================================
+
+    BackingTrackQueue.h
+    (Playlist mode for the music player: prefetch + gapless/crossfade playback)
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+
+/**
+    A queue of backing tracks played back to back on the music player.
+
+    The next few tracks are opened on a background thread and their first seconds
+    are buffered before they are needed, so a song boundary costs no disk I/O on
+    the audio thread. The boundary is either gapless or a linear crossfade rendered
+    in addNextAudioBlock().
+
+    Everything except prepareToPlay/releaseResources/addNextAudioBlock must be
+    called on the message thread. A change message is sent whenever the current
+    track or the play state changes.
+
+    Seeks and skips touch the decks' sources, so they are queued and carried out by
+    the audio thread at the start of its next block; deckLock is only ever held by
+    the message thread for pointer swaps.
+*/
+class BackingTrackQueue : public juce::ChangeBroadcaster, private juce::Timer
+{
+public:
+    explicit BackingTrackQueue(juce::AudioFormatManager& formatManagerToUse);
+    ~BackingTrackQueue() override;
+
+    void addTracks(const juce::Array<juce::File>& files);
+    void clear();
+    void playFromIndex(int index);
+    void play();
+    void pause();
+    void stop();
+    void skipToNext();
+
+    bool isEmpty() const { return tracks.isEmpty(); }
+    bool isPlaying() const { return playing.load(); }
+    const juce::Array<juce::File>& getTracks() const { return tracks; }
+    int getCurrentIndex() const { return currentIndex; }
+    juce::File getCurrentFile() const { return tracks[currentIndex]; }
+
+    double getCurrentPosition() const;
+    double getCurrentLength() const;
+    void setCurrentPosition(double seconds);
+
+    /** 0 means gapless. */
+    void setCrossfadeSeconds(double seconds);
+    double getCrossfadeSeconds() const { return crossfadeSeconds.load(); }
+
+    /** Times a song ended before the next one in the queue was ready to take over,
+        leaving a gap. Any thread. */
+    juce::uint64 getNumUnderruns() const noexcept { return numUnderruns.load(); }
+
+    juce::ValueTree getState() const;
+    void restoreState(const juce::ValueTree& state);
+
+    // Audio thread
+    void prepareToPlay(int samplesPerBlockExpected, double newSampleRate);
+    void releaseResources();
+    /** Mixes the queue's output into the first two channels of the buffer. */
+    void addNextAudioBlock(juce::AudioBuffer<float>& buffer, int numSamples);
+
+    static constexpr int numTracksToPrefetch = 2;
+    static constexpr double readAheadSeconds = 10.0;
+
+private:
+    struct Deck;
+
+    struct Command
+    {
+        enum class Type { Seek, Skip };
+
+        Type type = Type::Seek;
+        double seconds = 0.0;
+        int generation = 0;     // the decks it was meant for; stale commands are dropped
+    };
+
+    void timerCallback() override;
+    void requestDeck(int trackIndex);
+    std::unique_ptr<Deck> openDeck(const juce::File& file, int trackIndex, double rate, int blockSize);
+    void resetDecks();
+    void renderDeck(Deck& deck, juce::AudioBuffer<float>& target, int numSamples);
+    void pushCommand(const Command& command);
+
+    // Audio thread, with deckLock held
+    void handlePendingCommands();
+
+    juce::AudioFormatManager& formatManager;
+    juce::TimeSliceThread readAheadThread{ "Backing track read-ahead" };
+    juce::ThreadPool openPool{ 1 };
+
+    // Message thread
+    juce::Array<juce::File> tracks;
+    int currentIndex = -1;
+    juce::OwnedArray<Deck> decks;           // decks[0] is the current track
+    juce::Array<int> requestedTracks;
+    double pendingStartPosition = 0.0;
+    double preparedSampleRate = 0.0;
+    int generation = 0;
+
+    // Hand-off from the background opener
+    juce::CriticalSection openedLock;
+    juce::OwnedArray<Deck> openedDecks;
+
+    // Shared with the audio thread; only held for pointer swaps.
+    mutable juce::SpinLock deckLock;
+    Deck* current = nullptr;
+    Deck* next = nullptr;
+
+    static constexpr int commandQueueSize = 32;
+    juce::AbstractFifo commandFifo{ commandQueueSize };
+    std::array<Command, commandQueueSize> commandBuffer;
+
+    std::atomic<bool> playing{ false };
+    std::atomic<double> crossfadeSeconds{ 0.0 };
+    std::atomic<double> sampleRate{ 0.0 };
+    std::atomic<int> blockSize{ 0 };
+    std::atomic<int> lastTrackIndex{ -1 };
+    std::atomic<juce::uint64> numUnderruns{ 0 };
+    juce::AudioBuffer<float> outgoingBuffer, incomingBuffer;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BackingTrackQueue)
+};
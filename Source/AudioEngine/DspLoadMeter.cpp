@@ -0,0 +1,51 @@
+/*
+  ==============================================================================
+
+    DspLoadMeter.cpp
+
+  ==============================================================================
+*/
+
+#include "DspLoadMeter.h"
+
+void DspLoadMeter::addMeasurement(double elapsedSeconds, double blockSeconds) noexcept
+{
+    if (blockSeconds <= 0.0)
+        return;
+
+    const auto load = (float)(elapsedSeconds / blockSeconds);
+
+    // One writer, so plain loads and stores are enough; readers only need each value whole.
+    const auto smoothing = (float)juce::jmin(1.0, blockSeconds / averagingTimeSeconds);
+    const auto decay = (float)juce::jmax(0.0, 1.0 - blockSeconds / peakDecayTimeSeconds);
+
+    const auto relaxed = std::memory_order_relaxed;
+    averageLoad.store(averageLoad.load(relaxed) + smoothing * (load - averageLoad.load(relaxed)), relaxed);
+    averageSeconds.store(averageSeconds.load(relaxed) + smoothing * ((float)elapsedSeconds - averageSeconds.load(relaxed)), relaxed);
+    peakLoad.store(juce::jmax(load, peakLoad.load(relaxed) * decay), relaxed);
+    peakSeconds.store(juce::jmax((float)elapsedSeconds, peakSeconds.load(relaxed) * decay), relaxed);
+
+    const int bucket = juce::jlimit(0, numHistogramBuckets - 1, (int)(load * 10.0f));
+    histogram[(size_t)bucket].store(histogram[(size_t)bucket].load(relaxed) + 1, relaxed);
+
+    if (load > 1.0f)
+        numOverruns.store(numOverruns.load(relaxed) + 1, relaxed);
+
+    numBlocks.store(numBlocks.load(relaxed) + 1, std::memory_order_release);
+}
+
+DspLoadMeter::Snapshot DspLoadMeter::getSnapshot() const noexcept
+{
+    Snapshot snapshot;
+    snapshot.numBlocks = numBlocks.load(std::memory_order_acquire);
+    snapshot.numOverruns = numOverruns.load(std::memory_order_relaxed);
+    snapshot.averageLoad = averageLoad.load(std::memory_order_relaxed);
+    snapshot.peakLoad = peakLoad.load(std::memory_order_relaxed);
+    snapshot.averageMs = averageSeconds.load(std::memory_order_relaxed) * 1000.0;
+    snapshot.peakMs = peakSeconds.load(std::memory_order_relaxed) * 1000.0;
+
+    for (size_t i = 0; i < histogram.size(); ++i)
+        snapshot.histogram[i] = histogram[i].load(std::memory_order_relaxed);
+
+    return snapshot;
+}
@@ -0,0 +1,80 @@
+/*
+  ==============================================================================
+
+    DspLoadMeter.h
+    (How much of the block deadline a piece of DSP uses)
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+
+/**
+    Accumulates the time one piece of DSP (a plugin slot, a processor, a stage of
+    the audio callback) takes per block, as a share of the block's duration.
+
+    The audio thread adds measurements and nothing else; it never locks or allocates.
+    Any other thread can take a snapshot at any time. Averages and peaks are smoothed
+    over wall-clock time, so they read the same whatever the block size.
+*/
+class DspLoadMeter
+{
+public:
+    /** 10% wide buckets of load; the last one holds every block past 110%. */
+    static constexpr int numHistogramBuckets = 12;
+
+    static constexpr double averagingTimeSeconds = 1.0;
+    static constexpr double peakDecayTimeSeconds = 2.0;
+
+    struct Snapshot
+    {
+        double averageLoad = 0.0;   // 1.0 = the whole block duration
+        double peakLoad = 0.0;
+        double averageMs = 0.0;
+        double peakMs = 0.0;
+        juce::uint64 numBlocks = 0;
+        juce::uint64 numOverruns = 0; // blocks that took longer than their duration
+        std::array<juce::uint32, numHistogramBuckets> histogram{};
+    };
+
+    DspLoadMeter() = default;
+
+    /** Audio thread only. */
+    void addMeasurement(double elapsedSeconds, double blockSeconds) noexcept;
+
+    Snapshot getSnapshot() const noexcept;
+
+    /** Times the enclosing scope and adds it to a meter. */
+    class ScopedMeasurement
+    {
+    public:
+        ScopedMeasurement(DspLoadMeter& meterToUse, double blockSecondsToUse) noexcept
+            : meter(meterToUse), blockSeconds(blockSecondsToUse), startTicks(juce::Time::getHighResolutionTicks())
+        {
+        }
+
+        ~ScopedMeasurement()
+        {
+            meter.addMeasurement(juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks),
+                                 blockSeconds);
+        }
+
+    private:
+        DspLoadMeter& meter;
+        const double blockSeconds;
+        const juce::int64 startTicks;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedMeasurement)
+    };
+
+private:
+    std::atomic<float> averageLoad{ 0.0f }, peakLoad{ 0.0f };
+    std::atomic<float> averageSeconds{ 0.0f }, peakSeconds{ 0.0f };
+    std::atomic<juce::uint64> numBlocks{ 0 }, numOverruns{ 0 };
+    std::array<std::atomic<juce::uint32>, numHistogramBuckets> histogram{};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DspLoadMeter)
+};
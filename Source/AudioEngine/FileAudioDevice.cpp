@@ -0,0 +1,272 @@
+/*
+  ==============================================================================
+
+    FileAudioDevice.cpp
+
+  ==============================================================================
+*/
+
+#include "FileAudioDevice.h"
+#include <algorithm>
+
+FileAudioDevice::FileAudioDevice(const Options& deviceOptions)
+    : juce::AudioIODevice("Files", "Offline"),
+      options(deviceOptions)
+{
+    options.numOutputChannels = juce::jmax(1, options.numOutputChannels);
+    options.blockSize = juce::jmax(1, options.blockSize);
+    formatManager.registerBasicFormats();
+    openInputs();
+}
+
+FileAudioDevice::~FileAudioDevice()
+{
+    close();
+}
+
+bool FileAudioDevice::openInputs()
+{
+    for (const auto& file : options.inputFiles)
+    {
+        auto* reader = formatManager.createReaderFor(file);
+        if (reader == nullptr)
+        {
+            lastError = "Could not read " + file.getFullPathName();
+            return false;
+        }
+
+        Input input;
+        input.firstChannel = numInputChannels;
+        input.numChannels = (int)reader->numChannels;
+
+        const double ratio = reader->sampleRate / options.sampleRate;
+        input.lengthInSamples = (juce::int64)((double)reader->lengthInSamples / ratio);
+        input.reader = std::make_unique<juce::AudioFormatReaderSource>(reader, true);
+        input.reader->prepareToPlay(options.blockSize, reader->sampleRate);
+
+        if (!juce::approximatelyEqual(ratio, 1.0))
+        {
+            input.resampler = std::make_unique<juce::ResamplingAudioSource>(input.reader.get(), false, input.numChannels);
+            input.resampler->setResamplingRatio(ratio);
+            input.resampler->prepareToPlay(options.blockSize, options.sampleRate);
+        }
+
+        numInputChannels += input.numChannels;
+        inputs.push_back(std::move(input));
+    }
+
+    return true;
+}
+
+juce::Range<int> FileAudioDevice::getInputChannels(int fileIndex) const
+{
+    if (!juce::isPositiveAndBelow(fileIndex, (int)inputs.size()))
+        return {};
+
+    const auto& input = inputs[(size_t)fileIndex];
+    return juce::Range<int>::withStartAndLength(input.firstChannel, input.numChannels);
+}
+
+//==============================================================================
+juce::StringArray FileAudioDevice::getOutputChannelNames()
+{
+    juce::StringArray names;
+    for (int i = 0; i < options.numOutputChannels; ++i)
+        names.add("Output " + juce::String(i + 1));
+    return names;
+}
+
+juce::StringArray FileAudioDevice::getInputChannelNames()
+{
+    juce::StringArray names;
+    for (size_t i = 0; i < inputs.size(); ++i)
+        for (int ch = 0; ch < inputs[i].numChannels; ++ch)
+            names.add(options.inputFiles[(int)i].getFileNameWithoutExtension() + " " + juce::String(ch + 1));
+    return names;
+}
+
+juce::Array<double> FileAudioDevice::getAvailableSampleRates() { return { options.sampleRate }; }
+juce::Array<int> FileAudioDevice::getAvailableBufferSizes() { return { options.blockSize }; }
+int FileAudioDevice::getDefaultBufferSize() { return options.blockSize; }
+
+juce::BigInteger FileAudioDevice::getActiveOutputChannels() const
+{
+    juce::BigInteger channels;
+    channels.setRange(0, options.numOutputChannels, true);
+    return channels;
+}
+
+juce::BigInteger FileAudioDevice::getActiveInputChannels() const
+{
+    juce::BigInteger channels;
+    channels.setRange(0, numInputChannels, true);
+    return channels;
+}
+
+juce::String FileAudioDevice::open(const juce::BigInteger&, const juce::BigInteger&, double sampleRate, int bufferSizeSamples)
+{
+    // The rate and block size are fixed by the options; anything else is a caller mistake.
+    if ((sampleRate > 0 && !juce::approximatelyEqual(sampleRate, options.sampleRate))
+        || (bufferSizeSamples > 0 && bufferSizeSamples != options.blockSize))
+        return "FileAudioDevice only runs at " + juce::String(options.sampleRate) + " Hz, "
+               + juce::String(options.blockSize) + " samples";
+
+    opened = lastError.isEmpty();
+    return lastError;
+}
+
+void FileAudioDevice::close()
+{
+    stop();
+    opened = false;
+}
+
+void FileAudioDevice::start(juce::AudioIODeviceCallback* callback)
+{
+    if (!opened || callback == nullptr || callback == currentCallback)
+        return;
+
+    stop();
+    callback->audioDeviceAboutToStart(this);
+    currentCallback = callback;
+}
+
+void FileAudioDevice::stop()
+{
+    if (auto* callback = std::exchange(currentCallback, nullptr))
+        callback->audioDeviceStopped();
+}
+
+//==============================================================================
+bool FileAudioDevice::render(std::function<bool(double progress)> onProgress)
+{
+    if (!opened || currentCallback == nullptr)
+    {
+        lastError = "The device must be opened and started before rendering";
+        return false;
+    }
+
+    juce::int64 totalSamples = 0;
+    if (options.lengthSeconds > 0.0)
+        totalSamples = (juce::int64)(options.lengthSeconds * options.sampleRate);
+    else
+        for (const auto& input : inputs)
+            totalSamples = juce::jmax(totalSamples, input.lengthInSamples);
+    totalSamples += (juce::int64)(juce::jmax(0.0, options.tailSeconds) * options.sampleRate);
+
+    if (totalSamples <= 0)
+    {
+        lastError = "Nothing to render: no inputs and no length given";
+        return false;
+    }
+
+    std::unique_ptr<juce::TemporaryFile> temp;
+    std::unique_ptr<juce::AudioFormatWriter> writer;
+    if (options.outputFile != juce::File())
+    {
+        options.outputFile.getParentDirectory().createDirectory();
+        temp = std::make_unique<juce::TemporaryFile>(options.outputFile);
+
+        std::unique_ptr<juce::OutputStream> stream(temp->getFile().createOutputStream());
+        juce::WavAudioFormat wavFormat;
+        if (stream != nullptr)
+            writer.reset(wavFormat.createWriterFor(stream.get(), options.sampleRate,
+                (unsigned int)options.numOutputChannels, 24, {}, 0));
+        if (writer == nullptr)
+        {
+            lastError = "Could not write " + options.outputFile.getFullPathName();
+            return false;
+        }
+        stream.release();
+    }
+
+    const int blockSize = options.blockSize;
+    juce::AudioBuffer<float> inputBuffer(juce::jmax(1, numInputChannels), blockSize);
+    juce::AudioBuffer<float> outputBuffer(options.numOutputChannels, blockSize);
+
+    blockTimesMs.clear();
+    blockTimesMs.reserve((size_t)((totalSamples + blockSize - 1) / blockSize));
+
+    const auto renderStartTicks = juce::Time::getHighResolutionTicks();
+    juce::int64 position = 0;
+
+    while (position < totalSamples)
+    {
+        inputBuffer.clear();
+        for (auto& input : inputs)
+        {
+            juce::AudioBuffer<float> channels(inputBuffer.getArrayOfWritePointers() + input.firstChannel, input.numChannels, blockSize);
+            const juce::AudioSourceChannelInfo info(&channels, 0, blockSize);
+
+            if (input.resampler != nullptr)
+                input.resampler->getNextAudioBlock(info);
+            else
+                input.reader->getNextAudioBlock(info);
+        }
+
+        // The callback always gets a whole block, as it would from hardware; only the
+        // part within the render length is written.
+        outputBuffer.clear();
+        const auto callbackStartTicks = juce::Time::getHighResolutionTicks();
+        currentCallback->audioDeviceIOCallbackWithContext(inputBuffer.getArrayOfReadPointers(), numInputChannels,
+                                                          outputBuffer.getArrayOfWritePointers(), options.numOutputChannels,
+                                                          blockSize, {});
+        blockTimesMs.push_back(juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - callbackStartTicks) * 1000.0);
+
+        const int numToWrite = (int)juce::jmin((juce::int64)blockSize, totalSamples - position);
+        if (writer != nullptr && !writer->writeFromAudioSampleBuffer(outputBuffer, 0, numToWrite))
+        {
+            lastError = "Could not write " + options.outputFile.getFullPathName();
+            return false;
+        }
+
+        position += numToWrite;
+        if (onProgress != nullptr && !onProgress((double)position / (double)totalSamples))
+            break;
+    }
+
+    updateStats(juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - renderStartTicks));
+    stats.audioSeconds = (double)position / options.sampleRate;
+
+    writer.reset();
+    if (temp != nullptr && !temp->overwriteTargetFileWithTemporary())
+    {
+        lastError = "Could not replace " + options.outputFile.getFullPathName();
+        return false;
+    }
+
+    return true;
+}
+
+void FileAudioDevice::updateStats(double renderSeconds)
+{
+    stats = {};
+    stats.numBlocks = (int)blockTimesMs.size();
+    stats.blockMs = options.blockSize * 1000.0 / options.sampleRate;
+    stats.renderSeconds = renderSeconds;
+
+    if (blockTimesMs.empty())
+        return;
+
+    auto sorted = blockTimesMs;
+    std::sort(sorted.begin(), sorted.end());
+
+    const auto percentile = [&sorted](double fraction)
+    {
+        return sorted[(size_t)std::round(fraction * (double)(sorted.size() - 1))];
+    };
+
+    double sum = 0.0;
+    for (auto ms : sorted)
+    {
+        sum += ms;
+        if (ms > stats.blockMs)
+            ++stats.numOverruns;
+    }
+
+    stats.averageMs = sum / (double)sorted.size();
+    stats.medianMs = percentile(0.5);
+    stats.p95Ms = percentile(0.95);
+    stats.p99Ms = percentile(0.99);
+    stats.maxMs = sorted.back();
+}
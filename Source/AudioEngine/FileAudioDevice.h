@@ -0,0 +1,113 @@
+/*
+  ==============================================================================
+
+    FileAudioDevice.h
+    (A virtual audio device fed from audio files, for rendering without hardware)
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+/**
+    An AudioIODevice with no hardware behind it: its inputs are read from audio files
+    and its output is written to a WAV file. render() runs the callback given to start()
+    block after block on the calling thread, as fast as it can, and times every block.
+
+    Each input file fills as many input channels as it has, in the order given, so a
+    mono vocal file followed by a stereo music file makes inputs 0, 1 and 2. Files at
+    another sample rate are resampled on the way in.
+*/
+class FileAudioDevice : public juce::AudioIODevice
+{
+public:
+    struct Options
+    {
+        juce::Array<juce::File> inputFiles;
+        juce::File outputFile;              // none: the output is thrown away
+        int numOutputChannels = 2;
+        double sampleRate = 48000.0;
+        int blockSize = 256;
+        double lengthSeconds = 0.0;         // 0: until the longest input ends
+        double tailSeconds = 0.0;           // rendered after that, for reverb and delay tails
+    };
+
+    struct Stats
+    {
+        int numBlocks = 0;
+        int numOverruns = 0;                // blocks that took longer than they last
+        double blockMs = 0.0;
+        double audioSeconds = 0.0;
+        double renderSeconds = 0.0;
+        double averageMs = 0.0, medianMs = 0.0, p95Ms = 0.0, p99Ms = 0.0, maxMs = 0.0;
+
+        double getRealtimeFactor() const { return renderSeconds > 0.0 ? audioSeconds / renderSeconds : 0.0; }
+    };
+
+    explicit FileAudioDevice(const Options& options);
+    ~FileAudioDevice() override;
+
+    /** Runs the whole render; call after open() and start(). onProgress (0..1) can
+        return false to stop early. Returns false if an input or the output failed. */
+    bool render(std::function<bool(double progress)> onProgress = nullptr);
+
+    const Stats& getStats() const noexcept { return stats; }
+    /** How long each callback took, in render order. */
+    const std::vector<double>& getBlockTimesMs() const noexcept { return blockTimesMs; }
+    /** The input channels an input file fills; empty if it couldn't be read. */
+    juce::Range<int> getInputChannels(int fileIndex) const;
+
+    //==============================================================================
+    juce::StringArray getOutputChannelNames() override;
+    juce::StringArray getInputChannelNames() override;
+    juce::Array<double> getAvailableSampleRates() override;
+    juce::Array<int> getAvailableBufferSizes() override;
+    int getDefaultBufferSize() override;
+
+    juce::String open(const juce::BigInteger& inputChannels, const juce::BigInteger& outputChannels,
+                      double sampleRate, int bufferSizeSamples) override;
+    void close() override;
+    bool isOpen() override { return opened; }
+    void start(juce::AudioIODeviceCallback* callback) override;
+    void stop() override;
+    bool isPlaying() override { return currentCallback != nullptr; }
+    juce::String getLastError() override { return lastError; }
+
+    int getCurrentBufferSizeSamples() override { return options.blockSize; }
+    double getCurrentSampleRate() override { return options.sampleRate; }
+    int getCurrentBitDepth() override { return 32; }
+    juce::BigInteger getActiveOutputChannels() const override;
+    juce::BigInteger getActiveInputChannels() const override;
+    int getOutputLatencyInSamples() override { return 0; }
+    int getInputLatencyInSamples() override { return 0; }
+
+private:
+    struct Input
+    {
+        std::unique_ptr<juce::AudioFormatReaderSource> reader;
+        std::unique_ptr<juce::ResamplingAudioSource> resampler;
+        int firstChannel = 0;
+        int numChannels = 0;
+        juce::int64 lengthInSamples = 0;    // at the device's rate
+    };
+
+    bool openInputs();
+    void updateStats(double renderSeconds);
+
+    Options options;
+    juce::AudioFormatManager formatManager;
+    std::vector<Input> inputs;
+    int numInputChannels = 0;
+
+    juce::AudioIODeviceCallback* currentCallback = nullptr;
+    bool opened = false;
+    juce::String lastError;
+
+    Stats stats;
+    std::vector<double> blockTimesMs;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FileAudioDevice)
+};
@@ -0,0 +1,190 @@
+/*
+  ==============================================================================
+
+    OverrunWatchdog.cpp
+
+  ==============================================================================
+*/
+
+#include "OverrunWatchdog.h"
+#include "ProcessorBase.h"
+#include "../Diagnostics/TraceRecorder.h"
+
+namespace WatchdogIds
+{
+    const juce::Identifier OVERRUN_WATCHDOG("OVERRUN_WATCHDOG");
+    const juce::Identifier enabled("enabled");
+    const juce::Identifier maxOverruns("maxOverruns");
+    const juce::Identifier windowSeconds("windowSeconds");
+    const juce::Identifier minSlotShare("minSlotShare");
+    const juce::Identifier fadeMs("fadeMs");
+}
+
+OverrunWatchdog::OverrunWatchdog(const juce::Array<ProcessorBase*>& processorsToWatch)
+    : processors(processorsToWatch)
+{
+    startTimerHz(10);
+}
+
+OverrunWatchdog::~OverrunWatchdog()
+{
+    stopTimer();
+}
+
+void OverrunWatchdog::callbackFinished(double callbackSeconds, double blockSeconds) noexcept
+{
+    if (blockSeconds <= 0.0 || callbackSeconds <= blockSeconds)
+        return;
+
+    numOverruns.fetch_add(1, std::memory_order_relaxed);
+
+    if (!enabled.load(std::memory_order_relaxed))
+        return;
+
+    // The processors ran earlier in this same callback, so their timings are this block's.
+    Overrun overrun;
+    double slowestSeconds = 0.0;
+
+    for (int i = 0; i < processors.size(); ++i)
+    {
+        const auto& slowest = processors.getUnchecked(i)->getSlowestSlotOfLastBlock();
+        if (slowest.plugin != nullptr && slowest.seconds > slowestSeconds)
+        {
+            slowestSeconds = slowest.seconds;
+            overrun.processorIndex = i;
+            overrun.plugin = slowest.plugin;
+        }
+    }
+
+    if (overrun.plugin == nullptr || slowestSeconds < blockSeconds * minSlotShare.load(std::memory_order_relaxed))
+        return;
+
+    overrun.timeMs = juce::Time::getMillisecondCounterHiRes();
+    overrun.callbackMs = callbackSeconds * 1000.0;
+    overrun.slotMs = slowestSeconds * 1000.0;
+    overrun.blockMs = blockSeconds * 1000.0;
+
+    // If the message thread has fallen this far behind, dropping a few is fine.
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(1, start1, size1, start2, size2);
+    if (size1 > 0)
+        pendingOverruns[(size_t)start1] = overrun;
+    fifo.finishedWrite(size1);
+}
+
+void OverrunWatchdog::timerCallback()
+{
+    IDOL_TRACE_SCOPE("message", "Overrun watchdog");
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(fifo.getNumReady(), start1, size1, start2, size2);
+
+    for (int i = 0; i < size1; ++i)
+        handleOverrun(pendingOverruns[(size_t)(start1 + i)]);
+    for (int i = 0; i < size2; ++i)
+        handleOverrun(pendingOverruns[(size_t)(start2 + i)]);
+
+    fifo.finishedRead(size1 + size2);
+
+    // Forget plugins that have behaved for a whole window.
+    const auto now = juce::Time::getMillisecondCounterHiRes();
+    for (auto it = history.begin(); it != history.end();)
+    {
+        auto& overruns = it->second;
+        while (!overruns.empty() && now - overruns.front().timeMs > rule.windowSeconds * 1000.0)
+            overruns.pop_front();
+
+        it = overruns.empty() ? history.erase(it) : std::next(it);
+    }
+}
+
+void OverrunWatchdog::handleOverrun(const Overrun& overrun)
+{
+    if (!rule.enabled || !juce::isPositiveAndBelow(overrun.processorIndex, processors.size()))
+        return;
+
+    auto& overruns = history[{ overrun.processorIndex, overrun.plugin }];
+    overruns.push_back(overrun);
+
+    while (overrun.timeMs - overruns.front().timeMs > rule.windowSeconds * 1000.0)
+        overruns.pop_front();
+
+    if ((int)overruns.size() < rule.maxOverruns)
+        return;
+
+    Trip trip;
+    trip.processor = processors.getUnchecked(overrun.processorIndex);
+    trip.numOverruns = (int)overruns.size();
+    trip.windowSeconds = rule.windowSeconds;
+    trip.blockMs = overrun.blockMs;
+    for (const auto& o : overruns)
+    {
+        trip.worstCallbackMs = juce::jmax(trip.worstCallbackMs, o.callbackMs);
+        trip.worstSlotMs = juce::jmax(trip.worstSlotMs, o.slotMs);
+    }
+
+    history.erase({ overrun.processorIndex, overrun.plugin });
+
+    // The plugin may have been moved or removed since the audio thread saw it.
+    trip.slot = trip.processor->indexOfPlugin(static_cast<const juce::AudioPluginInstance*>(overrun.plugin));
+    if (trip.slot < 0 || trip.processor->isPluginBypassed(trip.slot))
+        return;
+
+    if (auto* plugin = trip.processor->getPlugin(trip.slot))
+        trip.pluginName = plugin->getName();
+
+    trip.processor->setPluginBypassed(trip.slot, true, rule.fadeMs);
+    trip.processor->sendChangeMessage();
+
+    juce::Logger::writeToLog("Overrun watchdog: bypassed '" + trip.pluginName + "' (slot " + juce::String(trip.slot + 1)
+                             + " of " + trip.processor->getProcessorId().toString() + ") after "
+                             + juce::String(trip.numOverruns) + " overruns in " + juce::String(trip.windowSeconds, 1)
+                             + " s; worst callback " + juce::String(trip.worstCallbackMs, 2) + " ms, plugin "
+                             + juce::String(trip.worstSlotMs, 2) + " ms, block " + juce::String(trip.blockMs, 2) + " ms");
+
+    if (onPluginBypassed != nullptr)
+        onPluginBypassed(trip);
+}
+
+void OverrunWatchdog::setRule(const Rule& newRule)
+{
+    rule = newRule;
+    rule.maxOverruns = juce::jmax(1, rule.maxOverruns);
+    rule.windowSeconds = juce::jmax(0.1, rule.windowSeconds);
+    rule.minSlotShare = juce::jlimit(0.0, 1.0, rule.minSlotShare);
+    rule.fadeMs = juce::jlimit(0.0, 500.0, rule.fadeMs);
+
+    enabled = rule.enabled;
+    minSlotShare = (float)rule.minSlotShare;
+    history.clear();
+}
+
+OverrunWatchdog::Rule OverrunWatchdog::getRule() const
+{
+    return rule;
+}
+
+juce::ValueTree OverrunWatchdog::getState() const
+{
+    juce::ValueTree state(WatchdogIds::OVERRUN_WATCHDOG);
+    state.setProperty(WatchdogIds::enabled, rule.enabled, nullptr);
+    state.setProperty(WatchdogIds::maxOverruns, rule.maxOverruns, nullptr);
+    state.setProperty(WatchdogIds::windowSeconds, rule.windowSeconds, nullptr);
+    state.setProperty(WatchdogIds::minSlotShare, rule.minSlotShare, nullptr);
+    state.setProperty(WatchdogIds::fadeMs, rule.fadeMs, nullptr);
+    return state;
+}
+
+void OverrunWatchdog::restoreState(const juce::ValueTree& state)
+{
+    if (!state.hasType(WatchdogIds::OVERRUN_WATCHDOG))
+        return;
+
+    const Rule defaults;
+    Rule newRule;
+    newRule.enabled = state.getProperty(WatchdogIds::enabled, defaults.enabled);
+    newRule.maxOverruns = state.getProperty(WatchdogIds::maxOverruns, defaults.maxOverruns);
+    newRule.windowSeconds = state.getProperty(WatchdogIds::windowSeconds, defaults.windowSeconds);
+    newRule.minSlotShare = state.getProperty(WatchdogIds::minSlotShare, defaults.minSlotShare);
+    newRule.fadeMs = state.getProperty(WatchdogIds::fadeMs, defaults.fadeMs);
+    setRule(newRule);
+}
@@ -0,0 +1,101 @@
+/*
+  ==============================================================================
+
+    OverrunWatchdog.h
+    (Bypasses a plugin that keeps making the audio callback miss its deadline)
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <deque>
+#include <map>
+
+class ProcessorBase;
+
+/**
+    Watches every audio callback against its deadline (numSamples / sampleRate).
+
+    When a callback overruns, the slowest plugin slot of that block is blamed, as long
+    as it took a real share of the block; an overrun nobody in particular caused (a
+    device hiccup) is only counted. Blame is collected on the message thread, and a
+    plugin that is blamed often enough within the rule's window is bypassed with a
+    short fade and reported through onPluginBypassed.
+
+    callbackFinished() is the only audio-thread entry point; it doesn't lock or allocate.
+*/
+class OverrunWatchdog : private juce::Timer
+{
+public:
+    struct Rule
+    {
+        bool enabled = true;
+        int maxOverruns = 3;            // this many overruns blamed on one plugin...
+        double windowSeconds = 2.0;     // ...within this long trips the rule
+        double minSlotShare = 0.25;     // a slot must have used this much of the block to be blamed
+        double fadeMs = 20.0;
+    };
+
+    /** Sent to the UI when a plugin has been bypassed. */
+    struct Trip
+    {
+        ProcessorBase* processor = nullptr;
+        int slot = -1;
+        juce::String pluginName;
+        int numOverruns = 0;
+        double windowSeconds = 0.0;
+        double worstCallbackMs = 0.0;
+        double worstSlotMs = 0.0;
+        double blockMs = 0.0;
+    };
+
+    /** The processors must outlive the watchdog; their order is fixed from here on. */
+    explicit OverrunWatchdog(const juce::Array<ProcessorBase*>& processorsToWatch);
+    ~OverrunWatchdog() override;
+
+    /** Audio thread, once at the end of each callback. */
+    void callbackFinished(double callbackSeconds, double blockSeconds) noexcept;
+
+    void setRule(const Rule& newRule);
+    Rule getRule() const;
+
+    /** Overruns seen since the watchdog was created, blamed or not. */
+    juce::uint64 getNumOverruns() const noexcept { return numOverruns.load(); }
+
+    juce::ValueTree getState() const;
+    void restoreState(const juce::ValueTree& state);
+
+    std::function<void(const Trip&)> onPluginBypassed;
+
+private:
+    struct Overrun
+    {
+        int processorIndex = -1;
+        const void* plugin = nullptr;   // identity only; checked against the chain before use
+        double timeMs = 0.0;
+        double callbackMs = 0.0;
+        double slotMs = 0.0;
+        double blockMs = 0.0;
+    };
+
+    void timerCallback() override;
+    void handleOverrun(const Overrun& overrun);
+
+    const juce::Array<ProcessorBase*> processors;
+
+    static constexpr int fifoSize = 64;
+    juce::AbstractFifo fifo{ fifoSize };
+    std::array<Overrun, fifoSize> pendingOverruns;
+    std::atomic<juce::uint64> numOverruns{ 0 };
+    std::atomic<float> minSlotShare{ 0.25f };
+    std::atomic<bool> enabled{ true };
+
+    // Message thread only.
+    Rule rule;
+    std::map<std::pair<int, const void*>, std::deque<Overrun>> history;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OverrunWatchdog)
+};
@@ -0,0 +1,140 @@
+/*
+  ==============================================================================
+
+    PeakCache.cpp
+
+  ==============================================================================
+*/
+
+#include "PeakCache.h"
+
+//==============================================================================
+class PeakCache::BuildJob : public juce::ThreadPoolJob
+{
+public:
+    BuildJob(PeakCache& ownerToUse, const juce::File& sourceFile)
+        : juce::ThreadPoolJob("Waveform peaks"),
+          owner(ownerToUse), weakOwner(&ownerToUse), source(sourceFile)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        std::unique_ptr<juce::AudioFormatReader> reader(owner.formatManager.createReaderFor(source));
+        const auto cancelled = [this] { return shouldExit(); };
+        bool succeeded = false;
+
+        if (reader != nullptr)
+        {
+            succeeded = PeakPyramid::build(*reader, source, getSidecarFileFor(source), cancelled);
+
+            // The source folder may be read-only; keep the overview in our own folder instead.
+            if (!succeeded && !shouldExit())
+                succeeded = PeakPyramid::build(*reader, source, getFallbackSidecarFileFor(source), cancelled);
+        }
+
+        if (shouldExit())
+            return jobHasFinished;
+
+        juce::MessageManager::callAsync([weak = weakOwner, file = source, succeeded]
+        {
+            if (weak != nullptr)
+                weak->buildFinished(file, succeeded);
+        });
+
+        return jobHasFinished;
+    }
+
+private:
+    PeakCache& owner;
+    juce::WeakReference<PeakCache> weakOwner;
+    const juce::File source;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BuildJob)
+};
+
+//==============================================================================
+PeakCache::PeakCache(juce::AudioFormatManager& formatManagerToUse)
+    : formatManager(formatManagerToUse)
+{
+}
+
+PeakCache::~PeakCache()
+{
+    buildPool.removeAllJobs(true, 5000);
+}
+
+juce::File PeakCache::getSidecarFileFor(const juce::File& source)
+{
+    return source.getSiblingFile(source.getFileName() + ".peaks");
+}
+
+juce::File PeakCache::getFallbackSidecarFileFor(const juce::File& source)
+{
+    const auto hash = juce::MD5(source.getFullPathName().toUTF8()).toHexString();
+
+    return juce::File::getSpecialLocation(juce::File::SpecialLocationType::userApplicationDataDirectory)
+        .getChildFile(ProjectInfo::companyName)
+        .getChildFile(ProjectInfo::projectName)
+        .getChildFile("PeakCache")
+        .getChildFile(hash + ".peaks");
+}
+
+PeakPyramid::Ptr PeakCache::getPyramid(const juce::File& source)
+{
+    if (!source.existsAsFile())
+        return nullptr;
+
+    for (int i = 0; i < openPyramids.size(); ++i)
+    {
+        auto pyramid = openPyramids[i];
+        if (pyramid->getSourceFile() == source)
+        {
+            openPyramids.move(i, 0);
+            return pyramid;
+        }
+    }
+
+    if (pendingBuilds.contains(source) || failedBuilds.contains(source))
+        return nullptr;
+
+    auto pyramid = PeakPyramid::open(getSidecarFileFor(source), source);
+    if (pyramid == nullptr)
+        pyramid = PeakPyramid::open(getFallbackSidecarFileFor(source), source);
+
+    if (pyramid == nullptr)
+    {
+        requestBuild(source);
+        return nullptr;
+    }
+
+    openPyramids.insert(0, pyramid);
+    while (openPyramids.size() > maxOpenPyramids)
+        openPyramids.removeLast();
+
+    return pyramid;
+}
+
+void PeakCache::requestBuild(const juce::File& source)
+{
+    if (!source.existsAsFile() || pendingBuilds.contains(source))
+        return;
+
+    // Unmap any stale copy first so the sidecar can be replaced.
+    for (int i = openPyramids.size(); --i >= 0;)
+        if (openPyramids[i]->getSourceFile() == source)
+            openPyramids.remove(i);
+
+    failedBuilds.removeFirstMatchingValue(source);
+    pendingBuilds.add(source);
+    buildPool.addJob(new BuildJob(*this, source), true);
+}
+
+void PeakCache::buildFinished(const juce::File& source, bool succeeded)
+{
+    pendingBuilds.removeFirstMatchingValue(source);
+    if (!succeeded)
+        failedBuilds.addIfNotAlreadyThere(source);
+
+    sendChangeMessage();
+}
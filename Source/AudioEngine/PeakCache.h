@@ -0,0 +1,58 @@
+/*
+  ==============================================================================
+
+    PeakCache.h
+    (Builds and hands out waveform peak pyramids)
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PeakPyramid.h"
+
+/**
+    Finds, builds and keeps open the PeakPyramid of audio files.
+
+    Pyramids are built on one background thread, the first time a file is shown
+    or as soon as a recording finishes. The sidecar goes next to the audio file as
+    "<file>.peaks". If that folder can't be written, it goes to the app's
+    PeakCache folder instead. A change message is sent whenever a build finishes.
+
+    Message thread only.
+*/
+class PeakCache : public juce::ChangeBroadcaster
+{
+public:
+    explicit PeakCache(juce::AudioFormatManager& formatManagerToUse);
+    ~PeakCache() override;
+
+    /** Returns the pyramid if it is ready, otherwise queues a build and returns nullptr. */
+    PeakPyramid::Ptr getPyramid(const juce::File& source);
+
+    /** Queues a (re)build, e.g. when a recording has just been closed. */
+    void requestBuild(const juce::File& source);
+
+    int getNumOpenPyramids() const { return openPyramids.size(); }
+    int getNumPendingBuilds() const { return pendingBuilds.size(); }
+
+    static juce::File getSidecarFileFor(const juce::File& source);
+    static juce::File getFallbackSidecarFileFor(const juce::File& source);
+
+    static constexpr int maxOpenPyramids = 8;
+
+private:
+    class BuildJob;
+
+    void buildFinished(const juce::File& source, bool succeeded);
+
+    juce::AudioFormatManager& formatManager;
+    juce::ThreadPool buildPool{ 1 };
+    juce::Array<juce::File> pendingBuilds;
+    juce::Array<juce::File> failedBuilds;    // not retried until requestBuild() is called again
+    juce::ReferenceCountedArray<PeakPyramid> openPyramids;   // most recently used first
+
+    JUCE_DECLARE_WEAK_REFERENCEABLE(PeakCache)
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PeakCache)
+};
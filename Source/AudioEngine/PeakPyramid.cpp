@@ -0,0 +1,255 @@
+/*
+  ==============================================================================
+
+    PeakPyramid.cpp
+
+  ==============================================================================
+*/
+
+#include "PeakPyramid.h"
+
+namespace
+{
+    constexpr int formatVersion = 1;
+    constexpr int headerSize = 64;
+    constexpr int levelEntrySize = 24;
+    constexpr int bytesPerPeak = 4;
+    constexpr int maxStoredChannels = 2;
+    constexpr int minPeaksInTopLevel = 64;
+
+    struct Accumulator
+    {
+        float minimum = 0.0f, maximum = 0.0f;
+        double sumOfSquares = 0.0;
+        juce::int64 count = 0;
+
+        void add(float sampleMin, float sampleMax, double squares, juce::int64 numSamples)
+        {
+            minimum = count == 0 ? sampleMin : juce::jmin(minimum, sampleMin);
+            maximum = count == 0 ? sampleMax : juce::jmax(maximum, sampleMax);
+            sumOfSquares += squares;
+            count += numSamples;
+        }
+    };
+
+    void encodePeak(juce::uint8* dest, float minimum, float maximum, float rms)
+    {
+        dest[0] = (juce::uint8)(juce::int8)juce::jlimit(-127, 127, juce::roundToInt(minimum * 127.0f));
+        dest[1] = (juce::uint8)(juce::int8)juce::jlimit(-127, 127, juce::roundToInt(maximum * 127.0f));
+        dest[2] = (juce::uint8)juce::jlimit(0, 255, juce::roundToInt(rms * 255.0f));
+        dest[3] = 0;
+    }
+
+    double readDouble(const juce::uint8* source)
+    {
+        auto bits = (juce::uint64)juce::ByteOrder::littleEndianInt64(source);
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+}
+
+//==============================================================================
+PeakPyramid::Ptr PeakPyramid::open(const juce::File& sidecar, const juce::File& source)
+{
+    if (!sidecar.existsAsFile() || sidecar.getSize() < headerSize)
+        return nullptr;
+
+    Ptr pyramid(new PeakPyramid());
+    pyramid->mappedFile = std::make_unique<juce::MemoryMappedFile>(sidecar, juce::MemoryMappedFile::readOnly);
+
+    const auto* bytes = static_cast<const juce::uint8*>(pyramid->mappedFile->getData());
+    const auto size = (juce::int64)pyramid->mappedFile->getSize();
+
+    if (bytes == nullptr || size < headerSize
+        || std::memcmp(bytes, "ILPK", 4) != 0
+        || (int)juce::ByteOrder::littleEndianInt(bytes + 4) != formatVersion)
+        return nullptr;
+
+    // A sidecar only describes the exact file it was built from.
+    if (juce::ByteOrder::littleEndianInt64(bytes + 32) != source.getSize()
+        || juce::ByteOrder::littleEndianInt64(bytes + 40) != source.getLastModificationTime().toMilliseconds())
+        return nullptr;
+
+    pyramid->sourceFile = source;
+    pyramid->data = bytes;
+    pyramid->numChannels = (int)juce::ByteOrder::littleEndianInt(bytes + 8);
+    const int numLevels = (int)juce::ByteOrder::littleEndianInt(bytes + 12);
+    pyramid->sampleRate = readDouble(bytes + 16);
+    pyramid->numSamples = juce::ByteOrder::littleEndianInt64(bytes + 24);
+
+    if (!juce::isPositiveAndNotGreaterThan(pyramid->numChannels, maxStoredChannels)
+        || !juce::isPositiveAndBelow(numLevels, 32)
+        || size < headerSize + numLevels * levelEntrySize)
+        return nullptr;
+
+    for (int i = 0; i < numLevels; ++i)
+    {
+        const auto* entry = bytes + headerSize + i * levelEntrySize;
+        Level level;
+        level.samplesPerPeak = juce::ByteOrder::littleEndianInt(entry);
+        level.numPeaks = juce::ByteOrder::littleEndianInt64(entry + 8);
+        level.offset = juce::ByteOrder::littleEndianInt64(entry + 16);
+
+        if (level.samplesPerPeak <= 0 || level.offset + level.numPeaks * pyramid->numChannels * bytesPerPeak > size)
+            return nullptr;
+
+        pyramid->levels.push_back(level);
+    }
+
+    return pyramid;
+}
+
+PeakPyramid::Peak PeakPyramid::getPeak(int channel, juce::int64 startSample, juce::int64 endSample) const
+{
+    Peak result;
+    if (levels.empty() || !juce::isPositiveAndBelow(channel, numChannels) || endSample <= startSample)
+        return result;
+
+    // The coarsest level that still has at least one peak inside the range.
+    const auto span = endSample - startSample;
+    const Level* level = &levels.front();
+    for (const auto& candidate : levels)
+        if (candidate.samplesPerPeak <= span)
+            level = &candidate;
+
+    const auto first = juce::jlimit((juce::int64)0, level->numPeaks, startSample / level->samplesPerPeak);
+    const auto last = juce::jlimit(first, level->numPeaks, (endSample + level->samplesPerPeak - 1) / level->samplesPerPeak);
+    if (first == last)
+        return result;
+
+    float minimum = 1.0f, maximum = -1.0f, sumOfSquares = 0.0f;
+    for (auto i = first; i < last; ++i)
+    {
+        const auto* peak = data + level->offset + (i * numChannels + channel) * bytesPerPeak;
+        const float rms = (float)peak[2] / 255.0f;
+
+        minimum = juce::jmin(minimum, (float)(juce::int8)peak[0] / 127.0f);
+        maximum = juce::jmax(maximum, (float)(juce::int8)peak[1] / 127.0f);
+        sumOfSquares += rms * rms;
+    }
+
+    result.minimum = minimum;
+    result.maximum = maximum;
+    result.rms = std::sqrt(sumOfSquares / (float)(last - first));
+    return result;
+}
+
+//==============================================================================
+bool PeakPyramid::build(juce::AudioFormatReader& reader, const juce::File& source, const juce::File& sidecar,
+                        const std::function<bool()>& shouldCancel)
+{
+    const int channels = juce::jlimit(1, maxStoredChannels, (int)reader.numChannels);
+    const auto length = reader.lengthInSamples;
+    if (length <= 0)
+        return false;
+
+    // Finest level straight from the audio.
+    std::vector<std::vector<juce::uint8>> levelData;
+    std::vector<juce::int64> levelSamplesPerPeak;
+
+    const auto basePeaks = (length + baseSamplesPerPeak - 1) / baseSamplesPerPeak;
+    levelData.emplace_back((size_t)(basePeaks * channels * bytesPerPeak), (juce::uint8)0);
+    levelSamplesPerPeak.push_back(baseSamplesPerPeak);
+
+    constexpr int blockSize = baseSamplesPerPeak * 256;
+    juce::AudioBuffer<float> block(channels, blockSize);
+
+    for (juce::int64 position = 0; position < length; position += blockSize)
+    {
+        if (shouldCancel != nullptr && shouldCancel())
+            return false;
+
+        const int numToRead = (int)juce::jmin((juce::int64)blockSize, length - position);
+        if (!reader.read(&block, 0, numToRead, position, true, true))
+            return false;
+
+        for (int offset = 0; offset < numToRead; offset += baseSamplesPerPeak)
+        {
+            const int count = juce::jmin(baseSamplesPerPeak, numToRead - offset);
+            const auto peakIndex = (position + offset) / baseSamplesPerPeak;
+
+            for (int ch = 0; ch < channels; ++ch)
+            {
+                const auto* samples = block.getReadPointer(ch, offset);
+                const auto range = juce::FloatVectorOperations::findMinAndMax(samples, count);
+
+                double squares = 0.0;
+                for (int i = 0; i < count; ++i)
+                    squares += (double)samples[i] * samples[i];
+
+                encodePeak(levelData[0].data() + (peakIndex * channels + ch) * bytesPerPeak,
+                           range.getStart(), range.getEnd(), (float)std::sqrt(squares / count));
+            }
+        }
+    }
+
+    // Coarser levels are folded from the one below.
+    while ((juce::int64)levelData.back().size() / (channels * bytesPerPeak) > minPeaksInTopLevel)
+    {
+        const auto& below = levelData.back();
+        const auto belowPeaks = (juce::int64)below.size() / (channels * bytesPerPeak);
+        const auto numPeaks = (belowPeaks + levelRatio - 1) / levelRatio;
+        std::vector<juce::uint8> level((size_t)(numPeaks * channels * bytesPerPeak), (juce::uint8)0);
+
+        for (juce::int64 i = 0; i < numPeaks; ++i)
+        {
+            for (int ch = 0; ch < channels; ++ch)
+            {
+                Accumulator acc;
+                for (auto j = i * levelRatio; j < juce::jmin(belowPeaks, (i + 1) * levelRatio); ++j)
+                {
+                    const auto* peak = below.data() + (j * channels + ch) * bytesPerPeak;
+                    const double rms = peak[2] / 255.0;
+                    acc.add((float)(juce::int8)peak[0] / 127.0f, (float)(juce::int8)peak[1] / 127.0f, rms * rms, 1);
+                }
+
+                encodePeak(level.data() + (i * channels + ch) * bytesPerPeak,
+                           acc.minimum, acc.maximum, (float)std::sqrt(acc.sumOfSquares / (double)acc.count));
+            }
+        }
+
+        levelSamplesPerPeak.push_back(levelSamplesPerPeak.back() * levelRatio);
+        levelData.push_back(std::move(level));
+    }
+
+    // Write header, level table and data through a temporary file.
+    sidecar.getParentDirectory().createDirectory();
+    juce::TemporaryFile temp(sidecar);
+
+    {
+        juce::FileOutputStream out(temp.getFile());
+        if (!out.openedOk())
+            return false;
+
+        const int numLevels = (int)levelData.size();
+        out.write("ILPK", 4);
+        out.writeInt(formatVersion);
+        out.writeInt(channels);
+        out.writeInt(numLevels);
+        out.writeDouble(reader.sampleRate);
+        out.writeInt64(length);
+        out.writeInt64(source.getSize());
+        out.writeInt64(source.getLastModificationTime().toMilliseconds());
+        out.writeRepeatedByte(0, (size_t)(headerSize - 48));
+
+        auto offset = (juce::int64)(headerSize + numLevels * levelEntrySize);
+        for (int i = 0; i < numLevels; ++i)
+        {
+            out.writeInt((int)levelSamplesPerPeak[(size_t)i]);
+            out.writeInt(0);
+            out.writeInt64((juce::int64)levelData[(size_t)i].size() / (channels * bytesPerPeak));
+            out.writeInt64(offset);
+            offset += (juce::int64)levelData[(size_t)i].size();
+        }
+
+        for (const auto& level : levelData)
+            out.write(level.data(), level.size());
+
+        out.flush();
+        if (out.getStatus().failed())
+            return false;
+    }
+
+    return temp.overwriteTargetFileWithTemporary();
+}
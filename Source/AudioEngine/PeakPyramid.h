@@ -0,0 +1,74 @@
+/*
+  ==============================================================================
+
+    PeakPyramid.h
+    (Multi-resolution min/max/RMS overview of an audio file, memory-mapped)
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+    A read-only view of a ".peaks" sidecar file.
+
+    The sidecar holds the same overview at several resolutions. The finest level
+    has one peak per 256 samples, and every level above it is 4x coarser. A query
+    for any sample range reads only a handful of entries from the best-fitting
+    level. Drawing an overview is therefore proportional to its width in pixels,
+    whatever the file length.
+
+    File layout (little endian):
+        header   64 bytes   "ILPK", version, channels, levels, sample rate,
+                            length, source size and source modification time
+        levels   24 bytes   samples per peak, peak count, data offset (per level)
+        data     4 bytes    int8 min, int8 max, uint8 rms, pad (per peak and channel)
+*/
+class PeakPyramid : public juce::ReferenceCountedObject
+{
+public:
+    using Ptr = juce::ReferenceCountedObjectPtr<PeakPyramid>;
+
+    struct Peak
+    {
+        float minimum = 0.0f, maximum = 0.0f, rms = 0.0f;
+    };
+
+    /** Maps the sidecar; returns nullptr if it is missing, corrupt or older than the source. */
+    static Ptr open(const juce::File& sidecar, const juce::File& source);
+
+    /** Reads the whole source once and writes its sidecar. Returns false on failure or if cancelled. */
+    static bool build(juce::AudioFormatReader& reader, const juce::File& source, const juce::File& sidecar,
+                      const std::function<bool()>& shouldCancel);
+
+    const juce::File& getSourceFile() const { return sourceFile; }
+    int getNumChannels() const { return numChannels; }
+    juce::int64 getNumSamples() const { return numSamples; }
+    double getSampleRate() const { return sampleRate; }
+
+    /** Combined peak of [startSample, endSample) on one channel. */
+    Peak getPeak(int channel, juce::int64 startSample, juce::int64 endSample) const;
+
+    static constexpr int baseSamplesPerPeak = 256;
+    static constexpr int levelRatio = 4;
+
+private:
+    struct Level
+    {
+        juce::int64 samplesPerPeak = 0, numPeaks = 0, offset = 0;
+    };
+
+    PeakPyramid() = default;
+
+    juce::File sourceFile;
+    std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+    const juce::uint8* data = nullptr;
+    std::vector<Level> levels;
+    int numChannels = 0;
+    juce::int64 numSamples = 0;
+    double sampleRate = 0.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PeakPyramid)
+};
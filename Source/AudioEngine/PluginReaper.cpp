@@ -0,0 +1,211 @@
+/*
+  ==============================================================================
+
+    PluginReaper.cpp
+
+  ==============================================================================
+*/
+
+#include "PluginReaper.h"
+#include "../Diagnostics/StallDetector.h"
+
+PluginReaper& PluginReaper::getInstance()
+{
+    static PluginReaper instance;
+    return instance;
+}
+
+PluginReaper::PluginReaper()
+    : juce::Thread("Plugin reaper")
+{
+    startThread();
+}
+
+PluginReaper::~PluginReaper()
+{
+    shutdown();
+}
+
+//==============================================================================
+void PluginReaper::release(std::unique_ptr<juce::AudioPluginInstance> plugin)
+{
+    if (plugin == nullptr)
+        return;
+
+    // The window showing the editor has to go first; it owns the editor component.
+    jassert(plugin->getActiveEditor() == nullptr);
+
+    Entry entry{ std::move(plugin), juce::Time::getMillisecondCounterHiRes() };
+
+    {
+        const juce::ScopedLock sl(queueLock);
+
+        if (!isShutDown && (int)queue.size() < maxQueuedPlugins)
+        {
+            queue.push_back(std::move(entry));
+            stats.maxQueued = juce::jmax(stats.maxQueued, (int)queue.size());
+            notify();
+            return;
+        }
+
+        if (!isShutDown)
+            ++stats.numOverflows;
+    }
+
+    // Queue full (or shutting down): do it here, the old blocking way.
+    IDOL_STALL_OPERATION("Tear down plugin in place");
+    DBG("PluginReaper: tearing down " << entry.plugin->getName() << " synchronously.");
+    suspend(*entry.plugin);
+    if (needsGracePeriod(*entry.plugin))
+        juce::Thread::sleep(wavesGracePeriodMs);
+
+    destroy(entry);
+}
+
+void PluginReaper::release(juce::OwnedArray<juce::AudioPluginInstance>& plugins)
+{
+    for (int i = plugins.size(); --i >= 0;)
+        release(std::unique_ptr<juce::AudioPluginInstance>(plugins.removeAndReturn(i)));
+}
+
+void PluginReaper::shutdown()
+{
+    {
+        const juce::ScopedLock sl(queueLock);
+        if (isShutDown)
+            return;
+
+        isShutDown = true;
+    }
+
+    // The reaper never waits for the message thread, so this can't deadlock.
+    signalThreadShouldExit();
+    notify();
+    stopThread(wavesGracePeriodMs * 4);
+    cancelPendingUpdate();
+
+    std::deque<Entry> remaining;
+    {
+        const juce::ScopedLock sl(queueLock);
+        remaining.swap(awaitingDelete);
+        for (auto& entry : queue)
+            remaining.push_back(std::move(entry));
+        queue.clear();
+    }
+
+    for (auto& entry : remaining)
+    {
+        suspend(*entry.plugin);
+        destroy(entry);
+    }
+}
+
+PluginReaper::Stats PluginReaper::getStats() const
+{
+    const juce::ScopedLock sl(queueLock);
+    auto current = stats;
+    current.numQueued = (int)queue.size();
+    current.numAwaitingDelete = (int)awaitingDelete.size();
+    return current;
+}
+
+//==============================================================================
+void PluginReaper::run()
+{
+    while (!threadShouldExit())
+    {
+        Entry entry;
+
+        {
+            const juce::ScopedLock sl(queueLock);
+            if (!queue.empty())
+            {
+                entry = std::move(queue.front());
+                queue.pop_front();
+            }
+        }
+
+        if (entry.plugin == nullptr)
+        {
+            wait(-1);
+            continue;
+        }
+
+        suspend(*entry.plugin);
+
+        // Waves shells keep worker threads alive for a moment after suspending. Every
+        // release() notifies this thread, so wait against a deadline, not one timeout.
+        if (needsGracePeriod(*entry.plugin))
+        {
+            const auto until = juce::Time::getMillisecondCounter() + (juce::uint32)wavesGracePeriodMs;
+            for (auto now = juce::Time::getMillisecondCounter(); !threadShouldExit() && now < until;
+                 now = juce::Time::getMillisecondCounter())
+                wait((int)(until - now));
+        }
+
+        {
+            const juce::ScopedLock sl(queueLock);
+            awaitingDelete.push_back(std::move(entry));
+        }
+
+        triggerAsyncUpdate();
+    }
+}
+
+void PluginReaper::handleAsyncUpdate()
+{
+    std::deque<Entry> ready;
+    {
+        const juce::ScopedLock sl(queueLock);
+        ready.swap(awaitingDelete);
+    }
+
+    for (auto& entry : ready)
+        destroy(entry);
+}
+
+//==============================================================================
+bool PluginReaper::needsGracePeriod(const juce::AudioPluginInstance& plugin)
+{
+    return plugin.getName().containsIgnoreCase("wave")
+        || plugin.getPluginDescription().manufacturerName.containsIgnoreCase("waves");
+}
+
+void PluginReaper::suspend(juce::AudioPluginInstance& plugin)
+{
+    try
+    {
+        plugin.suspendProcessing(true);
+    }
+    catch (...)
+    {
+        DBG("PluginReaper: exception while suspending " << plugin.getName());
+    }
+}
+
+void PluginReaper::destroy(Entry& entry)
+{
+    const auto name = entry.plugin->getName();
+    const auto deleteStart = juce::Time::getMillisecondCounterHiRes();
+
+    try
+    {
+        entry.plugin.reset();
+    }
+    catch (...)
+    {
+        DBG("PluginReaper: exception while deleting " << name);
+    }
+
+    const auto now = juce::Time::getMillisecondCounterHiRes();
+
+    const juce::ScopedLock sl(queueLock);
+    ++stats.numReleased;
+    stats.lastDeleteMs = now - deleteStart;
+    stats.lastTeardownMs = now - entry.handoffTime;
+    stats.maxTeardownMs = juce::jmax(stats.maxTeardownMs, stats.lastTeardownMs);
+
+    DBG("PluginReaper: released " << name << " in " << juce::String(stats.lastTeardownMs, 1)
+        << " ms (delete " << juce::String(stats.lastDeleteMs, 1) << " ms), "
+        << (int)queue.size() << " queued");
+}
@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    PluginReaper.h
+    (Tears removed plugin instances down off the UI and audio threads)
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <deque>
+
+/**
+    Takes ownership of plugin instances that are no longer in any chain and
+    disposes of them in the background.
+
+    The reaper thread suspends each instance. For Waves plugins it also waits out
+    the grace period they need before their threads can be torn down. The final
+    delete happens back on the message thread, where plugin formats expect it,
+    once the instance is quiet. The caller never sleeps and never holds the audio
+    thread's lock for longer than a queue push.
+
+    The queue is bounded. If it is full, the caller does the teardown itself, the
+    old blocking way, and the overflow is counted in the stats.
+
+    Editors must already be closed when an instance is handed over.
+*/
+class PluginReaper : private juce::Thread,
+                     private juce::AsyncUpdater
+{
+public:
+    static PluginReaper& getInstance();
+
+    /** Hands an instance over. Any thread except the audio thread. */
+    void release(std::unique_ptr<juce::AudioPluginInstance> plugin);
+    void release(juce::OwnedArray<juce::AudioPluginInstance>& plugins);
+
+    /** Finishes every pending teardown on the calling (message) thread. Call before the
+        plugin formats go away at shutdown; later releases are then done synchronously. */
+    void shutdown();
+
+    struct Stats
+    {
+        int numQueued = 0;
+        int numAwaitingDelete = 0;
+        int maxQueued = 0;
+        juce::int64 numReleased = 0;
+        juce::int64 numOverflows = 0;
+        double lastTeardownMs = 0.0;      // handoff until the instance was deleted
+        double maxTeardownMs = 0.0;
+        double lastDeleteMs = 0.0;        // time the delete itself took on the message thread
+    };
+
+    Stats getStats() const;
+
+    static constexpr int maxQueuedPlugins = 32;
+    static constexpr int wavesGracePeriodMs = 500;
+
+private:
+    PluginReaper();
+    ~PluginReaper() override;
+
+    struct Entry
+    {
+        std::unique_ptr<juce::AudioPluginInstance> plugin;
+        double handoffTime = 0.0;
+    };
+
+    void run() override;
+    void handleAsyncUpdate() override;
+
+    static bool needsGracePeriod(const juce::AudioPluginInstance& plugin);
+    static void suspend(juce::AudioPluginInstance& plugin);
+    void destroy(Entry& entry);
+
+    juce::CriticalSection queueLock;
+    std::deque<Entry> queue;
+    std::deque<Entry> awaitingDelete;
+    bool isShutDown = false;
+    Stats stats;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PluginReaper)
+};
@@ -0,0 +1,123 @@
+/*
+  ==============================================================================
+
+    PluginStateTracker.cpp
+
+  ==============================================================================
+*/
+
+#include "PluginStateTracker.h"
+#include "../Data/PresetFile.h"
+#include "../Diagnostics/TraceRecorder.h"
+
+PluginStateTracker::PluginStateTracker(juce::AudioPluginInstance& pluginToTrack, const juce::var& restoredState)
+    : plugin(pluginToTrack)
+{
+    resetToState(restoredState);
+    plugin.addListener(this);
+}
+
+PluginStateTracker::~PluginStateTracker()
+{
+    plugin.removeListener(this);
+    cancelPendingUpdate();
+}
+
+juce::var PluginStateTracker::getState()
+{
+    if (needsCapture || cachedState.isVoid())
+        capture();
+
+    return cachedState;
+}
+
+juce::String PluginStateTracker::getStateHash()
+{
+    getState();
+    return cachedHash;
+}
+
+void PluginStateTracker::resetToState(const juce::var& restoredState)
+{
+    stopTimer();
+    cancelPendingUpdate();
+    needsCapture = false;
+    ignoreChangesUntil = juce::Time::getMillisecondCounter() + (juce::uint32)settleTimeMs;
+
+    const PluginStateData state(restoredState);
+
+    if (state.isEmpty())
+    {
+        // Nothing to go by; capture the plugin's defaults when first asked.
+        cachedState = {};
+        cachedHash = {};
+    }
+    else if (auto* blob = dynamic_cast<PresetFile::Blob*>(restoredState.getObject()); blob != nullptr && blob->getKnownHash().isNotEmpty())
+    {
+        // From the state store: immutable, so it can be shared as it is.
+        cachedState = restoredState;
+        cachedHash = blob->getKnownHash();
+    }
+    else
+    {
+        // Copied, so the plugin never pins a mapped preset file.
+        cachedHash = state.getHash();
+        cachedState = juce::var(new PresetFile::Blob(juce::MemoryBlock(state.getData(), (size_t)state.getSize()), cachedHash));
+    }
+
+    savedHash = cachedHash;
+}
+
+//==============================================================================
+void PluginStateTracker::audioProcessorParameterChanged(juce::AudioProcessor*, int, float)
+{
+    noteChange();
+}
+
+void PluginStateTracker::audioProcessorChanged(juce::AudioProcessor*, const ChangeDetails& details)
+{
+    // Latency or parameter-name updates don't change what a preset would store.
+    if (details.programChanged || details.nonParameterStateChanged)
+        noteChange();
+}
+
+void PluginStateTracker::noteChange()
+{
+    // Can be the audio thread: only flags and a single async trigger per burst.
+    if (juce::Time::getMillisecondCounter() < ignoreChangesUntil.load())
+        return;
+
+    if (!needsCapture.exchange(true))
+        triggerAsyncUpdate();
+}
+
+void PluginStateTracker::handleAsyncUpdate()
+{
+    startTimer(captureDelayMs);
+}
+
+void PluginStateTracker::timerCallback()
+{
+    IDOL_TRACE_SCOPE("message", "Capture plugin state");
+    stopTimer();
+
+    if (!needsCapture)
+        return;
+
+    capture();
+
+    if (cachedHash != savedHash && onModified != nullptr)
+        onModified();
+}
+
+void PluginStateTracker::capture()
+{
+    // Cleared first, so a change that lands during the capture is caught next time.
+    needsCapture = false;
+
+    juce::MemoryBlock block;
+    plugin.getStateInformation(block);
+
+    cachedHash = PresetFile::hashState(block.getData(), block.getSize());
+    cachedState = juce::var(new PresetFile::Blob(std::move(block), cachedHash));
+}
@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+
+    PluginStateTracker.h
+    (Knows whether a plugin's state changed without asking the plugin)
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+    Watches one plugin in a chain and keeps its last captured state.
+
+    Parameter changes and the plugin's own "something changed" notifications (preset
+    or non-parameter edits in its editor) only set a flag, whatever thread they come
+    from. A moment after the last one, the state is captured on the message thread
+    and hashed. If it no longer matches the saved state, onModified is called. Saves
+    reuse the captured blob, so a clean plugin never has getStateInformation called
+    at save time.
+
+    Plugins often report parameter changes for a short while after a state has been
+    restored into them, so notifications are ignored for settleTimeMs after that.
+
+    Message thread only, apart from the listener callbacks.
+*/
+class PluginStateTracker : private juce::AudioProcessorListener,
+                           private juce::AsyncUpdater,
+                           private juce::Timer
+{
+public:
+    /** restoredState is the state the plugin was just loaded with (a preset's "state"
+        property), or void for a fresh plugin. */
+    PluginStateTracker(juce::AudioPluginInstance& pluginToTrack, const juce::var& restoredState);
+    ~PluginStateTracker() override;
+
+    /** The current state as a PresetFile::Blob; captured again only if it changed. */
+    juce::var getState();
+    juce::String getStateHash();
+
+    /** Call after restoring a state into the plugin; it becomes the saved state. */
+    void resetToState(const juce::var& restoredState);
+
+    /** The state from the last getState() is now what's saved. */
+    void markSaved() { savedHash = cachedHash; }
+
+    bool hasChangedSinceCapture() const noexcept { return needsCapture; }
+
+    std::function<void()> onModified;
+
+    static constexpr int settleTimeMs = 750;
+    static constexpr int captureDelayMs = 500;
+
+private:
+    void audioProcessorParameterChanged(juce::AudioProcessor*, int, float) override;
+    void audioProcessorChanged(juce::AudioProcessor*, const ChangeDetails& details) override;
+    void handleAsyncUpdate() override;
+    void timerCallback() override;
+
+    void noteChange();
+    void capture();
+
+    juce::AudioPluginInstance& plugin;
+    juce::var cachedState;
+    juce::String cachedHash, savedHash;
+    std::atomic<bool> needsCapture{ false };
+    std::atomic<juce::uint32> ignoreChangesUntil{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PluginStateTracker)
+};
@@ -0,0 +1,304 @@
+/*
+  ==============================================================================
+
+    PresetLoader.cpp
+
+  ==============================================================================
+*/
+
+#include "PresetLoader.h"
+#include "ProcessorBase.h"
+#include "../Data/PluginManager/PluginManager.h"
+#include "../Data/PresetFile.h"
+#include "../Diagnostics/TraceRecorder.h"
+#include "../Diagnostics/MetricsRegistry.h"
+#include "../Diagnostics/StallDetector.h"
+
+//==============================================================================
+class PresetLoader::ChainJob : public juce::ThreadPoolJob
+{
+public:
+    ChainJob(PresetLoader& loader, ProcessorBase& processorToPrepare, const juce::ValueTree& stateToLoad)
+        : juce::ThreadPoolJob("Preset chain " + processorToPrepare.getProcessorId().toString()),
+          owner(loader),
+          processor(processorToPrepare),
+          processorId(processorToPrepare.getProcessorId().toString()),
+          spec(processorToPrepare.getProcessSpec()),
+          state(stateToLoad)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        IDOL_TRACE_SCOPE_DYNAMIC("preset", "Load chain " + processorId);
+        const bool succeeded = !owner.cancelled && !owner.failed
+            && processor.prepareToLoadState(state, [this](const juce::PluginDescription& description, const PluginStateData& pluginState)
+                {
+                    return owner.createPlugin(processorId, description, pluginState, spec, *this);
+                });
+
+        owner.chainFinished(processor, succeeded);
+        return jobHasFinished;
+    }
+
+private:
+    PresetLoader& owner;
+    ProcessorBase& processor;
+    const juce::String processorId;
+    const juce::dsp::ProcessSpec spec;
+    const juce::ValueTree state;     // a private copy of this processor's part of the preset
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ChainJob)
+};
+
+/** A plugin handed to the message thread by a worker. Whichever side moves it out of
+    'pending' first decides whether it runs, so the worker can walk away safely. */
+struct PresetLoader::MessageThreadCall
+{
+    enum Status { pending, running, abandoned };
+
+    std::function<std::unique_ptr<juce::AudioPluginInstance>()> function;
+    std::unique_ptr<juce::AudioPluginInstance> instance;
+    std::atomic<int> status{ pending };
+    juce::WaitableEvent done;
+};
+
+//==============================================================================
+PresetLoader::PresetLoader()
+    : workers(juce::jlimit(1, maxWorkers, juce::SystemStats::getNumCpus()))
+{
+    selfReference = this;
+}
+
+PresetLoader::~PresetLoader()
+{
+    // Workers waiting on the message thread see the cancel and back out.
+    cancel();
+    workers.removeAllJobs(true, 10000);
+}
+
+bool PresetLoader::start(const juce::Array<ProcessorBase*>& processors, const juce::ValueTree& newState, Callbacks newCallbacks)
+{
+    if (loading)
+        return false;
+
+    IDOL_TRACE_SCOPE("preset", "Start preset load");
+    IDOL_STALL_OPERATION("Start preset load");
+    loading = true;
+    cancelled = false;
+    failed = false;
+    numPluginsLoaded = 0;
+    result = {};
+    callbacks = std::move(newCallbacks);
+    loadingProcessors = processors;
+    startTime = juce::Time::getMillisecondCounterHiRes();
+
+    numPluginsTotal = 0;
+    for (auto* processor : processors)
+        numPluginsTotal += processor->countPluginsToLoad(newState);
+
+    numChainsRunning = processors.size();
+    if (processors.isEmpty())
+    {
+        juce::MessageManager::callAsync([weak = selfReference]
+            {
+                if (auto* self = weak.get())
+                    self->finish();
+            });
+        return true;
+    }
+
+    for (auto* processor : processors)
+    {
+        // Each job gets its own deep copy, so no ValueTree is shared across threads.
+        juce::ValueTree chainState(newState.getType());
+        const auto processorState = newState.getChildWithName(processor->getProcessorId());
+        if (processorState.isValid())
+            chainState.appendChild(processorState.createCopy(), nullptr);
+
+        workers.addJob(new ChainJob(*this, *processor, chainState), true);
+    }
+
+    return true;
+}
+
+void PresetLoader::cancel()
+{
+    if (loading)
+        cancelled = true;
+}
+
+PresetLoader::ThreadPolicy PresetLoader::getThreadPolicy(const juce::PluginDescription& description)
+{
+    // Waves plugins all live in one shared WaveShell; creating or restoring two of
+    // them on different threads is asking for trouble, so they queue on the message thread.
+    if (description.manufacturerName.containsIgnoreCase("Waves")
+        || description.fileOrIdentifier.containsIgnoreCase("WaveShell"))
+        return ThreadPolicy::messageThread;
+
+    return ThreadPolicy::anyThread;
+}
+
+//==============================================================================
+std::unique_ptr<juce::AudioPluginInstance> PresetLoader::createPlugin(const juce::String& processorId,
+                                                                      const juce::PluginDescription& description,
+                                                                      const PluginStateData& state,
+                                                                      const juce::dsp::ProcessSpec& spec,
+                                                                      juce::ThreadPoolJob& job)
+{
+    if (cancelled || failed || job.shouldExit())
+        return nullptr;
+
+    PluginTiming timing{ processorId, description.name };
+    timing.onMessageThread = getThreadPolicy(description) == ThreadPolicy::messageThread;
+
+    auto createAndRestore = [&description, &state, &spec, &timing]() -> std::unique_ptr<juce::AudioPluginInstance>
+    {
+        try
+        {
+            IDOL_TRACE_SCOPE_DYNAMIC("preset", "Load " + description.name);
+            const auto createStart = juce::Time::getMillisecondCounterHiRes();
+            auto instance = getSharedPluginManager().createPluginInstance(description, spec);
+            timing.createMs = juce::Time::getMillisecondCounterHiRes() - createStart;
+
+            if (instance == nullptr)
+                return nullptr;
+
+            instance->suspendProcessing(true);
+
+            if (!state.isEmpty())
+            {
+                IDOL_TRACE_SCOPE("preset", "Restore plugin state");
+                const auto restoreStart = juce::Time::getMillisecondCounterHiRes();
+                instance->setStateInformation(state.getData(), state.getSize());
+                timing.restoreMs = juce::Time::getMillisecondCounterHiRes() - restoreStart;
+            }
+
+            return instance;
+        }
+        catch (...)
+        {
+            DBG("PresetLoader: exception while loading " << description.name);
+            return nullptr;
+        }
+    };
+
+    std::unique_ptr<juce::AudioPluginInstance> instance;
+
+    if (timing.onMessageThread)
+    {
+        auto call = std::make_shared<MessageThreadCall>();
+        call->function = createAndRestore;
+
+        juce::MessageManager::callAsync([call]
+            {
+                int expected = MessageThreadCall::pending;
+                if (!call->status.compare_exchange_strong(expected, MessageThreadCall::running))
+                    return;
+
+                IDOL_STALL_OPERATION("Create plugin for preset load");
+                call->instance = call->function();
+                call->done.signal();
+            });
+
+        while (!call->done.wait(50))
+        {
+            if (cancelled || job.shouldExit())
+            {
+                int expected = MessageThreadCall::pending;
+                if (call->status.compare_exchange_strong(expected, MessageThreadCall::abandoned))
+                    return nullptr;
+
+                // Already running on the message thread and using our locals; let it finish.
+                call->done.wait(-1);
+                break;
+            }
+        }
+
+        instance = std::move(call->instance);
+    }
+    else
+    {
+        instance = createAndRestore();
+    }
+
+    if (instance == nullptr)
+        return nullptr;
+
+    {
+        const juce::ScopedLock sl(resultLock);
+        result.timings.push_back(timing);
+    }
+
+    const int numLoaded = ++numPluginsLoaded;
+    juce::MessageManager::callAsync([weak = selfReference, numLoaded, numTotal = numPluginsTotal, name = description.name]
+        {
+            if (auto* self = weak.get())
+                if (self->loading && self->callbacks.onProgress != nullptr)
+                    self->callbacks.onProgress(numLoaded, numTotal, name);
+        });
+
+    return instance;
+}
+
+void PresetLoader::chainFinished(ProcessorBase& processor, bool succeeded)
+{
+    if (!succeeded)
+    {
+        failed = true;
+        const juce::ScopedLock sl(resultLock);
+        result.failedProcessors.add(processor.getProcessorId().toString());
+    }
+
+    if (--numChainsRunning == 0)
+        juce::MessageManager::callAsync([weak = selfReference]
+            {
+                if (auto* self = weak.get())
+                    self->finish();
+            });
+}
+
+void PresetLoader::finish()
+{
+    IDOL_TRACE_SCOPE("preset", "Finish preset load");
+    IDOL_STALL_OPERATION("Finish preset load");
+
+    // Every job has finished by now, so result is ours alone.
+    result.wasCancelled = cancelled;
+    result.succeeded = !result.wasCancelled && result.failedProcessors.isEmpty();
+    result.totalMs = juce::Time::getMillisecondCounterHiRes() - startTime;
+
+    auto& metrics = MetricsRegistry::getInstance();
+    const auto outcome = result.wasCancelled ? "cancelled" : result.succeeded ? "succeeded" : "failed";
+    metrics.addCounter("idol_preset_loads_total", "Full preset reloads, by how they ended.",
+                       "outcome=\"" + juce::String(outcome) + "\"").increment();
+    metrics.addHistogram("idol_preset_load_seconds", "Time a full preset reload took, from start to its result.",
+                         { 0.1, 0.25, 0.5, 1.0, 2.0, 3.0, 5.0, 8.0, 13.0, 20.0, 30.0, 60.0 })
+        .observe(result.totalMs / 1000.0);
+
+    if (!result.succeeded)
+        for (auto* processor : loadingProcessors)
+            processor->discardPreparedState();
+
+    std::sort(result.timings.begin(), result.timings.end(), [](const PluginTiming& a, const PluginTiming& b)
+        {
+            return a.createMs + a.restoreMs > b.createMs + b.restoreMs;
+        });
+
+    DBG("PresetLoader: " << (int)result.timings.size() << "/" << numPluginsTotal << " plugins in "
+        << juce::String(result.totalMs, 1) << " ms"
+        << (result.wasCancelled ? " (cancelled)" : result.succeeded ? "" : " (failed)"));
+    for (const auto& timing : result.timings)
+        DBG("    " << timing.processorId << " / " << timing.pluginName << ": create " << juce::String(timing.createMs, 1)
+            << " ms, restore " << juce::String(timing.restoreMs, 1) << " ms"
+            << (timing.onMessageThread ? " [message thread]" : ""));
+
+    auto finishedResult = std::exchange(result, {});
+    auto onFinished = std::exchange(callbacks.onFinished, nullptr);
+    callbacks = {};
+    loadingProcessors.clear();
+    loading = false;
+
+    if (onFinished != nullptr)
+        onFinished(finishedResult);
+}
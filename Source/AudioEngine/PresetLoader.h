@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+    PresetLoader.h
+    (Builds the plugin chains of a preset concurrently)
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+class ProcessorBase;
+class PluginStateData;
+
+/**
+    Runs the first stage of a full preset reload (ProcessorBase::prepareToLoadState)
+    for every processor at once.
+
+    The processors' chains don't depend on each other, so each one is built by its
+    own job on a small worker pool, while the message thread stays free to pump the
+    plugin constructors JUCE posts to it. Restoring plugin state, usually the slow
+    part, runs on the workers. Plugins that misbehave when touched off the message
+    thread (see getThreadPolicy) are created and restored there instead, one at a
+    time, while the other chains carry on.
+
+    Progress and the result are reported on the message thread. On failure or
+    cancellation every prepared chain is discarded before onFinished is called; on
+    success the caller swaps them in with commitStateLoad().
+*/
+class PresetLoader
+{
+public:
+    PresetLoader();
+    ~PresetLoader();
+
+    struct PluginTiming
+    {
+        juce::String processorId, pluginName;
+        double createMs = 0.0;
+        double restoreMs = 0.0;
+        bool onMessageThread = false;
+    };
+
+    struct Result
+    {
+        bool succeeded = false;
+        bool wasCancelled = false;
+        juce::StringArray failedProcessors;
+        std::vector<PluginTiming> timings;     // slowest first
+        double totalMs = 0.0;
+    };
+
+    struct Callbacks
+    {
+        std::function<void(int numLoaded, int numTotal, const juce::String& pluginName)> onProgress;
+        std::function<void(const Result&)> onFinished;
+    };
+
+    /** Returns false if a load is already running. */
+    bool start(const juce::Array<ProcessorBase*>& processors, const juce::ValueTree& newState, Callbacks callbacks);
+
+    /** Stops after the plugins currently being created; onFinished still follows. */
+    void cancel();
+    bool isLoading() const noexcept { return loading; }
+
+    enum class ThreadPolicy
+    {
+        anyThread,
+        messageThread
+    };
+
+    static ThreadPolicy getThreadPolicy(const juce::PluginDescription& description);
+
+    static constexpr int maxWorkers = 4;
+
+private:
+    class ChainJob;
+    struct MessageThreadCall;
+
+    std::unique_ptr<juce::AudioPluginInstance> createPlugin(const juce::String& processorId,
+                                                            const juce::PluginDescription& description,
+                                                            const PluginStateData& state,
+                                                            const juce::dsp::ProcessSpec& spec,
+                                                            juce::ThreadPoolJob& job);
+    void chainFinished(ProcessorBase& processor, bool succeeded);
+    void finish();
+
+    juce::ThreadPool workers;
+
+    juce::Array<ProcessorBase*> loadingProcessors;
+    Callbacks callbacks;
+    bool loading = false;
+    double startTime = 0.0;
+    int numPluginsTotal = 0;
+
+    std::atomic<bool> cancelled{ false };
+    std::atomic<bool> failed{ false };       // a chain failed; the others stop early
+    std::atomic<int> numPluginsLoaded{ 0 };
+    std::atomic<int> numChainsRunning{ 0 };
+
+    juce::CriticalSection resultLock;
+    Result result;
+
+    // Created on the message thread so the workers only ever copy it.
+    juce::WeakReference<PresetLoader> selfReference;
+
+    JUCE_DECLARE_WEAK_REFERENCEABLE(PresetLoader)
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetLoader)
+};
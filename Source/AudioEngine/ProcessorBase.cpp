@@ -8,8 +8,12 @@
 */
 
 #include "AudioEngine/ProcessorBase.h"
-#include "../Application/Application.h" 
+#include "../Data/PluginManager/PluginManager.h"
 #include "../Data/AppState.h"
+#include "PluginReaper.h"
+#include "../Data/PresetFile.h"
+#include "../Diagnostics/TraceRecorder.h"
+#include "../Diagnostics/StallDetector.h"
 
 namespace IDs
 {
@@ -34,28 +38,11 @@ ProcessorBase::~ProcessorBase()
     const juce::ScopedLock sl(pluginLock);
     DBG("ProcessorBase Destructor called for '" << processorId.toString() << "'");
 
-    for (int i = pluginChain.size(); --i >= 0;)
-    {
-        if (auto* plugin = pluginChain.getUnchecked(i))
-        {
-            try
-            {
-                DBG("Suspending plugin before destruction: " << plugin->getName());
-                plugin->suspendProcessing(true);
-                const auto name = plugin->getName().toLowerCase();
-                if (name.contains("waves") || name.contains("wave"))
-                {
-                    DBG("Detected Waves plugin. Sleeping for safe shutdown...");
-                    juce::Thread::sleep(500);
-                }
-            }
-            catch (...)
-            {
-                DBG("Exception during plugin suspend in destructor.");
-            }
-        }
-    }
-    pluginChain.clear();
+    // Suspending, the Waves grace period and deletion all happen on the reaper.
+    stateTrackers.clear();
+    PluginReaper::getInstance().release(pluginChain);
+    if (preparedPluginChain)
+        PluginReaper::getInstance().release(*preparedPluginChain);
 }
 
 void ProcessorBase::prepare(const juce::dsp::ProcessSpec& spec)
@@ -63,17 +50,24 @@ void ProcessorBase::prepare(const juce::dsp::ProcessSpec& spec)
     const juce::ScopedLock sl(pluginLock);
     this->processSpec = spec;
     gain.prepare(spec);
-    tempBuffer.setSize(8, spec.maximumBlockSize);
+    fadeBuffer.setSize((int)spec.numChannels, (int)spec.maximumBlockSize);
 
     for (auto* plugin : pluginChain)
+    {
         if (plugin != nullptr)
+        {
+            negotiateBusLayout(*plugin, (int)spec.numChannels);
             plugin->prepareToPlay(spec.sampleRate, spec.maximumBlockSize);
+        }
+    }
 
+    updatePluginSlots();
     reset();
 }
 
 void ProcessorBase::setState(const juce::ValueTree& processorState)
 {
+    IDOL_STALL_OPERATION("Load plugin chain");
     const juce::ScopedLock sl(pluginLock);
 
     if (processSpec.sampleRate <= 0) return;
@@ -82,7 +76,8 @@ void ProcessorBase::setState(const juce::ValueTree& processorState)
     setSendLevel(processorState.getProperty(IDs::sendLevel, 1.0f));
     setReturnLevel(processorState.getProperty(IDs::returnLevel, 1.0f));
 
-    pluginChain.clear();
+    stateTrackers.clear();
+    PluginReaper::getInstance().release(pluginChain);
     pluginBypassState.clear();
 
     juce::ValueTree pluginChainState = processorState.getChildWithName(IDs::PLUGIN_CHAIN);
@@ -92,6 +87,9 @@ void ProcessorBase::setState(const juce::ValueTree& processorState)
         return;
     }
 
+    auto& pluginManager = getSharedPluginManager();
+    const auto catalog = pluginManager.getCatalog();
+
     for (int i = 0; i < pluginChainState.getNumChildren(); ++i)
     {
         juce::ValueTree pluginState = pluginChainState.getChild(i);
@@ -100,58 +98,42 @@ void ProcessorBase::setState(const juce::ValueTree& processorState)
         int uidToFind = pluginState.getProperty(IDs::uid, 0);
         if (uidToFind == 0) continue;
 
-        auto& pluginManager = getSharedPluginManager();
-
-        // <<< FIXED: Correct search logic >>>
-        juce::PluginDescription desc;
-        bool found = false;
-        for (const auto& knownDesc : pluginManager.getKnownPlugins())
-        {
-            if (knownDesc.uniqueId == uidToFind)
-            {
-                desc = knownDesc;
-                found = true;
-                break;
-            }
-        }
-        if (!found)
+        const auto* desc = catalog->findByUniqueId(uidToFind);
+        if (desc == nullptr)
         {
             continue; // Plugin not found
         }
 
         try
         {
-            if (auto instance = pluginManager.createPluginInstance(desc, processSpec))
+            if (auto instance = pluginManager.createPluginInstance(*desc, processSpec))
             {
                 instance->suspendProcessing(true);
+                negotiateBusLayout(*instance, (int)processSpec.numChannels);
                 instance->prepareToPlay(processSpec.sampleRate, (int)processSpec.maximumBlockSize);
-                if (pluginState.hasProperty(IDs::state))
-                {
-                    auto base64State = pluginState.getProperty(IDs::state).toString();
-                    if (!base64State.isEmpty())
-                    {
-                        juce::MemoryBlock internalState;
-                        if (internalState.fromBase64Encoding(base64State))
-                            instance->setStateInformation(internalState.getData(), (int)internalState.getSize());
-                    }
-                }
+                const PluginStateData internalState(pluginState.getProperty(IDs::state));
+                if (!internalState.isEmpty())
+                    instance->setStateInformation(internalState.getData(), internalState.getSize());
                 instance->suspendProcessing(false);
                 if ((bool)pluginState.getProperty(IDs::bypassed, false))
                     pluginBypassState.insert(pluginChain.size());
+                startTracking(*instance, pluginState.getProperty(IDs::state));
                 pluginChain.add(std::move(instance));
             }
         }
         catch (...)
         {
-            DBG("Exception loading plugin in setState: " << desc.name);
+            DBG("Exception loading plugin in setState: " << desc->name);
         }
     }
+    updatePluginSlots();
     sendChangeMessage();
 }
 
 juce::ValueTree ProcessorBase::getState() const
 {
-    const juce::ScopedLock sl(pluginLock);
+    // Message thread, like every change to the chain, so no lock: the audio thread keeps
+    // the plugins running while their states are captured.
     juce::ValueTree state(processorId);
     state.setProperty(IDs::sendLevel, getSendLevel(), nullptr);
     state.setProperty(IDs::returnLevel, getReturnLevel(), nullptr);
@@ -166,9 +148,20 @@ juce::ValueTree ProcessorBase::getState() const
             juce::ValueTree pluginState(IDs::PLUGIN);
             pluginState.setProperty(IDs::uid, (int)plugin->getPluginDescription().uniqueId, nullptr);
 
-            juce::MemoryBlock internalState;
-            plugin->getStateInformation(internalState);
-            pluginState.setProperty(IDs::state, internalState.toBase64Encoding(), nullptr);
+            // Kept as raw bytes; PresetFile stores them as a blob and createXml() as base64.
+            // Unchanged plugins hand back the blob they were loaded or last captured with.
+            juce::var internalState;
+            if (const auto tracker = stateTrackers.find(plugin); tracker != stateTrackers.end())
+            {
+                internalState = tracker->second->getState();
+            }
+            else
+            {
+                juce::MemoryBlock capturedState;
+                plugin->getStateInformation(capturedState);
+                internalState = juce::var(capturedState);
+            }
+            pluginState.setProperty(IDs::state, internalState, nullptr);
 
             pluginState.setProperty(IDs::bypassed, isPluginBypassed(i), nullptr);
             pluginChainState.addChild(pluginState, -1, nullptr);
@@ -180,6 +173,8 @@ juce::ValueTree ProcessorBase::getState() const
 void ProcessorBase::process(juce::AudioBuffer<float>& buffer)
 {
     auto* currentLevelPtr = levelSource.load();
+    slowestSlot = {};
+
     if (muted.load())
     {
         buffer.clear();
@@ -188,38 +183,57 @@ void ProcessorBase::process(juce::AudioBuffer<float>& buffer)
         return;
     }
 
-    const juce::ScopedLock sl(pluginLock);
-    if (!pluginChain.isEmpty())
+    // The message thread only holds the lock while it adds, removes or moves plugins.
+    // Rather than wait for that, the block goes through without the plugins.
+    const juce::ScopedTryLock sl(pluginLock);
+    IDOL_TRACE_SCOPE("processor", processorId.getCharPointer().getAddress());
+    const double blockSeconds = processSpec.sampleRate > 0 ? buffer.getNumSamples() / processSpec.sampleRate : 0.0;
+    const DspLoadMeter::ScopedMeasurement chainMeasurement(chainLoad, blockSeconds);
+
+    if (sl.isLocked() && !pluginChain.isEmpty())
     {
         juce::MidiBuffer emptyMidi;
+        const int hostChannels = buffer.getNumChannels();
+
         for (int i = 0; i < pluginChain.size(); ++i)
         {
-            if (isPluginBypassed(i)) continue;
+            if (!juce::isPositiveAndBelow(i, (int)channelRoutings.size()))
+                break; // Added since the last slot update; never happens under the lock.
+
+            // A plugin bypassed with a fade keeps running until the fade is over.
+            auto& fade = bypassFades[(size_t)i];
+            const bool isFadingOut = isSlotBypassed(i);
+            if (!isFadingOut)
+                fade = {};
+            else if (const int fadeSamples = slotControls[(size_t)i].fadeSamples.exchange(0); fadeSamples > 0)
+                fade = { fadeSamples, fadeSamples };
+
+            if (isFadingOut && fade.samplesRemaining <= 0) continue;
+
             if (auto* plugin = pluginChain.getUnchecked(i))
             {
                 try
                 {
-                    const int requiredInputs = plugin->getTotalNumInputChannels();
-                    const int requiredOutputs = plugin->getTotalNumOutputChannels();
-                    const int hostChannels = buffer.getNumChannels();
-
-                    if (requiredInputs != hostChannels || requiredOutputs != hostChannels)
-                    {
-                        tempBuffer.setSize(juce::jmax(requiredInputs, requiredOutputs), buffer.getNumSamples(), false, true, true);
-                        tempBuffer.clear();
-                        int chansToCopyIn = juce::jmin(hostChannels, requiredInputs);
-                        for (int ch = 0; ch < chansToCopyIn; ++ch)
-                            tempBuffer.copyFrom(ch, 0, buffer, ch, 0, buffer.getNumSamples());
-                        plugin->processBlock(tempBuffer, emptyMidi);
-                        buffer.clear();
-                        int chansToCopyOut = juce::jmin(hostChannels, requiredOutputs);
-                        for (int ch = 0; ch < chansToCopyOut; ++ch)
-                            buffer.copyFrom(ch, 0, tempBuffer, ch, 0, buffer.getNumSamples());
-                    }
-                    else
-                    {
+                    if (isFadingOut)
+                        for (int ch = 0; ch < juce::jmin(hostChannels, fadeBuffer.getNumChannels()); ++ch)
+                            fadeBuffer.copyFrom(ch, 0, buffer, ch, 0, juce::jmin(buffer.getNumSamples(), fadeBuffer.getNumSamples()));
+
+                    const auto& routing = channelRoutings[(size_t)i];
+                    IDOL_TRACE_SCOPE("plugin", slotNames[i].toRawUTF8());
+                    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+                    if (routing.numInputs == hostChannels && routing.numOutputs == hostChannels)
                         plugin->processBlock(buffer, emptyMidi);
-                    }
+                    else
+                        processWithRouting(*plugin, routing, buffer, emptyMidi);
+
+                    const auto elapsed = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+                    slotLoads[(size_t)i]->addMeasurement(elapsed, blockSeconds);
+                    if (elapsed > slowestSlot.seconds)
+                        slowestSlot = { plugin, i, elapsed };
+
+                    if (isFadingOut)
+                        applyBypassFade(buffer, fade);
                 }
                 catch (...) { /* ... */ }
             }
@@ -241,13 +255,22 @@ void ProcessorBase::process(juce::AudioBuffer<float>& buffer)
 void ProcessorBase::addPlugin(std::unique_ptr<juce::AudioPluginInstance> newPlugin)
 {
     if (newPlugin == nullptr) return;
-    const juce::ScopedLock sl(pluginLock);
+
+    // Not in the chain yet, so it is prepared without holding up the audio thread.
     if (processSpec.sampleRate > 0)
     {
+        negotiateBusLayout(*newPlugin, (int)processSpec.numChannels);
         newPlugin->prepareToPlay(processSpec.sampleRate, (int)processSpec.maximumBlockSize);
         newPlugin->reset();
     }
-    pluginChain.add(std::move(newPlugin));
+    startTracking(*newPlugin, {});
+
+    {
+        const juce::ScopedLock sl(pluginLock);
+        pluginChain.add(std::move(newPlugin));
+        updatePluginSlots();
+    }
+
     AppState::getInstance().setPresetDirty(true);
     sendChangeMessage();
 }
@@ -261,36 +284,24 @@ void ProcessorBase::reset()
 
 void ProcessorBase::removePlugin(int index)
 {
-    const juce::ScopedLock sl(pluginLock);
-    if (!isPositiveAndBelow(index, pluginChain.size())) return;
-    if (auto* plugin = pluginChain.getUnchecked(index))
+    IDOL_STALL_OPERATION("Remove plugin");
+    std::unique_ptr<juce::AudioPluginInstance> removed;
+
     {
-        try
-        {
-            DBG("Preparing to safely remove plugin: " << plugin->getName());
-            plugin->suspendProcessing(true);
-            const auto name = plugin->getName().toLowerCase();
-            if (name.contains("waves") || name.contains("wave"))
-            {
-                DBG("Detected Waves plugin. Sleeping briefly to allow thread cleanup...");
-                juce::Thread::sleep(500);
-            }
-            if (plugin->hasEditor())
-            {
-                if (auto* editor = plugin->getActiveEditor())
-                {
-                    DBG("Closing plugin editor before removal: " << plugin->getName());
-                    editor->setVisible(false);
-                }
-            }
-        }
-        catch (...)
-        {
-            DBG("Exception during plugin suspend or editor close before removal.");
-        }
+        const juce::ScopedLock sl(pluginLock);
+        if (!isPositiveAndBelow(index, pluginChain.size())) return;
+
+        pluginBypassState.erase(index);
+        removed.reset(pluginChain.removeAndReturn(index));
+        updatePluginSlots();
     }
-    pluginBypassState.erase(index);
-    pluginChain.remove(index);
+
+    stopTracking(removed.get());
+
+    // Out of the chain, so the audio thread no longer sees it; the slow part happens on the reaper.
+    DBG("Handing plugin to the reaper: " << (removed != nullptr ? removed->getName() : juce::String()));
+    PluginReaper::getInstance().release(std::move(removed));
+
     AppState::getInstance().setPresetDirty(true);
     sendChangeMessage();
 }
@@ -307,16 +318,19 @@ void ProcessorBase::movePlugin(int oldIndex, int newIndex)
         if (oldIndexBypassed) pluginBypassState.insert(newIndex);
         if (newIndexBypassed) pluginBypassState.insert(oldIndex);
         pluginChain.move(oldIndex, newIndex);
+        updatePluginSlots();
         AppState::getInstance().setPresetDirty(true);
         sendChangeMessage();
     }
 }
 
-void ProcessorBase::setPluginBypassed(int pluginIndex, bool shouldBeBypassed)
+void ProcessorBase::setPluginBypassed(int pluginIndex, bool shouldBeBypassed, double fadeMs)
 {
-    const juce::ScopedLock sl(pluginLock);
+    // Message thread; the audio thread picks the change up from the slot's control.
     if (auto* plugin = pluginChain[pluginIndex])
     {
+        auto* control = juce::isPositiveAndBelow(pluginIndex, (int)slotControls.size()) ? &slotControls[(size_t)pluginIndex] : nullptr;
+
         if (auto* bypassParam = plugin->getBypassParameter())
         {
             if (auto* boolParam = dynamic_cast<juce::AudioParameterBool*>(bypassParam))
@@ -325,13 +339,29 @@ void ProcessorBase::setPluginBypassed(int pluginIndex, bool shouldBeBypassed)
                 boolParam->setValueNotifyingHost(shouldBeBypassed ? 1.0f : 0.0f);
                 boolParam->endChangeGesture();
                 pluginBypassState.erase(pluginIndex);
+                if (control != nullptr)
+                    control->bypassed = false;
                 return;
             }
         }
         if (shouldBeBypassed)
+        {
+            const int fadeSamples = juce::roundToInt(fadeMs * 0.001 * processSpec.sampleRate);
+            if (fadeSamples > 0 && !isPluginBypassed(pluginIndex) && control != nullptr)
+                control->fadeSamples = fadeSamples;
+
             pluginBypassState.insert(pluginIndex);
+        }
         else
+        {
             pluginBypassState.erase(pluginIndex);
+            if (control != nullptr)
+                control->fadeSamples = 0;
+        }
+
+        if (control != nullptr)
+            control->bypassed = shouldBeBypassed;
+
         AppState::getInstance().setPresetDirty(true);
     }
 }
@@ -350,15 +380,28 @@ bool ProcessorBase::isPluginBypassed(int index) const
     return false;
 }
 
+bool ProcessorBase::isSlotBypassed(int index) const
+{
+    if (auto* plugin = pluginChain[index])
+        if (auto* boolParam = dynamic_cast<juce::AudioParameterBool*>(plugin->getBypassParameter()))
+            return boolParam->get();
+
+    return juce::isPositiveAndBelow(index, (int)slotControls.size()) && slotControls[(size_t)index].bypassed.load();
+}
+
+// The chain only changes on the message thread, so its readers there needn't lock.
+int ProcessorBase::indexOfPlugin(const juce::AudioPluginInstance* plugin) const
+{
+    return pluginChain.indexOf(plugin);
+}
+
 juce::AudioPluginInstance* ProcessorBase::getPlugin(int index) const
 {
-    const juce::ScopedLock sl(pluginLock);
     return pluginChain[index];
 }
 
 int ProcessorBase::getNumPlugins() const
 {
-    const juce::ScopedLock sl(pluginLock);
     return pluginChain.size();
 }
 
@@ -375,7 +418,6 @@ float ProcessorBase::getReturnLevel() const { return returnLevel.load(); }
 
 bool ProcessorBase::isPluginChainIdentical(const juce::ValueTree& newState) const
 {
-    const juce::ScopedLock sl(pluginLock);
     const juce::ValueTree newProcessorState = newState.getChildWithName(processorId);
 
     if (!newProcessorState.isValid())
@@ -399,7 +441,7 @@ bool ProcessorBase::isPluginChainIdentical(const juce::ValueTree& newState) cons
 
 bool ProcessorBase::tryHotSwapState(const juce::ValueTree& newState)
 {
-    const juce::ScopedLock sl(pluginLock);
+    // The chain keeps its shape, so the plugins keep playing while their states change.
     const juce::ValueTree newProcessorState = newState.getChildWithName(processorId);
     if (!newProcessorState.isValid()) return true;
 
@@ -415,14 +457,23 @@ bool ProcessorBase::tryHotSwapState(const juce::ValueTree& newState)
         const juce::ValueTree newPluginState = newPluginChainState.getChild(i);
         try
         {
-            if (newPluginState.hasProperty(IDs::state))
+            // Presets often share a plugin's state with the one already loaded; restoring it
+            // again only costs time and can click, so compare content hashes first. The
+            // tracker knows the current hash without asking the plugin unless it was edited.
+            const auto newStateVar = newPluginState.getProperty(IDs::state);
+            const PluginStateData internalState(newStateVar);
+            if (!internalState.isEmpty())
             {
-                auto base64State = newPluginState.getProperty(IDs::state).toString();
-                if (!base64State.isEmpty())
+                const auto tracker = stateTrackers.find(plugin);
+                const bool isUnchanged = tracker != stateTrackers.end()
+                                         && tracker->second->getStateHash() == internalState.getHash();
+
+                if (!isUnchanged)
                 {
-                    juce::MemoryBlock internalState;
-                    if (internalState.fromBase64Encoding(base64State))
-                        plugin->setStateInformation(internalState.getData(), (int)internalState.getSize());
+                    plugin->setStateInformation(internalState.getData(), internalState.getSize());
+
+                    if (tracker != stateTrackers.end())
+                        tracker->second->resetToState(newStateVar);
                 }
             }
             setPluginBypassed(i, newPluginState.getProperty(IDs::bypassed, false));
@@ -441,7 +492,7 @@ bool ProcessorBase::tryHotSwapState(const juce::ValueTree& newState)
 // <<< IMPLEMENTATION of the new robust loading methods >>>
 // ==============================================================================
 
-bool ProcessorBase::prepareToLoadState(const juce::ValueTree& newState)
+bool ProcessorBase::prepareToLoadState(const juce::ValueTree& newState, const PluginFactory& createPlugin)
 {
     const juce::ValueTree processorState = newState.getChildWithName(processorId);
 
@@ -450,11 +501,14 @@ bool ProcessorBase::prepareToLoadState(const juce::ValueTree& newState)
 
     auto tempChain = std::make_unique<juce::OwnedArray<juce::AudioPluginInstance>>();
     auto tempBypass = std::make_unique<std::unordered_set<int>>();
+    std::vector<juce::var> tempStates;
 
     const juce::ValueTree newPluginChainState = processorState.getChildWithName(IDs::PLUGIN_CHAIN);
     if (newPluginChainState.isValid())
     {
         auto& pluginManager = getSharedPluginManager();
+        const auto catalog = pluginManager.getCatalog();
+
         for (int i = 0; i < newPluginChainState.getNumChildren(); ++i)
         {
             const juce::ValueTree pluginState = newPluginChainState.getChild(i);
@@ -463,52 +517,47 @@ bool ProcessorBase::prepareToLoadState(const juce::ValueTree& newState)
             const int uidToFind = pluginState.getProperty(IDs::uid, 0);
             if (uidToFind == 0) continue;
 
-            // <<< FIXED: Correct search logic >>>
-            juce::PluginDescription desc;
-            bool found = false;
-            for (const auto& knownDesc : pluginManager.getKnownPlugins())
-            {
-                if (knownDesc.uniqueId == uidToFind)
-                {
-                    desc = knownDesc;
-                    found = true;
-                    break;
-                }
-            }
-            if (!found)
+            const auto* desc = catalog->findByUniqueId(uidToFind);
+            if (desc == nullptr)
             {
                 DBG("Plugin with UID " << uidToFind << " not in known list. Cannot prepare.");
+                PluginReaper::getInstance().release(*tempChain);
                 return false;
             }
 
+            const PluginStateData internalState(pluginState.getProperty(IDs::state));
+
             try
             {
-                if (auto instance = pluginManager.createPluginInstance(desc, processSpec))
+                std::unique_ptr<juce::AudioPluginInstance> instance;
+
+                if (createPlugin != nullptr)
+                {
+                    instance = createPlugin(*desc, internalState);
+                }
+                else if ((instance = pluginManager.createPluginInstance(*desc, processSpec)) != nullptr)
                 {
                     instance->suspendProcessing(true);
-                    if (pluginState.hasProperty(IDs::state))
-                    {
-                        auto base64State = pluginState.getProperty(IDs::state).toString();
-                        if (!base64State.isEmpty())
-                        {
-                            juce::MemoryBlock internalState;
-                            if (internalState.fromBase64Encoding(base64State))
-                                instance->setStateInformation(internalState.getData(), (int)internalState.getSize());
-                        }
-                    }
-                    if ((bool)pluginState.getProperty(IDs::bypassed, false))
-                        tempBypass->insert(i);
-                    tempChain->add(std::move(instance));
+                    if (!internalState.isEmpty())
+                        instance->setStateInformation(internalState.getData(), internalState.getSize());
                 }
-                else
+
+                if (instance == nullptr)
                 {
-                    DBG("Failed to create prepared instance for: " << desc.name);
+                    DBG("Failed to create prepared instance for: " << desc->name);
+                    PluginReaper::getInstance().release(*tempChain);
                     return false;
                 }
+
+                if ((bool)pluginState.getProperty(IDs::bypassed, false))
+                    tempBypass->insert(i);
+                tempStates.push_back(pluginState.getProperty(IDs::state));
+                tempChain->add(std::move(instance));
             }
             catch (...)
             {
-                DBG("Exception while preparing instance for: " << desc.name);
+                DBG("Exception while preparing instance for: " << desc->name);
+                PluginReaper::getInstance().release(*tempChain);
                 return false;
             }
         }
@@ -516,9 +565,32 @@ bool ProcessorBase::prepareToLoadState(const juce::ValueTree& newState)
 
     preparedPluginChain = std::move(tempChain);
     preparedBypassState = std::move(tempBypass);
+    preparedStates = std::move(tempStates);
     return true;
 }
 
+int ProcessorBase::countPluginsToLoad(const juce::ValueTree& newState) const
+{
+    const auto chainState = newState.getChildWithName(processorId).getChildWithName(IDs::PLUGIN_CHAIN);
+
+    int numPlugins = 0;
+    for (const auto& pluginState : chainState)
+        if (pluginState.hasType(IDs::PLUGIN) && (int)pluginState.getProperty(IDs::uid, 0) != 0)
+            ++numPlugins;
+
+    return numPlugins;
+}
+
+void ProcessorBase::discardPreparedState()
+{
+    if (preparedPluginChain)
+        PluginReaper::getInstance().release(*preparedPluginChain);
+
+    preparedPluginChain.reset();
+    preparedBypassState.reset();
+    preparedStates.clear();
+}
+
 void ProcessorBase::commitStateLoad()
 {
     const juce::ScopedLock sl(pluginLock);
@@ -526,10 +598,15 @@ void ProcessorBase::commitStateLoad()
     setSendLevel(preparedSendLevel);
     setReturnLevel(preparedReturnLevel);
 
+    stateTrackers.clear();
+    PluginReaper::getInstance().release(pluginChain);
     if (preparedPluginChain)
-        pluginChain = std::move(*preparedPluginChain);
-    else
-        pluginChain.clear();
+        pluginChain.swapWith(*preparedPluginChain);
+
+    // The loaded states are the baseline, so a later save needn't ask any plugin for its state.
+    for (int i = 0; i < pluginChain.size(); ++i)
+        if (auto* plugin = pluginChain.getUnchecked(i))
+            startTracking(*plugin, i < (int)preparedStates.size() ? preparedStates[(size_t)i] : juce::var());
 
     if (preparedBypassState)
         pluginBypassState = std::move(*preparedBypassState);
@@ -538,5 +615,230 @@ void ProcessorBase::commitStateLoad()
 
     preparedPluginChain.reset();
     preparedBypassState.reset();
+    preparedStates.clear();
+    updatePluginSlots();
     sendChangeMessage();
-}
\ No newline at end of file
+}
+
+void ProcessorBase::markStateSaved()
+{
+    for (auto& [plugin, tracker] : stateTrackers)
+        tracker->markSaved();
+}
+
+void ProcessorBase::startTracking(juce::AudioPluginInstance& plugin, const juce::var& loadedState)
+{
+    auto tracker = std::make_unique<PluginStateTracker>(plugin, loadedState);
+    tracker->onModified = []
+    {
+        auto& appState = AppState::getInstance();
+        if (!appState.isLoadingPreset())
+            appState.setPresetDirty(true);
+    };
+
+    stateTrackers[&plugin] = std::move(tracker);
+}
+
+void ProcessorBase::stopTracking(const juce::AudioPluginInstance* plugin)
+{
+    stateTrackers.erase(plugin);
+}
+
+// ==============================================================================
+// Plugin slots: bus layouts, channel routing and load meters
+// ==============================================================================
+
+void ProcessorBase::negotiateBusLayout(juce::AudioPluginInstance& plugin, int numHostChannels)
+{
+    if (numHostChannels <= 0 || plugin.getBusCount(false) == 0)
+        return;
+
+    const auto mono = juce::AudioChannelSet::mono();
+    const auto stereo = juce::AudioChannelSet::stereo();
+    const auto host = juce::AudioChannelSet::canonicalChannelSet(numHostChannels);
+
+    const std::pair<juce::AudioChannelSet, juce::AudioChannelSet> candidates[] = {
+        { host, host }, { stereo, stereo }, { mono, mono }, { mono, stereo }
+    };
+
+    const auto original = plugin.getBusesLayout();
+    bool released = false;
+
+    for (const auto& [input, output] : candidates)
+    {
+        // Sidechains and extra outputs have nothing to connect to here, so try without them first.
+        for (const bool disableAuxBuses : { true, false })
+        {
+            auto layout = original;
+            if (!layout.inputBuses.isEmpty())
+                layout.inputBuses.getReference(0) = input;
+            layout.outputBuses.getReference(0) = output;
+
+            if (disableAuxBuses)
+            {
+                for (int bus = 1; bus < layout.inputBuses.size(); ++bus)
+                    layout.inputBuses.getReference(bus) = juce::AudioChannelSet::disabled();
+                for (int bus = 1; bus < layout.outputBuses.size(); ++bus)
+                    layout.outputBuses.getReference(bus) = juce::AudioChannelSet::disabled();
+            }
+
+            if (layout == plugin.getBusesLayout())
+                return;
+
+            if (!plugin.checkBusesLayoutSupported(layout))
+                continue;
+
+            if (!released)
+            {
+                plugin.releaseResources();
+                released = true;
+            }
+
+            if (plugin.setBusesLayout(layout))
+                return;
+        }
+    }
+
+    DBG("No matching bus layout for '" << plugin.getName() << "'; keeping "
+        << plugin.getTotalNumInputChannels() << " in / " << plugin.getTotalNumOutputChannels() << " out.");
+}
+
+void ProcessorBase::updatePluginSlots()
+{
+    std::vector<ChannelRouting> routings;
+    std::vector<DspLoadMeter*> loads;
+    juce::StringArray names;
+    std::unordered_map<const juce::AudioPluginInstance*, std::unique_ptr<DspLoadMeter>> keptLoads;
+    routings.reserve((size_t)pluginChain.size());
+    loads.reserve((size_t)pluginChain.size());
+
+    int maxChannels = 0;
+    for (auto* plugin : pluginChain)
+    {
+        ChannelRouting routing;
+        if (plugin != nullptr)
+        {
+            routing.numInputs = plugin->getTotalNumInputChannels();
+            routing.numOutputs = plugin->getTotalNumOutputChannels();
+            routing.numChannels = juce::jmax(routing.numInputs, routing.numOutputs);
+        }
+
+        maxChannels = juce::jmax(maxChannels, routing.numChannels);
+        routings.push_back(routing);
+        names.add(plugin != nullptr ? plugin->getName() : juce::String());
+
+        auto& load = keptLoads[plugin];
+        if (const auto existing = pluginLoads.find(plugin); existing != pluginLoads.end())
+            load = std::move(existing->second);
+        else
+            load = std::make_unique<DspLoadMeter>();
+        loads.push_back(load.get());
+    }
+
+    // Only the channels a plugin has beyond the processor's own come from here.
+    scratchBuffer.setSize(juce::jmin(maxChannels, maxRoutedChannels), (int)processSpec.maximumBlockSize, false, false, true);
+    channelRoutings = std::move(routings);
+    slotLoads = std::move(loads);
+    slotNames = std::move(names);
+    bypassFades.assign(channelRoutings.size(), {});
+
+    slotControls = std::vector<SlotControl>(channelRoutings.size());
+    for (const int index : pluginBypassState)
+        if (juce::isPositiveAndBelow(index, (int)slotControls.size()))
+            slotControls[(size_t)index].bypassed = true;
+
+    // Shrink the count before the pointers move and grow it after, so a reader never
+    // sees a slot that isn't filled in. Meters of removed plugins go only after this.
+    const int numLoads = juce::jmin((int)slotLoads.size(), maxMeteredSlots);
+    numPublishedLoads = juce::jmin(numPublishedLoads.load(), numLoads);
+    for (int i = 0; i < numLoads; ++i)
+        publishedLoads[(size_t)i] = slotLoads[(size_t)i];
+    numPublishedLoads = numLoads;
+
+    pluginLoads = std::move(keptLoads);
+}
+
+DspLoadMeter::Snapshot ProcessorBase::getPluginLoad(int index) const
+{
+    // Meters are only destroyed by a chain change, which happens on the message thread.
+    if (!juce::isPositiveAndBelow(index, numPublishedLoads.load()))
+        return {};
+
+    if (const auto* meter = publishedLoads[(size_t)index].load())
+        return meter->getSnapshot();
+
+    return {};
+}
+
+void ProcessorBase::processWithRouting(juce::AudioPluginInstance& plugin, const ChannelRouting& routing,
+                                       juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midi)
+{
+    const int hostChannels = buffer.getNumChannels();
+    const int numSamples = buffer.getNumSamples();
+
+    if (routing.numChannels > maxRoutedChannels || routing.numChannels > scratchBuffer.getNumChannels()
+        || numSamples > scratchBuffer.getNumSamples())
+    {
+        jassertfalse; // Routing out of date with the chain or the block size.
+        return;
+    }
+
+    // The plugin works straight on the processor's channels; only the ones it has
+    // beyond those (a sidechain it wouldn't give up, say) point at silent scratch space.
+    float* channels[maxRoutedChannels];
+    for (int ch = 0; ch < routing.numChannels; ++ch)
+    {
+        if (ch < hostChannels)
+        {
+            channels[ch] = buffer.getWritePointer(ch);
+        }
+        else
+        {
+            channels[ch] = scratchBuffer.getWritePointer(ch);
+            juce::FloatVectorOperations::clear(channels[ch], numSamples);
+        }
+    }
+
+    juce::AudioBuffer<float> view(channels, routing.numChannels, numSamples);
+    plugin.processBlock(view, midi);
+
+    // A mono plugin feeds every channel; otherwise channels it has no output for go silent.
+    if (routing.numOutputs > 0)
+    {
+        for (int ch = routing.numOutputs; ch < hostChannels; ++ch)
+        {
+            if (routing.numOutputs == 1)
+                buffer.copyFrom(ch, 0, buffer, 0, 0, numSamples);
+            else
+                buffer.clear(ch, 0, numSamples);
+        }
+    }
+}
+
+void ProcessorBase::applyBypassFade(juce::AudioBuffer<float>& buffer, BypassFade& fade)
+{
+    const int numSamples = buffer.getNumSamples();
+    const int numChannels = juce::jmin(buffer.getNumChannels(), fadeBuffer.getNumChannels());
+
+    if (numSamples > fadeBuffer.getNumSamples() || fade.totalSamples <= 0)
+    {
+        fade = {};
+        return;
+    }
+
+    // The plugin's output ramps down while the dry signal copied before it ramps up.
+    const int rampSamples = juce::jmin(numSamples, fade.samplesRemaining);
+    const auto startGain = (float)fade.samplesRemaining / (float)fade.totalSamples;
+    const auto endGain = (float)(fade.samplesRemaining - rampSamples) / (float)fade.totalSamples;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        buffer.applyGainRamp(ch, 0, rampSamples, startGain, endGain);
+        buffer.addFromWithRamp(ch, 0, fadeBuffer.getReadPointer(ch), rampSamples, 1.0f - startGain, 1.0f - endGain);
+
+        if (rampSamples < numSamples)
+            buffer.copyFrom(ch, rampSamples, fadeBuffer, ch, rampSamples, numSamples - rampSamples);
+    }
+
+    fade.samplesRemaining -= rampSamples;
+}
@@ -9,8 +9,14 @@
 #pragma once
 
 #include <JuceHeader.h>
-#include "../Components/LevelMeter.h"
 #include <unordered_set>
+#include <unordered_map>
+#include <functional>
+#include <array>
+#include "PluginStateTracker.h"
+#include "DspLoadMeter.h"
+
+class PluginStateData;
 
 class ProcessorBase : public juce::ChangeBroadcaster
 {
@@ -24,10 +30,13 @@ public:
 
     void addPlugin(std::unique_ptr<juce::AudioPluginInstance> newPlugin);
     void removePlugin(int index);
-    void setPluginBypassed(int pluginIndex, bool shouldBeBypassed);
+    /** With a fade, a plugin being bypassed keeps running while its output crossfades to
+        the dry signal. */
+    void setPluginBypassed(int pluginIndex, bool shouldBeBypassed, double fadeMs = 0.0);
     void movePlugin(int oldIndex, int newIndex);
 
     juce::AudioPluginInstance* getPlugin(int index) const;
+    int indexOfPlugin(const juce::AudioPluginInstance* plugin) const;
     int getNumPlugins() const;
 
     void setGain(float gainInDecibels);
@@ -53,11 +62,86 @@ public:
     bool tryHotSwapState(const juce::ValueTree& newState);
 
     // Methods for robust, two-stage preset reloading
-    bool prepareToLoadState(const juce::ValueTree& newState);
+    /** Creates a plugin for a prepared chain and restores its saved state (which may be
+        empty). Returning nullptr fails the preparation. */
+    using PluginFactory = std::function<std::unique_ptr<juce::AudioPluginInstance>(const juce::PluginDescription&,
+                                                                                   const PluginStateData& state)>;
+
+    /** Builds the new chain aside without touching the running one. Safe to call on a
+        worker thread, one call per processor at a time; without a factory the plugins
+        are created and restored on the calling thread. */
+    bool prepareToLoadState(const juce::ValueTree& newState, const PluginFactory& createPlugin = nullptr);
     void commitStateLoad();
+    void discardPreparedState();
+    int countPluginsToLoad(const juce::ValueTree& newState) const;
+
+    const juce::Identifier& getProcessorId() const { return processorId; }
+
+    /** The states getState() last returned are now what's saved in the preset. */
+    void markStateSaved();
+
+    /** How long one plugin's processBlock takes against the block deadline. Doesn't
+        take pluginLock; slots past maxMeteredSlots read as empty. */
+    DspLoadMeter::Snapshot getPluginLoad(int index) const;
+    /** The whole chain, gain and metering included. */
+    DspLoadMeter::Snapshot getChainLoad() const { return chainLoad.getSnapshot(); }
+
+    struct SlotTiming
+    {
+        const juce::AudioPluginInstance* plugin = nullptr;
+        int slot = -1;
+        double seconds = 0.0;
+    };
+
+    /** The plugin that took longest in the last process() call. Audio thread only. */
+    const SlotTiming& getSlowestSlotOfLastBlock() const noexcept { return slowestSlot; }
 
 private:
+    void startTracking(juce::AudioPluginInstance& plugin, const juce::var& loadedState);
+    void stopTracking(const juce::AudioPluginInstance* plugin);
+
+    /** How a slot's plugin channels map onto the processor's buffer, worked out when the
+        chain or its layouts change so process() only has to point at channels. */
+    struct ChannelRouting
+    {
+        int numInputs = 0;
+        int numOutputs = 0;
+        int numChannels = 0;
+    };
+
+    /** Asks for the plugin's main buses to match the host: stereo, then mono, then mono
+        in/stereo out. Must be called while the plugin isn't processing. */
+    static void negotiateBusLayout(juce::AudioPluginInstance& plugin, int numHostChannels);
+    /** Rebuilds what process() keeps per slot; call under pluginLock after any chain change. */
+    void updatePluginSlots();
+    /** isPluginBypassed() for the audio thread, which can't read pluginBypassState. */
+    bool isSlotBypassed(int index) const;
+    void processWithRouting(juce::AudioPluginInstance& plugin, const ChannelRouting& routing,
+                            juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midi);
+
+    struct BypassFade
+    {
+        int samplesRemaining = 0;
+        int totalSamples = 0;
+    };
+
+    /** How setPluginBypassed() tells the audio thread, without pluginLock. */
+    struct SlotControl
+    {
+        std::atomic<bool> bypassed{ false };
+        std::atomic<int> fadeSamples{ 0 };  // a fade to start, taken by the audio thread
+    };
+
+    void applyBypassFade(juce::AudioBuffer<float>& buffer, BypassFade& fade);
+
+    static constexpr int maxRoutedChannels = 16;
+    static constexpr int maxMeteredSlots = 64;
+
     juce::Identifier processorId;
+
+    // Guards the chain's structure and what process() keeps per slot. Only the message
+    // thread changes those, so its own reads don't take the lock; the audio thread only
+    // tries it, and plays the block dry while a plugin is added, removed or moved.
     juce::CriticalSection pluginLock;
     juce::dsp::ProcessSpec processSpec;
     juce::OwnedArray<juce::AudioPluginInstance> pluginChain;
@@ -69,10 +153,29 @@ private:
     std::unique_ptr<std::unordered_set<int>> preparedBypassState;
     float preparedSendLevel = 0.0f;
     float preparedReturnLevel = 1.0f;
+    std::vector<juce::var> preparedStates;
+
+    // One per plugin in pluginChain; created and destroyed on the message thread only.
+    std::unordered_map<const juce::AudioPluginInstance*, std::unique_ptr<PluginStateTracker>> stateTrackers;
 
     std::atomic<std::atomic<float>*> levelSource{ nullptr };
-    std::unordered_set<int> pluginBypassState;
-    juce::AudioBuffer<float> tempBuffer;
+    std::unordered_set<int> pluginBypassState; // message thread
+    std::vector<ChannelRouting> channelRoutings;
+    std::vector<DspLoadMeter*> slotLoads;
+    juce::StringArray slotNames; // for the trace, so the audio thread never asks the plugin
+    std::vector<BypassFade> bypassFades;
+    std::vector<SlotControl> slotControls;
+    juce::AudioBuffer<float> fadeBuffer;
+    SlotTiming slowestSlot;
+    juce::AudioBuffer<float> scratchBuffer;
+
+    // Kept per plugin rather than per slot, so a plugin's history moves with it.
+    std::unordered_map<const juce::AudioPluginInstance*, std::unique_ptr<DspLoadMeter>> pluginLoads;
+    DspLoadMeter chainLoad;
+
+    // slotLoads again, for the UI, republished by updatePluginSlots().
+    std::array<std::atomic<DspLoadMeter*>, maxMeteredSlots> publishedLoads{};
+    std::atomic<int> numPublishedLoads{ 0 };
 
     std::atomic<float> sendLevel{ 0.0f };
     std::atomic<float> returnLevel{ 1.0f };
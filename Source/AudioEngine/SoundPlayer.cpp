@@ -2,7 +2,7 @@
   ==============================================================================
 
     SoundPlayer.cpp
-    (Implementing user's monophonic playback solution)
+    (Polyphonic voice engine for the soundboard)
 
   ==============================================================================
 */
@@ -11,163 +11,415 @@
 
 namespace IdolAZ
 {
-    //==============================================================================
-    class GainAudioSource : public juce::AudioSource
+    namespace
     {
-    public:
-        GainAudioSource(juce::AudioSource* inputSource, bool deleteInputWhenDeleted)
-            : source(inputSource, deleteInputWhenDeleted) {
-        }
+        constexpr double fadeInSeconds = 0.002;
+        constexpr double fadeOutSeconds = 0.012;
+        constexpr double maxSampleLengthSeconds = 120.0;
+    }
+
+    SoundPlayer::SoundPlayer()
+    {
+        formatManager.registerBasicFormats();
+        smoothedGain.setCurrentAndTargetValue(targetGain.load());
+        startTimer(1000);
+    }
+
+    SoundPlayer::~SoundPlayer()
+    {
+        stopTimer();
+    }
+
+    void SoundPlayer::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
+    {
+        juce::ignoreUnused(samplesPerBlockExpected);
+
+        // Samples are decoded at the device rate, so voices started at another rate
+        // would play at the wrong pitch. Drop them; the timer re-decodes the slots.
+        if (!juce::approximatelyEqual(deviceSampleRate.load(), sampleRate))
+            for (auto& voice : voices)
+                voice.sample = nullptr;
+
+        deviceSampleRate = sampleRate;
+        fadeInSamples = juce::jmax(1, juce::roundToInt(sampleRate * fadeInSeconds));
+        fadeOutSamples = juce::jmax(1, juce::roundToInt(sampleRate * fadeOutSeconds));
+        smoothedGain.reset(sampleRate, 0.02);
+        smoothedGain.setCurrentAndTargetValue(targetGain.load());
+    }
+
+    void SoundPlayer::releaseResources()
+    {
+        for (auto& voice : voices)
+            voice.sample = nullptr;
 
-        void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override
+        numActiveVoices = 0;
+    }
+
+    void SoundPlayer::getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill)
+    {
+        bufferToFill.clearActiveBufferRegion();
+        handlePendingCommands();
+
+        auto& buffer = *bufferToFill.buffer;
+        int active = 0;
+
+        for (auto& voice : voices)
         {
-            if (source) source->prepareToPlay(samplesPerBlockExpected, sampleRate);
+            if (!voice.isActive())
+                continue;
+
+            renderVoice(voice, buffer, bufferToFill.startSample, bufferToFill.numSamples);
+
+            if (voice.isActive())
+                ++active;
         }
 
-        void releaseResources() override
+        numActiveVoices = active;
+
+        smoothedGain.setTargetValue(targetGain.load());
+        if (smoothedGain.isSmoothing())
         {
-            if (source) source->releaseResources();
+            const float startGain = smoothedGain.getCurrentValue();
+            const float endGain = smoothedGain.skip(bufferToFill.numSamples);
+            buffer.applyGainRamp(bufferToFill.startSample, bufferToFill.numSamples, startGain, endGain);
         }
-
-        void getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) override
+        else
         {
-            if (source)
-            {
-                source->getNextAudioBlock(bufferToFill);
-                bufferToFill.buffer->applyGain(gain);
-            }
+            buffer.applyGain(bufferToFill.startSample, bufferToFill.numSamples, smoothedGain.getCurrentValue());
         }
+    }
 
-        void setGain(float newGain) { gain = newGain; }
-        void clearSource() { source.reset(); }
+    void SoundPlayer::play(const SoundboardSlot& slot, int slotIndex)
+    {
+        JUCE_ASSERT_MESSAGE_THREAD
 
-    private:
-        juce::OptionalScopedPointer<juce::AudioSource> source;
-        float gain = 1.0f;
-    };
-    //==============================================================================
+        if (!enabled.load())
+            return;
 
+        if (!juce::isPositiveAndBelow(slotIndex, numSlots))
+        {
+            jassertfalse;
+            return;
+        }
 
-    SoundPlayer::SoundPlayer()
-    {
-        formatManager.registerBasicFormats();
+        if (!slot.audioFile.existsAsFile())
+        {
+            DBG("SoundPlayer::play() - File does not exist: " << slot.audioFile.getFullPathName());
+            return;
+        }
 
-        for (int i = 0; i < numVoices; ++i)
+        auto sample = getOrLoadSample(slot.audioFile, slotIndex);
+        if (sample == nullptr)
         {
-            auto* transportSource = transportSources.add(new juce::AudioTransportSource());
-            mixer.addInputSource(transportSource, false);
+            DBG("SoundPlayer::play() - Could not create reader for file: " << slot.audioFile.getFullPathName());
+            return;
         }
 
-        gainSource = std::make_unique<GainAudioSource>(&mixer, false);
-        gainSource->setGain(0.75f);
+        Command command;
+        command.type = Command::Type::Start;
+        command.sample = sample;
+        command.slotIndex = slotIndex;
+        command.chokeGroup = slot.chokeGroup;
+        command.playMode = slot.playMode;
+        pushCommand(std::move(command));
     }
 
-    SoundPlayer::~SoundPlayer()
+    void SoundPlayer::stopAll()
     {
-        if (gainSource)
-            gainSource->clearSource();
-
-        mixer.removeAllInputs();
+        Command command;
+        command.type = Command::Type::StopAll;
+        pushCommand(std::move(command));
+    }
 
-        stopAll();
+    void SoundPlayer::setGain(float newGain)
+    {
+        targetGain = newGain;
+    }
 
-        for (auto* ts : transportSources)
+    void SoundPlayer::setEnabled(bool shouldBeEnabled)
+    {
+        enabled = shouldBeEnabled;
+        if (!enabled)
         {
-            if (ts != nullptr)
-            {
-                ts->setSource(nullptr);
-            }
+            stopAll();
         }
-
-        transportSources.clear();
     }
 
-    void SoundPlayer::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
+    void SoundPlayer::preloadSlots(const juce::Array<SoundboardSlot>& slots)
     {
-        if (gainSource)
-            gainSource->prepareToPlay(samplesPerBlockExpected, sampleRate);
+        JUCE_ASSERT_MESSAGE_THREAD
+
+        for (int i = 0; i < juce::jmin(slots.size(), numSlots); ++i)
+        {
+            const auto& slot = slots.getReference(i);
+            if (slot.isEmpty())
+                slotSamples[(size_t)i] = nullptr;
+            else
+                getOrLoadSample(slot.audioFile, i);
+        }
     }
 
-    void SoundPlayer::getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill)
+    void SoundPlayer::timerCallback()
     {
-        if (gainSource)
-            gainSource->getNextAudioBlock(bufferToFill);
+        // Re-decode cached slots after a sample rate change so a trigger never has to.
+        const double rate = deviceSampleRate.load();
+        for (int i = 0; i < numSlots; ++i)
+        {
+            auto& cached = slotSamples[(size_t)i];
+            if (cached != nullptr && rate > 0.0 && !juce::approximatelyEqual(cached->sampleRate, rate))
+                getOrLoadSample(cached->file, i);
+        }
+
+        // Anything only the pool still references can no longer reach the audio thread.
+        for (int i = samplePool.size(); --i >= 0;)
+            if (samplePool.getObjectPointerUnchecked(i)->getReferenceCount() == 1)
+                samplePool.remove(i);
     }
 
-    void SoundPlayer::releaseResources()
+    SoundPlayer::Sample::Ptr SoundPlayer::getOrLoadSample(const juce::File& file, int slotIndex)
     {
-        if (gainSource)
-            gainSource->releaseResources();
+        const double rate = deviceSampleRate.load();
+        auto& cached = slotSamples[(size_t)slotIndex];
+
+        if (cached != nullptr
+            && cached->file == file
+            && cached->lastModified == file.getLastModificationTime()
+            && (rate <= 0.0 || juce::approximatelyEqual(cached->sampleRate, rate)))
+            return cached;
+
+        auto sample = decodeSample(file, rate);
+        if (sample != nullptr)
+        {
+            samplePool.add(sample);
+            cached = sample;
+        }
+        return sample;
     }
 
-    // Applying your correct logic for monophonic playback.
-    void SoundPlayer::play(const juce::File& audioFile, int slotIndex)
+    SoundPlayer::Sample::Ptr SoundPlayer::decodeSample(const juce::File& file, double targetSampleRate)
     {
-        if (!enabled.load())
-            return;
+        std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+        if (reader == nullptr || reader->lengthInSamples <= 0)
+            return nullptr;
+
+        const int numChannels = juce::jlimit(1, 2, (int)reader->numChannels);
+        const auto maxLength = (juce::int64)(maxSampleLengthSeconds * reader->sampleRate);
+        const int length = (int)juce::jmin(reader->lengthInSamples, maxLength);
+
+        if (reader->lengthInSamples > maxLength)
+            DBG("SoundPlayer: " << file.getFileName() << " is longer than " << maxSampleLengthSeconds << "s and will be truncated.");
 
-        if (!juce::isPositiveAndBelow(slotIndex, numVoices))
+        juce::AudioBuffer<float> decoded(numChannels, length);
+        reader->read(&decoded, 0, length, 0, true, numChannels > 1);
+
+        Sample::Ptr sample = new Sample();
+        sample->file = file;
+        sample->lastModified = file.getLastModificationTime();
+
+        if (targetSampleRate <= 0.0 || juce::approximatelyEqual(targetSampleRate, reader->sampleRate))
         {
-            jassertfalse;
-            return;
+            sample->sampleRate = reader->sampleRate;
+            sample->data = std::move(decoded);
+            return sample;
         }
 
-        if (!audioFile.existsAsFile())
+        const double ratio = reader->sampleRate / targetSampleRate;
+        const int resampledLength = (int)std::ceil(length / ratio);
+        sample->sampleRate = targetSampleRate;
+        sample->data.setSize(numChannels, resampledLength);
+
+        for (int ch = 0; ch < numChannels; ++ch)
         {
-            DBG("SoundPlayer::play() - File does not exist: " << audioFile.getFullPathName());
-            return;
+            juce::LagrangeInterpolator interpolator;
+            interpolator.process(ratio, decoded.getReadPointer(ch), sample->data.getWritePointer(ch),
+                resampledLength, length, 0);
         }
 
-        // As you suggested, stop all other sounds to enforce monophonic behavior.
-        stopAll();
+        return sample;
+    }
 
-        auto* transportSource = transportSources[slotIndex];
+    void SoundPlayer::pushCommand(Command&& command)
+    {
+        const auto scope = commandFifo.write(1);
 
-        // Safely decouple the transport from its old audio source.
-        transportSource->setSource(nullptr);
+        if (scope.blockSize1 > 0)
+            commandBuffer[(size_t)scope.startIndex1] = std::move(command);
+        else if (scope.blockSize2 > 0)
+            commandBuffer[(size_t)scope.startIndex2] = std::move(command);
+        else
+            DBG("SoundPlayer: command queue is full, trigger dropped.");
+    }
 
-        // Create a new reader for the audio file.
-        if (auto reader = std::unique_ptr<juce::AudioFormatReader>(formatManager.createReaderFor(audioFile)))
-        {
-            // Create a new reader source and assign it to the unique_ptr for this slot.
-            readerSources[slotIndex] = std::make_unique<juce::AudioFormatReaderSource>(reader.release(), true);
+    //==============================================================================
+    void SoundPlayer::handlePendingCommands()
+    {
+        const auto scope = commandFifo.read(commandFifo.getNumReady());
 
-            // Pass the raw pointer to the transport source.
-            transportSource->setSource(readerSources[slotIndex].get(), 0, nullptr, readerSources[slotIndex]->getAudioFormatReader()->sampleRate);
+        scope.forEach([this](int index)
+            {
+                auto& command = commandBuffer[(size_t)index];
+
+                if (command.type == Command::Type::StopAll)
+                {
+                    for (auto& voice : voices)
+                        if (voice.isActive())
+                            releaseVoice(voice);
+                }
+                else if (command.sample != nullptr)
+                {
+                    startVoice(command);
+                }
+
+                // The pool keeps its own reference, so this never frees memory here.
+                command.sample = nullptr;
+            });
+    }
+
+    void SoundPlayer::startVoice(Command& command)
+    {
+        int slotVoices = 0;
+        Voice* oldestSlotVoice = nullptr;
 
-            transportSource->setPosition(0.0);
-            transportSource->start();
+        for (auto& voice : voices)
+        {
+            if (!voice.isActive() || voice.releasing)
+                continue;
+
+            const bool choked = command.chokeGroup != 0 && voice.chokeGroup == command.chokeGroup;
+            const bool sameSlot = voice.slotIndex == command.slotIndex;
 
-            DBG("Playing sound on slot " << slotIndex << ": " << audioFile.getFileName());
+            if (choked || (sameSlot && command.playMode == SoundboardSlot::PlayMode::Retrigger))
+            {
+                releaseVoice(voice);
+            }
+            else if (sameSlot)
+            {
+                ++slotVoices;
+                if (oldestSlotVoice == nullptr || voice.startOrder < oldestSlotVoice->startOrder)
+                    oldestSlotVoice = &voice;
+            }
         }
-        else
+
+        if (slotVoices >= maxVoicesPerSlot && oldestSlotVoice != nullptr)
+            releaseVoice(*oldestSlotVoice);
+
+        auto& voice = findFreeVoice();
+        voice.sample = command.sample;
+        voice.slotIndex = command.slotIndex;
+        voice.chokeGroup = command.chokeGroup;
+        voice.position = 0;
+        voice.gain = 0.0f;
+        voice.gainStep = 1.0f / (float)fadeInSamples;
+        voice.releasing = false;
+        voice.startOrder = nextStartOrder++;
+
+        // Keep headroom in the pool: once it is nearly full, start fading the oldest
+        // voice so the next steal takes a voice that is already on its way out.
+        int sounding = 0;
+        Voice* oldest = nullptr;
+        for (auto& v : voices)
         {
-            DBG("SoundPlayer::play() - Could not create reader for file: " << audioFile.getFullPathName());
+            if (!v.isActive() || v.releasing)
+                continue;
+
+            ++sounding;
+            if (oldest == nullptr || v.startOrder < oldest->startOrder)
+                oldest = &v;
         }
+
+        if (sounding > numVoices - 2 && oldest != nullptr && oldest != &voice)
+            releaseVoice(*oldest);
     }
 
-    void SoundPlayer::stopAll()
+    SoundPlayer::Voice& SoundPlayer::findFreeVoice()
     {
-        for (auto* source : transportSources)
+        Voice* candidate = nullptr;
+
+        for (auto& voice : voices)
         {
-            if (source != nullptr && source->isPlaying())
-                source->stop();
+            if (!voice.isActive())
+                return voice;
+
+            // Prefer stealing the quietest fading voice, then the oldest one.
+            if (candidate == nullptr
+                || (voice.releasing && !candidate->releasing)
+                || (voice.releasing == candidate->releasing
+                    && (voice.releasing ? voice.gain < candidate->gain : voice.startOrder < candidate->startOrder)))
+                candidate = &voice;
         }
+
+        return *candidate;
     }
 
-    void SoundPlayer::setGain(float newGain)
+    void SoundPlayer::releaseVoice(Voice& voice)
     {
-        if (gainSource)
-            gainSource->setGain(newGain);
+        if (voice.gain <= 0.0f)
+        {
+            voice.sample = nullptr;
+            return;
+        }
+
+        voice.releasing = true;
+        voice.gainStep = -1.0f / (float)fadeOutSamples;
     }
 
-    void SoundPlayer::setEnabled(bool shouldBeEnabled)
+    void SoundPlayer::renderVoice(Voice& voice, juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
     {
-        enabled = shouldBeEnabled;
-        if (!enabled)
+        const auto& data = voice.sample->data;
+        const int numSourceChannels = data.getNumChannels();
+        const int numToRender = juce::jmin(numSamples, data.getNumSamples() - voice.position);
+        int rendered = 0;
+
+        if (voice.gainStep != 0.0f)
         {
-            stopAll();
+            // Short per-sample ramp while the voice fades in or out.
+            const float target = voice.gainStep > 0.0f ? 1.0f : 0.0f;
+            const int stepsLeft = (int)std::ceil(std::abs((target - voice.gain) / voice.gainStep));
+            const int rampLength = juce::jmin(numToRender, stepsLeft);
+
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            {
+                const auto* src = data.getReadPointer(ch % numSourceChannels, voice.position);
+                auto* dst = buffer.getWritePointer(ch, startSample);
+                float g = voice.gain;
+
+                for (int i = 0; i < rampLength; ++i)
+                {
+                    g = juce::jlimit(0.0f, 1.0f, g + voice.gainStep);
+                    dst[i] += src[i] * g;
+                }
+            }
+
+            voice.gain = juce::jlimit(0.0f, 1.0f, voice.gain + voice.gainStep * (float)rampLength);
+            rendered = rampLength;
+
+            if (rampLength == stepsLeft)
+            {
+                voice.gain = target;
+                voice.gainStep = 0.0f;
+
+                if (voice.releasing)
+                {
+                    voice.sample = nullptr;
+                    return;
+                }
+            }
+        }
+
+        if (rendered < numToRender && voice.gain > 0.0f)
+        {
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            {
+                juce::FloatVectorOperations::addWithMultiply(buffer.getWritePointer(ch, startSample + rendered),
+                    data.getReadPointer(ch % numSourceChannels, voice.position + rendered),
+                    voice.gain, numToRender - rendered);
+            }
         }
+
+        voice.position += numToRender;
+
+        if (voice.position >= data.getNumSamples())
+            voice.sample = nullptr;
     }
 
-} // namespace IdolAZ
\ No newline at end of file
+} // namespace IdolAZ
@@ -2,7 +2,7 @@
   ==============================================================================
 
     SoundPlayer.h
-    (Final version using user's unique_ptr solution)
+    (Polyphonic voice engine for the soundboard)
 
   ==============================================================================
 */
@@ -10,43 +10,118 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "../Data/SoundboardSlot.h"
 
 namespace IdolAZ
 {
-    class GainAudioSource;
+    /**
+        Plays soundboard samples from a fixed pool of voices.
 
-    class SoundPlayer : public juce::AudioSource
+        Samples are decoded up front on the message thread and handed to the audio
+        thread through a single-producer/single-consumer command queue, so a trigger
+        never locks, allocates or touches the disk on the audio thread. Every voice
+        fades in and out over a few milliseconds to avoid clicks when it is started,
+        retriggered, choked or stolen.
+    */
+    class SoundPlayer : public juce::AudioSource, private juce::Timer
     {
     public:
         SoundPlayer();
         ~SoundPlayer() override;
 
-        void play(const juce::File& audioFile, int slotIndex);
+        /** Queues a trigger for the slot. Must be called from the message thread. */
+        void play(const SoundboardSlot& slot, int slotIndex);
         void stopAll();
         void setGain(float newGain);
         void setEnabled(bool shouldBeEnabled);
 
+        /** Decodes every assigned slot ahead of time so the first trigger is instant. */
+        void preloadSlots(const juce::Array<SoundboardSlot>& slots);
+
+        /** Number of voices currently sounding (for the UI, approximate). */
+        int getNumActiveVoices() const { return numActiveVoices.load(); }
+
         void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
         void getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) override;
         void releaseResources() override;
 
+        static constexpr int numSlots = 9;
+        static constexpr int numVoices = 16;
+        static constexpr int maxVoicesPerSlot = 4;
+
     private:
-        static constexpr int numVoices = 9;
+        /** A fully decoded sample at the device sample rate. */
+        struct Sample : public juce::ReferenceCountedObject
+        {
+            using Ptr = juce::ReferenceCountedObjectPtr<Sample>;
+
+            juce::File file;
+            juce::Time lastModified;
+            double sampleRate = 0.0;
+            juce::AudioBuffer<float> data;
+        };
+
+        struct Command
+        {
+            enum class Type { Start, StopAll };
+
+            Type type = Type::Start;
+            Sample::Ptr sample;
+            int slotIndex = -1;
+            int chokeGroup = 0;
+            SoundboardSlot::PlayMode playMode = SoundboardSlot::PlayMode::Retrigger;
+        };
+
+        struct Voice
+        {
+            Sample::Ptr sample;
+            int slotIndex = -1;
+            int chokeGroup = 0;
+            int position = 0;
+            float gain = 0.0f;
+            float gainStep = 0.0f;
+            bool releasing = false;
+            juce::uint32 startOrder = 0;
+
+            bool isActive() const noexcept { return sample != nullptr; }
+        };
+
+        void timerCallback() override;
+        Sample::Ptr getOrLoadSample(const juce::File& file, int slotIndex);
+        Sample::Ptr decodeSample(const juce::File& file, double targetSampleRate);
+        void pushCommand(Command&& command);
+
+        // Audio thread only
+        void handlePendingCommands();
+        void startVoice(Command& command);
+        Voice& findFreeVoice();
+        void releaseVoice(Voice& voice);
+        void renderVoice(Voice& voice, juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
 
         juce::AudioFormatManager formatManager;
-        juce::MixerAudioSource mixer;
 
-        std::unique_ptr<GainAudioSource> gainSource;
-        juce::OwnedArray<juce::AudioTransportSource> transportSources;
+        // Message thread: per-slot cache plus a pool that keeps one reference to every
+        // sample the audio thread may still hold. Samples are freed by the timer once
+        // the pool owns the last reference, never on the audio thread.
+        std::array<Sample::Ptr, numSlots> slotSamples;
+        juce::ReferenceCountedArray<Sample> samplePool;
+
+        static constexpr int commandQueueSize = 64;
+        juce::AbstractFifo commandFifo{ commandQueueSize };
+        std::array<Command, commandQueueSize> commandBuffer;
 
-        // Using a unique_ptr to explicitly manage the lifetime of the reader sources.
-        // This is a robust solution to prevent memory leaks.
-        // We use an array of unique_ptrs to manage each slot's source independently.
-        std::array<std::unique_ptr<juce::AudioFormatReaderSource>, numVoices> readerSources;
+        std::array<Voice, numVoices> voices;
+        juce::uint32 nextStartOrder = 0;
+        int fadeInSamples = 96;
+        int fadeOutSamples = 480;
 
+        juce::LinearSmoothedValue<float> smoothedGain;
+        std::atomic<float> targetGain{ 0.75f };
+        std::atomic<double> deviceSampleRate{ 0.0 };
+        std::atomic<int> numActiveVoices{ 0 };
         std::atomic<bool> enabled{ true };
 
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SoundPlayer)
     };
 
-} // namespace IdolAZ
\ No newline at end of file
+} // namespace IdolAZ
@@ -0,0 +1,224 @@
+/*
+  ==============================================================================
+
+    TimePitchRenderCache.cpp
+
+  ==============================================================================
+*/
+
+#include "TimePitchRenderCache.h"
+#include "TimePitchShifter.h"
+
+//==============================================================================
+class TimePitchRenderCache::RenderJob : public juce::ThreadPoolJob
+{
+public:
+    RenderJob(TimePitchRenderCache& ownerToUse, const juce::File& sourceFile, const juce::File& targetFile,
+              int semitonesToUse, double tempoToUse, std::function<void(const juce::File&)> callback)
+        : juce::ThreadPoolJob("Key/tempo render"),
+          owner(ownerToUse), weakOwner(&ownerToUse),
+          source(sourceFile), target(targetFile),
+          semitones(semitonesToUse), tempo(tempoToUse),
+          onFinished(std::move(callback))
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        const bool succeeded = render();
+
+        if (shouldExit())
+            return jobHasFinished;
+
+        if (!succeeded)
+            DBG("Key/tempo render failed for " << source.getFullPathName());
+
+        juce::MessageManager::callAsync([weak = weakOwner, callback = std::move(onFinished),
+                                         result = succeeded ? target : juce::File()]
+        {
+            if (weak == nullptr)
+                return;
+
+            weak->pruneCache();
+            if (callback != nullptr)
+                callback(result);
+        });
+
+        return jobHasFinished;
+    }
+
+private:
+    bool render()
+    {
+        std::unique_ptr<juce::AudioFormatReader> reader(owner.formatManager.createReaderFor(source));
+        if (reader == nullptr || reader->lengthInSamples <= 0)
+            return false;
+
+        constexpr int blockSize = 8192;
+        const int numChannels = juce::jlimit(1, 2, (int)reader->numChannels);
+        const double rate = reader->sampleRate;
+        const auto outputLength = (juce::int64)std::ceil((double)reader->lengthInSamples / tempo);
+
+        target.getParentDirectory().createDirectory();
+        juce::TemporaryFile temp(target);
+
+        {
+            std::unique_ptr<juce::OutputStream> stream(temp.getFile().createOutputStream());
+            if (stream == nullptr)
+                return false;
+
+            juce::WavAudioFormat wavFormat;
+            std::unique_ptr<juce::AudioFormatWriter> writer(wavFormat.createWriterFor(stream.get(), rate,
+                (unsigned int)numChannels, 24, {}, 0));
+            if (writer == nullptr)
+                return false;
+            stream.release();
+
+            // Tempo: resample (moves the pitch too). Key: shift by whatever is left.
+            juce::AudioFormatReaderSource readerSource(reader.get(), false);
+            juce::ResamplingAudioSource resampler(&readerSource, false, numChannels);
+            resampler.setResamplingRatio(tempo);
+            resampler.prepareToPlay(blockSize, rate);
+
+            const float pitchRatio = TimePitchShifter::getPitchRatioFor(semitones, tempo);
+            const bool needsShift = !juce::approximatelyEqual(pitchRatio, 1.0f);
+
+            TimePitchShifter shifter;
+            shifter.prepare(TimePitchShifter::Quality::Render, numChannels);
+            shifter.setPitchRatio(pitchRatio);
+
+            // The shifter's latency is trimmed from the front; the reader's silence past
+            // the end of the file flushes its tail.
+            int samplesToSkip = needsShift ? shifter.getLatencyInSamples() : 0;
+            juce::AudioBuffer<float> block(numChannels, blockSize);
+            juce::int64 written = 0;
+
+            while (written < outputLength)
+            {
+                if (shouldExit())
+                    return false;
+
+                juce::AudioSourceChannelInfo info(&block, 0, blockSize);
+                resampler.getNextAudioBlock(info);
+
+                if (needsShift)
+                    shifter.process(block, blockSize);
+
+                const int skipped = juce::jmin(samplesToSkip, blockSize);
+                samplesToSkip -= skipped;
+
+                const int numToWrite = (int)juce::jmin((juce::int64)(blockSize - skipped), outputLength - written);
+                if (numToWrite > 0)
+                {
+                    if (!writer->writeFromAudioSampleBuffer(block, skipped, numToWrite))
+                        return false;
+                    written += numToWrite;
+                }
+
+                owner.progress = (float)((double)written / (double)outputLength);
+            }
+        }
+
+        return temp.overwriteTargetFileWithTemporary();
+    }
+
+    TimePitchRenderCache& owner;
+    juce::WeakReference<TimePitchRenderCache> weakOwner;
+    const juce::File source, target;
+    const int semitones;
+    const double tempo;
+    std::function<void(const juce::File&)> onFinished;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RenderJob)
+};
+
+//==============================================================================
+TimePitchRenderCache::TimePitchRenderCache(juce::AudioFormatManager& formatManagerToUse)
+    : formatManager(formatManagerToUse)
+{
+}
+
+TimePitchRenderCache::~TimePitchRenderCache()
+{
+    cancelAll();
+}
+
+juce::File TimePitchRenderCache::getCacheDirectory()
+{
+    return juce::File::getSpecialLocation(juce::File::SpecialLocationType::userApplicationDataDirectory)
+        .getChildFile(ProjectInfo::companyName)
+        .getChildFile(ProjectInfo::projectName)
+        .getChildFile("RenderCache");
+}
+
+juce::File TimePitchRenderCache::getCacheFileFor(const juce::File& source, int semitones, double tempo) const
+{
+    // Size and modification time are part of the key so an edited file is re-rendered.
+    const auto key = source.getFullPathName()
+        + "|" + juce::String(source.getSize())
+        + "|" + juce::String(source.getLastModificationTime().toMilliseconds())
+        + "|" + juce::String(semitones)
+        + "|" + juce::String(tempo, 3);
+
+    const auto hash = juce::MD5(key.toUTF8()).toHexString().substring(0, 12);
+    const auto name = source.getFileNameWithoutExtension()
+        + "_" + (semitones >= 0 ? "+" : "") + juce::String(semitones) + "st"
+        + "_" + juce::String(juce::roundToInt(tempo * 100.0)) + "pct"
+        + "_" + hash + ".wav";
+
+    return getCacheDirectory().getChildFile(juce::File::createLegalFileName(name));
+}
+
+bool TimePitchRenderCache::isCached(const juce::File& source, int semitones, double tempo) const
+{
+    return getCacheFileFor(source, semitones, tempo).existsAsFile();
+}
+
+void TimePitchRenderCache::requestRender(const juce::File& source, int semitones, double tempo,
+                                         std::function<void(const juce::File&)> onFinished)
+{
+    cancelAll();
+
+    auto target = getCacheFileFor(source, semitones, tempo);
+    if (target.existsAsFile())
+    {
+        target.setLastAccessTime(juce::Time::getCurrentTime());
+        if (onFinished != nullptr)
+            onFinished(target);
+        return;
+    }
+
+    progress = 0.0f;
+    renderPool.addJob(new RenderJob(*this, source, target, semitones, tempo, std::move(onFinished)), true);
+}
+
+void TimePitchRenderCache::cancelAll()
+{
+    renderPool.removeAllJobs(true, 5000);
+}
+
+TimePitchRenderCache::DiskUsage TimePitchRenderCache::getDiskUsage() const
+{
+    DiskUsage usage;
+    for (const auto& file : getCacheDirectory().findChildFiles(juce::File::findFiles, false, "*.wav"))
+    {
+        ++usage.numRenders;
+        usage.totalBytes += file.getSize();
+    }
+    return usage;
+}
+
+void TimePitchRenderCache::pruneCache()
+{
+    auto files = getCacheDirectory().findChildFiles(juce::File::findFiles, false, "*.wav");
+    if (files.size() <= maxCachedRenders)
+        return;
+
+    std::sort(files.begin(), files.end(), [](const juce::File& a, const juce::File& b)
+    {
+        return a.getLastAccessTime() > b.getLastAccessTime();
+    });
+
+    for (int i = maxCachedRenders; i < files.size(); ++i)
+        files.getReference(i).deleteFile();
+}
@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+    TimePitchRenderCache.h
+    (Background high-quality renders of transposed / re-timed backing tracks)
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+    Renders a backing track at a different key and tempo on a background thread and
+    keeps the result on disk, keyed by (file, semitones, tempo).
+
+    The live player uses the cheap preview shifter until the render is finished and
+    then switches to the cached file, so the expensive processing only runs once per
+    song/setting and never on the audio thread.
+
+    All public functions are message-thread only.
+*/
+class TimePitchRenderCache
+{
+public:
+    explicit TimePitchRenderCache(juce::AudioFormatManager& formatManagerToUse);
+    ~TimePitchRenderCache();
+
+    /** The file a render for these settings is (or would be) stored in. */
+    juce::File getCacheFileFor(const juce::File& source, int semitones, double tempo) const;
+    bool isCached(const juce::File& source, int semitones, double tempo) const;
+
+    /**
+        Starts rendering unless the result is already cached. Any render that is still
+        running for other settings is cancelled. onFinished is called on the message
+        thread with the cached file (or an empty File if the render failed).
+    */
+    void requestRender(const juce::File& source, int semitones, double tempo,
+                       std::function<void(const juce::File&)> onFinished);
+    void cancelAll();
+
+    bool isRendering() const { return renderPool.getNumJobs() > 0; }
+    /** 0..1 progress of the render in flight. */
+    float getProgress() const { return progress.load(); }
+
+    struct DiskUsage
+    {
+        int numRenders = 0;
+        juce::int64 totalBytes = 0;
+    };
+
+    /** What the cache holds on disk right now; scans the folder. */
+    DiskUsage getDiskUsage() const;
+
+    static juce::File getCacheDirectory();
+    static constexpr int maxCachedRenders = 32;
+
+private:
+    class RenderJob;
+
+    void pruneCache();
+
+    juce::AudioFormatManager& formatManager;
+    juce::ThreadPool renderPool{ 1 };
+    std::atomic<float> progress{ 0.0f };
+
+    JUCE_DECLARE_WEAK_REFERENCEABLE(TimePitchRenderCache)
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TimePitchRenderCache)
+};
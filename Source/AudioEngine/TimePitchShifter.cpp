@@ -0,0 +1,149 @@
+/*
+  ==============================================================================
+
+    TimePitchShifter.cpp
+
+  ==============================================================================
+*/
+
+#include "TimePitchShifter.h"
+
+void TimePitchShifter::prepare(Quality quality, int numChannels)
+{
+    const int fftOrder = (quality == Quality::Preview) ? 10 : 12;
+    overlap = (quality == Quality::Preview) ? 4 : 8;
+
+    fft = std::make_unique<juce::dsp::FFT>(fftOrder);
+    fftSize = fft->getSize();
+    hopSize = fftSize / overlap;
+    numBins = fftSize / 2 + 1;
+
+    // Hann analysis + synthesis windows overlap-add to 3/8 * overlap.
+    outputGain = 8.0f / (3.0f * (float)overlap);
+
+    window.resize((size_t)fftSize);
+    juce::dsp::WindowingFunction<float>::fillWindowingTables(window.data(), (size_t)fftSize,
+        juce::dsp::WindowingFunction<float>::hann, false);
+
+    fftData.assign((size_t)fftSize * 2, 0.0f);
+    analysisMagnitude.assign((size_t)numBins, 0.0f);
+    analysisFrequency.assign((size_t)numBins, 0.0f);
+    synthesisMagnitude.assign((size_t)numBins, 0.0f);
+    synthesisFrequency.assign((size_t)numBins, 0.0f);
+
+    channels.resize((size_t)numChannels);
+    reset();
+}
+
+void TimePitchShifter::reset()
+{
+    for (auto& channel : channels)
+    {
+        channel.inputFifo.assign((size_t)fftSize, 0.0f);
+        channel.outputFifo.assign((size_t)fftSize, 0.0f);
+        channel.outputAccum.assign((size_t)fftSize * 2, 0.0f);
+        channel.lastPhase.assign((size_t)numBins, 0.0f);
+        channel.sumPhase.assign((size_t)numBins, 0.0f);
+    }
+
+    fifoPosition = getLatencyInSamples();
+}
+
+void TimePitchShifter::process(juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    if (fft == nullptr)
+        return;
+
+    const int latency = getLatencyInSamples();
+    const int numChannelsToProcess = juce::jmin(buffer.getNumChannels(), (int)channels.size());
+    int position = 0;
+
+    while (position < numSamples)
+    {
+        // Exchange as many samples as fit before the next frame boundary.
+        const int chunk = juce::jmin(numSamples - position, fftSize - fifoPosition);
+
+        for (int ch = 0; ch < numChannelsToProcess; ++ch)
+        {
+            auto* data = buffer.getWritePointer(ch, position);
+            auto& channel = channels[(size_t)ch];
+
+            juce::FloatVectorOperations::copy(channel.inputFifo.data() + fifoPosition, data, chunk);
+            juce::FloatVectorOperations::copy(data, channel.outputFifo.data() + (fifoPosition - latency), chunk);
+        }
+
+        fifoPosition += chunk;
+        position += chunk;
+
+        if (fifoPosition >= fftSize)
+        {
+            fifoPosition = latency;
+            const float ratio = pitchRatio.load();
+
+            for (int ch = 0; ch < numChannelsToProcess; ++ch)
+                processFrame(channels[(size_t)ch], ratio);
+        }
+    }
+}
+
+void TimePitchShifter::processFrame(Channel& channel, float ratio)
+{
+    constexpr float twoPi = juce::MathConstants<float>::twoPi;
+    const float expectedAdvance = twoPi * (float)hopSize / (float)fftSize;
+    const auto wrap = [twoPi](float phase) { return phase - twoPi * std::round(phase / twoPi); };
+
+    juce::FloatVectorOperations::multiply(fftData.data(), channel.inputFifo.data(), window.data(), fftSize);
+    juce::FloatVectorOperations::clear(fftData.data() + fftSize, fftSize);
+    fft->performRealOnlyForwardTransform(fftData.data(), true);
+
+    // Analysis: magnitude and true frequency (in bins) of every partial.
+    for (int k = 0; k < numBins; ++k)
+    {
+        const float re = fftData[(size_t)(2 * k)];
+        const float im = fftData[(size_t)(2 * k + 1)];
+        const float phase = std::atan2(im, re);
+
+        const float deviation = wrap(phase - channel.lastPhase[(size_t)k] - (float)k * expectedAdvance);
+        channel.lastPhase[(size_t)k] = phase;
+
+        analysisMagnitude[(size_t)k] = std::sqrt(re * re + im * im);
+        analysisFrequency[(size_t)k] = (float)k + deviation * (float)overlap / twoPi;
+    }
+
+    // Move every partial to its transposed bin.
+    juce::FloatVectorOperations::clear(synthesisMagnitude.data(), numBins);
+    juce::FloatVectorOperations::clear(synthesisFrequency.data(), numBins);
+
+    for (int k = 0; k < numBins; ++k)
+    {
+        const int target = (int)((float)k * ratio);
+        if (target >= numBins)
+            break;
+
+        synthesisMagnitude[(size_t)target] += analysisMagnitude[(size_t)k];
+        synthesisFrequency[(size_t)target] = analysisFrequency[(size_t)k] * ratio;
+    }
+
+    // Synthesis: accumulate phase at the new frequencies.
+    for (int k = 0; k < numBins; ++k)
+    {
+        const float deviation = (synthesisFrequency[(size_t)k] - (float)k) * twoPi / (float)overlap;
+        const float phase = wrap(channel.sumPhase[(size_t)k] + (float)k * expectedAdvance + deviation);
+        channel.sumPhase[(size_t)k] = phase;
+
+        fftData[(size_t)(2 * k)] = synthesisMagnitude[(size_t)k] * std::cos(phase);
+        fftData[(size_t)(2 * k + 1)] = synthesisMagnitude[(size_t)k] * std::sin(phase);
+    }
+
+    fft->performRealOnlyInverseTransform(fftData.data());
+
+    // Overlap-add the windowed frame and hand one hop to the output FIFO.
+    juce::FloatVectorOperations::multiply(fftData.data(), window.data(), fftSize);
+    juce::FloatVectorOperations::addWithMultiply(channel.outputAccum.data(), fftData.data(), outputGain, fftSize);
+
+    std::copy_n(channel.outputAccum.begin(), hopSize, channel.outputFifo.begin());
+    std::copy(channel.outputAccum.begin() + hopSize, channel.outputAccum.end(), channel.outputAccum.begin());
+    std::fill(channel.outputAccum.end() - hopSize, channel.outputAccum.end(), 0.0f);
+
+    std::copy(channel.inputFifo.begin() + hopSize, channel.inputFifo.end(), channel.inputFifo.begin());
+}
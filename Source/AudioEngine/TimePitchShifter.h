@@ -0,0 +1,77 @@
+/*
+  ==============================================================================
+
+    TimePitchShifter.h
+    (Phase-vocoder pitch shifter used for key/tempo changes of backing tracks)
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+    A streaming phase-vocoder pitch shifter built on juce::dsp::FFT.
+
+    Input and output run at the same rate, so the class can sit directly on the
+    music player's buffer. Tempo changes are done by the caller through plain
+    resampling (which also moves the pitch), and the shifter is then asked for the
+    remaining pitch ratio; see getPitchRatioFor().
+
+    The same code runs in two qualities: a small FFT for the live preview and a
+    large, more overlapped one for the background renderer.
+*/
+class TimePitchShifter
+{
+public:
+    enum class Quality
+    {
+        Preview,    // 1024-point FFT, 4x overlap
+        Render      // 4096-point FFT, 8x overlap
+    };
+
+    TimePitchShifter() = default;
+
+    /** Allocates everything; not realtime safe. */
+    void prepare(Quality quality, int numChannels);
+    void reset();
+
+    /** Can be called from any thread; picked up at the next analysis frame. */
+    void setPitchRatio(float newRatio) { pitchRatio.store(newRatio); }
+    float getPitchRatio() const { return pitchRatio.load(); }
+
+    /** Processes the first numSamples of every prepared channel in place. */
+    void process(juce::AudioBuffer<float>& buffer, int numSamples);
+
+    /** Delay in samples between input and output. */
+    int getLatencyInSamples() const { return fftSize - hopSize; }
+
+    /** Pitch ratio that gives the requested key once playback is already sped up by tempo. */
+    static float getPitchRatioFor(int semitones, double tempo)
+    {
+        return (float)(std::pow(2.0, semitones / 12.0) / tempo);
+    }
+
+private:
+    struct Channel
+    {
+        std::vector<float> inputFifo, outputFifo, outputAccum;
+        std::vector<float> lastPhase, sumPhase;
+    };
+
+    void processFrame(Channel& channel, float ratio);
+
+    std::unique_ptr<juce::dsp::FFT> fft;
+    int fftSize = 0, hopSize = 0, overlap = 0, numBins = 0;
+    int fifoPosition = 0;
+    float outputGain = 1.0f;
+
+    std::vector<Channel> channels;
+    std::vector<float> window, fftData;
+    std::vector<float> analysisMagnitude, analysisFrequency, synthesisMagnitude, synthesisFrequency;
+
+    std::atomic<float> pitchRatio{ 1.0f };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TimePitchShifter)
+};
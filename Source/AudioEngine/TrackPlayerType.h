@@ -0,0 +1,13 @@
+/*
+  ==============================================================================
+
+    TrackPlayerType.h
+
+  ==============================================================================
+*/
+
+#pragma once
+
+/** Which track a file player feeds. Lives here rather than in the player component
+    so the engine doesn't need any GUI headers. */
+enum class TrackPlayerType { Vocal, Music };
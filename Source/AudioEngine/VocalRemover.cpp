@@ -0,0 +1,330 @@
+/*
+  ==============================================================================
+
+    VocalRemover.cpp
+
+  ==============================================================================
+*/
+
+#include "VocalRemover.h"
+#include "../Data/LanguageManager/LanguageManager.h"
+
+namespace
+{
+    // Frames start on multiples of the hop size counted from sample 0 of the file.
+    juce::int64 floorToHop(juce::int64 position)
+    {
+        const auto hop = (juce::int64)VocalRemover::hopSize;
+        return (position >= 0 ? position / hop : -((-position + hop - 1) / hop)) * hop;
+    }
+
+    /** 1 inside the vocal range, with smooth edges so bass and cymbals are left alone. */
+    std::vector<float> createBandWeights(double sampleRate)
+    {
+        constexpr double lowStart = 120.0, lowFull = 250.0, highFull = 6000.0, highEnd = 10000.0;
+        const int numBins = VocalRemover::fftSize / 2 + 1;
+        std::vector<float> weights((size_t)numBins, 0.0f);
+
+        for (int k = 0; k < numBins; ++k)
+        {
+            const double frequency = k * sampleRate / VocalRemover::fftSize;
+            double weight = 0.0;
+
+            if (frequency >= lowFull && frequency <= highFull)
+                weight = 1.0;
+            else if (frequency > lowStart && frequency < lowFull)
+                weight = (frequency - lowStart) / (lowFull - lowStart);
+            else if (frequency > highFull && frequency < highEnd)
+                weight = (highEnd - frequency) / (highEnd - highFull);
+
+            weights[(size_t)k] = (float)weight;
+        }
+
+        return weights;
+    }
+}
+
+//==============================================================================
+struct VocalRemover::Segment
+{
+    juce::int64 start = 0, end = 0;
+    juce::AudioBuffer<float> output;
+    juce::String error;
+    juce::WaitableEvent done;
+};
+
+class VocalRemover::SegmentJob : public juce::ThreadPoolJob
+{
+public:
+    SegmentJob(VocalRemover& ownerToUse, const juce::File& sourceFile, Segment& segmentToRender,
+               const std::vector<float>& bandWeightsToUse)
+        : juce::ThreadPoolJob("Vocal removal segment"),
+          owner(ownerToUse), source(sourceFile), segment(segmentToRender), bandWeights(bandWeightsToUse)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        segment.error = render();
+        segment.done.signal();
+        return jobHasFinished;
+    }
+
+private:
+    juce::String render()
+    {
+        // Readers are not thread-safe, so every segment opens its own.
+        std::unique_ptr<juce::AudioFormatReader> reader(owner.formatManager.createReaderFor(source));
+        if (reader == nullptr)
+            return "vocalRemover.errorUnreadable";
+
+        // Every frame that touches [start, end), including those that start before it.
+        const auto firstFrame = floorToHop(segment.start - fftSize) + hopSize;
+        const auto lastFrame = floorToHop(segment.end - 1);
+        const auto readStart = firstFrame;
+        const int readLength = (int)(lastFrame + fftSize - firstFrame);
+
+        juce::AudioBuffer<float> input(2, readLength);
+        if (!reader->read(&input, 0, readLength, readStart, true, true))
+            return "vocalRemover.errorUnreadable";
+
+        juce::AudioBuffer<float> accum(2, readLength);
+        accum.clear();
+
+        juce::dsp::FFT fft(fftOrder);
+        std::vector<float> window((size_t)fftSize);
+        juce::dsp::WindowingFunction<float>::fillWindowingTables(window.data(), (size_t)fftSize,
+            juce::dsp::WindowingFunction<float>::hann, false);
+
+        std::vector<float> left((size_t)fftSize * 2), right((size_t)fftSize * 2);
+        constexpr float overlapGain = 2.0f / 3.0f; // Hann x Hann at 4x overlap sums to 3/2
+        constexpr float strength = 1.0f;
+        const int numBins = fftSize / 2 + 1;
+
+        for (auto frame = firstFrame; frame <= lastFrame; frame += hopSize)
+        {
+            if (shouldExit())
+                return "cancelled";
+
+            const int offset = (int)(frame - readStart);
+
+            juce::FloatVectorOperations::multiply(left.data(), input.getReadPointer(0, offset), window.data(), fftSize);
+            juce::FloatVectorOperations::multiply(right.data(), input.getReadPointer(1, offset), window.data(), fftSize);
+            fft.performRealOnlyForwardTransform(left.data(), true);
+            fft.performRealOnlyForwardTransform(right.data(), true);
+
+            for (int k = 0; k < numBins; ++k)
+            {
+                const float weight = bandWeights[(size_t)k];
+                if (weight <= 0.0f)
+                    continue;
+
+                auto& lRe = left[(size_t)(2 * k)];
+                auto& lIm = left[(size_t)(2 * k + 1)];
+                auto& rRe = right[(size_t)(2 * k)];
+                auto& rIm = right[(size_t)(2 * k + 1)];
+
+                const float energy = lRe * lRe + lIm * lIm + rRe * rRe + rIm * rIm;
+                if (energy <= 1.0e-12f)
+                    continue;
+
+                // 1 when both sides match in level and phase, 0 for anything panned or out of phase.
+                const float centreness = juce::jmax(0.0f, 2.0f * (lRe * rRe + lIm * rIm) / energy);
+                const float c2 = centreness * centreness;
+                const float c4 = c2 * c2;
+                const float gain = strength * weight * c4 * c4;
+
+                const float midRe = 0.5f * (lRe + rRe) * gain;
+                const float midIm = 0.5f * (lIm + rIm) * gain;
+                lRe -= midRe;  lIm -= midIm;
+                rRe -= midRe;  rIm -= midIm;
+            }
+
+            fft.performRealOnlyInverseTransform(left.data());
+            fft.performRealOnlyInverseTransform(right.data());
+
+            juce::FloatVectorOperations::multiply(left.data(), window.data(), fftSize);
+            juce::FloatVectorOperations::multiply(right.data(), window.data(), fftSize);
+            juce::FloatVectorOperations::addWithMultiply(accum.getWritePointer(0, offset), left.data(), overlapGain, fftSize);
+            juce::FloatVectorOperations::addWithMultiply(accum.getWritePointer(1, offset), right.data(), overlapGain, fftSize);
+
+            ++owner.framesDone;
+        }
+
+        const int numSamples = (int)(segment.end - segment.start);
+        const int outputOffset = (int)(segment.start - readStart);
+        segment.output.setSize(2, numSamples);
+        segment.output.copyFrom(0, 0, accum, 0, outputOffset, numSamples);
+        segment.output.copyFrom(1, 0, accum, 1, outputOffset, numSamples);
+        return {};
+    }
+
+    VocalRemover& owner;
+    const juce::File source;
+    Segment& segment;
+    const std::vector<float>& bandWeights;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SegmentJob)
+};
+
+//==============================================================================
+VocalRemover::VocalRemover(juce::AudioFormatManager& formatManagerToUse)
+    : juce::Thread("Vocal remover"),
+      formatManager(formatManagerToUse),
+      workers(juce::jmax(1, juce::SystemStats::getNumCpus() - 1))
+{
+    selfReference = this;
+}
+
+VocalRemover::~VocalRemover()
+{
+    cancel();
+}
+
+juce::File VocalRemover::getInstrumentalFileFor(const juce::File& source)
+{
+    return source.getSiblingFile(source.getFileNameWithoutExtension() + "_instrumental.wav");
+}
+
+bool VocalRemover::hasCachedInstrumental(const juce::File& source)
+{
+    auto instrumental = getInstrumentalFileFor(source);
+    return instrumental.existsAsFile()
+        && instrumental.getLastModificationTime() >= source.getLastModificationTime();
+}
+
+juce::File VocalRemover::getCurrentSource() const
+{
+    const juce::ScopedLock sl(sourceLock);
+    return currentSource;
+}
+
+bool VocalRemover::start(const juce::File& source,
+                         std::function<void(const juce::File&, const juce::String&)> onFinished)
+{
+    if (isThreadRunning())
+        return false;
+
+    if (hasCachedInstrumental(source))
+    {
+        if (onFinished != nullptr)
+            onFinished(getInstrumentalFileFor(source), {});
+        return true;
+    }
+
+    {
+        const juce::ScopedLock sl(sourceLock);
+        currentSource = source;
+    }
+
+    finishedCallback = std::move(onFinished);
+    progress = 0.0f;
+    framesDone = 0;
+    startThread();
+    sendChangeMessage();
+    return true;
+}
+
+void VocalRemover::cancel()
+{
+    stopThread(10000);
+    workers.removeAllJobs(true, 10000);
+}
+
+void VocalRemover::run()
+{
+    const auto source = getCurrentSource();
+    const auto target = getInstrumentalFileFor(source);
+    const auto error = process(source, target);
+
+    if (error == "cancelled")
+        return;
+
+    finish(error.isEmpty() ? target : juce::File(), error);
+}
+
+juce::String VocalRemover::process(const juce::File& source, const juce::File& target)
+{
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(source));
+    if (reader == nullptr || reader->lengthInSamples <= 0)
+        return "vocalRemover.errorUnreadable";
+    if (reader->numChannels < 2)
+        return "vocalRemover.errorNotStereo";
+
+    const auto length = reader->lengthInSamples;
+    const double sampleRate = reader->sampleRate;
+    const auto bandWeights = createBandWeights(sampleRate);
+
+    // Cut the song into hop-aligned segments and count the frames for the progress bar.
+    const auto segmentLength = juce::jmax((juce::int64)hopSize, floorToHop((juce::int64)(segmentSeconds * sampleRate)));
+    juce::OwnedArray<Segment> segments;
+    juce::int64 totalFrames = 0;
+
+    for (juce::int64 start = 0; start < length; start += segmentLength)
+    {
+        auto* segment = segments.add(new Segment());
+        segment->start = start;
+        segment->end = juce::jmin(length, start + segmentLength);
+        totalFrames += (floorToHop(segment->end - 1) - (floorToHop(segment->start - fftSize) + hopSize)) / hopSize + 1;
+    }
+
+    target.getParentDirectory().createDirectory();
+    juce::TemporaryFile temp(target);
+    std::unique_ptr<juce::OutputStream> stream(temp.getFile().createOutputStream());
+    if (stream == nullptr)
+        return "vocalRemover.errorWrite";
+
+    juce::WavAudioFormat wavFormat;
+    std::unique_ptr<juce::AudioFormatWriter> writer(wavFormat.createWriterFor(stream.get(), sampleRate, 2, 24, {}, 0));
+    if (writer == nullptr)
+        return "vocalRemover.errorWrite";
+    stream.release();
+
+    for (auto* segment : segments)
+        workers.addJob(new SegmentJob(*this, source, *segment, bandWeights), true);
+
+    // Segments finish in any order; write them out in order and free each one once written.
+    for (auto* segment : segments)
+    {
+        while (!segment->done.wait(100))
+        {
+            if (threadShouldExit())
+            {
+                workers.removeAllJobs(true, 10000);
+                return "cancelled";
+            }
+
+            progress = (float)((double)framesDone.load() / (double)totalFrames);
+            sendChangeMessage();
+        }
+
+        if (segment->error.isNotEmpty() || !writer->writeFromAudioSampleBuffer(segment->output, 0, segment->output.getNumSamples()))
+        {
+            workers.removeAllJobs(true, 10000);
+            return segment->error.isNotEmpty() ? segment->error : juce::String("vocalRemover.errorWrite");
+        }
+
+        segment->output.setSize(0, 0);
+    }
+
+    writer.reset();
+    if (!temp.overwriteTargetFileWithTemporary())
+        return "vocalRemover.errorWrite";
+
+    progress = 1.0f;
+    return {};
+}
+
+void VocalRemover::finish(const juce::File& result, const juce::String& error)
+{
+    juce::MessageManager::callAsync([weak = selfReference, result, error]
+    {
+        if (weak == nullptr)
+            return;
+
+        weak->sendChangeMessage();
+
+        if (auto callback = std::exchange(weak->finishedCallback, nullptr))
+            callback(result, error.isEmpty() ? juce::String() : LanguageManager::getInstance().get(error));
+    });
+}
@@ -0,0 +1,81 @@
+/*
+  ==============================================================================
+
+    VocalRemover.h
+    (Offline centre-channel vocal attenuation for karaoke beats)
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+    Writes an instrumental version of a stereo track by removing what is panned
+    dead centre in the vocal range.
+
+    Every STFT bin whose left and right parts match in level and phase is treated
+    as centre content, and its mid signal is subtracted from both channels. The
+    frequency range is limited, so centred bass and kick survive.
+
+    The song is cut into independent segments that run on all cores. Each segment
+    reads one FFT frame of overlap on either side, and frames sit on a global hop
+    grid, so the result matches a single-pass render exactly. The output goes next
+    to the source as "<name>_instrumental.wav" and is reused while it is newer than
+    the source.
+
+    Only one file is processed at a time. A change message is sent as progress moves.
+*/
+class VocalRemover : public juce::ChangeBroadcaster,
+                     private juce::Thread
+{
+public:
+    explicit VocalRemover(juce::AudioFormatManager& formatManagerToUse);
+    ~VocalRemover() override;
+
+    static juce::File getInstrumentalFileFor(const juce::File& source);
+    static bool hasCachedInstrumental(const juce::File& source);
+
+    /**
+        Starts processing in the background. Returns false if another file is still
+        being processed. onFinished is called on the message thread with the
+        instrumental file, or with an empty file and an error message.
+    */
+    bool start(const juce::File& source,
+               std::function<void(const juce::File& instrumental, const juce::String& error)> onFinished);
+    void cancel();
+
+    bool isBusy() const { return isThreadRunning(); }
+    juce::File getCurrentSource() const;
+    float getProgress() const { return progress.load(); }
+
+    static constexpr int fftOrder = 12;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int hopSize = fftSize / 4;
+    static constexpr double segmentSeconds = 15.0;
+
+private:
+    class SegmentJob;
+    struct Segment;
+
+    void run() override;
+    juce::String process(const juce::File& source, const juce::File& target);
+    void finish(const juce::File& result, const juce::String& error);
+
+    juce::AudioFormatManager& formatManager;
+    juce::ThreadPool workers;
+
+    mutable juce::CriticalSection sourceLock;
+    juce::File currentSource;
+    std::function<void(const juce::File&, const juce::String&)> finishedCallback;
+
+    std::atomic<float> progress{ 0.0f };
+    std::atomic<juce::int64> framesDone{ 0 };
+
+    // Created on the message thread so the worker only ever copies it.
+    juce::WeakReference<VocalRemover> selfReference;
+
+    JUCE_DECLARE_WEAK_REFERENCEABLE(VocalRemover)
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VocalRemover)
+};
@@ -24,4 +24,18 @@ namespace IdolUIHelpers
     {
         return createBoldFont("Default", height);
     }
+
+    // DSP load (1.0 = toàn bộ thời lượng block) dạng "12.3%"
+    inline juce::String formatLoad(double load)
+    {
+        return juce::String(load * 100.0, 1) + "%";
+    }
+
+    // Màu theo mức tải: xanh, cam khi quá nửa block, đỏ khi sát deadline
+    inline juce::Colour getLoadColour(double load)
+    {
+        if (load >= 0.9) return juce::Colours::red;
+        if (load >= 0.5) return juce::Colours::orange;
+        return juce::Colours::lightgreen;
+    }
 }
@@ -0,0 +1,49 @@
+/*
+  ==============================================================================
+
+    BeatSearch.cpp
+
+  ==============================================================================
+*/
+
+#include "BeatSearch.h"
+
+juce::String BeatSearch::simplify(const juce::String& text)
+{
+    juce::String result = text;
+
+    // Chữ 'a'
+    result = result.replaceCharacters("áàảãạăắằẳẵặâấầẩẫậ", "aaaaaaaaaaaaaaaaa");
+    result = result.replaceCharacters("ÁÀẢÃẠĂẮẰẲẴẶÂẤẦẨẪẬ", "AAAAAAAAAAAAAAAAA");
+
+    // Chữ 'e'
+    result = result.replaceCharacters("éèẻẽẹêếềểễệ", "eeeeeeeeeee");
+    result = result.replaceCharacters("ÉÈẺẼẸÊẾỀỂỄỆ", "EEEEEEEEEEE");
+
+    // Chữ 'i'
+    result = result.replaceCharacters("íìỉĩị", "iiiii");
+    result = result.replaceCharacters("ÍÌỈĨỊ", "IIIII");
+
+    // Chữ 'o'
+    result = result.replaceCharacters("óòỏõọôốồổỗộơớờởỡợ", "ooooooooooooooooo");
+    result = result.replaceCharacters("ÓÒỎÕỌÔỐỒỔỖỘƠỚỜỞỠỢ", "OOOOOOOOOOOOOOOOO");
+
+    // Chữ 'u'
+    result = result.replaceCharacters("úùủũụưứừửữự", "uuuuuuuuuuu");
+    result = result.replaceCharacters("ÚÙỦŨỤƯỨỪỬỮỰ", "UUUUUUUUUUU");
+
+    // Chữ 'y'
+    result = result.replaceCharacters("ýỳỷỹỵ", "yyyyy");
+    result = result.replaceCharacters("ÝỲỶỸỴ", "YYYYY");
+
+    // Chữ 'đ'
+    result = result.replaceCharacters("đ", "d");
+    result = result.replaceCharacters("Đ", "D");
+
+    return result.toLowerCase();
+}
+
+bool BeatSearch::matches(const juce::String& title, const juce::String& simplifiedTerm)
+{
+    return simplify(title).contains(simplifiedTerm);
+}
@@ -0,0 +1,25 @@
+/*
+  ==============================================================================
+
+    BeatSearch.h
+    (Accent- and case-insensitive matching of beat titles)
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+    The matching the beat manager's search box uses, kept apart from the component so
+    it can be benchmarked without a GUI.
+*/
+namespace BeatSearch
+{
+    /** Lower-cases the text and strips Vietnamese diacritics, so "Đêm Đông" becomes "dem dong". */
+    juce::String simplify(const juce::String& text);
+
+    /** True if the title contains a term that has already been through simplify(). */
+    bool matches(const juce::String& title, const juce::String& simplifiedTerm);
+}
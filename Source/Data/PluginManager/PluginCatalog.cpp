@@ -0,0 +1,227 @@
+#include "Data/PluginManager/PluginCatalog.h"
+#include <algorithm>
+
+namespace
+{
+    constexpr float minimumTrigramOverlap = 0.6f;
+
+    juce::StringArray splitIntoWords(const juce::String& lowerCaseText)
+    {
+        juce::StringArray words;
+        juce::String current;
+
+        for (auto c : lowerCaseText)
+        {
+            if (juce::CharacterFunctions::isLetterOrDigit(c))
+            {
+                current += c;
+            }
+            else if (current.isNotEmpty())
+            {
+                words.add(current);
+                current.clear();
+            }
+        }
+
+        if (current.isNotEmpty())
+            words.add(current);
+
+        return words;
+    }
+
+    bool anyWordStartsWith(const juce::String& lowerCaseText, const juce::String& token)
+    {
+        for (const auto& word : splitIntoWords(lowerCaseText))
+            if (word.startsWith(token))
+                return true;
+
+        return false;
+    }
+}
+
+//==============================================================================
+PluginCatalog::PluginCatalog(const juce::Array<juce::PluginDescription>& types)
+    : plugins(types)
+{
+    fields.reserve((size_t)plugins.size());
+    indexByUniqueId.reserve((size_t)plugins.size());
+    indexByFile.reserve((size_t)plugins.size());
+
+    for (int i = 0; i < plugins.size(); ++i)
+    {
+        const auto& desc = plugins.getReference(i);
+
+        // First entry wins, as the old linear scans did.
+        indexByUniqueId.emplace(desc.uniqueId, i);
+        indexByFile.emplace(desc.fileOrIdentifier, i);
+
+        fields.push_back({ desc.name.toLowerCase(), desc.manufacturerName.toLowerCase(), desc.category.toLowerCase() });
+        const auto& f = fields.back();
+        indexField(i, f.name);
+        indexField(i, f.manufacturer);
+        indexField(i, f.category);
+    }
+
+    std::sort(wordIndex.begin(), wordIndex.end());
+    wordIndex.erase(std::unique(wordIndex.begin(), wordIndex.end()), wordIndex.end());
+}
+
+void PluginCatalog::indexField(int pluginIndex, const juce::String& lowerCaseText)
+{
+    for (const auto& word : splitIntoWords(lowerCaseText))
+        wordIndex.emplace_back(word, pluginIndex);
+
+    // Plugins are indexed in order, so checking the last entry keeps each list sorted and unique.
+    for (auto trigram : getTrigrams(lowerCaseText))
+    {
+        auto& postings = trigramIndex[trigram];
+        if (postings.empty() || postings.back() != pluginIndex)
+            postings.push_back(pluginIndex);
+    }
+}
+
+const juce::PluginDescription* PluginCatalog::findByUniqueId(int uniqueId) const
+{
+    const auto it = indexByUniqueId.find(uniqueId);
+    return it != indexByUniqueId.end() ? &plugins.getReference(it->second) : nullptr;
+}
+
+const juce::PluginDescription* PluginCatalog::findByFileOrIdentifier(const juce::String& fileOrIdentifier) const
+{
+    const auto it = indexByFile.find(fileOrIdentifier);
+    return it != indexByFile.end() ? &plugins.getReference(it->second) : nullptr;
+}
+
+//==============================================================================
+std::vector<const juce::PluginDescription*> PluginCatalog::search(const juce::String& searchText, int maxResults) const
+{
+    std::vector<const juce::PluginDescription*> results;
+    const auto numPlugins = (size_t)plugins.size();
+    const auto tokens = splitIntoWords(searchText.trim().toLowerCase());
+
+    if (tokens.isEmpty())
+    {
+        results.reserve(numPlugins);
+        for (const auto& desc : plugins)
+            results.push_back(&desc);
+    }
+    else
+    {
+        // Every token has to match somewhere; the scores of all tokens add up.
+        std::vector<int> totals(numPlugins, 0);
+        std::vector<int> tokenScores(numPlugins, 0);
+        std::vector<int> trigramHits(numPlugins, 0);
+        std::vector<int> candidates;
+
+        for (int t = 0; t < tokens.size(); ++t)
+        {
+            const auto& token = tokens[t];
+            std::fill(tokenScores.begin(), tokenScores.end(), 0);
+            std::fill(trigramHits.begin(), trigramHits.end(), 0);
+            candidates.clear();
+
+            // Word prefixes catch short tokens, trigrams catch substrings and typos.
+            for (auto it = std::lower_bound(wordIndex.begin(), wordIndex.end(), std::make_pair(token, -1));
+                 it != wordIndex.end() && it->first.startsWith(token); ++it)
+                candidates.push_back(it->second);
+
+            const auto trigrams = getTrigrams(token);
+            for (auto trigram : trigrams)
+            {
+                const auto it = trigramIndex.find(trigram);
+                if (it == trigramIndex.end())
+                    continue;
+
+                for (auto index : it->second)
+                    if (trigramHits[(size_t)index]++ == 0)
+                        candidates.push_back(index);
+            }
+
+            for (auto index : candidates)
+                if ((t == 0 || totals[(size_t)index] > 0) && tokenScores[(size_t)index] == 0)
+                    tokenScores[(size_t)index] = scoreToken(index, token, trigramHits[(size_t)index], (int)trigrams.size());
+
+            for (size_t i = 0; i < numPlugins; ++i)
+                totals[i] = tokenScores[i] > 0 ? totals[i] + tokenScores[i] : 0;
+        }
+
+        std::vector<int> matches;
+        for (size_t i = 0; i < numPlugins; ++i)
+            if (totals[i] > 0)
+                matches.push_back((int)i);
+
+        std::stable_sort(matches.begin(), matches.end(), [&](int a, int b)
+        {
+            if (totals[(size_t)a] != totals[(size_t)b])
+                return totals[(size_t)a] > totals[(size_t)b];
+
+            return fields[(size_t)a].name < fields[(size_t)b].name;
+        });
+
+        results.reserve(matches.size());
+        for (auto index : matches)
+            results.push_back(&plugins.getReference(index));
+    }
+
+    if (maxResults >= 0 && results.size() > (size_t)maxResults)
+        results.resize((size_t)maxResults);
+
+    return results;
+}
+
+int PluginCatalog::scoreToken(int pluginIndex, const juce::String& token, int trigramHits, int numTrigrams) const
+{
+    const auto& f = fields[(size_t)pluginIndex];
+
+    if (f.name == token)                                 return 1000;
+    if (f.name.startsWith(token))                        return 600;
+    if (anyWordStartsWith(f.name, token))                return 400;
+    if (f.name.contains(token))                          return 300;
+    if (anyWordStartsWith(f.manufacturer, token)
+        || anyWordStartsWith(f.category, token))         return 200;
+    if (f.manufacturer.contains(token)
+        || f.category.contains(token))                   return 150;
+
+    // Fuzzy: most of the token's trigrams appear somewhere in the fields.
+    if (numTrigrams > 0)
+    {
+        const auto overlap = (float)trigramHits / (float)numTrigrams;
+        if (overlap >= minimumTrigramOverlap)
+            return juce::roundToInt(100.0f * overlap);
+    }
+
+    return 0;
+}
+
+//==============================================================================
+juce::uint64 PluginCatalog::makeTrigram(juce::juce_wchar a, juce::juce_wchar b, juce::juce_wchar c) noexcept
+{
+    // Unicode code points fit in 21 bits.
+    return ((juce::uint64)(a & 0x1fffff) << 42) | ((juce::uint64)(b & 0x1fffff) << 21) | (juce::uint64)(c & 0x1fffff);
+}
+
+std::vector<juce::uint64> PluginCatalog::getTrigrams(const juce::String& lowerCaseText)
+{
+    std::vector<juce::uint64> trigrams;
+    auto p = lowerCaseText.getCharPointer();
+
+    if (p.isEmpty())
+        return trigrams;
+
+    auto a = p.getAndAdvance();
+    if (p.isEmpty())
+        return trigrams;
+
+    auto b = p.getAndAdvance();
+    while (!p.isEmpty())
+    {
+        const auto c = p.getAndAdvance();
+        trigrams.push_back(makeTrigram(a, b, c));
+        a = b;
+        b = c;
+    }
+
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    return trigrams;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+/**
+    An immutable, indexed snapshot of the known plugin list.
+
+    Lookups by uniqueId or fileOrIdentifier are hash lookups, and search() ranks
+    matches over name, manufacturer and category using a word-prefix index plus a
+    trigram index, so small typos ("compresor") still find the plugin.
+
+    A snapshot never changes once built. PluginManager swaps in a new one whenever
+    the list changes, so holding a Ptr keeps every returned pointer valid.
+*/
+class PluginCatalog
+{
+public:
+    using Ptr = std::shared_ptr<const PluginCatalog>;
+
+    PluginCatalog() = default;
+    explicit PluginCatalog(const juce::Array<juce::PluginDescription>& types);
+
+    /** All plugins, in the same order as the KnownPluginList they were taken from. */
+    const juce::Array<juce::PluginDescription>& getAll() const noexcept { return plugins; }
+    int size() const noexcept { return plugins.size(); }
+
+    /** Returns nullptr when no plugin has this id. */
+    const juce::PluginDescription* findByUniqueId(int uniqueId) const;
+    const juce::PluginDescription* findByFileOrIdentifier(const juce::String& fileOrIdentifier) const;
+
+    /** Best matches first. An empty search returns every plugin in list order. */
+    std::vector<const juce::PluginDescription*> search(const juce::String& searchText, int maxResults = -1) const;
+
+private:
+    struct SearchFields
+    {
+        juce::String name, manufacturer, category;
+    };
+
+    void indexField(int pluginIndex, const juce::String& lowerCaseText);
+    int scoreToken(int pluginIndex, const juce::String& token, int trigramHits, int numTrigrams) const;
+
+    static juce::uint64 makeTrigram(juce::juce_wchar a, juce::juce_wchar b, juce::juce_wchar c) noexcept;
+    static std::vector<juce::uint64> getTrigrams(const juce::String& lowerCaseText);
+
+    juce::Array<juce::PluginDescription> plugins;
+    std::vector<SearchFields> fields;                           // lower-case copies, parallel to plugins
+
+    std::unordered_map<int, int> indexByUniqueId;
+    std::unordered_map<juce::String, int> indexByFile;
+    std::unordered_map<juce::uint64, std::vector<int>> trigramIndex;   // sorted plugin indices per trigram
+    std::vector<std::pair<juce::String, int>> wordIndex;              // (word, plugin index), sorted by word
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PluginCatalog)
+};
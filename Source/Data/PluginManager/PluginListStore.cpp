@@ -0,0 +1,249 @@
+#include "Data/PluginManager/PluginListStore.h"
+
+namespace
+{
+    constexpr int headerSize = 32;
+
+    juce::uint64 fnv1a(const void* data, size_t numBytes) noexcept
+    {
+        auto hash = (juce::uint64)0xcbf29ce484222325ull;
+        const auto* bytes = static_cast<const juce::uint8*>(data);
+
+        for (size_t i = 0; i < numBytes; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= (juce::uint64)0x100000001b3ull;
+        }
+
+        return hash;
+    }
+
+    void writeString(juce::MemoryOutputStream& out, const juce::String& text)
+    {
+        const auto utf8 = text.toUTF8();
+        const auto numBytes = utf8.sizeInBytes() - 1;
+        out.writeInt((int)numBytes);
+        out.write(utf8.getAddress(), numBytes);
+    }
+
+    /** Bounds-checked decoding straight out of the mapped file. */
+    struct PayloadReader
+    {
+        const juce::uint8* data;
+        size_t size;
+        size_t position = 0;
+        bool failed = false;
+
+        bool canRead(size_t numBytes)
+        {
+            failed = failed || numBytes > size - position;
+            return !failed;
+        }
+
+        int readInt()
+        {
+            if (!canRead(4)) return 0;
+            const auto value = (int)juce::ByteOrder::littleEndianInt(data + position);
+            position += 4;
+            return value;
+        }
+
+        juce::int64 readInt64()
+        {
+            if (!canRead(8)) return 0;
+            const auto value = (juce::int64)juce::ByteOrder::littleEndianInt64(data + position);
+            position += 8;
+            return value;
+        }
+
+        bool readBool()
+        {
+            if (!canRead(1)) return false;
+            return data[position++] != 0;
+        }
+
+        juce::String readString()
+        {
+            const auto numBytes = readInt();
+            if (numBytes < 0 || !canRead((size_t)numBytes))
+            {
+                failed = true;
+                return {};
+            }
+
+            auto text = juce::String::fromUTF8(reinterpret_cast<const char*>(data + position), numBytes);
+            position += (size_t)numBytes;
+            return text;
+        }
+    };
+}
+
+//==============================================================================
+bool PluginListStore::read(const juce::File& file, Contents& contents)
+{
+    if (!file.existsAsFile() || file.getSize() < headerSize)
+        return false;
+
+    juce::MemoryMappedFile mapped(file, juce::MemoryMappedFile::readOnly);
+    const auto* bytes = static_cast<const juce::uint8*>(mapped.getData());
+    const auto fileSize = mapped.getSize();
+
+    if (bytes == nullptr || fileSize < (size_t)headerSize
+        || std::memcmp(bytes, "ILKP", 4) != 0
+        || (int)juce::ByteOrder::littleEndianInt(bytes + 4) != formatVersion)
+        return false;
+
+    const auto payloadSize = (size_t)juce::ByteOrder::littleEndianInt64(bytes + 8);
+    const auto checksum = juce::ByteOrder::littleEndianInt64(bytes + 16);
+
+    if (payloadSize != fileSize - (size_t)headerSize || fnv1a(bytes + headerSize, payloadSize) != checksum)
+    {
+        DBG("PluginListStore: " + file.getFileName() + " is corrupt, ignoring it.");
+        return false;
+    }
+
+    PayloadReader in{ bytes + headerSize, payloadSize };
+    Contents loaded;
+
+    const int numTypes = in.readInt();
+    for (int i = 0; i < numTypes && !in.failed; ++i)
+    {
+        juce::PluginDescription desc;
+        desc.name = in.readString();
+        desc.descriptiveName = in.readString();
+        desc.pluginFormatName = in.readString();
+        desc.category = in.readString();
+        desc.manufacturerName = in.readString();
+        desc.version = in.readString();
+        desc.fileOrIdentifier = in.readString();
+        desc.lastFileModTime = juce::Time(in.readInt64());
+        desc.lastInfoUpdateTime = juce::Time(in.readInt64());
+        desc.deprecatedUid = in.readInt();
+        desc.uniqueId = in.readInt();
+        desc.isInstrument = in.readBool();
+        desc.numInputChannels = in.readInt();
+        desc.numOutputChannels = in.readInt();
+        desc.hasSharedContainer = in.readBool();
+        loaded.types.add(desc);
+    }
+
+    const int numBlacklisted = in.readInt();
+    for (int i = 0; i < numBlacklisted && !in.failed; ++i)
+        loaded.blacklistedFiles.add(in.readString());
+
+    const int numReasons = in.readInt();
+    for (int i = 0; i < numReasons && !in.failed; ++i)
+    {
+        const auto path = in.readString();
+        loaded.blacklistReasons.set(path, in.readString());
+    }
+
+    if (in.failed)
+        return false;
+
+    contents = std::move(loaded);
+    return true;
+}
+
+bool PluginListStore::write(const juce::File& file, const Contents& contents)
+{
+    juce::MemoryOutputStream payload;
+
+    payload.writeInt(contents.types.size());
+    for (const auto& desc : contents.types)
+    {
+        writeString(payload, desc.name);
+        writeString(payload, desc.descriptiveName);
+        writeString(payload, desc.pluginFormatName);
+        writeString(payload, desc.category);
+        writeString(payload, desc.manufacturerName);
+        writeString(payload, desc.version);
+        writeString(payload, desc.fileOrIdentifier);
+        payload.writeInt64(desc.lastFileModTime.toMilliseconds());
+        payload.writeInt64(desc.lastInfoUpdateTime.toMilliseconds());
+        payload.writeInt(desc.deprecatedUid);
+        payload.writeInt(desc.uniqueId);
+        payload.writeBool(desc.isInstrument);
+        payload.writeInt(desc.numInputChannels);
+        payload.writeInt(desc.numOutputChannels);
+        payload.writeBool(desc.hasSharedContainer);
+    }
+
+    payload.writeInt(contents.blacklistedFiles.size());
+    for (const auto& path : contents.blacklistedFiles)
+        writeString(payload, path);
+
+    payload.writeInt(contents.blacklistReasons.size());
+    for (int i = 0; i < contents.blacklistReasons.size(); ++i)
+    {
+        writeString(payload, contents.blacklistReasons.getAllKeys()[i]);
+        writeString(payload, contents.blacklistReasons.getAllValues()[i]);
+    }
+
+    file.getParentDirectory().createDirectory();
+    juce::TemporaryFile temp(file);
+
+    {
+        juce::FileOutputStream out(temp.getFile());
+        if (!out.openedOk())
+            return false;
+
+        out.write("ILKP", 4);
+        out.writeInt(formatVersion);
+        out.writeInt64((juce::int64)payload.getDataSize());
+        out.writeInt64((juce::int64)fnv1a(payload.getData(), payload.getDataSize()));
+        out.writeRepeatedByte(0, (size_t)(headerSize - 24));
+        out.write(payload.getData(), payload.getDataSize());
+
+        out.flush();
+        if (out.getStatus().failed())
+            return false;
+    }
+
+    return temp.overwriteTargetFileWithTemporary();
+}
+
+//==============================================================================
+bool PluginListStore::readXml(const juce::XmlElement& xml, Contents& contents)
+{
+    if (!xml.hasTagName("KNOWNPLUGINS"))
+        return false;
+
+    for (auto* child : xml.getChildIterator())
+    {
+        juce::PluginDescription desc;
+
+        if (child->hasTagName("BLACKLISTED"))
+            contents.blacklistedFiles.add(child->getStringAttribute("id"));
+        else if (desc.loadFromXml(*child))
+            contents.types.add(desc);
+    }
+
+    if (auto* reasons = xml.getChildByName("BLACKLIST_REASONS"))
+        for (auto* entry : reasons->getChildWithTagNameIterator("ENTRY"))
+            contents.blacklistReasons.set(entry->getStringAttribute("file"), entry->getStringAttribute("reason"));
+
+    return true;
+}
+
+std::unique_ptr<juce::XmlElement> PluginListStore::createXml(const Contents& contents)
+{
+    // Same layout as KnownPluginList::createXml, so other hosts can read the plugins.
+    auto xml = std::make_unique<juce::XmlElement>("KNOWNPLUGINS");
+
+    for (const auto& desc : contents.types)
+        xml->addChildElement(desc.createXml().release());
+
+    for (const auto& path : contents.blacklistedFiles)
+        xml->createNewChildElement("BLACKLISTED")->setAttribute("id", path);
+
+    auto* reasons = xml->createNewChildElement("BLACKLIST_REASONS");
+    for (int i = 0; i < contents.blacklistReasons.size(); ++i)
+    {
+        auto* entry = reasons->createNewChildElement("ENTRY");
+        entry->setAttribute("file", contents.blacklistReasons.getAllKeys()[i]);
+        entry->setAttribute("reason", contents.blacklistReasons.getAllValues()[i]);
+    }
+
+    return xml;
+}
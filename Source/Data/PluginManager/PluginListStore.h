@@ -0,0 +1,41 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+    The on-disk form of the known plugin list.
+
+    A small header ("ILKP", version, payload size, FNV-1a checksum) is followed by
+    a flat payload of length-prefixed UTF-8 strings and little-endian integers.
+    Reading memory-maps the file and decodes it in place. There is no XML parse,
+    so a list with thousands of Waves shell entries loads in a few milliseconds.
+    A file with a bad checksum or an unknown version is rejected, never half-read.
+
+    XML is still written by PluginManager::exportToXml() for people who want to
+    look at or share the list.
+*/
+class PluginListStore
+{
+public:
+    struct Contents
+    {
+        juce::Array<juce::PluginDescription> types;
+        juce::StringArray blacklistedFiles;
+        juce::StringPairArray blacklistReasons;
+    };
+
+    /** Returns false if the file is missing, from another version or corrupt. */
+    static bool read(const juce::File& file, Contents& contents);
+
+    /** Writes through a temporary file, so a crash mid-save leaves the old list intact. */
+    static bool write(const juce::File& file, const Contents& contents);
+
+    /** Reads the old knownPlugins.xml layout (KnownPluginList::createXml plus our reasons). */
+    static bool readXml(const juce::XmlElement& xml, Contents& contents);
+    static std::unique_ptr<juce::XmlElement> createXml(const Contents& contents);
+
+    static constexpr int formatVersion = 1;
+
+private:
+    PluginListStore() = delete;
+};
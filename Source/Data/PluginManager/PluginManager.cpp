@@ -1,122 +1,164 @@
 // Source/Data/PluginManager/PluginManager.cpp
 
-// <<< ADD THIS BLOCK AT THE VERY TOP OF THE FILE >>>
-#if JUCE_DEBUG
-// Override the jassert macro to throw an exception instead of halting.
-// This allows our try-catch blocks to handle problematic plugins during scanning/loading.
-#undef jassert
-#define jassert(expression)  if (!(expression)) { throw std::runtime_error ( "jassert failed: " #expression ); }
-#endif
-// <<< END OF ADDED BLOCK >>>
-
 #include "Data/PluginManager/PluginManager.h"
 #include "Data/PluginManager/WavesShellManager.h"
+#include "Diagnostics/StallDetector.h"
 
-PluginManager::PluginManager()
+PluginManager::PluginManager(const juce::File& knownPluginsListFile)
 {
     formatManager.addDefaultFormats();
-
-    knownPluginsFile = juce::File::getSpecialLocation(juce::File::SpecialLocationType::userApplicationDataDirectory)
-        .getChildFile(ProjectInfo::companyName)
-        .getChildFile(ProjectInfo::projectName)
-        .getChildFile("knownPlugins.xml");
-
-    loadKnownPluginsList();
+   #if IDOL_ENABLE_SYNTHETIC_PLUGINS
+    formatManager.addFormat(new SyntheticPluginFormat());
+   #endif
+
+    knownPluginsFile = knownPluginsListFile != juce::File()
+        ? knownPluginsListFile
+        : juce::File::getSpecialLocation(juce::File::SpecialLocationType::userApplicationDataDirectory)
+            .getChildFile(ProjectInfo::companyName)
+            .getChildFile(ProjectInfo::projectName)
+            .getChildFile("knownPlugins.bin");
+
+    selfReference = this;
+
+    // The list can hold thousands of Waves entries; read it while the splash is up.
+    // Anyone who needs it earlier waits in getCatalog() or ensureLoaded().
+    loadPool.addJob([this]
+    {
+        loadKnownPluginsList();
+        return juce::ThreadPoolJob::jobHasFinished;
+    });
 }
 
 PluginManager::~PluginManager()
 {
+    loadPool.removeAllJobs(true, 10000);
     DBG("PluginManager destroyed cleanly.");
 }
 
-void PluginManager::scanAndMergeAll()
+void PluginManager::ensureLoaded()
+{
+    catalogReady.wait(-1);
+    applyLoadedList();
+}
+
+juce::Array<juce::File> PluginManager::findPluginFiles() const
 {
-    knownPluginList.clear();
     juce::VST3PluginFormat vst3Format;
+    juce::Array<juce::File> files;
 
-    // --- NEW, ROBUST SCANNING LOGIC ---
+    // The format knows about bundles, so this also finds .vst3 folders on Linux and macOS.
+    for (const auto& path : vst3Format.searchPathsForPlugins(vst3Format.getDefaultLocationsToSearch(), true, false))
+    {
+        const juce::File file(path);
+        if (!WavesShellManager::isIgnoredShell(file))
+            files.add(file);
+    }
 
-    // 1. Manually find all VST3 plugin files from default locations.
-    juce::Array<juce::File> allPluginFiles;
+    return files;
+}
 
-    // <<< FIX IS HERE: Correctly iterate over juce::FileSearchPath >>>
-    auto searchPaths = vst3Format.getDefaultLocationsToSearch();
-    for (int i = 0; i < searchPaths.getNumPaths(); ++i)
+bool PluginManager::scanAndMergeAll(std::function<void()> onFinished)
+{
+    if (scanner.isScanning())
+        return false;
+
+    IDOL_STALL_OPERATION("Start plugin scan");
+    ensureLoaded();
+    if (!scanCacheLoaded)
     {
-        const juce::File path = searchPaths[i];
-        path.findChildFiles(allPluginFiles, juce::File::findFiles, true, "*.vst3");
+        scanCache.load(knownPluginsFile.getSiblingFile("pluginScanCache.xml"));
+        scanCacheLoaded = true;
     }
 
-    // 2. Scan non-Waves plugins first, skipping any WaveShell files.
-    DBG("Starting standard VST3 plugin scan (excluding WaveShells)...");
-    for (const auto& pluginFile : allPluginFiles)
+    const auto installedFiles = findPluginFiles();
+    const auto blacklist = knownPluginList.getBlacklistedFiles();
+    scanCache.removeAllExcept(installedFiles);
+    lastScanFailures.clear();
+
+    // Unchanged files keep their cached descriptions; only new or changed ones are
+    // scanned. Blacklisted files stay skipped until the user adds them again by hand.
+    auto foundTypes = std::make_shared<juce::Array<juce::PluginDescription>>();
+    auto fingerprints = std::make_shared<std::unordered_map<juce::String, PluginScanCache::Fingerprint>>();
+    juce::Array<juce::File> filesToScan;
+
+    for (const auto& file : installedFiles)
     {
-        if (pluginFile.getFileName().containsIgnoreCase("WaveShell"))
-        {
-            DBG("Skipping WaveShell file, will be handled by WavesShellManager: " + pluginFile.getFileName());
+        if (blacklist.contains(file.getFullPathName()))
             continue;
-        }
 
-        // Add a try-catch block for safety against other misbehaving plugins.
-        try
+        const auto fingerprint = PluginScanCache::fingerprintOf(file);
+        if (const auto* cachedTypes = scanCache.find(file, fingerprint))
         {
-            juce::OwnedArray<juce::PluginDescription> descs;
-            vst3Format.findAllTypesForFile(descs, pluginFile.getFullPathName());
-            for (auto* desc : descs)
-                if (desc != nullptr)
-                    knownPluginList.addType(*desc);
+            foundTypes->addArray(*cachedTypes);
         }
-        catch (...)
+        else
         {
-            DBG("An exception was caught while scanning a non-Waves plugin: " + pluginFile.getFileName() + ". Skipping this file.");
+            (*fingerprints)[file.getFullPathName()] = fingerprint;
+            filesToScan.add(file);
         }
     }
-    DBG("Standard scan complete. Found " + juce::String(knownPluginList.getNumTypes()) + " standard plugins.");
-
-    // 3. Now, handle Waves plugins using the dedicated, safe manager.
-    DBG("Starting isolated WavesShell scan...");
-    WavesShellManager::getInstance().scanAndParseShells();
-    const auto& wavesPlugins = WavesShellManager::getInstance().getScannedPlugins();
-    DBG("Found " + juce::String(wavesPlugins.size()) + " Waves plugins.");
-    for (const auto& wavesDesc : wavesPlugins)
+
+    DBG("Reusing " + juce::String(foundTypes->size()) + " cached plugins, scanning "
+        + juce::String(filesToScan.size()) + " new or changed files out of process...");
+
+    PluginScanner::Callbacks callbacks;
+    callbacks.onFileScanned = [this, foundTypes, fingerprints](const juce::File& file, const juce::Array<juce::PluginDescription>& types)
     {
-        knownPluginList.addType(wavesDesc);
-    }
+        IDOL_STALL_OPERATION("Add scanned plugins");
+        scanCache.store(file, (*fingerprints)[file.getFullPathName()], types);
 
-    saveKnownPluginsList();
-    sendChangeMessage();
-    DBG("Full plugin scan and merge complete.");
+        // Show new plugins straight away; the list is tidied up once the scan is done.
+        for (const auto& desc : types)
+            knownPluginList.addType(desc);
+
+        foundTypes->addArray(types);
+        rebuildCatalog();
+        sendChangeMessage();
+    };
+    callbacks.onFileFailed = [this](const juce::File& file, const juce::String& reason)
+    {
+        blacklistFile(file, reason);
+    };
+    callbacks.onFinished = [this, foundTypes, onFinished](bool wasCancelled)
+    {
+        IDOL_STALL_OPERATION("Finish plugin scan");
+
+        // A finished scan is the whole truth: drop plugins whose files have gone.
+        if (!wasCancelled)
+        {
+            knownPluginList.clear();
+            for (const auto& desc : *foundTypes)
+                knownPluginList.addType(desc);
+        }
+
+        saveKnownPluginsList();
+        scanCache.save();
+        rebuildCatalog();
+        sendChangeMessage();
+        DBG("Full plugin scan and merge complete.");
+
+        if (onFinished != nullptr)
+            onFinished();
+    };
+
+    return scanner.start(filesToScan, std::move(callbacks));
 }
 
 void PluginManager::addPluginFromUserChoice()
 {
     auto fc = std::make_shared<juce::FileChooser>("Add VST3 Plugin", juce::File{}, "*.vst3");
 
-    fc->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+    fc->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles
+                        | juce::FileBrowserComponent::canSelectDirectories,
         [this, fc](const juce::FileChooser& chooser)
         {
             const juce::File pluginFile = chooser.getResult();
             if (pluginFile == juce::File{})
                 return;
 
-            if (pluginFile.getFileName().containsIgnoreCase("WaveShell"))
-            {
-                // If user selects a waveshell, trigger a full rescan to handle it correctly
-                scanAndMergeAll();
-                return;
-            }
+            ensureLoaded();
 
-            bool alreadyInList = false;
-            for (const auto& desc : knownPluginList.getTypes())
-            {
-                if (desc.fileOrIdentifier == pluginFile.getFullPathName())
-                {
-                    alreadyInList = true;
-                    break;
-                }
-            }
-
-            if (alreadyInList)
+            if (getCatalog()->findByFileOrIdentifier(pluginFile.getFullPathName()) != nullptr)
             {
                 juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon,
                     "Plugin Not Added",
@@ -124,59 +166,97 @@ void PluginManager::addPluginFromUserChoice()
                 return;
             }
 
-            juce::VST3PluginFormat vst3Format;
-            juce::OwnedArray<juce::PluginDescription> descs;
-            vst3Format.findAllTypesForFile(descs, pluginFile.getFullPathName());
+            // Picking a file by hand gives a blacklisted plugin another chance.
+            knownPluginList.removeFromBlacklist(pluginFile.getFullPathName());
+            blacklistReasons.remove(pluginFile.getFullPathName());
 
-            if (descs.size() > 0)
+            PluginScanner::Callbacks callbacks;
+            callbacks.onFileScanned = [this](const juce::File& file, const juce::Array<juce::PluginDescription>& types)
             {
-                for (auto* desc : descs)
-                    knownPluginList.addType(*desc);
+                scanCache.store(file, PluginScanCache::fingerprintOf(file), types);
+
+                if (types.isEmpty())
+                {
+                    juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon,
+                        "Plugin Scan Failed",
+                        "Could not find any valid VST3 plugins in the selected file.");
+                    return;
+                }
 
+                for (const auto& desc : types)
+                    knownPluginList.addType(desc);
+            };
+            callbacks.onFileFailed = [this](const juce::File& file, const juce::String& reason)
+            {
+                blacklistFile(file, reason);
+                juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon,
+                    "Plugin Scan Failed",
+                    file.getFileName() + ": " + reason);
+            };
+            callbacks.onFinished = [this](bool)
+            {
                 saveKnownPluginsList();
+                scanCache.save();
+                rebuildCatalog();
                 sendChangeMessage();
-            }
-            else
+            };
+
+            if (!scanner.start({ pluginFile }, std::move(callbacks)))
             {
                 juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon,
-                    "Plugin Scan Failed",
-                    "Could not find any valid VST3 plugins in the selected file.");
+                    "Plugin Not Added",
+                    "A plugin scan is already running. Please try again when it has finished.");
             }
         });
 }
 
+void PluginManager::blacklistFile(const juce::File& file, const juce::String& reason)
+{
+    DBG("Blacklisting plugin " + file.getFullPathName() + ": " + reason);
+    knownPluginList.addToBlacklist(file.getFullPathName());
+    scanCache.remove(file);
+    blacklistReasons.set(file.getFullPathName(), reason);
+    lastScanFailures.set(file.getFullPathName(), reason);
+}
+
+juce::String PluginManager::getBlacklistReason(const juce::String& fileOrIdentifier) const
+{
+    return blacklistReasons[fileOrIdentifier];
+}
+
 void PluginManager::removePluginFromListByIndex(int index)
 {
-    if (isPositiveAndBelow(index, knownPluginList.getTypes().size()))
+    ensureLoaded();
+    const auto current = getCatalog();
+    if (isPositiveAndBelow(index, current->size()))
     {
-        auto description = knownPluginList.getTypes()[index];
-        knownPluginList.removeType(description);
+        knownPluginList.removeType(current->getAll().getReference(index));
         saveKnownPluginsList();
+        rebuildCatalog();
         sendChangeMessage();
     }
 }
 
-juce::Array<juce::PluginDescription> PluginManager::getKnownPlugins() const
+PluginCatalog::Ptr PluginManager::getCatalog() const
 {
-    return knownPluginList.getTypes();
+    catalogReady.wait(-1);
+
+    const juce::SpinLock::ScopedLockType lock(catalogLock);
+    return catalog;
 }
 
-juce::Array<juce::PluginDescription> PluginManager::getFilteredPlugins(const juce::String& searchText) const
+void PluginManager::rebuildCatalog()
 {
-    const auto& allPlugins = getKnownPlugins();
-
-    if (searchText.isEmpty())
-        return allPlugins;
-
-    juce::Array<juce::PluginDescription> filteredList;
+    // Build outside the lock; readers only ever wait for the pointer swap. The old
+    // snapshot is released after the lock, or by whoever still holds it.
+    auto types = knownPluginList.getTypes();
+    types.addArray(syntheticTypes);
+    auto newCatalog = std::make_shared<const PluginCatalog>(types);
 
-    for (const auto& desc : allPlugins)
     {
-        if (desc.name.containsIgnoreCase(searchText))
-            filteredList.add(desc);
+        const juce::SpinLock::ScopedLockType lock(catalogLock);
+        std::swap(catalog, newCatalog);
     }
-
-    return filteredList;
 }
 
 std::unique_ptr<juce::AudioPluginInstance> PluginManager::createPluginInstance(const juce::PluginDescription& description,
@@ -194,27 +274,100 @@ std::unique_ptr<juce::AudioPluginInstance> PluginManager::createPluginInstance(c
     return instance;
 }
 
+#if IDOL_ENABLE_SYNTHETIC_PLUGINS
+juce::PluginDescription PluginManager::registerSyntheticPlugin(const SyntheticPlugin::Config& config)
+{
+    ensureLoaded();
+
+    const auto description = config.createDescription();
+    const bool alreadyRegistered = std::any_of(syntheticTypes.begin(), syntheticTypes.end(),
+        [&description](const juce::PluginDescription& d) { return d.isDuplicateOf(description); });
+
+    if (!alreadyRegistered)
+    {
+        syntheticTypes.add(description);
+        rebuildCatalog();
+        sendChangeMessage();
+    }
+
+    return description;
+}
+#endif
+
+PluginListStore::Contents PluginManager::getStoreContents() const
+{
+    return { knownPluginList.getTypes(), knownPluginList.getBlacklistedFiles(), blacklistReasons };
+}
+
 void PluginManager::saveKnownPluginsList()
 {
-    if (auto xml = knownPluginList.createXml())
-        xml->writeTo(knownPluginsFile, {});
+    if (!PluginListStore::write(knownPluginsFile, getStoreContents()))
+        DBG("Failed to save the known plugins list to " + knownPluginsFile.getFullPathName());
+}
+
+bool PluginManager::exportToXml(const juce::File& destination)
+{
+    ensureLoaded();
+    return PluginListStore::createXml(getStoreContents())->writeTo(destination, {});
 }
 
 void PluginManager::loadKnownPluginsList()
 {
-    if (knownPluginsFile.existsAsFile())
-        if (auto xml = juce::parseXML(knownPluginsFile))
-            knownPluginList.recreateFromXml(*xml);
+    // Runs on loadPool. Falls back to the XML list older versions wrote, once.
+    if (!PluginListStore::read(knownPluginsFile, loadedContents))
+    {
+        const auto legacyFile = knownPluginsFile.getSiblingFile("knownPlugins.xml");
+        if (auto xml = juce::parseXML(legacyFile))
+            loadedListNeedsSaving = PluginListStore::readXml(*xml, loadedContents);
+    }
+
+    auto newCatalog = std::make_shared<const PluginCatalog>(loadedContents.types);
+    {
+        const juce::SpinLock::ScopedLockType lock(catalogLock);
+        std::swap(catalog, newCatalog);
+    }
+
+    catalogReady.signal();
+
+    juce::MessageManager::callAsync([weak = selfReference]
+    {
+        if (weak != nullptr)
+            weak->applyLoadedList();
+    });
+}
+
+void PluginManager::applyLoadedList()
+{
+    if (loadedListApplied)
+        return;
+
+    loadedListApplied = true;
+
+    for (const auto& desc : loadedContents.types)
+        knownPluginList.addType(desc);
+
+    for (const auto& path : loadedContents.blacklistedFiles)
+        knownPluginList.addToBlacklist(path);
+
+    blacklistReasons = loadedContents.blacklistReasons;
+    loadedContents = {};
+
+    if (loadedListNeedsSaving)
+        saveKnownPluginsList();
+
+    sendChangeMessage();
 }
 
 void PluginManager::replaceAllPlugins(const juce::KnownPluginList& newList)
 {
+    ensureLoaded();
     knownPluginList.clear();
     for (const auto& desc : newList.getTypes())
     {
         knownPluginList.addType(desc);
     }
     saveKnownPluginsList();
+    rebuildCatalog();
     sendChangeMessage();
     DBG("Plugin list updated from non-blocking scan.");
 }
\ No newline at end of file
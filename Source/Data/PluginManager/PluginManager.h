@@ -2,31 +2,92 @@
 
 #include <JuceHeader.h>
 #include "WavesShellManager.h" 
+#include "PluginCatalog.h"
+#include "PluginScanner.h"
+#include "PluginScanCache.h"
+#include "PluginListStore.h"
+#include "SyntheticPlugin.h"
 
 class PluginManager : public juce::ChangeBroadcaster
 {
 public:
-    PluginManager();
+    /** Keeps its list in knownPluginsListFile, or in the app's data folder if none is given. */
+    explicit PluginManager(const juce::File& knownPluginsListFile = {});
     ~PluginManager() override;
 
-    void scanAndMergeAll();
+    /** Rescans the installed VST3 files and merges the results as they arrive. Files
+        whose fingerprint hasn't changed reuse their cached descriptions; the rest are
+        scanned in child processes, and any that crash or hang the scanner are blacklisted.
+        Returns false if a scan is already running; onFinished is called on the message
+        thread at the end. */
+    bool scanAndMergeAll(std::function<void()> onFinished = nullptr);
+    bool isScanning() const noexcept { return scanner.isScanning(); }
+    double getScanProgress() const noexcept { return scanner.getProgress(); }
+
+    /** Files blacklisted by the most recent scan, with the reason for each. */
+    const juce::StringPairArray& getLastScanFailures() const noexcept { return lastScanFailures; }
+    juce::String getBlacklistReason(const juce::String& fileOrIdentifier) const;
 
-    juce::Array<juce::PluginDescription> getFilteredPlugins(const juce::String& searchText) const;
     void replaceAllPlugins(const juce::KnownPluginList& newList);
     void addPluginFromUserChoice();
     void removePluginFromListByIndex(int index);
-    juce::Array<juce::PluginDescription> getKnownPlugins() const;
+
+    /** The current indexed snapshot of the known plugins. Safe to call from any thread;
+        keep the returned pointer alive for as long as you use descriptions from it.
+        Blocks until the stored list has been read at startup. */
+    PluginCatalog::Ptr getCatalog() const;
+
+    /** Writes the list in KnownPluginList's XML layout. */
+    bool exportToXml(const juce::File& destination);
+
     std::unique_ptr<juce::AudioPluginInstance> createPluginInstance(const juce::PluginDescription& description,
         const juce::dsp::ProcessSpec& spec);
 
+   #if IDOL_ENABLE_SYNTHETIC_PLUGINS
+    /** Adds a synthetic plugin to the catalog, so presets can refer to it and the engine
+        creates it like any other. Never saved with the known plugins list. */
+    juce::PluginDescription registerSyntheticPlugin(const SyntheticPlugin::Config& config);
+   #endif
+
 private:
     PluginManager(const PluginManager&) = delete;
     PluginManager& operator=(const PluginManager&) = delete;
 
     void saveKnownPluginsList();
     void loadKnownPluginsList();
+    void applyLoadedList();
+    void ensureLoaded();
+    PluginListStore::Contents getStoreContents() const;
+    void rebuildCatalog();
+    juce::Array<juce::File> findPluginFiles() const;
+    void blacklistFile(const juce::File& file, const juce::String& reason);
 
     juce::AudioPluginFormatManager formatManager;
     juce::KnownPluginList knownPluginList;
     juce::File knownPluginsFile;
-};
\ No newline at end of file
+
+    PluginScanCache scanCache;
+    bool scanCacheLoaded = false;
+    PluginScanner scanner;
+    juce::StringPairArray blacklistReasons;     // file path -> why it was blacklisted
+    juce::StringPairArray lastScanFailures;
+
+    juce::Array<juce::PluginDescription> syntheticTypes;
+
+    PluginCatalog::Ptr catalog{ std::make_shared<const PluginCatalog>() };
+    mutable juce::SpinLock catalogLock;
+
+    // Startup load: filled on loadPool, handed to knownPluginList on the message thread.
+    PluginListStore::Contents loadedContents;
+    bool loadedListNeedsSaving = false;
+    bool loadedListApplied = false;
+    mutable juce::WaitableEvent catalogReady{ true };
+    juce::WeakReference<PluginManager> selfReference;
+    juce::ThreadPool loadPool{ 1 };
+
+    JUCE_DECLARE_WEAK_REFERENCEABLE(PluginManager)
+};
+
+/** The one the engine creates plugins with. Defined by whatever links the engine:
+    the app in Application.cpp, the command-line tools in their own Main.cpp. */
+PluginManager& getSharedPluginManager();
\ No newline at end of file
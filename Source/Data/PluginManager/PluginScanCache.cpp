@@ -0,0 +1,126 @@
+#include "Data/PluginManager/PluginScanCache.h"
+
+namespace
+{
+    constexpr int cacheVersion = 1;
+}
+
+//==============================================================================
+PluginScanCache::Fingerprint PluginScanCache::fingerprintOf(const juce::File& pluginFile)
+{
+    Fingerprint fingerprint;
+    fingerprint.modificationTime = pluginFile.getLastModificationTime().toMilliseconds();
+
+    if (!pluginFile.isDirectory())
+    {
+        fingerprint.size = pluginFile.getSize();
+        return fingerprint;
+    }
+
+    // A bundle folder's own timestamp doesn't change when the binary inside is
+    // replaced, so hash the size and date of its contents. Resources can hold
+    // thousands of preset files and never affect what the plugin reports, so skip them.
+    juce::StringArray lines;
+    for (const auto& entry : juce::RangedDirectoryIterator(pluginFile, true, "*", juce::File::findFiles))
+    {
+        const auto& file = entry.getFile();
+        const auto relativePath = file.getRelativePathFrom(pluginFile);
+
+        if (relativePath.containsIgnoreCase("Resources"))
+            continue;
+
+        lines.add(relativePath + "|" + juce::String(entry.getFileSize()) + "|"
+                  + juce::String(entry.getModificationTime().toMilliseconds()));
+        fingerprint.size += entry.getFileSize();
+    }
+
+    lines.sort(false);
+    fingerprint.bundleHash = juce::MD5(lines.joinIntoString("\n").toUTF8()).toHexString();
+    return fingerprint;
+}
+
+//==============================================================================
+const juce::Array<juce::PluginDescription>* PluginScanCache::find(const juce::File& pluginFile, const Fingerprint& fingerprint) const
+{
+    const auto it = entries.find(pluginFile.getFullPathName());
+    if (it == entries.end() || it->second.fingerprint != fingerprint)
+        return nullptr;
+
+    return &it->second.types;
+}
+
+void PluginScanCache::store(const juce::File& pluginFile, const Fingerprint& fingerprint,
+                            const juce::Array<juce::PluginDescription>& types)
+{
+    entries[pluginFile.getFullPathName()] = { fingerprint, types };
+}
+
+void PluginScanCache::remove(const juce::File& pluginFile)
+{
+    entries.erase(pluginFile.getFullPathName());
+}
+
+void PluginScanCache::removeAllExcept(const juce::Array<juce::File>& installedFiles)
+{
+    std::unordered_map<juce::String, Entry> kept;
+
+    for (const auto& file : installedFiles)
+    {
+        const auto it = entries.find(file.getFullPathName());
+        if (it != entries.end())
+            kept.insert(std::move(*it));
+    }
+
+    entries = std::move(kept);
+}
+
+//==============================================================================
+void PluginScanCache::load(const juce::File& fileToLoadFrom)
+{
+    storageFile = fileToLoadFrom;
+    entries.clear();
+
+    auto xml = juce::parseXML(storageFile);
+    if (xml == nullptr || !xml->hasTagName("PLUGIN_SCAN_CACHE") || xml->getIntAttribute("version") != cacheVersion)
+        return;
+
+    for (auto* fileXml : xml->getChildWithTagNameIterator("FILE"))
+    {
+        Entry entry;
+        entry.fingerprint.size = fileXml->getStringAttribute("size").getLargeIntValue();
+        entry.fingerprint.modificationTime = fileXml->getStringAttribute("modified").getLargeIntValue();
+        entry.fingerprint.bundleHash = fileXml->getStringAttribute("bundleHash");
+
+        for (auto* pluginXml : fileXml->getChildIterator())
+        {
+            juce::PluginDescription desc;
+            if (desc.loadFromXml(*pluginXml))
+                entry.types.add(desc);
+        }
+
+        entries[fileXml->getStringAttribute("path")] = std::move(entry);
+    }
+}
+
+void PluginScanCache::save() const
+{
+    if (storageFile == juce::File())
+        return;
+
+    juce::XmlElement xml("PLUGIN_SCAN_CACHE");
+    xml.setAttribute("version", cacheVersion);
+
+    for (const auto& [path, entry] : entries)
+    {
+        auto* fileXml = xml.createNewChildElement("FILE");
+        fileXml->setAttribute("path", path);
+        fileXml->setAttribute("size", juce::String(entry.fingerprint.size));
+        fileXml->setAttribute("modified", juce::String(entry.fingerprint.modificationTime));
+        fileXml->setAttribute("bundleHash", entry.fingerprint.bundleHash);
+
+        for (const auto& desc : entry.types)
+            fileXml->addChildElement(desc.createXml().release());
+    }
+
+    xml.writeTo(storageFile);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <unordered_map>
+
+/**
+    Remembers what each plugin file contained the last time it was scanned.
+
+    Entries are keyed by path and checked against a fingerprint of size and
+    modification time. For .vst3 bundle folders, the fingerprint also includes a
+    hash over the files inside them. A rescan only has to send new or changed
+    files to the PluginScanner; everything else, WaveShells included, reuses the
+    stored descriptions.
+
+    Message thread only.
+*/
+class PluginScanCache
+{
+public:
+    struct Fingerprint
+    {
+        juce::int64 size = 0;
+        juce::int64 modificationTime = 0;
+        juce::String bundleHash;
+
+        bool operator==(const Fingerprint& other) const noexcept
+        {
+            return size == other.size && modificationTime == other.modificationTime && bundleHash == other.bundleHash;
+        }
+
+        bool operator!=(const Fingerprint& other) const noexcept { return !operator==(other); }
+    };
+
+    PluginScanCache() = default;
+
+    static Fingerprint fingerprintOf(const juce::File& pluginFile);
+
+    /** The stored descriptions, or nullptr if the file is unknown or has changed since. */
+    const juce::Array<juce::PluginDescription>* find(const juce::File& pluginFile, const Fingerprint& fingerprint) const;
+
+    void store(const juce::File& pluginFile, const Fingerprint& fingerprint, const juce::Array<juce::PluginDescription>& types);
+    void remove(const juce::File& pluginFile);
+
+    /** Forgets files that are no longer installed. */
+    void removeAllExcept(const juce::Array<juce::File>& installedFiles);
+
+    void load(const juce::File& fileToLoadFrom);
+    void save() const;
+
+private:
+    struct Entry
+    {
+        Fingerprint fingerprint;
+        juce::Array<juce::PluginDescription> types;
+    };
+
+    std::unordered_map<juce::String, Entry> entries;
+    juce::File storageFile;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PluginScanCache)
+};
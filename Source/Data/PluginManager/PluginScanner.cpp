@@ -0,0 +1,239 @@
+#include "Data/PluginManager/PluginScanner.h"
+#include "Diagnostics/TraceRecorder.h"
+
+namespace
+{
+    const juce::String workerFlag("--scan-plugin");
+}
+
+//==============================================================================
+struct PluginScanner::Worker
+{
+    juce::File pluginFile;
+    juce::File outputFile;
+    std::unique_ptr<juce::ChildProcess> process;
+    juce::uint32 startTime = 0;
+};
+
+//==============================================================================
+PluginScanner::PluginScanner()
+    : juce::Thread("Plugin scan"),
+      workerExecutable(juce::File::getSpecialLocation(juce::File::SpecialLocationType::currentExecutableFile))
+{
+    selfReference = this;
+}
+
+PluginScanner::~PluginScanner()
+{
+    stopThread(timeoutMs);
+}
+
+bool PluginScanner::start(const juce::Array<juce::File>& filesToScan, Callbacks callbacks)
+{
+    if (scanning.load())
+        return false;
+
+    // The previous coordinator has already posted its last result; let it finish exiting.
+    stopThread(1000);
+
+    files = filesToScan;
+    currentCallbacks = std::move(callbacks);
+    numFilesDone = 0;
+    numFilesTotal = files.size();
+    scanning = true;
+
+    startThread();
+    return true;
+}
+
+void PluginScanner::setWorker(const juce::File& executable, int timeoutMilliseconds)
+{
+    jassert(!scanning.load());
+    workerExecutable = executable;
+    timeoutMs = timeoutMilliseconds;
+}
+
+void PluginScanner::cancel()
+{
+    signalThreadShouldExit();
+}
+
+double PluginScanner::getProgress() const noexcept
+{
+    const int total = numFilesTotal.load();
+    return total > 0 ? (double)numFilesDone.load() / (double)total : 0.0;
+}
+
+//==============================================================================
+void PluginScanner::run()
+{
+    IDOL_TRACE_SCOPE("scan", "Plugin scan");
+    const int maxWorkers = juce::jmax(1, juce::SystemStats::getNumCpus());
+    std::vector<Worker> running;
+    int nextFile = 0;
+
+    while (!threadShouldExit())
+    {
+        while ((int)running.size() < maxWorkers && nextFile < files.size())
+        {
+            Worker worker;
+            const auto& file = files.getReference(nextFile++);
+            IDOL_TRACE_SCOPE_DYNAMIC("scan", "Launch " + file.getFileName());
+
+            if (launchWorker(worker, file))
+            {
+                running.push_back(std::move(worker));
+            }
+            else
+            {
+                ++numFilesDone;
+                postToMessageThread([file](Callbacks& c)
+                {
+                    if (c.onFileFailed != nullptr)
+                        c.onFileFailed(file, "Could not start the scanner process");
+                });
+            }
+        }
+
+        if (running.empty())
+            break;
+
+        for (auto it = running.begin(); it != running.end();)
+        {
+            const bool timedOut = juce::Time::getMillisecondCounter() - it->startTime > (juce::uint32)timeoutMs;
+
+            if (it->process->isRunning() && !timedOut)
+            {
+                ++it;
+                continue;
+            }
+
+            finishWorker(*it, timedOut);
+            it = running.erase(it);
+        }
+
+        wait(20);
+    }
+
+    // Cancelled: don't leave children behind.
+    for (auto& worker : running)
+    {
+        worker.process->kill();
+        worker.outputFile.deleteFile();
+    }
+
+    // Queued behind every result, so onFinished really is the last call.
+    juce::MessageManager::callAsync([weak = selfReference, wasCancelled = threadShouldExit()]
+    {
+        if (weak == nullptr)
+            return;
+
+        weak->scanning = false;
+        if (auto callback = std::exchange(weak->currentCallbacks.onFinished, nullptr))
+            callback(wasCancelled);
+    });
+}
+
+bool PluginScanner::launchWorker(Worker& worker, const juce::File& file)
+{
+    worker.pluginFile = file;
+    worker.outputFile = juce::File::getSpecialLocation(juce::File::SpecialLocationType::tempDirectory)
+                            .getChildFile("idolPluginScan_" + juce::Uuid().toString() + ".xml");
+    worker.process = std::make_unique<juce::ChildProcess>();
+    worker.startTime = juce::Time::getMillisecondCounter();
+
+    // No pipes: plugins that print a lot would otherwise block on a full pipe.
+    return worker.process->start(juce::StringArray{ workerExecutable.getFullPathName(), workerFlag,
+                                                    file.getFullPathName(), worker.outputFile.getFullPathName() },
+                                 0);
+}
+
+void PluginScanner::finishWorker(Worker& worker, bool timedOut)
+{
+    juce::Array<juce::PluginDescription> found;
+    juce::String failure;
+
+    if (timedOut)
+    {
+        worker.process->kill();
+        failure = "Timed out after " + juce::String(timeoutMs / 1000.0, timeoutMs % 1000 == 0 ? 0 : 1) + " seconds";
+    }
+    else if (auto xml = juce::parseXML(worker.outputFile); xml != nullptr && xml->hasTagName("SCAN_RESULT"))
+    {
+        for (auto* child : xml->getChildIterator())
+        {
+            juce::PluginDescription desc;
+            if (desc.loadFromXml(*child))
+                found.add(desc);
+        }
+    }
+    else
+    {
+        // The exit code is only informative; a crash is any exit without a result file.
+        failure = "Crashed while scanning (exit code " + juce::String(worker.process->getExitCode()) + ")";
+    }
+
+    worker.outputFile.deleteFile();
+    ++numFilesDone;
+
+    const auto file = worker.pluginFile;
+    postToMessageThread([file, found, failure](Callbacks& c)
+    {
+        if (failure.isNotEmpty())
+        {
+            if (c.onFileFailed != nullptr)
+                c.onFileFailed(file, failure);
+        }
+        else if (c.onFileScanned != nullptr)
+        {
+            c.onFileScanned(file, found);
+        }
+    });
+}
+
+void PluginScanner::postToMessageThread(std::function<void(Callbacks&)> callback)
+{
+    juce::MessageManager::callAsync([weak = selfReference, callback = std::move(callback)]
+    {
+        if (weak == nullptr)
+            return;
+
+        callback(weak->currentCallbacks);
+    });
+}
+
+//==============================================================================
+bool PluginScanner::isWorkerCommandLine(const juce::String& commandLine)
+{
+    return commandLine.contains(workerFlag);
+}
+
+int PluginScanner::runWorker(const juce::StringArray& arguments)
+{
+    const int flagIndex = arguments.indexOf(workerFlag);
+    if (flagIndex < 0 || flagIndex + 2 >= arguments.size())
+        return 2;
+
+    const auto pluginPath = arguments[flagIndex + 1].unquoted();
+    const juce::File outputFile(arguments[flagIndex + 2].unquoted());
+
+    juce::VST3PluginFormat vst3Format;
+    juce::OwnedArray<juce::PluginDescription> descs;
+
+    try
+    {
+        vst3Format.findAllTypesForFile(descs, pluginPath);
+    }
+    catch (...)
+    {
+        return 3;
+    }
+
+    // Only a finished scan writes the file; the parent treats a missing file as a crash.
+    juce::XmlElement result("SCAN_RESULT");
+    for (auto* desc : descs)
+        if (desc != nullptr)
+            result.addChildElement(desc->createXml().release());
+
+    return result.writeTo(outputFile) ? 0 : 1;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <functional>
+
+/**
+    Scans plugin files in a pool of child processes, one file per process.
+
+    Each child is this same executable started with "--scan-plugin <file> <output>".
+    It writes the descriptions it found to <output> and quits. A child that
+    crashes, or that is still running after the timeout, produces no output. Its
+    file is reported through onFileFailed with a reason, so the caller can
+    blacklist it. The scan itself can't be taken down by a bad plugin.
+
+    Results arrive on the message thread as each file finishes, so the plugin
+    list can fill in while the scan is still running.
+*/
+class PluginScanner : private juce::Thread
+{
+public:
+    struct Callbacks
+    {
+        std::function<void(const juce::File&, const juce::Array<juce::PluginDescription>&)> onFileScanned;
+        std::function<void(const juce::File&, const juce::String& reason)> onFileFailed;
+        std::function<void(bool wasCancelled)> onFinished;
+    };
+
+    PluginScanner();
+    ~PluginScanner() override;
+
+    /** Starts scanning; returns false if a scan is already running. Message thread only. */
+    bool start(const juce::Array<juce::File>& filesToScan, Callbacks callbacks);
+    void cancel();
+
+    /** Starts children from another executable, with another timeout. Tests use this to
+        stand in workers that crash or hang; call it before start(). */
+    void setWorker(const juce::File& executable, int timeoutMilliseconds);
+
+    bool isScanning() const noexcept { return scanning.load(); }
+    double getProgress() const noexcept;
+
+    //==============================================================================
+    /** True for the command line of a scanner child process. */
+    static bool isWorkerCommandLine(const juce::String& commandLine);
+
+    /** The whole job of a child process: scan one file, write the result, return an exit code. */
+    static int runWorker(const juce::StringArray& arguments);
+
+    static constexpr int defaultTimeoutMs = 30000;
+
+private:
+    struct Worker;
+
+    void run() override;
+    bool launchWorker(Worker& worker, const juce::File& file);
+    void finishWorker(Worker& worker, bool timedOut);
+    void postToMessageThread(std::function<void(Callbacks&)> callback);
+
+    juce::File workerExecutable;
+    int timeoutMs = defaultTimeoutMs;
+    juce::Array<juce::File> files;
+    Callbacks currentCallbacks;
+    std::atomic<bool> scanning{ false };
+    std::atomic<int> numFilesDone{ 0 };
+    std::atomic<int> numFilesTotal{ 0 };
+    juce::WeakReference<PluginScanner> selfReference;
+
+    JUCE_DECLARE_WEAK_REFERENCEABLE(PluginScanner)
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PluginScanner)
+};
@@ -0,0 +1,273 @@
+/*
+  ==============================================================================
+
+    SyntheticPlugin.cpp
+
+  ==============================================================================
+*/
+
+#include "Data/PluginManager/SyntheticPlugin.h"
+#include <cstring>
+
+#if IDOL_ENABLE_SYNTHETIC_PLUGINS
+
+namespace
+{
+    constexpr juce::uint32 stateMagic = 0x504e5953; // "SYNP"
+    constexpr int stateHeaderSize = 8;               // magic, gain
+
+    juce::String layoutToString(SyntheticPlugin::Layout layout)
+    {
+        switch (layout)
+        {
+            case SyntheticPlugin::Layout::mono:         return "mono";
+            case SyntheticPlugin::Layout::monoToStereo: return "monoToStereo";
+            case SyntheticPlugin::Layout::stereo:       break;
+        }
+        return "stereo";
+    }
+
+    SyntheticPlugin::Layout layoutFromString(const juce::String& text)
+    {
+        if (text == "mono")         return SyntheticPlugin::Layout::mono;
+        if (text == "monoToStereo") return SyntheticPlugin::Layout::monoToStereo;
+        return SyntheticPlugin::Layout::stereo;
+    }
+}
+
+//==============================================================================
+juce::String SyntheticPlugin::Config::toIdentifier() const
+{
+    // ';' and '=' separate the settings, so they can't appear in the names.
+    const auto clean = [](const juce::String& text) { return text.replaceCharacters(";=", "__"); };
+
+    juce::StringArray settings;
+    settings.add("name=" + clean(name));
+    settings.add("manufacturer=" + clean(manufacturer));
+    settings.add("work=" + juce::String(workPerSample));
+    settings.add("latency=" + juce::String(latencySamples));
+    settings.add("tail=" + juce::String(tailSeconds));
+    settings.add("layout=" + layoutToString(layout));
+    settings.add("state=" + juce::String(stateSize));
+    settings.add("createMs=" + juce::String(createDelayMs));
+    settings.add("restoreMs=" + juce::String(restoreDelayMs));
+    settings.add("destroyMs=" + juce::String(destroyDelayMs));
+    settings.add("gain=" + juce::String(gain));
+    return identifierPrefix + settings.joinIntoString(";");
+}
+
+bool SyntheticPlugin::Config::fromIdentifier(const juce::String& identifier, Config& result)
+{
+    if (!identifier.startsWith(identifierPrefix))
+        return false;
+
+    result = {};
+    for (const auto& setting : juce::StringArray::fromTokens(identifier.substring((int)std::strlen(identifierPrefix)), ";", {}))
+    {
+        const auto key = setting.upToFirstOccurrenceOf("=", false, false);
+        const auto value = setting.fromFirstOccurrenceOf("=", false, false);
+
+        if (key == "name")              result.name = value;
+        else if (key == "manufacturer") result.manufacturer = value;
+        else if (key == "work")         result.workPerSample = juce::jmax(0, value.getIntValue());
+        else if (key == "latency")      result.latencySamples = juce::jmax(0, value.getIntValue());
+        else if (key == "tail")         result.tailSeconds = juce::jmax(0.0, value.getDoubleValue());
+        else if (key == "layout")       result.layout = layoutFromString(value);
+        else if (key == "state")        result.stateSize = juce::jmax(0, value.getIntValue());
+        else if (key == "createMs")     result.createDelayMs = juce::jmax(0, value.getIntValue());
+        else if (key == "restoreMs")    result.restoreDelayMs = juce::jmax(0, value.getIntValue());
+        else if (key == "destroyMs")    result.destroyDelayMs = juce::jmax(0, value.getIntValue());
+        else if (key == "gain")         result.gain = value.getFloatValue();
+    }
+
+    return true;
+}
+
+juce::PluginDescription SyntheticPlugin::Config::createDescription() const
+{
+    juce::PluginDescription description;
+    description.name = name;
+    description.descriptiveName = name;
+    description.pluginFormatName = formatName;
+    description.category = "Effect";
+    description.manufacturerName = manufacturer;
+    description.version = "1.0";
+    description.fileOrIdentifier = toIdentifier();
+    description.uniqueId = description.fileOrIdentifier.hashCode();
+    description.deprecatedUid = description.uniqueId;
+    description.isInstrument = false;
+    description.numInputChannels = layout == Layout::stereo ? 2 : 1;
+    description.numOutputChannels = layout == Layout::mono ? 1 : 2;
+    return description;
+}
+
+//==============================================================================
+SyntheticPlugin::BusesProperties SyntheticPlugin::getBuses(Layout layout)
+{
+    const auto input = layout == Layout::stereo ? juce::AudioChannelSet::stereo() : juce::AudioChannelSet::mono();
+    const auto output = layout == Layout::mono ? juce::AudioChannelSet::mono() : juce::AudioChannelSet::stereo();
+    return BusesProperties().withInput("Input", input, true).withOutput("Output", output, true);
+}
+
+SyntheticPlugin::SyntheticPlugin(const Config& pluginConfig)
+    : juce::AudioPluginInstance(getBuses(pluginConfig.layout)),
+      config(pluginConfig),
+      gain(pluginConfig.gain)
+{
+    // The same config always gives the same bytes.
+    state.setSize((size_t)juce::jmax(stateHeaderSize, config.stateSize));
+    juce::Random random(config.toIdentifier().hashCode64());
+    random.fillBitsRandomly(state.getData(), state.getSize());
+
+    setLatencySamples(config.latencySamples);
+}
+
+SyntheticPlugin::~SyntheticPlugin()
+{
+    if (config.destroyDelayMs > 0)
+        juce::Thread::sleep(config.destroyDelayMs);
+}
+
+void SyntheticPlugin::fillInPluginDescription(juce::PluginDescription& description) const
+{
+    description = config.createDescription();
+}
+
+void SyntheticPlugin::prepareToPlay(double, int)
+{
+    delayLine.setSize(juce::jmax(1, getTotalNumOutputChannels()), juce::jmax(1, config.latencySamples));
+    reset();
+}
+
+void SyntheticPlugin::releaseResources()
+{
+    delayLine.setSize(0, 0);
+}
+
+void SyntheticPlugin::reset()
+{
+    delayLine.clear();
+    delayPosition = 0;
+    workResult = 0.0f;
+}
+
+bool SyntheticPlugin::isBusesLayoutSupported(const BusesLayout& layouts) const
+{
+    const auto buses = getBuses(config.layout);
+    return layouts.getMainInputChannelSet() == buses.inputLayouts.getReference(0).defaultLayout
+        && layouts.getMainOutputChannelSet() == buses.outputLayouts.getReference(0).defaultLayout;
+}
+
+void SyntheticPlugin::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
+{
+    juce::ScopedNoDenormals noDenormals;
+
+    const int numSamples = buffer.getNumSamples();
+    const int numChannels = juce::jmin(buffer.getNumChannels(), getTotalNumOutputChannels(), delayLine.getNumChannels());
+
+    if (config.layout == Layout::monoToStereo && numChannels > 1)
+        buffer.copyFrom(1, 0, buffer, 0, 0, numSamples);
+
+    const int delayLength = delayLine.getNumSamples();
+    const bool delayed = config.latencySamples > 0;
+    float work = workResult;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto* data = buffer.getWritePointer(ch);
+        auto* delay = delayLine.getWritePointer(ch);
+        int position = delayPosition;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float input = data[i];
+
+            // The cost: a serial chain the compiler can neither vectorise nor drop,
+            // since its result is kept.
+            for (int n = 0; n < config.workPerSample; ++n)
+                work = work * 0.999f + input * 0.001f;
+
+            float output = input;
+            if (delayed)
+            {
+                output = delay[position];
+                delay[position] = input;
+                if (++position == delayLength)
+                    position = 0;
+            }
+
+            data[i] = output * gain;
+        }
+    }
+
+    if (delayed)
+        delayPosition = (int)((delayPosition + numSamples) % delayLength);
+
+    workResult = work;
+}
+
+void SyntheticPlugin::getStateInformation(juce::MemoryBlock& destData)
+{
+    const auto magic = stateMagic;
+    state.copyFrom(&magic, 0, sizeof(magic));
+    state.copyFrom(&gain, 4, sizeof(gain));
+    destData = state;
+}
+
+void SyntheticPlugin::setStateInformation(const void* data, int sizeInBytes)
+{
+    if (config.restoreDelayMs > 0)
+        juce::Thread::sleep(config.restoreDelayMs);
+
+    juce::uint32 magic = 0;
+    if (sizeInBytes >= stateHeaderSize)
+        std::memcpy(&magic, data, sizeof(magic));
+
+    if (magic == stateMagic)
+        std::memcpy(&gain, juce::addBytesToPointer(data, 4), sizeof(gain));
+
+    state.replaceAll(data, (size_t)sizeInBytes);
+}
+
+//==============================================================================
+void SyntheticPluginFormat::findAllTypesForFile(juce::OwnedArray<juce::PluginDescription>& results, const juce::String& fileOrIdentifier)
+{
+    SyntheticPlugin::Config config;
+    if (SyntheticPlugin::Config::fromIdentifier(fileOrIdentifier, config))
+        results.add(new juce::PluginDescription(config.createDescription()));
+}
+
+bool SyntheticPluginFormat::fileMightContainThisPluginType(const juce::String& fileOrIdentifier)
+{
+    return fileOrIdentifier.startsWith(SyntheticPlugin::identifierPrefix);
+}
+
+juce::String SyntheticPluginFormat::getNameOfPluginFromIdentifier(const juce::String& fileOrIdentifier)
+{
+    SyntheticPlugin::Config config;
+    return SyntheticPlugin::Config::fromIdentifier(fileOrIdentifier, config) ? config.name : fileOrIdentifier;
+}
+
+bool SyntheticPluginFormat::doesPluginStillExist(const juce::PluginDescription& description)
+{
+    return fileMightContainThisPluginType(description.fileOrIdentifier);
+}
+
+void SyntheticPluginFormat::createPluginInstance(const juce::PluginDescription& description, double, int,
+                                                 PluginCreationCallback callback)
+{
+    SyntheticPlugin::Config config;
+    if (!SyntheticPlugin::Config::fromIdentifier(description.fileOrIdentifier, config))
+    {
+        callback(nullptr, "Not a synthetic plugin: " + description.fileOrIdentifier);
+        return;
+    }
+
+    // Where a real plugin would load its binary and build its DSP.
+    if (config.createDelayMs > 0)
+        juce::Thread::sleep(config.createDelayMs);
+
+    callback(std::make_unique<SyntheticPlugin>(config), {});
+}
+
+#endif
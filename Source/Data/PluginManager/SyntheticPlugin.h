@@ -0,0 +1,140 @@
+/*
+  ==============================================================================
+
+    SyntheticPlugin.h
+    (A configurable stand-in plugin for benchmarks and tests)
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/** Set to 1 in benchmark and test builds to let PluginManager create synthetic plugins. */
+#ifndef IDOL_ENABLE_SYNTHETIC_PLUGINS
+ #define IDOL_ENABLE_SYNTHETIC_PLUGINS 0
+#endif
+
+#if IDOL_ENABLE_SYNTHETIC_PLUGINS
+
+/**
+    A plugin whose cost and behaviour are set by a Config rather than by what it does,
+    so chains, preset loading and teardown can be timed against plugins that behave like
+    real ones, without needing any installed.
+
+    Everything it does is deterministic: the same config and input give the same output,
+    state and timings on every run. Its audio is the input delayed by its latency and
+    scaled by its gain; the CPU cost comes from a fixed amount of arithmetic per sample
+    whose result is kept but never reaches the output.
+
+    A config is carried in the description's fileOrIdentifier ("synthetic:work=64;latency=128"),
+    so presets that use synthetic plugins save and load like any others once the same
+    configs are registered with PluginManager::registerSyntheticPlugin().
+*/
+class SyntheticPlugin : public juce::AudioPluginInstance
+{
+public:
+    enum class Layout
+    {
+        mono,
+        stereo,
+        monoToStereo
+    };
+
+    struct Config
+    {
+        juce::String name{ "Synthetic" };
+        juce::String manufacturer{ "idolLiveAudio" }; // "Waves" makes the preset loader treat it like one
+        int workPerSample = 16;             // arithmetic steps per sample and channel
+        int latencySamples = 0;
+        double tailSeconds = 0.0;
+        Layout layout = Layout::stereo;     // the only layout it accepts, like many real plugins
+        int stateSize = 1024;               // bytes getStateInformation returns
+        int createDelayMs = 0;              // slept in the format while creating an instance
+        int restoreDelayMs = 0;             // slept in setStateInformation
+        int destroyDelayMs = 0;             // slept in the destructor
+        float gain = 1.0f;
+
+        /** "synthetic:" followed by every setting, as key=value pairs. */
+        juce::String toIdentifier() const;
+        /** False if the identifier isn't a synthetic plugin's; unknown keys are ignored. */
+        static bool fromIdentifier(const juce::String& identifier, Config& result);
+
+        juce::PluginDescription createDescription() const;
+    };
+
+    static constexpr const char* formatName = "Synthetic";
+    static constexpr const char* identifierPrefix = "synthetic:";
+
+    explicit SyntheticPlugin(const Config& config);
+    ~SyntheticPlugin() override;
+
+    const Config& getConfig() const noexcept { return config; }
+
+    //==============================================================================
+    void fillInPluginDescription(juce::PluginDescription& description) const override;
+    const juce::String getName() const override { return config.name; }
+
+    void prepareToPlay(double sampleRate, int maximumExpectedSamplesPerBlock) override;
+    void releaseResources() override;
+    void reset() override;
+    bool isBusesLayoutSupported(const BusesLayout& layouts) const override;
+    void processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midi) override;
+
+    double getTailLengthSeconds() const override { return config.tailSeconds; }
+    bool acceptsMidi() const override { return false; }
+    bool producesMidi() const override { return false; }
+    juce::AudioProcessorEditor* createEditor() override { return nullptr; }
+    bool hasEditor() const override { return false; }
+
+    int getNumPrograms() override { return 1; }
+    int getCurrentProgram() override { return 0; }
+    void setCurrentProgram(int) override {}
+    const juce::String getProgramName(int) override { return {}; }
+    void changeProgramName(int, const juce::String&) override {}
+
+    void getStateInformation(juce::MemoryBlock& destData) override;
+    void setStateInformation(const void* data, int sizeInBytes) override;
+
+private:
+    static BusesProperties getBuses(Layout layout);
+
+    const Config config;
+    float gain;
+    juce::MemoryBlock state;
+
+    juce::AudioBuffer<float> delayLine;
+    int delayPosition = 0;
+    float workResult = 0.0f;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SyntheticPlugin)
+};
+
+//==============================================================================
+/** Creates SyntheticPlugins from their descriptions; PluginManager adds it to its formats. */
+class SyntheticPluginFormat : public juce::AudioPluginFormat
+{
+public:
+    SyntheticPluginFormat() = default;
+
+    juce::String getName() const override { return SyntheticPlugin::formatName; }
+    void findAllTypesForFile(juce::OwnedArray<juce::PluginDescription>& results, const juce::String& fileOrIdentifier) override;
+    bool fileMightContainThisPluginType(const juce::String& fileOrIdentifier) override;
+    juce::String getNameOfPluginFromIdentifier(const juce::String& fileOrIdentifier) override;
+    bool pluginNeedsRescanning(const juce::PluginDescription&) override { return false; }
+    bool doesPluginStillExist(const juce::PluginDescription& description) override;
+    bool canScanForPlugins() const override { return false; }
+    bool isTrivialToScan() const override { return true; }
+    juce::StringArray searchPathsForPlugins(const juce::FileSearchPath&, bool, bool) override { return {}; }
+    juce::FileSearchPath getDefaultLocationsToSearch() override { return {}; }
+
+private:
+    void createPluginInstance(const juce::PluginDescription& description, double initialSampleRate,
+                              int initialBufferSize, PluginCreationCallback callback) override;
+    bool requiresUnblockedMessageThreadDuringCreation(const juce::PluginDescription&) const override { return false; }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SyntheticPluginFormat)
+};
+
+#endif
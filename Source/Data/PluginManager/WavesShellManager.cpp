@@ -54,6 +54,12 @@ const juce::Array<juce::PluginDescription>& WavesShellManager::getScannedPlugins
     return knownWavesPlugins;
 }
 
+bool WavesShellManager::isIgnoredShell(const juce::File& file)
+{
+    return file.getFileName().containsIgnoreCase("WaveShell")
+        && file.getFileName().containsIgnoreCase("InternalSynth");
+}
+
 void WavesShellManager::findWavesShellFiles(juce::Array<juce::File>& filesFound) const
 {
     auto searchPaths = juce::VST3PluginFormat().getDefaultLocationsToSearch();
@@ -66,7 +72,7 @@ void WavesShellManager::findWavesShellFiles(juce::Array<juce::File>& filesFound)
 
         for (const auto& foundFile : results)
         {
-            if (!foundFile.getFileName().containsIgnoreCase("InternalSynth"))
+            if (!isIgnoredShell(foundFile))
             {
                 filesFound.add(foundFile);
             }
@@ -21,6 +21,9 @@ public:
     */
     const juce::Array<juce::PluginDescription>& getScannedPlugins() const;
 
+    /** Waves shells that must never be scanned (they hang or crash the scanner). */
+    static bool isIgnoredShell(const juce::File& file);
+
 private:
     // Private constructor/destructor for singleton
     WavesShellManager() = default;
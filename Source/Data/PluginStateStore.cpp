@@ -0,0 +1,121 @@
+/*
+  ==============================================================================
+
+    PluginStateStore.cpp
+
+  ==============================================================================
+*/
+#include "PluginStateStore.h"
+
+namespace
+{
+    bool isValidHash(const juce::String& hash)
+    {
+        return hash.length() == 64 && hash.containsOnly("0123456789abcdef");
+    }
+}
+
+PluginStateStore::PluginStateStore(const juce::File& storeDirectory)
+    : directory(storeDirectory)
+{
+}
+
+juce::File PluginStateStore::getFileFor(const juce::String& hash) const
+{
+    return directory.getChildFile(hash + ".state");
+}
+
+juce::String PluginStateStore::add(const PluginStateData& state)
+{
+    const auto hash = state.getHash();
+    const auto file = getFileFor(hash);
+
+    const juce::ScopedLock sl(lock);
+
+    // Same hash, same bytes: nothing to write.
+    if (file.existsAsFile() && file.getSize() == (juce::int64)state.getSize())
+        return hash;
+
+    directory.createDirectory();
+    juce::TemporaryFile temp(file);
+
+    {
+        juce::FileOutputStream out(temp.getFile());
+        if (!out.openedOk() || !out.write(state.getData(), (size_t)state.getSize()))
+            return {};
+
+        out.flush();
+        if (out.getStatus().failed())
+            return {};
+    }
+
+    return temp.overwriteTargetFileWithTemporary() ? hash : juce::String();
+}
+
+juce::ReferenceCountedObjectPtr<PresetFile::Blob> PluginStateStore::find(const juce::String& hash)
+{
+    if (!isValidHash(hash))
+        return nullptr;
+
+    const juce::ScopedLock sl(lock);
+
+    const auto cached = cache.find(hash);
+    if (cached != cache.end())
+        return cached->second;
+
+    const auto file = getFileFor(hash);
+    if (!file.existsAsFile())
+        return nullptr;
+
+    juce::ReferenceCountedObjectPtr<PresetFile::Blob> blob;
+
+    if (file.getSize() == 0)
+    {
+        blob = new PresetFile::Blob(juce::MemoryBlock());
+    }
+    else
+    {
+        auto mapped = std::make_shared<const juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+        if (mapped->getData() == nullptr)
+            return nullptr;
+
+        blob = new PresetFile::Blob(mapped, mapped->getData(), mapped->getSize(), hash);
+    }
+
+    trimCache();
+    cache[hash] = blob;
+    return blob;
+}
+
+int PluginStateStore::removeAllExcept(const juce::StringArray& hashesInUse)
+{
+    const juce::ScopedLock sl(lock);
+
+    // Drop our own references first; a mapped file can't be deleted on Windows.
+    cache.clear();
+
+    int numRemoved = 0;
+    for (const auto& entry : juce::RangedDirectoryIterator(directory, false, "*.state", juce::File::findFiles))
+    {
+        const auto file = entry.getFile();
+        if (!hashesInUse.contains(file.getFileNameWithoutExtension()) && file.deleteFile())
+            ++numRemoved;
+    }
+
+    return numRemoved;
+}
+
+void PluginStateStore::trimCache()
+{
+    if ((int)cache.size() < maxCachedBlobs)
+        return;
+
+    // Forget the blobs no loaded preset holds on to any more.
+    for (auto it = cache.begin(); it != cache.end();)
+    {
+        if (it->second->getReferenceCount() == 1)
+            it = cache.erase(it);
+        else
+            ++it;
+    }
+}
@@ -0,0 +1,54 @@
+/*
+  ==============================================================================
+
+    PluginStateStore.h
+    (Content-addressed storage for plugin state blobs shared between presets)
+
+  ==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include "PresetFile.h"
+#include <unordered_map>
+
+/**
+    Keeps each distinct plugin state once, in a file named after its SHA-256, so
+    presets that share a reverb or EQ setting share one copy on disk and in memory.
+
+    find() memory-maps a state the first time it is asked for and hands out the same
+    Blob to every preset that references it while it stays cached. Blobs carry their
+    hash, so two states can be compared without reading either.
+
+    Files are written once and never changed; unreferenced ones are removed by
+    removeAllExcept(). All methods are thread-safe.
+*/
+class PluginStateStore
+{
+public:
+    explicit PluginStateStore(const juce::File& storeDirectory);
+
+    /** Adds a state if the store doesn't have it yet. Returns its hash, or an empty
+        string if it couldn't be written. */
+    juce::String add(const PluginStateData& state);
+
+    /** Returns nullptr if no state with this hash is stored. */
+    juce::ReferenceCountedObjectPtr<PresetFile::Blob> find(const juce::String& hash);
+
+    /** Deletes every stored state whose hash isn't listed. Returns how many went. */
+    int removeAllExcept(const juce::StringArray& hashesInUse);
+
+    const juce::File& getDirectory() const noexcept { return directory; }
+
+    static constexpr int maxCachedBlobs = 256;
+
+private:
+    juce::File getFileFor(const juce::String& hash) const;
+    void trimCache();
+
+    const juce::File directory;
+    juce::CriticalSection lock;
+    std::unordered_map<juce::String, juce::ReferenceCountedObjectPtr<PresetFile::Blob>> cache;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PluginStateStore)
+};
@@ -0,0 +1,365 @@
+/*
+  ==============================================================================
+
+    PresetFile.cpp
+
+  ==============================================================================
+*/
+#include "PresetFile.h"
+#include "PluginStateStore.h"
+
+namespace
+{
+    constexpr int headerSize = 16;
+    constexpr int entrySize = 24;
+    constexpr juce::uint32 compressedFlag = 1;
+
+    // Blobs smaller than this aren't worth the compression header.
+    constexpr size_t minCompressibleSize = 256;
+
+    const juce::Identifier stateId("state");
+    const juce::Identifier stateBlobId("stateBlob");
+
+    struct Chunk
+    {
+        char id[4];
+        juce::MemoryBlock stored;
+        juce::uint32 rawSize = 0;
+        bool compressed = false;
+    };
+
+    Chunk makeChunk(const char* id, const void* data, size_t size, bool tryCompressing)
+    {
+        Chunk chunk;
+        std::memcpy(chunk.id, id, 4);
+        chunk.rawSize = (juce::uint32)size;
+
+        if (tryCompressing && size >= minCompressibleSize)
+        {
+            juce::MemoryOutputStream compressed;
+            {
+                juce::GZIPCompressorOutputStream zipper(compressed);
+                zipper.write(data, size);
+            }
+
+            // Plugin states that are already compressed (many are) stay as they are.
+            if (compressed.getDataSize() < size - size / 10)
+            {
+                chunk.stored = compressed.getMemoryBlock();
+                chunk.compressed = true;
+                return chunk;
+            }
+        }
+
+        chunk.stored.replaceAll(data, size);
+        return chunk;
+    }
+
+    Chunk makeTreeChunk(const char* id, const juce::ValueTree& tree)
+    {
+        juce::MemoryOutputStream out;
+        tree.writeToStream(out);
+        return makeChunk(id, out.getData(), out.getDataSize(), false);
+    }
+
+    /** Moves every plugin state under 'tree' into its own BLOB chunk, or into the store. */
+    bool extractStates(juce::ValueTree tree, std::vector<Chunk>& blobs, PluginStateStore* store, bool compress)
+    {
+        if (tree.hasProperty(stateId))
+        {
+            const PluginStateData state(tree.getProperty(stateId));
+
+            if (store != nullptr)
+            {
+                const auto hash = store->add(state);
+                if (hash.isEmpty())
+                    return false;
+
+                auto chunk = makeChunk("BREF", hash.toRawUTF8(), (size_t)hash.getNumBytesAsUTF8(), false);
+                chunk.rawSize = (juce::uint32)state.getSize();
+                blobs.push_back(std::move(chunk));
+            }
+            else
+            {
+                blobs.push_back(makeChunk("BLOB", state.getData(), (size_t)state.getSize(), compress));
+            }
+
+            tree.removeProperty(stateId, nullptr);
+            tree.setProperty(stateBlobId, (int)blobs.size() - 1, nullptr);
+        }
+
+        for (auto child : tree)
+            if (!extractStates(child, blobs, store, compress))
+                return false;
+
+        return true;
+    }
+
+    /** Puts the blobs back where extractStates() took them from. */
+    bool restoreStates(juce::ValueTree tree, const juce::ReferenceCountedArray<PresetFile::Blob>& blobs)
+    {
+        if (tree.hasProperty(stateBlobId))
+        {
+            const int index = tree.getProperty(stateBlobId);
+            if (!juce::isPositiveAndBelow(index, blobs.size()))
+                return false;
+
+            tree.removeProperty(stateBlobId, nullptr);
+            tree.setProperty(stateId, juce::var(blobs[index].get()), nullptr);
+        }
+
+        for (auto child : tree)
+            if (!restoreStates(child, blobs))
+                return false;
+
+        return true;
+    }
+
+    void statesToBase64(juce::ValueTree tree)
+    {
+        if (tree.hasProperty(stateId))
+        {
+            const PluginStateData state(tree.getProperty(stateId));
+            tree.setProperty(stateId, juce::MemoryBlock(state.getData(), (size_t)state.getSize()).toBase64Encoding(), nullptr);
+        }
+
+        for (auto child : tree)
+            statesToBase64(child);
+    }
+}
+
+//==============================================================================
+PresetFile::Blob::Blob(std::shared_ptr<const juce::MemoryMappedFile> sourceFile, const void* blobData, size_t blobSize,
+                       const juce::String& knownHash)
+    : file(std::move(sourceFile)), hash(knownHash), data(blobData), size(blobSize)
+{
+}
+
+PresetFile::Blob::Blob(juce::MemoryBlock&& decompressedData, const juce::String& knownHash)
+    : hash(knownHash), ownedData(std::move(decompressedData)), data(ownedData.getData()), size(ownedData.getSize())
+{
+}
+
+PluginStateData::PluginStateData(const juce::var& stateProperty)
+{
+    if (auto* stateBlob = dynamic_cast<PresetFile::Blob*>(stateProperty.getObject()))
+    {
+        blob = stateBlob;
+        data = blob->getData();
+        size = blob->getSize();
+    }
+    else if (auto* block = stateProperty.getBinaryData())
+    {
+        data = block->getData();
+        size = block->getSize();
+    }
+    else if (stateProperty.isString() && decoded.fromBase64Encoding(stateProperty.toString()))
+    {
+        data = decoded.getData();
+        size = decoded.getSize();
+    }
+}
+
+juce::String PluginStateData::getHash() const
+{
+    if (blob != nullptr && blob->getKnownHash().isNotEmpty())
+        return blob->getKnownHash();
+
+    return PresetFile::hashState(data, size);
+}
+
+juce::String PresetFile::hashState(const void* data, size_t size)
+{
+    return juce::SHA256(data, size).toHexString();
+}
+
+//==============================================================================
+juce::ValueTree PresetFile::load(const juce::File& file, PluginStateStore* store)
+{
+    auto mapped = std::make_shared<const juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+    const auto* bytes = static_cast<const juce::uint8*>(mapped->getData());
+    const auto fileSize = mapped->getSize();
+
+    if (bytes == nullptr || fileSize < (size_t)headerSize || std::memcmp(bytes, "ILPR", 4) != 0)
+    {
+        // Presets saved before the binary format.
+        if (auto xml = juce::parseXML(file))
+            return juce::ValueTree::fromXml(*xml);
+
+        return {};
+    }
+
+    const int version = (int)juce::ByteOrder::littleEndianInt(bytes + 4);
+    const int numChunks = (int)juce::ByteOrder::littleEndianInt(bytes + 8);
+
+    if (version < 1 || version > formatVersion || numChunks <= 0
+        || (size_t)headerSize + (size_t)numChunks * (size_t)entrySize > fileSize)
+    {
+        DBG("PresetFile: " + file.getFileName() + " is from another version or corrupt.");
+        return {};
+    }
+
+    juce::ValueTree preset;
+    juce::Array<juce::ValueTree> processors;
+    juce::ReferenceCountedArray<Blob> blobs;
+
+    for (int i = 0; i < numChunks; ++i)
+    {
+        const auto* entry = bytes + headerSize + i * entrySize;
+        const auto flags = juce::ByteOrder::littleEndianInt(entry + 4);
+        const auto offset = (juce::uint64)juce::ByteOrder::littleEndianInt64(entry + 8);
+        const auto storedSize = (size_t)juce::ByteOrder::littleEndianInt(entry + 16);
+        const auto rawSize = (size_t)juce::ByteOrder::littleEndianInt(entry + 20);
+
+        if (offset > fileSize || storedSize > fileSize - offset)
+        {
+            DBG("PresetFile: chunk " << i << " of " << file.getFileName() << " lies outside the file.");
+            return {};
+        }
+
+        const auto* chunkData = bytes + offset;
+        const bool isCompressed = (flags & compressedFlag) != 0;
+        juce::MemoryBlock decompressed;
+
+        if (isCompressed)
+        {
+            juce::MemoryInputStream source(chunkData, storedSize, false);
+            juce::GZIPDecompressorInputStream unzipper(source);
+            unzipper.readIntoMemoryBlock(decompressed);
+
+            if (decompressed.getSize() != rawSize)
+            {
+                DBG("PresetFile: chunk " << i << " of " << file.getFileName() << " doesn't decompress.");
+                return {};
+            }
+        }
+
+        const void* data = isCompressed ? decompressed.getData() : chunkData;
+        const size_t size = isCompressed ? decompressed.getSize() : storedSize;
+
+        if (std::memcmp(entry, "PRST", 4) == 0)
+            preset = juce::ValueTree::readFromData(data, size);
+        else if (std::memcmp(entry, "PROC", 4) == 0)
+            processors.add(juce::ValueTree::readFromData(data, size));
+        else if (std::memcmp(entry, "BLOB", 4) == 0)
+            blobs.add(isCompressed ? new Blob(std::move(decompressed)) : new Blob(mapped, data, size));
+        else if (std::memcmp(entry, "BREF", 4) == 0)
+        {
+            const auto hash = juce::String::fromUTF8(static_cast<const char*>(data), (int)size);
+            auto blob = store != nullptr ? store->find(hash) : nullptr;
+
+            if (blob == nullptr || blob->getSize() != rawSize)
+            {
+                DBG("PresetFile: " + file.getFileName() + " needs the stored state " + hash + ", which is missing.");
+                return {};
+            }
+
+            blobs.add(blob);
+        }
+        // Chunks from newer versions that this one doesn't know are skipped.
+    }
+
+    if (!preset.isValid())
+        return {};
+
+    for (auto& processor : processors)
+    {
+        if (!processor.isValid() || !restoreStates(processor, blobs))
+            return {};
+
+        preset.appendChild(processor, nullptr);
+    }
+
+    return preset;
+}
+
+bool PresetFile::save(const juce::ValueTree& preset, const juce::File& file, PluginStateStore* store, bool compressStates)
+{
+    std::vector<Chunk> chunks;
+    std::vector<Chunk> blobs;
+
+    juce::ValueTree properties(preset.getType());
+    properties.copyPropertiesFrom(preset, nullptr);
+    chunks.push_back(makeTreeChunk("PRST", properties));
+
+    for (const auto& processor : preset)
+    {
+        auto stripped = processor.createCopy();
+        if (!extractStates(stripped, blobs, store, compressStates))
+            return false;
+
+        chunks.push_back(makeTreeChunk("PROC", stripped));
+    }
+
+    for (auto& blob : blobs)
+        chunks.push_back(std::move(blob));
+
+    file.getParentDirectory().createDirectory();
+    juce::TemporaryFile temp(file);
+
+    {
+        juce::FileOutputStream out(temp.getFile());
+        if (!out.openedOk())
+            return false;
+
+        out.write("ILPR", 4);
+        out.writeInt(formatVersion);
+        out.writeInt((int)chunks.size());
+        out.writeInt(0);
+
+        auto offset = (juce::int64)headerSize + (juce::int64)chunks.size() * entrySize;
+        for (const auto& chunk : chunks)
+        {
+            out.write(chunk.id, 4);
+            out.writeInt((int)(chunk.compressed ? compressedFlag : 0));
+            out.writeInt64(offset);
+            out.writeInt((int)chunk.stored.getSize());
+            out.writeInt((int)chunk.rawSize);
+            offset += (juce::int64)chunk.stored.getSize();
+        }
+
+        for (const auto& chunk : chunks)
+            out.write(chunk.stored.getData(), chunk.stored.getSize());
+
+        out.flush();
+        if (out.getStatus().failed())
+            return false;
+    }
+
+    return temp.overwriteTargetFileWithTemporary();
+}
+
+juce::StringArray PresetFile::getReferencedStates(const juce::File& file)
+{
+    juce::StringArray hashes;
+
+    juce::MemoryMappedFile mapped(file, juce::MemoryMappedFile::readOnly);
+    const auto* bytes = static_cast<const juce::uint8*>(mapped.getData());
+    const auto fileSize = mapped.getSize();
+
+    if (bytes == nullptr || fileSize < (size_t)headerSize || std::memcmp(bytes, "ILPR", 4) != 0)
+        return hashes;
+
+    const int numChunks = (int)juce::ByteOrder::littleEndianInt(bytes + 8);
+    if (numChunks <= 0 || (size_t)headerSize + (size_t)numChunks * (size_t)entrySize > fileSize)
+        return hashes;
+
+    for (int i = 0; i < numChunks; ++i)
+    {
+        const auto* entry = bytes + headerSize + i * entrySize;
+        const auto offset = (juce::uint64)juce::ByteOrder::littleEndianInt64(entry + 8);
+        const auto storedSize = (size_t)juce::ByteOrder::littleEndianInt(entry + 16);
+
+        if (std::memcmp(entry, "BREF", 4) == 0 && offset <= fileSize && storedSize <= fileSize - offset)
+            hashes.addIfNotAlreadyThere(juce::String::fromUTF8(reinterpret_cast<const char*>(bytes + offset), (int)storedSize));
+    }
+
+    return hashes;
+}
+
+std::unique_ptr<juce::XmlElement> PresetFile::createXml(const juce::ValueTree& preset)
+{
+    auto copy = preset.createCopy();
+    statesToBase64(copy);
+    return copy.createXml();
+}
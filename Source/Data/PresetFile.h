@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+    PresetFile.h
+    (Binary preset container with raw plugin state blobs)
+
+  ==============================================================================
+*/
+#pragma once
+
+#include <JuceHeader.h>
+
+class PluginStateStore;
+
+/**
+    Reads and writes presets as a chunked binary file (.ilpreset).
+
+    A 16-byte header ("ILPR", version, chunk count) is followed by a directory of
+    chunks (id, flags, offset, stored size, raw size) and then the chunks:
+
+        PRST    the preset's own properties, as a ValueTree with no children
+        PROC    one per processor: its tree, with every plugin's "state" replaced by
+                a "stateBlob" index into the BLOB chunks
+        BLOB    one per plugin: the bytes getStateInformation returned, zlib-compressed
+                when that makes them noticeably smaller
+        BREF    instead of a BLOB when saved with a PluginStateStore: the SHA-256 of
+                the state, which lives once in the store however many presets use it
+
+    Loading memory-maps the file. The "state" property of each plugin in the returned
+    tree holds a Blob; uncompressed blobs point straight into the mapping and keep it
+    alive, so their bytes reach setStateInformation without being copied or decoded.
+
+    load() also reads the XML presets older versions wrote, and createXml() turns any
+    preset tree back into that format.
+*/
+class PresetFile
+{
+public:
+    static constexpr const char* fileExtension = ".ilpreset";
+    static constexpr int formatVersion = 2;
+
+    /** Reads a binary or XML preset; returns an invalid tree if neither works. A preset
+        that references stored states can only be read with the store it was saved to. */
+    static juce::ValueTree load(const juce::File& file, PluginStateStore* store = nullptr);
+
+    /** Writes a binary preset through a temporary file. With a store, the plugin states
+        are added to it and only referenced from the preset. */
+    static bool save(const juce::ValueTree& preset, const juce::File& file,
+                     PluginStateStore* store = nullptr, bool compressStates = true);
+
+    /** The hashes of the stored states a preset references, read without loading it. */
+    static juce::StringArray getReferencedStates(const juce::File& file);
+
+    /** The content hash used by PluginStateStore (SHA-256, hex). */
+    static juce::String hashState(const void* data, size_t size);
+
+    /** The XML layout older versions saved, with states as base64 text. */
+    static std::unique_ptr<juce::XmlElement> createXml(const juce::ValueTree& preset);
+
+    /** A plugin state inside a loaded preset tree. */
+    class Blob : public juce::ReferenceCountedObject
+    {
+    public:
+        Blob(std::shared_ptr<const juce::MemoryMappedFile> sourceFile, const void* data, size_t size,
+             const juce::String& knownHash = {});
+        explicit Blob(juce::MemoryBlock&& decompressedData, const juce::String& knownHash = {});
+
+        const void* getData() const noexcept { return data; }
+        size_t getSize() const noexcept { return size; }
+
+        /** Set for blobs from a PluginStateStore or a PluginStateTracker; empty otherwise. */
+        const juce::String& getKnownHash() const noexcept { return hash; }
+
+    private:
+        std::shared_ptr<const juce::MemoryMappedFile> file;
+        juce::String hash;
+        juce::MemoryBlock ownedData;
+        const void* data = nullptr;
+        size_t size = 0;
+    };
+
+private:
+    PresetFile() = delete;
+};
+
+/**
+    The bytes of one plugin's saved state, whichever form the preset tree holds them
+    in: a Blob from a binary preset, a MemoryBlock from ProcessorBase::getState(), or
+    base64 text from an XML preset. Only the text needs decoding; for the others the
+    var (or its tree) must outlive this object.
+*/
+class PluginStateData
+{
+public:
+    PluginStateData() = default;
+    explicit PluginStateData(const juce::var& stateProperty);
+
+    const void* getData() const noexcept { return data; }
+    int getSize() const noexcept { return (int)size; }
+    bool isEmpty() const noexcept { return size == 0; }
+
+    /** Free for states from the store; hashed on demand otherwise. */
+    juce::String getHash() const;
+
+private:
+    juce::ReferenceCountedObjectPtr<PresetFile::Blob> blob;
+    juce::MemoryBlock decoded;
+    const void* data = nullptr;
+    size_t size = 0;
+
+    JUCE_DECLARE_NON_COPYABLE(PluginStateData)
+};
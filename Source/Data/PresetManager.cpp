@@ -10,8 +10,13 @@
 #include "PresetManager.h"
 #include "../AudioEngine/AudioEngine.h"
 #include "../Data/AppState.h"
+#include "PresetFile.h"
+#include "../Diagnostics/StallDetector.h"
 
-PresetManager::PresetManager() {}
+PresetManager::PresetManager()
+    : stateStore(std::make_unique<PluginStateStore>(getPresetDirectory().getChildFile("States")))
+{
+}
 PresetManager::~PresetManager() {}
 
 juce::File PresetManager::getPresetDirectory()
@@ -29,6 +34,7 @@ juce::File PresetManager::getPresetDirectory()
 
 void PresetManager::savePreset(AudioEngine& engine, const juce::File& file)
 {
+    IDOL_STALL_OPERATION("Save preset");
     juce::ValueTree presetState(Identifiers::Preset);
     auto& appState = AppState::getInstance();
 
@@ -54,26 +60,22 @@ void PresetManager::savePreset(AudioEngine& engine, const juce::File& file)
             presetState.addChild(musicFx->getState(), -1, nullptr);
     }
 
-    if (auto xml = std::unique_ptr<juce::XmlElement>(presetState.createXml()))
-    {
-        xml->writeTo(file, {});
-    }
+    writePreset(presetState, file);
 }
 
 
 void PresetManager::loadPreset(AudioEngine& engine, const juce::File& file)
 {
+    IDOL_STALL_OPERATION("Load preset");
     if (!file.existsAsFile())
     {
         DBG("PresetManager::loadPreset - File does not exist: " + file.getFullPathName());
         return;
     }
 
-    juce::XmlDocument xmlDoc(file);
-    if (auto xml = std::unique_ptr<juce::XmlElement>(xmlDoc.getDocumentElement()))
+    auto presetState = readPreset(file);
+    if (presetState.isValid())
     {
-        auto presetState = juce::ValueTree::fromXml(*xml);
-
         if (presetState.hasType(Identifiers::Preset))
         {
             auto& appState = AppState::getInstance();
@@ -118,18 +120,113 @@ void PresetManager::loadPreset(AudioEngine& engine, const juce::File& file)
     }
     else
     {
-        DBG("PresetManager::loadPreset - Could not parse XML from file: " + file.getFullPathName());
+        DBG("PresetManager::loadPreset - Could not read preset file: " + file.getFullPathName());
     }
 }
 
 void PresetManager::deletePreset(const juce::String& presetName)
 {
-    auto presetFile = getPresetDirectory().getChildFile(presetName + ".xml");
-    if (presetFile.existsAsFile())
+    bool deletedAny = false;
+    for (const auto* extension : { PresetFile::fileExtension, ".xml" })
     {
-        if (presetFile.deleteFile())
+        auto presetFile = getPresetDirectory().getChildFile(presetName + extension);
+        if (presetFile.existsAsFile() && presetFile.deleteFile())
+            deletedAny = true;
+    }
+
+    if (deletedAny)
+    {
+        removeUnusedStates();
+        sendChangeMessage();
+    }
+}
+
+juce::File PresetManager::getPresetFile(const juce::String& presetName)
+{
+    auto presetFile = getPresetDirectory().getChildFile(presetName + PresetFile::fileExtension);
+    auto legacyFile = presetFile.withFileExtension(".xml");
+
+    return (!presetFile.existsAsFile() && legacyFile.existsAsFile()) ? legacyFile : presetFile;
+}
+
+juce::Array<juce::File> PresetManager::getPresetFiles()
+{
+    auto presetDir = getPresetDirectory();
+    auto presetFiles = presetDir.findChildFiles(juce::File::findFiles, false, juce::String("*") + PresetFile::fileExtension);
+
+    // An old XML preset is only listed until it has been saved in the new format.
+    for (const auto& legacyFile : presetDir.findChildFiles(juce::File::findFiles, false, "*.xml"))
+        if (!legacyFile.withFileExtension(PresetFile::fileExtension).existsAsFile())
+            presetFiles.add(legacyFile);
+
+    struct ByName
+    {
+        static int compareElements(const juce::File& a, const juce::File& b)
         {
-            sendChangeMessage();
+            return a.getFileNameWithoutExtension().compareNatural(b.getFileNameWithoutExtension());
         }
+    } byName;
+
+    presetFiles.sort(byName);
+    return presetFiles;
+}
+
+juce::ValueTree PresetManager::readPreset(const juce::File& file)
+{
+    auto preset = PresetFile::load(file, stateStore.get());
+    return preset.hasType(Identifiers::Preset) ? preset : juce::ValueTree();
+}
+
+bool PresetManager::writePreset(const juce::ValueTree& preset, const juce::File& file)
+{
+    const auto target = file.withFileExtension(PresetFile::fileExtension);
+    const bool overwriting = target.existsAsFile();
+
+    if (!PresetFile::save(preset, target, stateStore.get()))
+    {
+        DBG("PresetManager::writePreset - Could not write " + target.getFullPathName());
+        return false;
     }
+
+    // The states the old version used may now be orphaned.
+    if (overwriting)
+        removeUnusedStates();
+
+    return true;
+}
+
+void PresetManager::removeUnusedStates()
+{
+    juce::StringArray hashesInUse;
+    for (const auto& entry : juce::RangedDirectoryIterator(getPresetDirectory(), false,
+                                                          juce::String("*") + PresetFile::fileExtension, juce::File::findFiles))
+        hashesInUse.addArray(PresetFile::getReferencedStates(entry.getFile()));
+
+    const int numRemoved = stateStore->removeAllExcept(hashesInUse);
+    if (numRemoved > 0)
+        DBG("PresetManager: removed " << numRemoved << " unused plugin states.");
+}
+
+juce::String PresetManager::importXmlPreset(const juce::File& xmlFile)
+{
+    auto preset = readPreset(xmlFile);
+    if (!preset.isValid())
+        return {};
+
+    const auto presetName = xmlFile.getFileNameWithoutExtension();
+    if (!writePreset(preset, getPresetDirectory().getChildFile(presetName)))
+        return {};
+
+    sendChangeMessage();
+    return presetName;
+}
+
+bool PresetManager::exportPresetAsXml(const juce::File& presetFile, const juce::File& destination)
+{
+    auto preset = readPreset(presetFile);
+    if (!preset.isValid())
+        return false;
+
+    auto xml = PresetFile::createXml(preset);
+    return xml != nullptr && xml->writeTo(destination.withFileExtension(".xml"), {});
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "JuceHeader.h"
+#include "PluginStateStore.h"
 
 // Forward declaration
 class AudioEngine;
@@ -43,6 +44,29 @@ public:
 
     juce::File getPresetDirectory();
 
+    /** Presets are saved as binary PresetFiles whose plugin states live once in the
+        shared PluginStateStore. The .xml presets older versions wrote are still listed
+        and loaded; saving one writes it in the new format. */
+    juce::File getPresetFile(const juce::String& presetName);
+    juce::Array<juce::File> getPresetFiles();
+    juce::ValueTree readPreset(const juce::File& file);
+    bool writePreset(const juce::ValueTree& preset, const juce::File& file);
+
+    /** Copies an XML preset from anywhere into the preset folder. Returns its name, or
+        an empty string if the file isn't a preset. */
+    juce::String importXmlPreset(const juce::File& xmlFile);
+    bool exportPresetAsXml(const juce::File& presetFile, const juce::File& destination);
+
+    PluginStateStore& getStateStore() { return *stateStore; }
+
 private:
+    /** Removes stored states that no preset references any more. */
+    void removeUnusedStates();
+
+    std::unique_ptr<PluginStateStore> stateStore;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetManager)
-};
\ No newline at end of file
+};
+
+/** Defined in Application.cpp. */
+PresetManager& getSharedPresetManager();
\ No newline at end of file
@@ -8,6 +8,7 @@
 */
 
 #include "SoundboardProfileManager.h"
+#include "../Diagnostics/StallDetector.h"
 
 SoundboardProfileManager::SoundboardProfileManager()
 {
@@ -92,6 +93,8 @@ void SoundboardProfileManager::cleanProfile()
 // <<< FIX: Use std::unique_ptr to manage the ZipInputStream lifetime >>>
 void SoundboardProfileManager::importProfile(const juce::File& zipFile)
 {
+    IDOL_STALL_OPERATION("Import soundboard profile");
+
     if (!zipFile.existsAsFile() || zipFile.getFileExtension() != ".zip")
     {
         juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon, "Import Failed", "Please select a valid .zip profile file.");
@@ -142,6 +145,8 @@ void SoundboardProfileManager::importProfile(const juce::File& zipFile)
 
 void SoundboardProfileManager::exportProfile(const juce::File& destinationZipFile)
 {
+    IDOL_STALL_OPERATION("Export soundboard profile");
+
     if (destinationZipFile.exists())
         destinationZipFile.deleteFile();
 
@@ -211,6 +216,8 @@ juce::var SoundboardProfileManager::soundboardSlotToVar(const SoundboardSlot& sl
 
     slotObject->setProperty("hotkeyCode", slot.hotkey.getKeyCode());
     slotObject->setProperty("hotkeyModifiers", slot.hotkey.getModifiers().getRawFlags());
+    slotObject->setProperty("playMode", slot.playMode == SoundboardSlot::PlayMode::OneShot ? "oneShot" : "retrigger");
+    slotObject->setProperty("chokeGroup", slot.chokeGroup);
     return juce::var(slotObject);
 }
 
@@ -233,6 +240,11 @@ SoundboardSlot SoundboardProfileManager::varToSoundboardSlot(const juce::var& sl
         int keyCode = obj->getProperty("hotkeyCode");
         int modifiers = obj->getProperty("hotkeyModifiers");
         slot.hotkey = juce::KeyPress(keyCode, juce::ModifierKeys(modifiers), 0);
+
+        // Older profiles have neither property and keep the defaults.
+        slot.playMode = obj->getProperty("playMode").toString() == "oneShot" ? SoundboardSlot::PlayMode::OneShot
+                                                                             : SoundboardSlot::PlayMode::Retrigger;
+        slot.chokeGroup = juce::jlimit(0, 4, (int)obj->getProperty("chokeGroup"));
     }
     return slot;
 }
\ No newline at end of file
@@ -40,6 +40,18 @@ struct SoundboardSlot
     // True = chiếm dụng phím(hành vi cũ), false = mượn phím(hành vi mới)
     bool consumeKey = false;
 
+    /** How a new trigger treats the voices this slot is already playing. */
+    enum class PlayMode
+    {
+        Retrigger,  // fade out the slot's running voices, then start again
+        OneShot     // layer a new voice on top, earlier ones keep ringing
+    };
+
+    PlayMode playMode = PlayMode::Retrigger;
+
+    // Slots sharing a non-zero choke group cut each other off. 0 = no group.
+    int chokeGroup = 0;
+
     /** Returns true if no audio file is associated with this slot. */
     bool isEmpty() const
     {
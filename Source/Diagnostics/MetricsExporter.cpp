@@ -0,0 +1,290 @@
+/*
+  ==============================================================================
+
+    MetricsExporter.cpp
+
+  ==============================================================================
+*/
+
+#include "MetricsExporter.h"
+#include "MetricsRegistry.h"
+
+#if JUCE_WINDOWS
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <windows.h>
+ #include <psapi.h>
+#elif JUCE_MAC
+ #include <mach/mach.h>
+#elif JUCE_LINUX
+ #include <unistd.h>
+#endif
+
+namespace MetricsIds
+{
+    const juce::Identifier METRICS_EXPORT("METRICS_EXPORT");
+    const juce::Identifier enabled("enabled");
+    const juce::Identifier file("file");
+    const juce::Identifier writeFile("writeFile");
+    const juce::Identifier httpPort("httpPort");
+    const juce::Identifier intervalSeconds("intervalSeconds");
+}
+
+namespace
+{
+    /** The process's resident set (working set on Windows), or 0 if it can't be read. */
+    juce::uint64 getResidentMemoryBytes()
+    {
+       #if JUCE_WINDOWS
+        PROCESS_MEMORY_COUNTERS counters{};
+        if (K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+            return (juce::uint64)counters.WorkingSetSize;
+       #elif JUCE_MAC
+        mach_task_basic_info_data_t info{};
+        mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+        if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) == KERN_SUCCESS)
+            return (juce::uint64)info.resident_size;
+       #elif JUCE_LINUX
+        // statm: total and resident size, in pages.
+        const auto fields = juce::StringArray::fromTokens(juce::File("/proc/self/statm").loadFileAsString(), true);
+        if (fields.size() > 1)
+            return (juce::uint64)fields[1].getLargeIntValue() * (juce::uint64)sysconf(_SC_PAGESIZE);
+       #endif
+        return 0;
+    }
+}
+
+//==============================================================================
+/** Answers GET /metrics on a localhost port with the exporter's latest text. */
+class MetricsExporter::HttpServer : public juce::Thread
+{
+public:
+    explicit HttpServer(MetricsExporter& ownerToUse)
+        : juce::Thread("Metrics server"), owner(ownerToUse)
+    {
+    }
+
+    ~HttpServer() override
+    {
+        signalThreadShouldExit();
+        socket.close();     // wakes waitForNextConnection()
+        stopThread(2000);
+    }
+
+    bool start(int port)
+    {
+        // Localhost only: the figures are for a collector running on the same PC.
+        if (!socket.createListener(port, "127.0.0.1"))
+            return false;
+
+        startThread(juce::Thread::Priority::low);
+        return true;
+    }
+
+    int getPort() const { return socket.getBoundPort(); }
+
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            std::unique_ptr<juce::StreamingSocket> client(socket.waitForNextConnection());
+            if (client == nullptr)
+            {
+                wait(100);
+                continue;
+            }
+
+            handle(*client);
+        }
+    }
+
+private:
+    void handle(juce::StreamingSocket& client)
+    {
+        // Only the request line matters; the headers are read and ignored.
+        juce::MemoryBlock request;
+        char buffer[1024];
+        while (request.getSize() < 8192 && !request.toString().contains("\r\n\r\n"))
+        {
+            if (client.waitUntilReady(true, 2000) != 1)
+                return;
+
+            const int numRead = client.read(buffer, (int)sizeof(buffer), false);
+            if (numRead <= 0)
+                return;
+
+            request.append(buffer, (size_t)numRead);
+        }
+
+        const auto requestLine = juce::StringArray::fromTokens(request.toString().upToFirstOccurrenceOf("\r\n", false, false), " ", {});
+        const auto path = requestLine[1].upToFirstOccurrenceOf("?", false, false);
+
+        juce::String status = "200 OK", body;
+        if (requestLine[0] != "GET")
+            status = "405 Method Not Allowed";
+        else if (path != "/metrics" && path != "/")
+            status = "404 Not Found";
+        else
+            body = owner.getLatestText();
+
+        const auto bodyUtf8 = body.toUTF8();
+        const auto bodySize = (int)body.getNumBytesAsUTF8();
+
+        juce::String header;
+        header << "HTTP/1.1 " << status << "\r\n"
+               << "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+               << "Content-Length: " << bodySize << "\r\n"
+               << "Connection: close\r\n\r\n";
+
+        client.write(header.toRawUTF8(), (int)header.getNumBytesAsUTF8());
+        if (bodySize > 0)
+            client.write(bodyUtf8.getAddress(), bodySize);
+    }
+
+    MetricsExporter& owner;
+    juce::StreamingSocket socket;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(HttpServer)
+};
+
+//==============================================================================
+MetricsExporter::MetricsExporter()
+    : startTimeMs(juce::Time::getMillisecondCounterHiRes())
+{
+}
+
+MetricsExporter::~MetricsExporter()
+{
+    stopTimer();
+    server.reset();
+
+    if (processCollectorId != 0)
+        MetricsRegistry::getInstance().removeCollector(processCollectorId);
+}
+
+juce::File MetricsExporter::getDefaultFile()
+{
+    return juce::File::getSpecialLocation(juce::File::SpecialLocationType::userApplicationDataDirectory)
+        .getChildFile(ProjectInfo::companyName)
+        .getChildFile(ProjectInfo::projectName)
+        .getChildFile("Metrics")
+        .getChildFile(juce::String(ProjectInfo::projectName) + ".prom");
+}
+
+void MetricsExporter::registerProcessMetrics()
+{
+    if (processCollectorId != 0)
+        return;
+
+    auto& registry = MetricsRegistry::getInstance();
+    registry.addGauge("idol_build_info", "Always 1; the labels say which build is running.",
+                      "version=\"" + juce::String(ProjectInfo::versionString) + "\"").set(1.0);
+
+    auto& uptime = registry.addGauge("idol_uptime_seconds", "Seconds since the exporter started.");
+    auto& residentBytes = registry.addGauge("idol_process_resident_bytes", "Physical memory the process is using.");
+
+    processCollectorId = registry.addCollector([this, &uptime, &residentBytes]
+        {
+            uptime.set((juce::Time::getMillisecondCounterHiRes() - startTimeMs) / 1000.0);
+            residentBytes.set((double)getResidentMemoryBytes());
+        });
+}
+
+void MetricsExporter::setSettings(const Settings& newSettings)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+    settings = newSettings;
+    settings.intervalSeconds = juce::jlimit(1.0, 3600.0, settings.intervalSeconds);
+
+    stopTimer();
+    server.reset();
+
+    if (!settings.enabled)
+        return;
+
+    registerProcessMetrics();
+
+    if (settings.httpPort > 0)
+    {
+        server = std::make_unique<HttpServer>(*this);
+        if (!server->start(settings.httpPort))
+        {
+            DBG("MetricsExporter: could not listen on port " << settings.httpPort);
+            server.reset();
+        }
+    }
+
+    exportNow();
+    startTimer(juce::roundToInt(settings.intervalSeconds * 1000.0));
+}
+
+bool MetricsExporter::exportNow()
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+    auto& registry = MetricsRegistry::getInstance();
+    registry.collectAll();
+    const auto text = registry.toPrometheusText();
+
+    {
+        const juce::ScopedLock sl(textLock);
+        latestText = text;
+    }
+
+    if (!settings.writeFile)
+        return true;
+
+    // Written aside and swapped into place, so a reader never sees half a file. On Windows
+    // moveFileTo() deletes the old file first; replaceFileIn() swaps it in one step.
+    const auto file = settings.file != juce::File() ? settings.file : getDefaultFile();
+    const auto temp = file.getSiblingFile(file.getFileName() + ".tmp");
+    if (file.getParentDirectory().createDirectory() && temp.replaceWithText(text) && temp.replaceFileIn(file))
+        return true;
+
+    DBG("MetricsExporter: could not write " << file.getFullPathName());
+    return false;
+}
+
+juce::String MetricsExporter::getLatestText() const
+{
+    const juce::ScopedLock sl(textLock);
+    return latestText;
+}
+
+int MetricsExporter::getListeningPort() const
+{
+    return server != nullptr ? server->getPort() : 0;
+}
+
+void MetricsExporter::timerCallback()
+{
+    exportNow();
+}
+
+//==============================================================================
+juce::ValueTree MetricsExporter::getState() const
+{
+    juce::ValueTree state(MetricsIds::METRICS_EXPORT);
+    state.setProperty(MetricsIds::enabled, settings.enabled, nullptr);
+    state.setProperty(MetricsIds::file, settings.file.getFullPathName(), nullptr);
+    state.setProperty(MetricsIds::writeFile, settings.writeFile, nullptr);
+    state.setProperty(MetricsIds::httpPort, settings.httpPort, nullptr);
+    state.setProperty(MetricsIds::intervalSeconds, settings.intervalSeconds, nullptr);
+    return state;
+}
+
+void MetricsExporter::restoreState(const juce::ValueTree& state)
+{
+    if (!state.hasType(MetricsIds::METRICS_EXPORT))
+        return;
+
+    const Settings defaults;
+    Settings newSettings;
+    newSettings.enabled = state.getProperty(MetricsIds::enabled, defaults.enabled);
+    const auto path = state.getProperty(MetricsIds::file).toString();
+    newSettings.file = juce::File::isAbsolutePath(path) ? juce::File(path) : juce::File();
+    newSettings.writeFile = state.getProperty(MetricsIds::writeFile, defaults.writeFile);
+    newSettings.httpPort = state.getProperty(MetricsIds::httpPort, defaults.httpPort);
+    newSettings.intervalSeconds = state.getProperty(MetricsIds::intervalSeconds, defaults.intervalSeconds);
+    setSettings(newSettings);
+}
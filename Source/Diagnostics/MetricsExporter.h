@@ -0,0 +1,75 @@
+/*
+  ==============================================================================
+
+    MetricsExporter.h
+    (Writes MetricsRegistry to a Prometheus text file and serves it on localhost)
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+    Publishes the MetricsRegistry every few seconds, in either or both of two ways:
+
+    - a text file, replaced atomically, for node_exporter's textfile collector or
+      anything else that reads files;
+    - GET /metrics on a localhost port, for Prometheus or curl to scrape directly.
+
+    The collectors run and the text is rendered on the message thread, on the timer;
+    the server thread only sends the latest text, so a scrape never touches the engine
+    and sees figures at most one interval old.
+
+    Off until enabled; the settings are saved with the session.
+*/
+class MetricsExporter : private juce::Timer
+{
+public:
+    struct Settings
+    {
+        bool enabled = false;
+        juce::File file;                // none: getDefaultFile()
+        bool writeFile = true;
+        int httpPort = 0;               // 0: no server
+        double intervalSeconds = 10.0;
+    };
+
+    MetricsExporter();
+    ~MetricsExporter() override;
+
+    /** Message thread. */
+    void setSettings(const Settings& newSettings);
+    Settings getSettings() const { return settings; }
+
+    /** Collects and publishes now, whatever the interval. */
+    bool exportNow();
+    /** What the last export rendered. */
+    juce::String getLatestText() const;
+
+    /** The port the server is listening on, or 0 if it isn't running. */
+    int getListeningPort() const;
+
+    /** A .prom file in the app's data folder. */
+    static juce::File getDefaultFile();
+
+    juce::ValueTree getState() const;
+    void restoreState(const juce::ValueTree& state);
+
+private:
+    class HttpServer;
+
+    void timerCallback() override;
+    void registerProcessMetrics();
+
+    Settings settings;
+    std::unique_ptr<HttpServer> server;
+    int processCollectorId = 0;
+    double startTimeMs = 0.0;
+
+    mutable juce::CriticalSection textLock;
+    juce::String latestText;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MetricsExporter)
+};
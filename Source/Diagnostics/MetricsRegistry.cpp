@@ -0,0 +1,240 @@
+/*
+  ==============================================================================
+
+    MetricsRegistry.cpp
+
+  ==============================================================================
+*/
+
+#include "MetricsRegistry.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    juce::String formatValue(double value)
+    {
+        if (std::isnan(value)) return "NaN";
+        if (std::isinf(value)) return value > 0.0 ? "+Inf" : "-Inf";
+        return juce::String(value);
+    }
+
+    juce::String escapeHelp(const juce::String& help)
+    {
+        return help.replace("\\", "\\\\").replace("\n", "\\n");
+    }
+
+    juce::String withLabels(const juce::String& name, const juce::String& labels, const juce::String& extraLabel = {})
+    {
+        juce::StringArray all;
+        if (labels.isNotEmpty()) all.add(labels);
+        if (extraLabel.isNotEmpty()) all.add(extraLabel);
+        return all.isEmpty() ? name : name + "{" + all.joinIntoString(",") + "}";
+    }
+}
+
+//==============================================================================
+MetricsRegistry::Histogram::Histogram(const juce::Array<double>& upperBounds)
+{
+    for (int i = 0; i < juce::jmin(maxBuckets, upperBounds.size()); ++i)
+    {
+        jassert(i == 0 || upperBounds[i] > upperBounds[i - 1]);
+        bounds.add(upperBounds[i]);
+    }
+}
+
+void MetricsRegistry::Histogram::observe(double value) noexcept
+{
+    int bucket = 0;
+    while (bucket < bounds.size() && value > bounds.getUnchecked(bucket))
+        ++bucket;
+
+    counts[(size_t)bucket].fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+MetricsRegistry::Histogram::Snapshot MetricsRegistry::Histogram::getSnapshot() const noexcept
+{
+    // Not one atomic read: an observation landing meanwhile can show in the counts but
+    // not yet the sum. Scrapes are seconds apart, so that doesn't matter.
+    Snapshot snapshot;
+    for (int i = 0; i <= bounds.size(); ++i)
+    {
+        snapshot.counts[(size_t)i] = counts[(size_t)i].load(std::memory_order_relaxed);
+        snapshot.count += snapshot.counts[(size_t)i];
+    }
+    snapshot.sum = sum.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+double MetricsRegistry::Histogram::getQuantile(const Snapshot& earlier, const Snapshot& later, double q) const
+{
+    const auto total = later.count - earlier.count;
+    if (total == 0 || bounds.isEmpty())
+        return 0.0;
+
+    const double target = juce::jlimit(0.0, 1.0, q) * (double)total;
+    double below = 0.0;
+
+    for (int i = 0; i <= bounds.size(); ++i)
+    {
+        const auto inBucket = (double)(later.counts[(size_t)i] - earlier.counts[(size_t)i]);
+        if (inBucket > 0.0 && below + inBucket >= target)
+        {
+            // Past the last bound there is nothing to interpolate towards.
+            if (i == bounds.size())
+                return bounds.getLast();
+
+            const double lower = i == 0 ? 0.0 : bounds.getUnchecked(i - 1);
+            const double upper = bounds.getUnchecked(i);
+            return lower + (upper - lower) * (target - below) / inBucket;
+        }
+        below += inBucket;
+    }
+
+    return bounds.getLast();
+}
+
+//==============================================================================
+MetricsRegistry& MetricsRegistry::getInstance()
+{
+    static MetricsRegistry instance;
+    return instance;
+}
+
+MetricsRegistry::Entry* MetricsRegistry::findEntry(const juce::String& name, const juce::String& labels, Type type) const
+{
+    for (auto* entry : entries)
+        if (entry->name == name && entry->labels == labels)
+            return entry->type == type ? entry : nullptr;
+
+    return nullptr;
+}
+
+MetricsRegistry::Entry& MetricsRegistry::addEntry(const juce::String& name, const juce::String& help,
+                                                  const juce::String& labels, Type type)
+{
+    // One name is one family; it can't be a counter here and a gauge there.
+    jassert(std::none_of(entries.begin(), entries.end(), [&](const Entry* e) { return e->name == name && e->type != type; }));
+
+    auto* entry = entries.add(new Entry());
+    entry->name = name;
+    entry->help = help;
+    entry->labels = labels;
+    entry->type = type;
+    return *entry;
+}
+
+MetricsRegistry::Counter& MetricsRegistry::addCounter(const juce::String& name, const juce::String& help, const juce::String& labels)
+{
+    const juce::ScopedLock sl(lock);
+    if (auto* entry = findEntry(name, labels, Type::counter))
+        return *entry->counter;
+
+    auto& entry = addEntry(name, help, labels, Type::counter);
+    entry.counter = std::make_unique<Counter>();
+    return *entry.counter;
+}
+
+MetricsRegistry::Gauge& MetricsRegistry::addGauge(const juce::String& name, const juce::String& help, const juce::String& labels)
+{
+    const juce::ScopedLock sl(lock);
+    if (auto* entry = findEntry(name, labels, Type::gauge))
+        return *entry->gauge;
+
+    auto& entry = addEntry(name, help, labels, Type::gauge);
+    entry.gauge = std::make_unique<Gauge>();
+    return *entry.gauge;
+}
+
+MetricsRegistry::Histogram& MetricsRegistry::addHistogram(const juce::String& name, const juce::String& help,
+                                                          const juce::Array<double>& upperBounds, const juce::String& labels)
+{
+    const juce::ScopedLock sl(lock);
+    if (auto* entry = findEntry(name, labels, Type::histogram))
+        return *entry->histogram;
+
+    auto& entry = addEntry(name, help, labels, Type::histogram);
+    entry.histogram = std::make_unique<Histogram>(upperBounds);
+    return *entry.histogram;
+}
+
+//==============================================================================
+int MetricsRegistry::addCollector(std::function<void()> collector)
+{
+    const juce::ScopedLock sl(collectorLock);
+    const int id = nextCollectorId++;
+    collectors[id] = std::move(collector);
+    return id;
+}
+
+void MetricsRegistry::removeCollector(int collectorId)
+{
+    const juce::ScopedLock sl(collectorLock);
+    collectors.erase(collectorId);
+}
+
+void MetricsRegistry::collectAll()
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+    const juce::ScopedLock sl(collectorLock);
+    for (auto& [id, collector] : collectors)
+        collector();
+}
+
+juce::String MetricsRegistry::toPrometheusText() const
+{
+    const juce::ScopedLock sl(lock);
+
+    // Prometheus wants each family's samples together, under one HELP and TYPE.
+    juce::Array<const Entry*> sorted;
+    for (auto* entry : entries)
+        sorted.add(entry);
+    std::stable_sort(sorted.begin(), sorted.end(), [](const Entry* a, const Entry* b) { return a->name < b->name; });
+
+    juce::MemoryOutputStream out;
+    juce::String family;
+
+    for (auto* entry : sorted)
+    {
+        if (entry->name != family)
+        {
+            family = entry->name;
+            out << "# HELP " << family << " " << escapeHelp(entry->help) << "\n";
+            out << "# TYPE " << family << " "
+                << (entry->type == Type::counter ? "counter" : entry->type == Type::gauge ? "gauge" : "histogram") << "\n";
+        }
+
+        switch (entry->type)
+        {
+            case Type::counter:
+                out << withLabels(entry->name, entry->labels) << " " << juce::String(entry->counter->get()) << "\n";
+                break;
+
+            case Type::gauge:
+                out << withLabels(entry->name, entry->labels) << " " << formatValue(entry->gauge->get()) << "\n";
+                break;
+
+            case Type::histogram:
+            {
+                const auto& histogram = *entry->histogram;
+                const auto snapshot = histogram.getSnapshot();
+                const auto& bounds = histogram.getUpperBounds();
+
+                juce::uint64 cumulative = 0;
+                for (int i = 0; i <= bounds.size(); ++i)
+                {
+                    cumulative += snapshot.counts[(size_t)i];
+                    const auto le = i < bounds.size() ? formatValue(bounds[i]) : juce::String("+Inf");
+                    out << withLabels(entry->name + "_bucket", entry->labels, "le=\"" + le + "\"") << " "
+                        << juce::String(cumulative) << "\n";
+                }
+                out << withLabels(entry->name + "_sum", entry->labels) << " " << formatValue(snapshot.sum) << "\n";
+                out << withLabels(entry->name + "_count", entry->labels) << " " << juce::String(snapshot.count) << "\n";
+                break;
+            }
+        }
+    }
+
+    return out.toString();
+}
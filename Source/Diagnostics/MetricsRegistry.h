@@ -0,0 +1,141 @@
+/*
+  ==============================================================================
+
+    MetricsRegistry.h
+    (Counters, gauges and histograms for operational monitoring, in Prometheus text format)
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <functional>
+#include <map>
+
+/**
+    The app's operational metrics: what a monitoring system scraping every streaming
+    PC wants to see, such as callback times, xruns, recorder disk time and preset
+    load times.
+
+    Metrics are registered once, on any thread but usually the message thread, and
+    the reference handed back stays valid for the life of the program. Updating one
+    is a relaxed atomic operation that never locks or allocates, so it is safe on
+    the audio thread.
+
+    Values that live elsewhere (a cache's size, the device's xrun count) are copied
+    in by collectors, which MetricsExporter runs on the message thread just before
+    each export.
+*/
+class MetricsRegistry
+{
+public:
+    static MetricsRegistry& getInstance();
+
+    /** Only ever goes up, e.g. idol_callback_overruns_total. */
+    class Counter
+    {
+    public:
+        void increment(juce::uint64 amount = 1) noexcept { value.fetch_add(amount, std::memory_order_relaxed); }
+        /** For a count kept somewhere else, copied in by a collector. */
+        void setTotal(juce::uint64 total) noexcept { value.store(total, std::memory_order_relaxed); }
+        juce::uint64 get() const noexcept { return value.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<juce::uint64> value{ 0 };
+    };
+
+    /** Goes up and down, e.g. the number of plugins loaded. */
+    class Gauge
+    {
+    public:
+        void set(double newValue) noexcept { value.store(newValue, std::memory_order_relaxed); }
+        double get() const noexcept { return value.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<double> value{ 0.0 };
+    };
+
+    /** Counts observations into fixed buckets, e.g. how long each callback took. */
+    class Histogram
+    {
+    public:
+        static constexpr int maxBuckets = 16;
+
+        /** Counts and sum at one moment; subtracting two gives the interval between them. */
+        struct Snapshot
+        {
+            std::array<juce::uint64, maxBuckets + 1> counts{};  // per bucket; the one after the last bound is +Inf
+            double sum = 0.0;
+            juce::uint64 count = 0;
+        };
+
+        /** upperBounds must be ascending; only the first maxBuckets are used. */
+        explicit Histogram(const juce::Array<double>& upperBounds);
+
+        void observe(double value) noexcept;
+
+        Snapshot getSnapshot() const noexcept;
+        const juce::Array<double>& getUpperBounds() const noexcept { return bounds; }
+
+        /** The value below which a share q (0..1) of the observations made between two
+            snapshots fall, interpolated within its bucket; 0 if there were none. */
+        double getQuantile(const Snapshot& earlier, const Snapshot& later, double q) const;
+
+    private:
+        juce::Array<double> bounds;
+        std::array<std::atomic<juce::uint64>, maxBuckets + 1> counts{};
+        std::atomic<double> sum{ 0.0 };
+
+        JUCE_DECLARE_NON_COPYABLE(Histogram)
+    };
+
+    /** The same name and labels always return the same metric. Labels are given in
+        Prometheus form without the braces: chain="vocal",slot="1". */
+    Counter& addCounter(const juce::String& name, const juce::String& help, const juce::String& labels = {});
+    Gauge& addGauge(const juce::String& name, const juce::String& help, const juce::String& labels = {});
+    Histogram& addHistogram(const juce::String& name, const juce::String& help,
+                            const juce::Array<double>& upperBounds, const juce::String& labels = {});
+
+    /** Run by collectAll(); returns an id for removeCollector(). */
+    int addCollector(std::function<void()> collector);
+    void removeCollector(int collectorId);
+
+    /** Message thread. */
+    void collectAll();
+
+    /** Every metric, in the Prometheus text exposition format (version 0.0.4). */
+    juce::String toPrometheusText() const;
+
+private:
+    MetricsRegistry() = default;
+
+    enum class Type
+    {
+        counter,
+        gauge,
+        histogram
+    };
+
+    struct Entry
+    {
+        juce::String name, help, labels;
+        Type type;
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<Histogram> histogram;
+    };
+
+    Entry* findEntry(const juce::String& name, const juce::String& labels, Type type) const;
+    Entry& addEntry(const juce::String& name, const juce::String& help, const juce::String& labels, Type type);
+
+    mutable juce::CriticalSection lock;
+    juce::OwnedArray<Entry> entries;
+
+    juce::CriticalSection collectorLock;
+    std::map<int, std::function<void()>> collectors;
+    int nextCollectorId = 1;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MetricsRegistry)
+};
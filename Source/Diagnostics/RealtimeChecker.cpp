@@ -0,0 +1,203 @@
+/*
+  ==============================================================================
+
+    RealtimeChecker.cpp
+
+  ==============================================================================
+*/
+
+#include "RealtimeChecker.h"
+#include "StackTrace.h"
+#include <algorithm>
+
+namespace
+{
+    // Plain values, so reading them from inside malloc() needs no initialisation.
+    thread_local int realtimeDepth = 0;
+    thread_local int allowDepth = 0;
+    thread_local bool insideCheck = false;
+}
+
+/** The hooks' way in; see RealtimeCheckerHooks.cpp. */
+namespace idolRealtime
+{
+    void check(int kind, const char* function) noexcept
+    {
+        RealtimeChecker::check((RealtimeChecker::Kind)kind, function);
+    }
+}
+
+//==============================================================================
+RealtimeChecker& RealtimeChecker::getInstance()
+{
+    static RealtimeChecker instance;
+    return instance;
+}
+
+RealtimeChecker::RealtimeChecker()
+{
+    // The first backtrace() loads the unwinder, which allocates; better here than
+    // in the middle of recording a violation.
+    void* frames[4];
+    juce::ignoreUnused(StackTrace::capture(frames, 4));
+}
+
+void RealtimeChecker::setEnabled(bool shouldBeEnabled) noexcept
+{
+    enabled.store(shouldBeEnabled);
+}
+
+void RealtimeChecker::check(Kind kind, const char* function) noexcept
+{
+    if (realtimeDepth == 0 || allowDepth > 0 || insideCheck)
+        return;
+
+    // Whatever recording calls (the unwinder, say) mustn't come back round.
+    insideCheck = true;
+    auto& checker = getInstance();
+    if (checker.isEnabled())
+        checker.record(kind, function);
+    insideCheck = false;
+}
+
+void RealtimeChecker::record(Kind kind, const char* function) noexcept
+{
+    numViolations.fetch_add(1, std::memory_order_relaxed);
+
+    // Two more than kept: record() and check() themselves.
+    constexpr int ownFrames = 2;
+    std::array<void*, maxFrames + ownFrames> frames{};
+    const int numCaptured = StackTrace::capture(frames.data(), (int)frames.size());
+    const int firstFrame = juce::jmin(ownFrames, numCaptured);
+    const int numFrames = numCaptured - firstFrame;
+
+    juce::uint64 hash = 14695981039346656037ull;
+    const auto mix = [&hash](juce::uint64 value) { hash = (hash ^ value) * 1099511628211ull; };
+    mix((juce::uint64)kind);
+    mix((juce::uint64)(juce::pointer_sized_uint)function);
+    for (int i = 0; i < numFrames; ++i)
+        mix((juce::uint64)(juce::pointer_sized_uint)frames[(size_t)(firstFrame + i)]);
+
+    const int numClaimed = juce::jmin(numRecords.load(std::memory_order_acquire), maxDistinctViolations);
+    for (int i = 0; i < numClaimed; ++i)
+    {
+        auto& existing = records[(size_t)i];
+        if (existing.ready.load(std::memory_order_acquire) && existing.hash == hash)
+        {
+            existing.count.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    // Past the last slot a violation is only counted.
+    const int index = numRecords.fetch_add(1, std::memory_order_acq_rel);
+    if (index >= maxDistinctViolations)
+        return;
+
+    auto& slot = records[(size_t)index];
+    slot.kind = kind;
+    slot.function = function;
+    slot.hash = hash;
+    slot.numFrames = numFrames;
+    for (int i = 0; i < numFrames; ++i)
+        slot.frames[(size_t)i] = frames[(size_t)(firstFrame + i)];
+    slot.count.store(1, std::memory_order_relaxed);
+    slot.ready.store(true, std::memory_order_release);
+}
+
+std::vector<RealtimeChecker::Violation> RealtimeChecker::getViolations() const
+{
+    std::vector<Violation> violations;
+
+    const int numClaimed = juce::jmin(numRecords.load(std::memory_order_acquire), maxDistinctViolations);
+    for (int i = 0; i < numClaimed; ++i)
+    {
+        const auto& slot = records[(size_t)i];
+        if (!slot.ready.load(std::memory_order_acquire))
+            continue;
+
+        Violation violation;
+        violation.kind = slot.kind;
+        violation.function = slot.function;
+        violation.stack = StackTrace::symbolise(slot.frames.data(), slot.numFrames);
+        violation.count = slot.count.load(std::memory_order_relaxed);
+        violations.push_back(std::move(violation));
+    }
+
+    std::stable_sort(violations.begin(), violations.end(),
+                     [](const Violation& a, const Violation& b) { return a.count > b.count; });
+    return violations;
+}
+
+juce::String RealtimeChecker::getReport() const
+{
+    const auto total = getNumViolations();
+    if (total == 0)
+        return {};
+
+    const auto violations = getViolations();
+
+    juce::String report;
+    report << "Realtime violations on the audio thread: " << (juce::int64)total
+           << " calls from " << (int)violations.size() << " places\n";
+
+    if (numRecords.load() > maxDistinctViolations)
+        report << "(only the first " << maxDistinctViolations << " places were kept)\n";
+
+    for (const auto& violation : violations)
+    {
+        report << "\n" << getKindName(violation.kind) << ": " << violation.function
+               << ", " << (juce::int64)violation.count << (violation.count == 1 ? " time" : " times") << "\n";
+
+        for (int i = 0; i < violation.stack.size(); ++i)
+            report << "  " << juce::String(i).paddedLeft(' ', 2) << "  " << violation.stack[i] << "\n";
+    }
+
+    return report;
+}
+
+void RealtimeChecker::clear() noexcept
+{
+    const int numClaimed = juce::jmin(numRecords.load(), maxDistinctViolations);
+    for (int i = 0; i < numClaimed; ++i)
+        records[(size_t)i].ready.store(false);
+
+    numRecords.store(0);
+    numViolations.store(0);
+}
+
+juce::String RealtimeChecker::getKindName(Kind kind)
+{
+    switch (kind)
+    {
+        case Kind::allocation:   return "Allocation";
+        case Kind::deallocation: return "Deallocation";
+        case Kind::lock:         return "Lock";
+        case Kind::blockingCall: return "Blocking call";
+    }
+    return {};
+}
+
+//==============================================================================
+RealtimeChecker::ScopedRealtime::ScopedRealtime() noexcept
+{
+    // Made now, before the thread is realtime, so its construction isn't a violation.
+    juce::ignoreUnused(getInstance());
+    ++realtimeDepth;
+}
+
+RealtimeChecker::ScopedRealtime::~ScopedRealtime()
+{
+    --realtimeDepth;
+}
+
+RealtimeChecker::ScopedAllow::ScopedAllow(const char* reason) noexcept
+{
+    juce::ignoreUnused(reason);
+    ++allowDepth;
+}
+
+RealtimeChecker::ScopedAllow::~ScopedAllow()
+{
+    --allowDepth;
+}
@@ -0,0 +1,146 @@
+/*
+  ==============================================================================
+
+    RealtimeChecker.h
+    (Catches allocations, locks and blocking calls made on the audio thread)
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <vector>
+
+/** Set to 1 (in a Debug or CI build) to compile the checker and its hooks in. */
+#ifndef IDOL_ENABLE_REALTIME_CHECKS
+ #define IDOL_ENABLE_REALTIME_CHECKS 0
+#endif
+
+/**
+    While a thread is inside IDOL_REALTIME_SCOPE() (the audio callback), every call it
+    makes to the allocator, to a blocking lock or to a blocking system call is recorded
+    as a violation, with the stack it was made from.
+
+    The hooks replace the functions themselves, so they see calls made from JUCE and
+    from plugins as well as ours:
+
+    - Linux: malloc and friends, pthread mutex/rwlock/condition waits, semaphores,
+      thread joins, sleeps, poll/select and file open/read/write/close/fsync.
+    - macOS: operator new/delete, and the pthread and file calls above as made from
+      the app's own code (JUCE included); system frameworks and plugins go to libSystem
+      directly.
+    - Windows: operator new/delete only.
+
+    Try-locks and atomics never block, so juce::SpinLock and ScopedTryLock are fine.
+
+    Recording a violation doesn't lock or allocate: the stack is captured into one of a
+    fixed set of slots, and a stack already seen only bumps its count. The stacks are
+    symbolised when the report is asked for, on another thread.
+
+    A call that is known to be harmless but can't be told apart from a real problem
+    (a lock nobody else ever takes, say) can be let through with IDOL_REALTIME_ALLOW("why").
+*/
+class RealtimeChecker
+{
+public:
+    enum class Kind
+    {
+        allocation,
+        deallocation,
+        lock,
+        blockingCall
+    };
+
+    struct Violation
+    {
+        Kind kind = Kind::allocation;
+        juce::String function;
+        juce::StringArray stack;
+        juce::uint64 count = 0;
+    };
+
+    static RealtimeChecker& getInstance();
+
+    static constexpr int maxFrames = 32;
+    static constexpr int maxDistinctViolations = 256;
+
+    /** True if the hooks are compiled into this build. */
+    static constexpr bool isAvailable() noexcept { return IDOL_ENABLE_REALTIME_CHECKS != 0; }
+
+    /** Checking is on by default in builds that have it. */
+    void setEnabled(bool shouldBeEnabled) noexcept;
+    bool isEnabled() const noexcept { return enabled.load(std::memory_order_relaxed); }
+
+    /** Every violation since the last clear(), counting repeats. */
+    juce::uint64 getNumViolations() const noexcept { return numViolations.load(); }
+    /** The distinct violations (by kind, function and stack) since the last clear(), symbolised. */
+    std::vector<Violation> getViolations() const;
+    /** The violations as text, most frequent first; empty if there were none. */
+    juce::String getReport() const;
+    /** Not while a realtime scope is running. */
+    void clear() noexcept;
+
+    static juce::String getKindName(Kind kind);
+
+    /** Marks the calling thread as realtime until the scope ends; scopes nest. */
+    class ScopedRealtime
+    {
+    public:
+        ScopedRealtime() noexcept;
+        ~ScopedRealtime();
+
+    private:
+        JUCE_DECLARE_NON_COPYABLE(ScopedRealtime)
+    };
+
+    /** Lets the calling thread lock or allocate until the scope ends. The reason is only
+        there for whoever reads the code. */
+    class ScopedAllow
+    {
+    public:
+        explicit ScopedAllow(const char* reason) noexcept;
+        ~ScopedAllow();
+
+    private:
+        JUCE_DECLARE_NON_COPYABLE(ScopedAllow)
+    };
+
+    /** Called by the hooks: records a violation if the calling thread is realtime. */
+    static void check(Kind kind, const char* function) noexcept;
+
+private:
+    RealtimeChecker();
+
+    struct Record
+    {
+        std::atomic<bool> ready{ false };
+        Kind kind = Kind::allocation;
+        const char* function = nullptr;
+        juce::uint64 hash = 0;
+        std::array<void*, maxFrames> frames{};
+        int numFrames = 0;
+        std::atomic<juce::uint64> count{ 0 };
+    };
+
+    void record(Kind kind, const char* function) noexcept;
+
+    std::atomic<bool> enabled{ true };
+    std::atomic<juce::uint64> numViolations{ 0 };
+    std::atomic<int> numRecords{ 0 };
+    std::array<Record, maxDistinctViolations> records;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RealtimeChecker)
+};
+
+#if IDOL_ENABLE_REALTIME_CHECKS
+ #define IDOL_REALTIME_SCOPE() \
+    const RealtimeChecker::ScopedRealtime JUCE_JOIN_MACRO(idolRealtimeScope_, __LINE__)
+ #define IDOL_REALTIME_ALLOW(reason) \
+    const RealtimeChecker::ScopedAllow JUCE_JOIN_MACRO(idolRealtimeAllow_, __LINE__)(reason)
+#else
+ #define IDOL_REALTIME_SCOPE()
+ #define IDOL_REALTIME_ALLOW(reason)
+#endif
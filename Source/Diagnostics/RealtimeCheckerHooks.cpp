@@ -0,0 +1,389 @@
+/*
+  ==============================================================================
+
+    RealtimeCheckerHooks.cpp
+    (The allocator, lock and system call replacements behind RealtimeChecker)
+
+    This file deliberately includes no JUCE header: JUCE's headers turn on large
+    file and fortify options that rename or inline some of the functions defined
+    here, so they're switched off before the first system header instead.
+
+  ==============================================================================
+*/
+
+#ifndef IDOL_ENABLE_REALTIME_CHECKS
+ #define IDOL_ENABLE_REALTIME_CHECKS 0
+#endif
+
+#if IDOL_ENABLE_REALTIME_CHECKS
+
+#undef _FORTIFY_SOURCE
+#undef _FILE_OFFSET_BITS
+#ifndef _GNU_SOURCE
+ #define _GNU_SOURCE 1
+#endif
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#if defined(__linux__) || defined(__APPLE__)
+ #include <atomic>
+ #include <cerrno>
+ #include <cstdarg>
+ #include <cstdio>
+ #include <dlfcn.h>
+ #include <fcntl.h>
+ #include <poll.h>
+ #include <pthread.h>
+ #include <semaphore.h>
+ #include <sys/select.h>
+ #include <time.h>
+ #include <unistd.h>
+ #if defined(__linux__)
+  #include <malloc.h>
+ #endif
+#endif
+
+// Defined in RealtimeChecker.cpp. The kinds are RealtimeChecker::Kind's.
+namespace idolRealtime
+{
+    void check(int kind, const char* function) noexcept;
+
+    enum : int
+    {
+        allocation = 0,
+        deallocation = 1,
+        lock = 2,
+        blockingCall = 3
+    };
+}
+
+#ifdef __THROW
+ #define IDOL_HOOK_NOTHROW __THROW
+#else
+ #define IDOL_HOOK_NOTHROW
+#endif
+
+#if defined(__linux__) || defined(__APPLE__)
+namespace
+{
+    /** The definition the hook is standing in for, looked up once. */
+    void* findNext(std::atomic<void*>& cache, const char* name, const char* version = nullptr) noexcept
+    {
+        auto* function = cache.load(std::memory_order_acquire);
+        if (function == nullptr)
+        {
+           #if defined(__GLIBC__)
+            // Versioned symbols: plain dlsym() finds the oldest, which for the condition
+            // variable calls is an incompatible implementation.
+            if (version != nullptr)
+                function = dlvsym(RTLD_NEXT, name, version);
+           #else
+            (void)version;
+           #endif
+            if (function == nullptr)
+                function = dlsym(RTLD_NEXT, name);
+            cache.store(function, std::memory_order_release);
+        }
+        return function;
+    }
+}
+
+#define IDOL_NEXT_VERSIONED(function, version) \
+    ([]() noexcept \
+    { \
+        static std::atomic<void*> cache{ nullptr }; \
+        return reinterpret_cast<decltype(&::function)>(findNext(cache, #function, version)); \
+    }())
+
+#define IDOL_NEXT(function) IDOL_NEXT_VERSIONED(function, nullptr)
+
+#if defined(__GLIBC__) && defined(__x86_64__)
+ #define IDOL_CONDVAR_VERSION "GLIBC_2.3.2"
+#else
+ #define IDOL_CONDVAR_VERSION nullptr
+#endif
+
+extern "C"
+{
+    //==============================================================================
+   #if defined(__GLIBC__)
+    // glibc's own entry points, so the allocator needs no lookup and can't recurse.
+    void* __libc_malloc(size_t size);
+    void* __libc_calloc(size_t count, size_t size);
+    void* __libc_realloc(void* pointer, size_t size);
+    void __libc_free(void* pointer);
+    void* __libc_memalign(size_t alignment, size_t size);
+
+    void* malloc(size_t size) IDOL_HOOK_NOTHROW
+    {
+        idolRealtime::check(idolRealtime::allocation, "malloc");
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t count, size_t size) IDOL_HOOK_NOTHROW
+    {
+        idolRealtime::check(idolRealtime::allocation, "calloc");
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* pointer, size_t size) IDOL_HOOK_NOTHROW
+    {
+        idolRealtime::check(idolRealtime::allocation, "realloc");
+        return __libc_realloc(pointer, size);
+    }
+
+    void free(void* pointer) IDOL_HOOK_NOTHROW
+    {
+        if (pointer != nullptr)
+            idolRealtime::check(idolRealtime::deallocation, "free");
+        __libc_free(pointer);
+    }
+
+    int posix_memalign(void** result, size_t alignment, size_t size) IDOL_HOOK_NOTHROW
+    {
+        idolRealtime::check(idolRealtime::allocation, "posix_memalign");
+        *result = __libc_memalign(alignment, size);
+        return *result != nullptr ? 0 : ENOMEM;
+    }
+
+    void* aligned_alloc(size_t alignment, size_t size) IDOL_HOOK_NOTHROW
+    {
+        idolRealtime::check(idolRealtime::allocation, "aligned_alloc");
+        return __libc_memalign(alignment, size);
+    }
+
+    void* memalign(size_t alignment, size_t size) IDOL_HOOK_NOTHROW
+    {
+        idolRealtime::check(idolRealtime::allocation, "memalign");
+        return __libc_memalign(alignment, size);
+    }
+   #endif
+
+    //==============================================================================
+    int pthread_mutex_lock(pthread_mutex_t* mutex) IDOL_HOOK_NOTHROW
+    {
+        idolRealtime::check(idolRealtime::lock, "pthread_mutex_lock");
+        return IDOL_NEXT(pthread_mutex_lock)(mutex);
+    }
+
+    int pthread_rwlock_rdlock(pthread_rwlock_t* rwlock) IDOL_HOOK_NOTHROW
+    {
+        idolRealtime::check(idolRealtime::lock, "pthread_rwlock_rdlock");
+        return IDOL_NEXT(pthread_rwlock_rdlock)(rwlock);
+    }
+
+    int pthread_rwlock_wrlock(pthread_rwlock_t* rwlock) IDOL_HOOK_NOTHROW
+    {
+        idolRealtime::check(idolRealtime::lock, "pthread_rwlock_wrlock");
+        return IDOL_NEXT(pthread_rwlock_wrlock)(rwlock);
+    }
+
+    int pthread_cond_wait(pthread_cond_t* condition, pthread_mutex_t* mutex)
+    {
+        idolRealtime::check(idolRealtime::lock, "pthread_cond_wait");
+        return IDOL_NEXT_VERSIONED(pthread_cond_wait, IDOL_CONDVAR_VERSION)(condition, mutex);
+    }
+
+    int pthread_cond_timedwait(pthread_cond_t* condition, pthread_mutex_t* mutex, const struct timespec* time)
+    {
+        idolRealtime::check(idolRealtime::lock, "pthread_cond_timedwait");
+        return IDOL_NEXT_VERSIONED(pthread_cond_timedwait, IDOL_CONDVAR_VERSION)(condition, mutex, time);
+    }
+
+   #if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 30)
+    // What std::condition_variable's timed waits use on newer glibc.
+    int pthread_cond_clockwait(pthread_cond_t* condition, pthread_mutex_t* mutex, clockid_t clock, const struct timespec* time)
+    {
+        idolRealtime::check(idolRealtime::lock, "pthread_cond_clockwait");
+        return IDOL_NEXT(pthread_cond_clockwait)(condition, mutex, clock, time);
+    }
+   #endif
+
+    int pthread_join(pthread_t thread, void** result)
+    {
+        idolRealtime::check(idolRealtime::lock, "pthread_join");
+        return IDOL_NEXT(pthread_join)(thread, result);
+    }
+
+    int sem_wait(sem_t* semaphore)
+    {
+        idolRealtime::check(idolRealtime::lock, "sem_wait");
+        return IDOL_NEXT(sem_wait)(semaphore);
+    }
+
+    //==============================================================================
+    int open(const char* path, int flags, ...)
+    {
+        idolRealtime::check(idolRealtime::blockingCall, "open");
+
+        mode_t mode = 0;
+        if ((flags & O_CREAT) != 0)
+        {
+            va_list args;
+            va_start(args, flags);
+            mode = (mode_t)va_arg(args, int);
+            va_end(args);
+        }
+        return IDOL_NEXT(open)(path, flags, mode);
+    }
+
+    int openat(int directory, const char* path, int flags, ...)
+    {
+        idolRealtime::check(idolRealtime::blockingCall, "openat");
+
+        mode_t mode = 0;
+        if ((flags & O_CREAT) != 0)
+        {
+            va_list args;
+            va_start(args, flags);
+            mode = (mode_t)va_arg(args, int);
+            va_end(args);
+        }
+        return IDOL_NEXT(openat)(directory, path, flags, mode);
+    }
+
+   #if defined(__GLIBC__)
+    // macOS gives fopen() and select() variant symbol names; there the open() and
+    // read() underneath are caught instead.
+    FILE* fopen(const char* path, const char* mode)
+    {
+        idolRealtime::check(idolRealtime::blockingCall, "fopen");
+        return IDOL_NEXT(fopen)(path, mode);
+    }
+
+    // Code built for large files calls these instead.
+    int open64(const char* path, int flags, ...)
+    {
+        idolRealtime::check(idolRealtime::blockingCall, "open64");
+
+        mode_t mode = 0;
+        if ((flags & O_CREAT) != 0)
+        {
+            va_list args;
+            va_start(args, flags);
+            mode = (mode_t)va_arg(args, int);
+            va_end(args);
+        }
+        return IDOL_NEXT(open64)(path, flags, mode);
+    }
+
+    FILE* fopen64(const char* path, const char* mode)
+    {
+        idolRealtime::check(idolRealtime::blockingCall, "fopen64");
+        return IDOL_NEXT(fopen64)(path, mode);
+    }
+   #endif
+
+    ssize_t read(int descriptor, void* buffer, size_t numBytes)
+    {
+        idolRealtime::check(idolRealtime::blockingCall, "read");
+        return IDOL_NEXT(read)(descriptor, buffer, numBytes);
+    }
+
+    ssize_t write(int descriptor, const void* buffer, size_t numBytes)
+    {
+        idolRealtime::check(idolRealtime::blockingCall, "write");
+        return IDOL_NEXT(write)(descriptor, buffer, numBytes);
+    }
+
+    int close(int descriptor)
+    {
+        idolRealtime::check(idolRealtime::blockingCall, "close");
+        return IDOL_NEXT(close)(descriptor);
+    }
+
+    int fsync(int descriptor)
+    {
+        idolRealtime::check(idolRealtime::blockingCall, "fsync");
+        return IDOL_NEXT(fsync)(descriptor);
+    }
+
+    int nanosleep(const struct timespec* duration, struct timespec* remaining)
+    {
+        idolRealtime::check(idolRealtime::blockingCall, "nanosleep");
+        return IDOL_NEXT(nanosleep)(duration, remaining);
+    }
+
+    int usleep(useconds_t microseconds)
+    {
+        idolRealtime::check(idolRealtime::blockingCall, "usleep");
+        return IDOL_NEXT(usleep)(microseconds);
+    }
+
+    unsigned int sleep(unsigned int seconds)
+    {
+        idolRealtime::check(idolRealtime::blockingCall, "sleep");
+        return IDOL_NEXT(sleep)(seconds);
+    }
+
+    int poll(struct pollfd* descriptors, nfds_t numDescriptors, int timeoutMs)
+    {
+        idolRealtime::check(idolRealtime::blockingCall, "poll");
+        return IDOL_NEXT(poll)(descriptors, numDescriptors, timeoutMs);
+    }
+
+   #if defined(__GLIBC__)
+    int select(int numDescriptors, fd_set* readSet, fd_set* writeSet, fd_set* errorSet, struct timeval* timeout)
+    {
+        idolRealtime::check(idolRealtime::blockingCall, "select");
+        return IDOL_NEXT(select)(numDescriptors, readSet, writeSet, errorSet, timeout);
+    }
+   #endif
+}
+#endif
+
+//==============================================================================
+#if ! defined(__GLIBC__)
+// Elsewhere the C allocator can't be replaced from inside the app, so C++ allocations
+// are caught here instead; on Linux they arrive through malloc() and free().
+void* operator new(std::size_t size)
+{
+    idolRealtime::check(idolRealtime::allocation, "operator new");
+    if (auto* pointer = std::malloc(size > 0 ? size : 1))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    idolRealtime::check(idolRealtime::allocation, "operator new[]");
+    if (auto* pointer = std::malloc(size > 0 ? size : 1))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    idolRealtime::check(idolRealtime::allocation, "operator new");
+    return std::malloc(size > 0 ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    idolRealtime::check(idolRealtime::allocation, "operator new[]");
+    return std::malloc(size > 0 ? size : 1);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    if (pointer != nullptr)
+        idolRealtime::check(idolRealtime::deallocation, "operator delete");
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    if (pointer != nullptr)
+        idolRealtime::check(idolRealtime::deallocation, "operator delete[]");
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept                 { operator delete(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept               { operator delete[](pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept       { operator delete(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept     { operator delete[](pointer); }
+#endif
+
+#endif
@@ -0,0 +1,103 @@
+/*
+  ==============================================================================
+
+    StackTrace.cpp
+
+  ==============================================================================
+*/
+
+#include "StackTrace.h"
+
+#if JUCE_LINUX || JUCE_MAC
+ #include <cxxabi.h>
+ #include <execinfo.h>
+#elif JUCE_WINDOWS
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <windows.h>
+#endif
+
+#if JUCE_MSVC
+ #define IDOL_NO_INLINE __declspec(noinline)
+#else
+ #define IDOL_NO_INLINE __attribute__((noinline))
+#endif
+
+// Kept out of line, so there is always exactly one frame of its own to drop.
+IDOL_NO_INLINE int StackTrace::capture(void** frames, int maxFrames) noexcept
+{
+   #if JUCE_LINUX || JUCE_MAC
+    // The first frame is this function. Dropping it after the call also stops the
+    // compiler turning the call into a jump, which would leave no frame to drop.
+    const int numCaptured = ::backtrace(frames, maxFrames);
+    if (numCaptured <= 1)
+        return 0;
+
+    std::memmove(frames, frames + 1, sizeof(void*) * (size_t)(numCaptured - 1));
+    return numCaptured - 1;
+   #elif JUCE_WINDOWS
+    return (int)RtlCaptureStackBackTrace(1, (DWORD)maxFrames, frames, nullptr);
+   #else
+    juce::ignoreUnused(frames, maxFrames);
+    return 0;
+   #endif
+}
+
+juce::StringArray StackTrace::symbolise(void* const* frames, int numFrames)
+{
+    juce::StringArray lines;
+
+   #if JUCE_LINUX || JUCE_MAC
+    if (char** symbols = ::backtrace_symbols(frames, numFrames))
+    {
+        for (int i = 0; i < numFrames; ++i)
+        {
+            juce::String line(symbols[i]);
+
+            // Demangle the one C++ name each line has, if it has one.
+            const auto mangledStart = line.indexOf("_Z");
+            if (mangledStart >= 0)
+            {
+                auto mangledEnd = mangledStart;
+                while (mangledEnd < line.length() && line[mangledEnd] != '+' && line[mangledEnd] != ')'
+                       && !juce::CharacterFunctions::isWhitespace(line[mangledEnd]))
+                    ++mangledEnd;
+
+                int status = 0;
+                const auto mangled = line.substring(mangledStart, mangledEnd);
+                if (char* demangled = abi::__cxa_demangle(mangled.toRawUTF8(), nullptr, nullptr, &status))
+                {
+                    if (status == 0)
+                        line = line.replaceSection(mangledStart, mangledEnd - mangledStart, demangled);
+                    std::free(demangled);
+                }
+            }
+
+            lines.add(line);
+        }
+        std::free(symbols);
+    }
+   #elif JUCE_WINDOWS
+    for (int i = 0; i < numFrames; ++i)
+    {
+        HMODULE module = nullptr;
+        wchar_t moduleName[MAX_PATH] = {};
+        if (GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                               (LPCWSTR)frames[i], &module)
+            && GetModuleFileNameW(module, moduleName, MAX_PATH) > 0)
+        {
+            const auto offset = (juce::pointer_sized_uint)frames[i] - (juce::pointer_sized_uint)module;
+            lines.add(juce::File(juce::String(moduleName)).getFileName() + "+0x" + juce::String::toHexString((juce::int64)offset));
+        }
+        else
+        {
+            lines.add("0x" + juce::String::toHexString((juce::pointer_sized_int)frames[i]));
+        }
+    }
+   #else
+    juce::ignoreUnused(frames, numFrames);
+   #endif
+
+    return lines;
+}
@@ -0,0 +1,33 @@
+/*
+  ==============================================================================
+
+    StackTrace.h
+    (Capturing and symbolising call stacks, for the diagnostics that report them)
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+    Stacks are captured as raw return addresses, which is cheap enough to do while
+    something is going wrong, and turned into text later, on whichever thread writes
+    the report.
+
+    - Linux and macOS: "module(function+offset) [address]", C++ names demangled.
+      Linux only knows the names the executable exports, so functions of our own can
+      come out as bare offsets; run those through addr2line.
+    - Windows: "module+offset"; load the .pdb in a debugger to turn them into lines.
+*/
+namespace StackTrace
+{
+    /** Fills frames with the calling thread's return addresses, innermost first and
+        starting with the caller of capture(), and returns how many there were.
+        Doesn't lock or allocate once it has run once. */
+    int capture(void** frames, int maxFrames) noexcept;
+
+    /** One line per frame. */
+    juce::StringArray symbolise(void* const* frames, int numFrames);
+}
@@ -0,0 +1,556 @@
+/*
+  ==============================================================================
+
+    StallDetector.cpp
+
+  ==============================================================================
+*/
+
+#include "StallDetector.h"
+#include "StackTrace.h"
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+
+#if JUCE_LINUX || JUCE_MAC
+ #include <cerrno>
+ #include <csignal>
+ #include <pthread.h>
+#elif JUCE_WINDOWS
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <windows.h>
+#endif
+
+namespace StallIds
+{
+    const juce::Identifier STALL_DETECTOR("STALL_DETECTOR");
+    const juce::Identifier enabled("enabled");
+    const juce::Identifier thresholdMs("thresholdMs");
+    const juce::Identifier sampleIntervalMs("sampleIntervalMs");
+    const juce::Identifier pingIntervalMs("pingIntervalMs");
+}
+
+//==============================================================================
+#if JUCE_LINUX || JUCE_MAC
+namespace
+{
+    /** Handed to the message thread's signal handler; only touched through atomics there. */
+    struct SignalRequest
+    {
+        void** frames = nullptr;
+        int maxFrames = 0;
+        std::atomic<int> numFrames{ -1 };
+    };
+
+    std::atomic<SignalRequest*> pendingRequest{ nullptr };
+
+    void handleSampleSignal(int)
+    {
+        const int savedErrno = errno;
+
+        if (auto* request = pendingRequest.exchange(nullptr))
+            request->numFrames.store(StackTrace::capture(request->frames, request->maxFrames), std::memory_order_release);
+
+        errno = savedErrno;
+    }
+}
+
+/** Made on the message thread, used from the watchdog. */
+class StallDetector::Sampler
+{
+public:
+    Sampler()
+        : messageThread(pthread_self())
+    {
+        // The first backtrace() loads the unwinder; that mustn't happen inside the handler.
+        void* frames[4];
+        juce::ignoreUnused(StackTrace::capture(frames, 4));
+
+        // Left in place for good: a signal that arrives late finds no request and does
+        // nothing, where the default action would end the process.
+        static const bool handlerInstalled = []
+        {
+            struct sigaction action {};
+            action.sa_handler = handleSampleSignal;
+            action.sa_flags = SA_RESTART;
+            sigemptyset(&action.sa_mask);
+            return sigaction(SIGPROF, &action, nullptr) == 0;
+        }();
+
+        installed = handlerInstalled;
+    }
+
+    int sample(void** frames, int frameLimit)
+    {
+        if (!installed)
+            return 0;
+
+        // The handler's own frame and the signal trampoline come first.
+        constexpr int signalFrames = 2;
+        std::array<void*, StallDetector::maxFrames + signalFrames> captured{};
+
+        SignalRequest request;
+        request.frames = captured.data();
+        request.maxFrames = juce::jmin(frameLimit + signalFrames, (int)captured.size());
+        pendingRequest.store(&request);
+
+        if (pthread_kill(messageThread, SIGPROF) != 0)
+        {
+            pendingRequest.store(nullptr);
+            return 0;
+        }
+
+        for (int i = 0; i < 100 && request.numFrames.load(std::memory_order_acquire) < 0; ++i)
+            juce::Thread::sleep(1);
+
+        if (request.numFrames.load(std::memory_order_acquire) < 0)
+        {
+            // Taking it back before the handler does means it will never write to it...
+            if (pendingRequest.exchange(nullptr) == &request)
+                return 0;
+
+            // ...otherwise the handler is using our frames and has to be let finish.
+            while (request.numFrames.load(std::memory_order_acquire) < 0)
+                juce::Thread::yield();
+        }
+
+        const int numFrames = juce::jlimit(0, frameLimit, request.numFrames.load() - signalFrames);
+        std::copy_n(captured.begin() + signalFrames, numFrames, frames);
+        return numFrames;
+    }
+
+private:
+    const pthread_t messageThread;
+    bool installed = false;
+};
+
+#elif JUCE_WINDOWS && JUCE_64BIT && JUCE_INTEL
+class StallDetector::Sampler
+{
+public:
+    Sampler()
+        : stackCopy(maxStackCopy)
+    {
+        DuplicateHandle(GetCurrentProcess(), GetCurrentThread(), GetCurrentProcess(), &messageThread,
+                        THREAD_SUSPEND_RESUME | THREAD_GET_CONTEXT | THREAD_QUERY_INFORMATION, FALSE, 0);
+    }
+
+    ~Sampler()
+    {
+        if (messageThread != nullptr)
+            CloseHandle(messageThread);
+    }
+
+    int sample(void** frames, int frameLimit)
+    {
+        if (messageThread == nullptr)
+            return 0;
+
+        CONTEXT context {};
+        context.ContextFlags = CONTEXT_FULL;
+        const auto copyStart = (juce::pointer_sized_uint)stackCopy.data();
+        juce::pointer_sized_uint stackBottom = 0;
+        size_t stackSize = 0;
+
+        if (SuspendThread(messageThread) == (DWORD)-1)
+            return 0;
+
+        // Nothing between here and ResumeThread may allocate or lock: the suspended
+        // thread could be holding the very lock that would be needed.
+        if (GetThreadContext(messageThread, &context))
+        {
+            MEMORY_BASIC_INFORMATION info {};
+            if (VirtualQuery((LPCVOID)context.Rsp, &info, sizeof(info)) != 0)
+            {
+                // From the stack pointer up to the end of the committed stack.
+                stackBottom = (juce::pointer_sized_uint)context.Rsp;
+                const auto stackTop = (juce::pointer_sized_uint)info.BaseAddress + info.RegionSize;
+                stackSize = juce::jmin((size_t)(stackTop - stackBottom), stackCopy.size());
+                std::memcpy(stackCopy.data(), (const void*)stackBottom, stackSize);
+            }
+        }
+
+        ResumeThread(messageThread);
+
+        if (stackSize == 0)
+            return 0;
+
+        // Point everything that pointed into the real stack into the copy instead.
+        const auto rebase = [stackBottom, stackSize, copyStart](DWORD64& value)
+        {
+            if (value >= stackBottom && value < stackBottom + stackSize)
+                value = value - stackBottom + copyStart;
+        };
+
+        for (size_t offset = 0; offset + sizeof(DWORD64) <= stackSize; offset += sizeof(DWORD64))
+            rebase(*reinterpret_cast<DWORD64*>(stackCopy.data() + offset));
+
+        for (auto* reg : { &context.Rsp, &context.Rbp, &context.Rbx, &context.Rsi, &context.Rdi,
+                           &context.R12, &context.R13, &context.R14, &context.R15 })
+            rebase(*reg);
+
+        const auto isInCopy = [copyStart, stackSize](DWORD64 address)
+        {
+            return address >= copyStart && address + sizeof(DWORD64) <= copyStart + stackSize;
+        };
+
+        int numFrames = 0;
+        while (numFrames < frameLimit && context.Rip != 0 && isInCopy(context.Rsp))
+        {
+            frames[numFrames++] = (void*)context.Rip;
+
+            DWORD64 imageBase = 0;
+            if (auto* function = RtlLookupFunctionEntry(context.Rip, &imageBase, nullptr))
+            {
+                void* handlerData = nullptr;
+                DWORD64 establisherFrame = 0;
+                RtlVirtualUnwind(UNW_FLAG_NHANDLER, imageBase, context.Rip, function, &context,
+                                 &handlerData, &establisherFrame, nullptr);
+            }
+            else
+            {
+                // A leaf function: the return address is on top of the stack.
+                context.Rip = *reinterpret_cast<DWORD64*>(context.Rsp);
+                context.Rsp += sizeof(DWORD64);
+            }
+        }
+
+        return numFrames;
+    }
+
+private:
+    static constexpr size_t maxStackCopy = 1 << 20;    // the main thread's default stack size
+
+    HANDLE messageThread = nullptr;
+    std::vector<juce::uint8> stackCopy;
+};
+
+#else
+class StallDetector::Sampler
+{
+public:
+    int sample(void**, int) { return 0; }
+};
+#endif
+
+//==============================================================================
+std::array<std::atomic<const char*>, StallDetector::maxOperationDepth> StallDetector::operations{};
+std::atomic<int> StallDetector::operationDepth{ 0 };
+
+StallDetector::StallDetector()
+    : juce::Thread("Stall detector"),
+      stallsTotal(MetricsRegistry::getInstance().addCounter("idol_message_thread_stalls_total",
+          "Times the message thread didn't answer within the stall threshold.")),
+      stallSeconds(MetricsRegistry::getInstance().addHistogram("idol_message_thread_stall_seconds",
+          "How long each message thread stall lasted.", { 0.5, 1.0, 2.0, 5.0, 10.0, 30.0, 60.0 }))
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+    setSettings(settings);
+}
+
+StallDetector::~StallDetector()
+{
+    stopWatching();
+}
+
+bool StallDetector::canSampleStacks() noexcept
+{
+   #if JUCE_LINUX || JUCE_MAC || (JUCE_WINDOWS && JUCE_64BIT && JUCE_INTEL)
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+void StallDetector::setSettings(const Settings& newSettings)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+    settings = newSettings;
+    settings.thresholdMs = juce::jlimit(100.0, 60000.0, settings.thresholdMs);
+    settings.sampleIntervalMs = juce::jlimit(1.0, 1000.0, settings.sampleIntervalMs);
+    settings.pingIntervalMs = juce::jlimit(10.0, 5000.0, settings.pingIntervalMs);
+
+    thresholdMs = settings.thresholdMs;
+    sampleIntervalMs = settings.sampleIntervalMs;
+    pingIntervalMs = settings.pingIntervalMs;
+
+    if (settings.enabled)
+        startWatching();
+    else
+        stopWatching();
+}
+
+void StallDetector::startWatching()
+{
+    if (isThreadRunning())
+        return;
+
+    if (canSampleStacks() && sampler == nullptr)
+        sampler = std::make_unique<Sampler>();
+
+    samples.resize((size_t)maxSamples);
+    pongReceived.reset();
+    startThread(juce::Thread::Priority::high);
+}
+
+void StallDetector::stopWatching()
+{
+    signalThreadShouldExit();
+    notify();
+    pongReceived.signal();
+    stopThread(2000);
+    cancelPendingUpdate();
+
+    sampler.reset();
+    samples = {};
+}
+
+juce::String StallDetector::getLastReport() const
+{
+    const juce::ScopedLock sl(reportLock);
+    return lastReport;
+}
+
+juce::File StallDetector::getReportFolder()
+{
+    return juce::File::getSpecialLocation(juce::File::SpecialLocationType::userApplicationDataDirectory)
+        .getChildFile(ProjectInfo::companyName)
+        .getChildFile(ProjectInfo::projectName)
+        .getChildFile("Stalls");
+}
+
+//==============================================================================
+void StallDetector::handleAsyncUpdate()
+{
+    pongReceived.signal();
+}
+
+void StallDetector::run()
+{
+    // The first answer only says the message loop is running.
+    triggerAsyncUpdate();
+    while (!pongReceived.wait(100))
+        if (threadShouldExit())
+            return;
+
+    while (!threadShouldExit())
+    {
+        wait(juce::roundToInt(pingIntervalMs.load()));
+        if (threadShouldExit())
+            return;
+
+        pongReceived.reset();
+        const auto pingSentMs = juce::Time::getMillisecondCounterHiRes();
+        triggerAsyncUpdate();
+
+        if (!pongReceived.wait(juce::roundToInt(thresholdMs.load())))
+            watchStall(pingSentMs);
+    }
+}
+
+void StallDetector::watchStall(double pingSentMs)
+{
+    int numSamplesTaken = 0;
+
+    do
+    {
+        if (threadShouldExit())
+            return;
+
+        if (numSamplesTaken < (int)samples.size())
+            takeSample(samples[(size_t)numSamplesTaken++]);
+    }
+    while (!pongReceived.wait(juce::roundToInt(sampleIntervalMs.load())));
+
+    // Timed from the ping, so the time the ping spent queued behind the stall counts.
+    const auto stallMs = juce::Time::getMillisecondCounterHiRes() - pingSentMs;
+    numStalls.fetch_add(1);
+    stallsTotal.increment();
+    stallSeconds.observe(stallMs / 1000.0);
+
+    publishReport(buildReport(stallMs, numSamplesTaken));
+}
+
+void StallDetector::takeSample(Sample& sample)
+{
+    sample.numOperations = juce::jlimit(0, maxOperationDepth, operationDepth.load(std::memory_order_acquire));
+    for (int i = 0; i < sample.numOperations; ++i)
+        sample.operations[(size_t)i] = operations[(size_t)i].load(std::memory_order_relaxed);
+
+    sample.numFrames = sampler != nullptr ? sampler->sample(sample.frames.data(), maxFrames) : 0;
+}
+
+//==============================================================================
+juce::String StallDetector::buildReport(double stallMs, int numSamplesTaken) const
+{
+    constexpr int maxHotFrames = 25;
+
+    const auto startTime = juce::Time::getCurrentTime() - juce::RelativeTime::milliseconds((juce::int64)stallMs);
+    const auto share = [numSamplesTaken](int count)
+    {
+        return juce::String(juce::roundToInt(100.0 * count / juce::jmax(1, numSamplesTaken))).paddedLeft(' ', 3) + "%";
+    };
+
+    juce::String report;
+    report << "Message thread stalled for " << juce::String(stallMs / 1000.0, 2) << " s, from "
+           << startTime.formatted("%Y-%m-%d %H:%M:%S") << "\n";
+
+    // What the message thread said it was doing, most often first.
+    std::map<juce::String, int> operationCounts;
+    for (int i = 0; i < numSamplesTaken; ++i)
+    {
+        const auto& sample = samples[(size_t)i];
+        juce::StringArray names;
+        for (int j = 0; j < sample.numOperations; ++j)
+            if (sample.operations[(size_t)j] != nullptr)
+                names.add(sample.operations[(size_t)j]);
+
+        ++operationCounts[names.isEmpty() ? juce::String("none marked") : names.joinIntoString(" > ")];
+    }
+
+    std::vector<std::pair<juce::String, int>> sortedOperations(operationCounts.begin(), operationCounts.end());
+    std::stable_sort(sortedOperations.begin(), sortedOperations.end(),
+                     [](const auto& a, const auto& b) { return a.second > b.second; });
+
+    for (const auto& [name, count] : sortedOperations)
+        report << "Operation: " << name << " (" << count << " of " << numSamplesTaken << " samples)\n";
+
+    report << numSamplesTaken << " samples, every " << juce::String(sampleIntervalMs.load(), 0) << " ms";
+    if (numSamplesTaken >= maxSamples)
+        report << " (only the first " << maxSamples << " were taken)";
+    report << "\n";
+
+    if (sampler == nullptr)
+        return report << "Stacks can't be sampled on this platform.\n";
+
+    // How many samples each frame was on the stack in, counting recursion once; ties
+    // go to the frame nearer the top, which is the more specific one.
+    struct FrameCount
+    {
+        int count = 0;
+        int minDepth = maxFrames;
+    };
+
+    std::unordered_map<void*, FrameCount> frameCounts;
+    std::map<std::vector<void*>, int> stackCounts;
+
+    for (int i = 0; i < numSamplesTaken; ++i)
+    {
+        const auto& sample = samples[(size_t)i];
+        if (sample.numFrames == 0)
+            continue;
+
+        for (int depth = 0; depth < sample.numFrames; ++depth)
+        {
+            const auto frames = sample.frames.begin();
+            if (std::find(frames, frames + depth, sample.frames[(size_t)depth]) != frames + depth)
+                continue;
+
+            auto& frameCount = frameCounts[sample.frames[(size_t)depth]];
+            ++frameCount.count;
+            frameCount.minDepth = juce::jmin(frameCount.minDepth, depth);
+        }
+
+        ++stackCounts[std::vector<void*>(sample.frames.begin(), sample.frames.begin() + sample.numFrames)];
+    }
+
+    if (frameCounts.empty())
+        return report << "No stack could be sampled.\n";
+
+    std::vector<std::pair<void*, FrameCount>> hotFrames(frameCounts.begin(), frameCounts.end());
+    std::sort(hotFrames.begin(), hotFrames.end(), [](const auto& a, const auto& b)
+        {
+            return a.second.count != b.second.count ? a.second.count > b.second.count
+                                                    : a.second.minDepth < b.second.minDepth;
+        });
+    hotFrames.resize(juce::jmin(hotFrames.size(), (size_t)maxHotFrames));
+
+    std::vector<void*> hotAddresses;
+    for (const auto& hotFrame : hotFrames)
+        hotAddresses.push_back(hotFrame.first);
+    const auto hotNames = StackTrace::symbolise(hotAddresses.data(), (int)hotAddresses.size());
+
+    report << "\nHot frames (share of samples each was on the stack):\n";
+    for (size_t i = 0; i < hotFrames.size(); ++i)
+        report << "  " << share(hotFrames[i].second.count) << "  " << hotNames[(int)i] << "\n";
+
+    const auto commonStack = std::max_element(stackCounts.begin(), stackCounts.end(),
+                                              [](const auto& a, const auto& b) { return a.second < b.second; });
+    const auto commonNames = StackTrace::symbolise(commonStack->first.data(), (int)commonStack->first.size());
+
+    report << "\nMost common stack (" << commonStack->second << " of " << numSamplesTaken << " samples):\n";
+    for (int i = 0; i < commonNames.size(); ++i)
+        report << "  " << juce::String(i).paddedLeft(' ', 2) << "  " << commonNames[i] << "\n";
+
+    return report;
+}
+
+void StallDetector::publishReport(const juce::String& report)
+{
+    {
+        const juce::ScopedLock sl(reportLock);
+        lastReport = report;
+    }
+
+    const auto folder = getReportFolder();
+    folder.createDirectory();
+
+    const auto file = folder.getChildFile("stall-" + juce::Time::getCurrentTime().formatted("%Y%m%d-%H%M%S") + ".txt")
+                            .getNonexistentSibling();
+    const bool written = file.replaceWithText(report);
+
+    // The names sort oldest first.
+    auto oldReports = folder.findChildFiles(juce::File::findFiles, false, "stall-*.txt");
+    oldReports.sort();
+    for (int i = 0; i < oldReports.size() - maxReportFiles; ++i)
+        oldReports.getReference(i).deleteFile();
+
+    juce::Logger::writeToLog("Stall detector: " + report
+                             + (written ? "Written to " + file.getFullPathName() : juce::String("Couldn't write the report")));
+}
+
+//==============================================================================
+juce::ValueTree StallDetector::getState() const
+{
+    juce::ValueTree state(StallIds::STALL_DETECTOR);
+    state.setProperty(StallIds::enabled, settings.enabled, nullptr);
+    state.setProperty(StallIds::thresholdMs, settings.thresholdMs, nullptr);
+    state.setProperty(StallIds::sampleIntervalMs, settings.sampleIntervalMs, nullptr);
+    state.setProperty(StallIds::pingIntervalMs, settings.pingIntervalMs, nullptr);
+    return state;
+}
+
+void StallDetector::restoreState(const juce::ValueTree& state)
+{
+    if (!state.hasType(StallIds::STALL_DETECTOR))
+        return;
+
+    const Settings defaults;
+    Settings newSettings;
+    newSettings.enabled = state.getProperty(StallIds::enabled, defaults.enabled);
+    newSettings.thresholdMs = state.getProperty(StallIds::thresholdMs, defaults.thresholdMs);
+    newSettings.sampleIntervalMs = state.getProperty(StallIds::sampleIntervalMs, defaults.sampleIntervalMs);
+    newSettings.pingIntervalMs = state.getProperty(StallIds::pingIntervalMs, defaults.pingIntervalMs);
+    setSettings(newSettings);
+}
+
+//==============================================================================
+StallDetector::ScopedOperation::ScopedOperation(const char* name) noexcept
+    : isActive(juce::MessageManager::existsAndIsCurrentThread())
+{
+    if (!isActive)
+        return;
+
+    const int depth = operationDepth.load(std::memory_order_relaxed);
+    if (depth < maxOperationDepth)
+        operations[(size_t)depth].store(name, std::memory_order_relaxed);
+    operationDepth.store(depth + 1, std::memory_order_release);
+}
+
+StallDetector::ScopedOperation::~ScopedOperation()
+{
+    if (isActive)
+        operationDepth.store(operationDepth.load(std::memory_order_relaxed) - 1, std::memory_order_release);
+}
@@ -0,0 +1,147 @@
+/*
+  ==============================================================================
+
+    StallDetector.h
+    (Notices when the message thread stops answering and samples what it is doing)
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "MetricsRegistry.h"
+#include <array>
+#include <vector>
+
+/** Set to 0 to compile every IDOL_STALL_OPERATION marker away. */
+#ifndef IDOL_ENABLE_STALL_OPERATIONS
+ #define IDOL_ENABLE_STALL_OPERATIONS 1
+#endif
+
+/**
+    A watchdog thread posts a ping to the message loop every pingIntervalMs. If the
+    ping hasn't been answered after thresholdMs, the UI has frozen: from then until
+    it answers, the watchdog samples the message thread's stack every
+    sampleIntervalMs. Once it answers, the samples are added up into a report: which
+    frames were on the stack most often, the most common whole stack, and the
+    operation the message thread said it was in, from IDOL_STALL_OPERATION("name").
+
+    The report is logged and written to a timestamped file in the Stalls folder of
+    the app's data folder, where the last maxReportFiles are kept.
+
+    Sampling another thread's stack needs help from the platform:
+
+    - Linux and macOS: the message thread is sent SIGPROF and captures its own stack
+      in the handler. Signals are only sent while a stall is being sampled; a sleep
+      they interrupt ends early, and a poll() or select() returns EINTR, as it would
+      for any other signal.
+    - Windows (x64): the message thread is suspended for as long as it takes to copy
+      its stack, and the copy is unwound once it is running again, so nothing the
+      suspended thread might hold (the heap lock, the loader lock) is ever needed.
+    - Elsewhere stalls are still reported, with the operation but no stacks.
+
+    The first ping only tells the watchdog the message loop has started, so the
+    time spent starting up isn't reported as a stall.
+*/
+class StallDetector : private juce::Thread,
+                      private juce::AsyncUpdater
+{
+public:
+    struct Settings
+    {
+        bool enabled = true;
+        double thresholdMs = 500.0;     // unanswered for this long is a stall
+        double sampleIntervalMs = 20.0;
+        double pingIntervalMs = 100.0;
+    };
+
+    static constexpr int maxFrames = 64;
+    static constexpr int maxSamples = 1000;         // samples past this aren't taken, only the time is counted
+    static constexpr int maxOperationDepth = 8;
+    static constexpr int maxReportFiles = 20;
+
+    /** Message thread; starts watching if the default settings say so. */
+    StallDetector();
+    ~StallDetector() override;
+
+    /** Message thread. */
+    void setSettings(const Settings& newSettings);
+    Settings getSettings() const { return settings; }
+
+    /** True if this platform can sample the message thread's stack. */
+    static bool canSampleStacks() noexcept;
+
+    juce::uint64 getNumStalls() const noexcept { return numStalls.load(); }
+    /** The newest report, or empty if there hasn't been a stall. */
+    juce::String getLastReport() const;
+
+    /** Where reports are written. */
+    static juce::File getReportFolder();
+
+    juce::ValueTree getState() const;
+    void restoreState(const juce::ValueTree& state);
+
+    /** Names what the message thread is doing until the scope ends; scopes nest. The
+        name must be a literal. Off the message thread it does nothing. */
+    class ScopedOperation
+    {
+    public:
+        explicit ScopedOperation(const char* name) noexcept;
+        ~ScopedOperation();
+
+    private:
+        bool isActive = false;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedOperation)
+    };
+
+private:
+    class Sampler;
+
+    struct Sample
+    {
+        std::array<void*, maxFrames> frames{};
+        int numFrames = 0;
+        std::array<const char*, maxOperationDepth> operations{};
+        int numOperations = 0;
+    };
+
+    void run() override;
+    void handleAsyncUpdate() override;
+
+    void startWatching();
+    void stopWatching();
+    void watchStall(double pingSentMs);
+    void takeSample(Sample& sample);
+    juce::String buildReport(double stallMs, int numSamplesTaken) const;
+    void publishReport(const juce::String& report);
+
+    // Written by the message thread, read by the watchdog.
+    static std::array<std::atomic<const char*>, maxOperationDepth> operations;
+    static std::atomic<int> operationDepth;
+
+    Settings settings;  // message thread
+    std::atomic<double> thresholdMs{ 500.0 };
+    std::atomic<double> sampleIntervalMs{ 20.0 };
+    std::atomic<double> pingIntervalMs{ 100.0 };
+
+    juce::WaitableEvent pongReceived;
+    std::unique_ptr<Sampler> sampler;
+    std::vector<Sample> samples;        // watchdog thread; allocated up front
+    std::atomic<juce::uint64> numStalls{ 0 };
+    MetricsRegistry::Counter& stallsTotal;
+    MetricsRegistry::Histogram& stallSeconds;
+
+    mutable juce::CriticalSection reportLock;
+    juce::String lastReport;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StallDetector)
+};
+
+#if IDOL_ENABLE_STALL_OPERATIONS
+ #define IDOL_STALL_OPERATION(name) \
+    const StallDetector::ScopedOperation JUCE_JOIN_MACRO(idolStallOperation_, __LINE__)(name)
+#else
+ #define IDOL_STALL_OPERATION(name)
+#endif
@@ -0,0 +1,243 @@
+/*
+  ==============================================================================
+
+    TraceRecorder.cpp
+
+  ==============================================================================
+*/
+
+#include "TraceRecorder.h"
+
+std::atomic<bool> TraceRecorder::capturing{ false };
+
+namespace
+{
+    // The buffer this thread writes into, and which capture it was claimed for.
+    thread_local void* currentThreadBuffer = nullptr;
+    thread_local juce::uint32 currentThreadGeneration = 0;
+
+    void copyName(char* destination, const char* source) noexcept
+    {
+        if (source == nullptr)
+            source = "";
+
+        int i = 0;
+        for (; i < TraceRecorder::maxNameLength - 1 && source[i] != 0; ++i)
+            destination[i] = source[i];
+
+        destination[i] = 0;
+    }
+
+    juce::String quoted(const juce::String& text)
+    {
+        return juce::JSON::toString(juce::var(text));
+    }
+}
+
+TraceRecorder& TraceRecorder::getInstance()
+{
+    static TraceRecorder instance;
+    return instance;
+}
+
+void TraceRecorder::start()
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+    capturing = false;
+
+    // Made once and kept: a thread may still hold a pointer into them from the last capture.
+    if (!buffersAllocated)
+    {
+        for (auto& buffer : buffers)
+            buffer.events.reset(new Event[(size_t)maxEventsPerThread]);
+
+        buffersAllocated = true;
+    }
+
+    for (auto& buffer : buffers)
+    {
+        buffer.numWritten = 0;
+        buffer.threadName = nullptr;
+        buffer.threadId = nullptr;
+        buffer.ownName.clear();
+    }
+
+    numBuffersClaimed = 0;
+    captureStartTicks = juce::Time::getHighResolutionTicks();
+    ++generation;
+    capturing = true;
+
+    DBG("TraceRecorder: capture started");
+}
+
+void TraceRecorder::stop()
+{
+    if (!capturing.exchange(false))
+        return;
+
+    // Events that were already past their check land in a moment.
+    juce::Thread::sleep(20);
+    DBG("TraceRecorder: capture stopped");
+}
+
+void TraceRecorder::nameCurrentThread(const char* name) noexcept
+{
+    if (!isCapturing())
+        return;
+
+    if (auto* buffer = getBufferForCurrentThread())
+        buffer->threadName.store(name, std::memory_order_relaxed);
+}
+
+TraceRecorder::ThreadBuffer* TraceRecorder::getBufferForCurrentThread() noexcept
+{
+    auto& recorder = getInstance();
+    const auto currentGeneration = recorder.generation.load(std::memory_order_acquire);
+
+    if (currentThreadGeneration != currentGeneration)
+    {
+        currentThreadGeneration = currentGeneration;
+        currentThreadBuffer = nullptr;
+
+        const int index = recorder.numBuffersClaimed.fetch_add(1);
+        if (index < maxThreads)
+        {
+            auto& buffer = recorder.buffers[(size_t)index];
+            buffer.threadId = juce::Thread::getCurrentThreadId();
+
+            if (juce::MessageManager::existsAndIsCurrentThread())
+                buffer.threadName = "Message thread";
+            else if (auto* thread = juce::Thread::getCurrentThread())
+                buffer.ownName = thread->getThreadName();
+
+            currentThreadBuffer = &buffer;
+        }
+    }
+
+    return static_cast<ThreadBuffer*>(currentThreadBuffer);
+}
+
+void TraceRecorder::record(const char* category, const char* name, juce::int64 startTicks, juce::int64 endTicks) noexcept
+{
+    auto* buffer = getBufferForCurrentThread();
+    if (buffer == nullptr)
+        return;
+
+    // Single writer per buffer; the oldest events are overwritten once it is full.
+    const auto index = buffer->numWritten.load(std::memory_order_relaxed);
+    auto& event = buffer->events[(size_t)(index % (juce::uint64)maxEventsPerThread)];
+    event.category = category;
+    copyName(event.name, name);
+    event.startTicks = startTicks;
+    event.endTicks = endTicks;
+    buffer->numWritten.store(index + 1, std::memory_order_release);
+}
+
+//==============================================================================
+TraceRecorder::ScopedEvent::ScopedEvent(const char* eventCategory, const char* name) noexcept
+{
+    if (!isCapturing())
+        return;
+
+    category = eventCategory;
+    staticName = name;
+    startTicks = juce::Time::getHighResolutionTicks();
+}
+
+TraceRecorder::ScopedEvent::ScopedEvent(const char* eventCategory, const juce::String& name) noexcept
+{
+    if (!isCapturing())
+        return;
+
+    category = eventCategory;
+    name.copyToUTF8(copiedName, (size_t)maxNameLength);
+    startTicks = juce::Time::getHighResolutionTicks();
+}
+
+TraceRecorder::ScopedEvent::~ScopedEvent()
+{
+    if (startTicks == 0 || !isCapturing())
+        return;
+
+    getInstance().record(category, staticName != nullptr ? staticName : copiedName,
+                         startTicks, juce::Time::getHighResolutionTicks());
+}
+
+//==============================================================================
+juce::File TraceRecorder::getDefaultTraceFile()
+{
+    return juce::File::getSpecialLocation(juce::File::SpecialLocationType::userApplicationDataDirectory)
+        .getChildFile(ProjectInfo::companyName)
+        .getChildFile(ProjectInfo::projectName)
+        .getChildFile("Traces")
+        .getChildFile("trace-" + juce::Time::getCurrentTime().formatted("%Y%m%d-%H%M%S") + ".json");
+}
+
+bool TraceRecorder::writeChromeTrace(const juce::File& file)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+    stop();
+
+    if (!buffersAllocated)
+        return false;
+
+    file.getParentDirectory().createDirectory();
+    juce::TemporaryFile temp(file);
+
+    {
+        juce::FileOutputStream out(temp.getFile());
+        if (!out.openedOk())
+            return false;
+
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+            << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":" << quoted(ProjectInfo::projectName) << "}}";
+
+        const auto toMicroseconds = [this](juce::int64 ticks)
+        {
+            return juce::Time::highResolutionTicksToSeconds(ticks - captureStartTicks) * 1.0e6;
+        };
+
+        const int numThreads = juce::jmin(numBuffersClaimed.load(), maxThreads);
+        for (int i = 0; i < numThreads; ++i)
+        {
+            const auto& buffer = buffers[(size_t)i];
+            const int tid = i + 1;
+
+            juce::String threadName = buffer.ownName;
+            if (auto* name = buffer.threadName.load())
+                threadName = name;
+            if (threadName.isEmpty())
+                threadName = "Thread " + juce::String(tid);
+
+            out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+                << ",\"args\":{\"name\":" << quoted(threadName) << "}}";
+
+            const auto numWritten = buffer.numWritten.load(std::memory_order_acquire);
+            const auto first = numWritten > (juce::uint64)maxEventsPerThread ? numWritten - (juce::uint64)maxEventsPerThread : 0;
+
+            for (auto n = first; n < numWritten; ++n)
+            {
+                const auto& event = buffer.events[(size_t)(n % (juce::uint64)maxEventsPerThread)];
+                if (event.startTicks < captureStartTicks)
+                    continue; // began before the capture did
+
+                const auto start = toMicroseconds(event.startTicks);
+                const auto duration = toMicroseconds(event.endTicks) - start;
+
+                out << ",\n{\"name\":" << quoted(juce::String::fromUTF8(event.name))
+                    << ",\"cat\":" << quoted(event.category != nullptr ? event.category : "")
+                    << ",\"ph\":\"X\",\"ts\":" << juce::String(start, 3)
+                    << ",\"dur\":" << juce::String(duration, 3)
+                    << ",\"pid\":1,\"tid\":" << tid << "}";
+            }
+        }
+
+        out << "\n]}\n";
+        out.flush();
+
+        if (out.getStatus().failed())
+            return false;
+    }
+
+    return temp.overwriteTargetFileWithTemporary();
+}
@@ -0,0 +1,119 @@
+/*
+  ==============================================================================
+
+    TraceRecorder.h
+    (Timeline capture of the audio and message threads, for chrome://tracing or Perfetto)
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+
+/** Set to 0 to compile every IDOL_TRACE_* macro away. */
+#ifndef IDOL_ENABLE_TRACING
+ #define IDOL_ENABLE_TRACING 1
+#endif
+
+/**
+    Records scoped events into fixed-size per-thread ring buffers while a capture is
+    running, and writes them out in the Chrome trace event format.
+
+    Recording an event never locks or allocates: a thread claims one of the buffers
+    made when the first capture started, the first time it records, and from then on
+    only writes into it. Each buffer keeps the newest maxEventsPerThread events. When
+    no capture is running an event costs one relaxed atomic load.
+
+    Use the macros rather than the class, so tracing can be compiled out:
+
+        IDOL_TRACE_SCOPE("audio", "Callback");              // name must be a literal
+        IDOL_TRACE_SCOPE_DYNAMIC("plugin", plugin->getName()); // copied, only evaluated while capturing
+*/
+class TraceRecorder
+{
+public:
+    static TraceRecorder& getInstance();
+
+    static constexpr int maxThreads = 32;
+    static constexpr int maxEventsPerThread = 16384;
+    static constexpr int maxNameLength = 48;
+
+    static bool isCapturing() noexcept { return capturing.load(std::memory_order_relaxed); }
+
+    /** Message thread. Throws away whatever the last capture recorded. */
+    void start();
+    void stop();
+
+    /** Writes what the last (or current, which is stopped first) capture recorded. */
+    bool writeChromeTrace(const juce::File& file);
+
+    /** The file a capture is written to by default: a timestamped name under the app's data folder. */
+    static juce::File getDefaultTraceFile();
+
+    /** Names the calling thread in the trace; the audio device's thread has no name of its own. */
+    static void nameCurrentThread(const char* name) noexcept;
+
+    class ScopedEvent
+    {
+    public:
+        ScopedEvent(const char* category, const char* name) noexcept;
+        ScopedEvent(const char* category, const juce::String& name) noexcept;
+        ~ScopedEvent();
+
+    private:
+        const char* category = nullptr;
+        const char* staticName = nullptr;
+        char copiedName[maxNameLength] = {};
+        juce::int64 startTicks = 0;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedEvent)
+    };
+
+private:
+    TraceRecorder() = default;
+
+    struct Event
+    {
+        const char* category;
+        char name[maxNameLength];
+        juce::int64 startTicks;
+        juce::int64 endTicks;
+    };
+
+    struct ThreadBuffer
+    {
+        std::unique_ptr<Event[]> events;
+        std::atomic<juce::uint64> numWritten{ 0 };
+        std::atomic<const char*> threadName{ nullptr };
+        juce::Thread::ThreadID threadId = nullptr;
+        juce::String ownName;
+    };
+
+    static ThreadBuffer* getBufferForCurrentThread() noexcept;
+    void record(const char* category, const char* name, juce::int64 startTicks, juce::int64 endTicks) noexcept;
+
+    static std::atomic<bool> capturing;
+
+    std::array<ThreadBuffer, maxThreads> buffers;
+    std::atomic<int> numBuffersClaimed{ 0 };
+    std::atomic<juce::uint32> generation{ 0 };
+    juce::int64 captureStartTicks = 0;
+    bool buffersAllocated = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TraceRecorder)
+};
+
+#if IDOL_ENABLE_TRACING
+ #define IDOL_TRACE_SCOPE(category, name) \
+    const TraceRecorder::ScopedEvent JUCE_JOIN_MACRO(idolTraceEvent_, __LINE__)(category, name)
+ #define IDOL_TRACE_SCOPE_DYNAMIC(category, nameExpression) \
+    const TraceRecorder::ScopedEvent JUCE_JOIN_MACRO(idolTraceEvent_, __LINE__)(category, \
+        TraceRecorder::isCapturing() ? juce::String(nameExpression) : juce::String())
+ #define IDOL_TRACE_THREAD_NAME(name) TraceRecorder::nameCurrentThread(name)
+#else
+ #define IDOL_TRACE_SCOPE(category, name)
+ #define IDOL_TRACE_SCOPE_DYNAMIC(category, nameExpression)
+ #define IDOL_TRACE_THREAD_NAME(name)
+#endif
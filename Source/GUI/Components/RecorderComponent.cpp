@@ -46,6 +46,9 @@ RecorderComponent::RecorderComponent(AudioEngine& engine)
     addAndMakeVisible(recordedListButton);
     recordedListButton.onClick = [this] { openRecordingList(); };
 
+    waveformView = std::make_unique<WaveformView>(audioEngine.getPeakCache());
+    addAndMakeVisible(*waveformView);
+
     addAndMakeVisible(positionSlider);
     positionSlider.setRange(0.0, 1.0, 0.001);
     positionSlider.onDragEnd = [this] {
@@ -137,6 +140,7 @@ void RecorderComponent::resized()
     currentTimeLabel.setBounds(positionSliderArea.removeFromLeft(50));
     totalTimeLabel.setBounds(positionSliderArea.removeFromRight(50));
     positionSlider.setBounds(positionSliderArea);
+    waveformView->setBounds(positionSliderArea);
 
     volumeLabel.setBounds(volumeSliderArea.removeFromLeft(80));
     volumeSlider.setBounds(volumeSliderArea);
@@ -272,6 +276,7 @@ void RecorderComponent::startPlayback(const juce::File& fileToPlay)
 {
     audioEngine.startPlayback(fileToPlay);
     currentlyLoadedFile = fileToPlay;
+    waveformView->setFile(currentlyLoadedFile);
     updateLoadedFileLabel();
 }
 
@@ -280,6 +285,7 @@ void RecorderComponent::stopPlayback()
     audioEngine.stopPlayback();
     state = PlayState::Stopped; // Trực tiếp đặt trạng thái là Stopped
     currentlyLoadedFile = {}; // Xóa file
+    waveformView->setFile({});
     updateLoadedFileLabel();
     updateButtonStates();       // Cập nhật lại giao diện ngay lập tức
 }
@@ -5,6 +5,7 @@
 #include <JuceHeader.h>
 #include "../../Data/LanguageManager/LanguageManager.h"
 #include "../../AudioEngine/AudioEngine.h"
+#include "WaveformView.h"
 
 // Forward declaration
 class RecordingListWindow;
@@ -49,6 +50,7 @@ private:
     juce::TextButton stopButton;
     juce::TextButton pauseButton;
     juce::TextButton recordedListButton;
+    std::unique_ptr<WaveformView> waveformView;
     juce::Slider positionSlider;
     juce::Label currentTimeLabel;
     juce::Label totalTimeLabel;
@@ -17,6 +17,11 @@ TrackPlayerComponent::TrackPlayerComponent(PlayerType type, AudioEngine& engine)
     audioEngine.getTrackTransportSource(playerType).addChangeListener(this);
     // <<< ĐĂNG KÝ LẮNG NGHE TRẠNG THÁI PROJECT >>>
     audioEngine.getProjectState().addListener(this);
+    if (playerType == PlayerType::Music)
+    {
+        audioEngine.getBackingTrackQueue().addChangeListener(this);
+        audioEngine.getVocalRemover().addChangeListener(this);
+    }
 
     addAndMakeVisible(titleLabel);
     titleLabel.setFont(IdolUIHelpers::createBoldFont(15.0f));
@@ -56,12 +61,25 @@ TrackPlayerComponent::TrackPlayerComponent(PlayerType type, AudioEngine& engine)
     addAndMakeVisible(loadButton);
     loadButton.onClick = [this] { loadFile(); };
 
+    if (playerType == PlayerType::Music)
+    {
+        addAndMakeVisible(queueButton);
+        queueButton.onClick = [this] { showQueueMenu(); };
+
+        addAndMakeVisible(keyButton);
+        keyButton.onClick = [this] { showKeyTempoMenu(); };
+    }
+
     addAndMakeVisible(muteButton);
     muteButton.setClickingTogglesState(true);
     muteButton.onClick = [this] {
         audioEngine.setTrackPlayerMute(playerType, muteButton.getToggleState());
         };
 
+    // Drawn behind the slider so the thumb stays on top.
+    waveformView = std::make_unique<WaveformView>(audioEngine.getPeakCache());
+    addAndMakeVisible(*waveformView);
+
     addAndMakeVisible(positionSlider);
     positionSlider.setRange(0.0, 1.0, 0.001);
     positionSlider.onDragEnd = [this] {
@@ -69,6 +87,11 @@ TrackPlayerComponent::TrackPlayerComponent(PlayerType type, AudioEngine& engine)
         {
             audioEngine.seekProject(positionSlider.getValue());
         }
+        else if (isQueueMode())
+        {
+            auto& queue = audioEngine.getBackingTrackQueue();
+            queue.setCurrentPosition(positionSlider.getValue() * queue.getCurrentLength());
+        }
         else
         {
             auto& transport = audioEngine.getTrackTransportSource(playerType);
@@ -95,6 +118,11 @@ TrackPlayerComponent::~TrackPlayerComponent()
     audioEngine.getTrackTransportSource(playerType).removeChangeListener(this);
     // <<< HỦY ĐĂNG KÝ LẮNG NGHE >>>
     audioEngine.getProjectState().removeListener(this);
+    if (playerType == PlayerType::Music)
+    {
+        audioEngine.getBackingTrackQueue().removeChangeListener(this);
+        audioEngine.getVocalRemover().removeChangeListener(this);
+    }
 }
 
 void TrackPlayerComponent::paint(juce::Graphics& g)
@@ -118,6 +146,7 @@ void TrackPlayerComponent::resized()
     currentTimeLabel.setBounds(sliderArea.removeFromLeft(40));
     totalTimeLabel.setBounds(sliderArea.removeFromRight(40));
     positionSlider.setBounds(sliderArea);
+    waveformView->setBounds(sliderArea);
 
     juce::FlexBox fb;
     fb.justifyContent = juce::FlexBox::JustifyContent::spaceAround;
@@ -128,6 +157,11 @@ void TrackPlayerComponent::resized()
     fb.items.add(juce::FlexItem(stopButton).withFlex(1.0f));
     fb.items.add(juce::FlexItem(listButton).withFlex(1.0f));
     fb.items.add(juce::FlexItem(loadButton).withFlex(1.0f));
+    if (playerType == PlayerType::Music)
+    {
+        fb.items.add(juce::FlexItem(queueButton).withFlex(1.0f));
+        fb.items.add(juce::FlexItem(keyButton).withFlex(1.0f));
+    }
     fb.items.add(juce::FlexItem(muteButton).withWidth(60.0f));
 
     fb.performLayout(buttonArea);
@@ -135,6 +169,23 @@ void TrackPlayerComponent::resized()
 
 void TrackPlayerComponent::timerCallback()
 {
+    waveformView->setFile(isQueueMode() ? audioEngine.getBackingTrackQueue().getCurrentFile()
+                                        : audioEngine.getTrackFile(playerType));
+
+    if (isQueueMode())
+    {
+        auto& queue = audioEngine.getBackingTrackQueue();
+        const double totalLength = queue.getCurrentLength();
+        const double currentPos = queue.getCurrentPosition();
+
+        if (totalLength > 0 && !positionSlider.isMouseButtonDown())
+            positionSlider.setValue(currentPos / totalLength, juce::dontSendNotification);
+
+        currentTimeLabel.setText(formatTime(currentPos), juce::dontSendNotification);
+        totalTimeLabel.setText(formatTime(totalLength), juce::dontSendNotification);
+        return;
+    }
+
     auto& transport = audioEngine.getTrackTransportSource(playerType);
     if (playState != State::Stopped)
     {
@@ -162,8 +213,29 @@ void TrackPlayerComponent::changeListenerCallback(juce::ChangeBroadcaster* sourc
     {
         updateTexts();
     }
+    else if (playerType == PlayerType::Music && source == &audioEngine.getVocalRemover())
+    {
+        updateTexts();
+    }
+    else if (playerType == PlayerType::Music && source == &audioEngine.getBackingTrackQueue())
+    {
+        auto& queue = audioEngine.getBackingTrackQueue();
+        if (queue.isEmpty())
+            setQueueMode(false);
+        else if (!audioEngine.getTrackTransportSource(playerType).isPlaying())
+            setQueueMode(true);
+
+        if (isQueueMode())
+            playState = queue.isPlaying() ? State::Playing : State::Stopped;
+
+        updateTexts();
+        setButtonsEnabled(!audioEngine.isProjectPlaybackActive());
+    }
     else if (source == &audioEngine.getTrackTransportSource(playerType))
     {
+        if (isQueueMode())
+            return;
+
         auto& transport = audioEngine.getTrackTransportSource(playerType);
         if (transport.isPlaying())
         {
@@ -206,6 +278,7 @@ void TrackPlayerComponent::setButtonsEnabled(bool shouldBeEnabled)
     playButton.setEnabled(shouldBeEnabled);
     listButton.setEnabled(shouldBeEnabled);
     loadButton.setEnabled(shouldBeEnabled);
+    keyButton.setEnabled(shouldBeEnabled);
 
     // Nút Stop chỉ bật khi đang phát và không ở chế độ project
     stopButton.setEnabled(shouldBeEnabled && (playState != State::Stopped));
@@ -224,7 +297,29 @@ void TrackPlayerComponent::updateTexts()
 {
     auto& lang = LanguageManager::getInstance();
 
-    titleLabel.setText(lang.get("trackPlayer.title"), juce::dontSendNotification);
+    auto title = lang.get("trackPlayer.title");
+    if (isQueueMode())
+    {
+        auto& queue = audioEngine.getBackingTrackQueue();
+        title << "  " << juce::String(queue.getCurrentIndex() + 1) << "/" << juce::String(queue.getTracks().size())
+              << "  " << queue.getCurrentFile().getFileNameWithoutExtension();
+    }
+    else if (playerType == PlayerType::Music
+             && (audioEngine.getMusicSemitones() != 0 || !juce::approximatelyEqual(audioEngine.getMusicTempo(), 1.0)))
+    {
+        const int semitones = audioEngine.getMusicSemitones();
+        title << "  [" << (semitones > 0 ? "+" : "") << juce::String(semitones) << " / "
+              << juce::String(juce::roundToInt(audioEngine.getMusicTempo() * 100.0)) << "%]";
+    }
+
+    if (playerType == PlayerType::Music)
+    {
+        auto& remover = audioEngine.getVocalRemover();
+        if (remover.isBusy() && remover.getCurrentSource() == audioEngine.getCurrentMusicFile())
+            title << "  (" << lang.get("vocalRemover.progress") << " "
+                  << juce::String(juce::roundToInt(remover.getProgress() * 100.0f)) << "%)";
+    }
+    titleLabel.setText(title, juce::dontSendNotification);
     // Sửa: Chỉ đặt text cho nút REC nếu nó không đang ghi âm
     if (!recordButton.getToggleState())
         recordButton.setButtonText(lang.get("trackPlayer.rec"));
@@ -234,6 +329,8 @@ void TrackPlayerComponent::updateTexts()
     listButton.setButtonText(lang.get("trackPlayer.list"));
     loadButton.setButtonText(lang.get("trackPlayer.load"));
     muteButton.setButtonText(lang.get("tracks.mute"));
+    queueButton.setButtonText(lang.get("trackPlayer.queue"));
+    keyButton.setButtonText(lang.get("trackPlayer.key"));
 }
 
 void TrackPlayerComponent::updatePlayButtonState()
@@ -251,11 +348,21 @@ void TrackPlayerComponent::updatePlayButtonState()
 
 void TrackPlayerComponent::playTrack(const juce::File& fileToPlay)
 {
+    setQueueMode(false);
     audioEngine.startTrackPlayback(playerType, fileToPlay);
+    updateTexts();
 }
 
 void TrackPlayerComponent::stopTrack()
 {
+    if (isQueueMode())
+    {
+        audioEngine.getBackingTrackQueue().stop();
+        playState = State::Stopped;
+        updatePlayButtonState();
+        return;
+    }
+
     audioEngine.stopTrackPlayback(playerType);
     playState = State::Stopped;
     updatePlayButtonState();
@@ -263,11 +370,20 @@ void TrackPlayerComponent::stopTrack()
 
 void TrackPlayerComponent::pauseTrack()
 {
-    audioEngine.pauseTrackPlayback(playerType);
+    if (isQueueMode())
+        audioEngine.getBackingTrackQueue().pause();
+    else
+        audioEngine.pauseTrackPlayback(playerType);
 }
 
 void TrackPlayerComponent::resumeTrack()
 {
+    if (isQueueMode())
+    {
+        audioEngine.getBackingTrackQueue().play();
+        return;
+    }
+
     // Chỉ cho phép load file mới nếu không ở chế độ project
     if (audioEngine.getTrackTransportSource(playerType).getTotalLength() <= 0 && !audioEngine.isProjectPlaybackActive())
         loadFile();
@@ -291,4 +407,182 @@ void TrackPlayerComponent::openTrackRecordingList()
     auto subDirName = (playerType == PlayerType::Vocal) ? "Vocal" : "Music";
     listWindow = std::make_unique<RecordingListWindow>(subDirName, [this](const juce::File& f) { playTrack(f); });
     listWindow->setVisible(true);
-}
\ No newline at end of file
+}
+
+void TrackPlayerComponent::setQueueMode(bool shouldUseQueue)
+{
+    if (playerType != PlayerType::Music || queueMode == shouldUseQueue)
+        return;
+
+    queueMode = shouldUseQueue;
+
+    // The queue and the single-file player share the music bus; only one runs at a time.
+    if (queueMode)
+        audioEngine.stopTrackPlayback(playerType);
+    else
+        audioEngine.getBackingTrackQueue().pause();
+
+    playState = State::Stopped;
+    updateTexts();
+}
+
+void TrackPlayerComponent::addTracksToQueue()
+{
+    auto fc = std::make_shared<juce::FileChooser>("Add Tracks To Queue", juce::File{}, "*.mp3;*.wav;*.aif;*.aiff");
+    fc->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles
+        | juce::FileBrowserComponent::canSelectMultipleItems,
+        [this, fc](const juce::FileChooser& chooser)
+        {
+            if (chooser.getResults().isEmpty()) return;
+            setQueueMode(true);
+            audioEngine.getBackingTrackQueue().addTracks(chooser.getResults());
+        });
+}
+
+void TrackPlayerComponent::showQueueMenu()
+{
+    auto& lang = LanguageManager::getInstance();
+    auto& queue = audioEngine.getBackingTrackQueue();
+
+    enum MenuIds { addTracksId = 1, skipId, clearId, crossfadeBaseId = 100, trackBaseId = 1000 };
+
+    juce::PopupMenu trackMenu;
+    const auto& tracks = queue.getTracks();
+    for (int i = 0; i < tracks.size(); ++i)
+        trackMenu.addItem(trackBaseId + i, juce::String(i + 1) + ". " + tracks[i].getFileNameWithoutExtension(),
+            true, isQueueMode() && i == queue.getCurrentIndex());
+
+    juce::PopupMenu crossfadeMenu;
+    const double currentFade = queue.getCrossfadeSeconds();
+    crossfadeMenu.addItem(crossfadeBaseId, lang.get("trackPlayer.queueGapless"), true, currentFade <= 0.0);
+    for (int seconds : { 2, 4, 8 })
+        crossfadeMenu.addItem(crossfadeBaseId + seconds, juce::String(seconds) + " s", true,
+            juce::approximatelyEqual(currentFade, (double)seconds));
+
+    juce::PopupMenu menu;
+    menu.addItem(addTracksId, lang.get("trackPlayer.queueAddTracks"));
+    if (tracks.isEmpty())
+        menu.addItem(-1, lang.get("trackPlayer.queueEmpty"), false);
+    else
+        menu.addSubMenu(lang.get("trackPlayer.queueTracks"), trackMenu);
+    menu.addSubMenu(lang.get("trackPlayer.queueCrossfade"), crossfadeMenu);
+    menu.addSeparator();
+    menu.addItem(skipId, lang.get("trackPlayer.queueSkip"), isQueueMode() && queue.isPlaying());
+    menu.addItem(clearId, lang.get("trackPlayer.queueClear"), !tracks.isEmpty());
+
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&queueButton),
+        [this](int result)
+        {
+            auto& q = audioEngine.getBackingTrackQueue();
+
+            if (result == addTracksId)
+                addTracksToQueue();
+            else if (result == skipId)
+                q.skipToNext();
+            else if (result == clearId)
+                q.clear();
+            else if (result >= trackBaseId)
+            {
+                setQueueMode(true);
+                q.playFromIndex(result - trackBaseId);
+            }
+            else if (result >= crossfadeBaseId)
+                q.setCrossfadeSeconds((double)(result - crossfadeBaseId));
+        });
+}
+
+void TrackPlayerComponent::showKeyTempoMenu()
+{
+    auto& lang = LanguageManager::getInstance();
+    const bool canChange = !isQueueMode() && audioEngine.hasMusicTrackLoaded() && !audioEngine.isProjectPlaybackActive();
+    const int currentSemitones = audioEngine.getMusicSemitones();
+    const int currentTempoPercent = juce::roundToInt(audioEngine.getMusicTempo() * 100.0);
+
+    enum MenuIds { resetId = 1, removeVocalsId, semitoneBaseId = 100, tempoBaseId = 1000 };
+
+    juce::PopupMenu keyMenu;
+    for (int semitones = 6; semitones >= -6; --semitones)
+        keyMenu.addItem(semitoneBaseId + semitones + 12, (semitones > 0 ? "+" : "") + juce::String(semitones),
+            canChange, semitones == currentSemitones);
+
+    juce::PopupMenu tempoMenu;
+    for (int percent = 80; percent <= 120; percent += 5)
+        tempoMenu.addItem(tempoBaseId + percent, juce::String(percent) + "%", canChange, percent == currentTempoPercent);
+
+    juce::PopupMenu menu;
+    menu.addSubMenu(lang.get("trackPlayer.keyTranspose"), keyMenu, canChange);
+    menu.addSubMenu(lang.get("trackPlayer.keyTempo"), tempoMenu, canChange);
+    menu.addItem(resetId, lang.get("trackPlayer.keyReset"),
+        canChange && (currentSemitones != 0 || currentTempoPercent != 100));
+
+    menu.addSeparator();
+    menu.addItem(removeVocalsId, lang.get("trackPlayer.removeVocals"),
+        canChange && !audioEngine.getVocalRemover().isBusy());
+
+    if (audioEngine.isMusicRenderPending())
+    {
+        menu.addSeparator();
+        menu.addItem(-1, lang.get("trackPlayer.keyRendering") + " "
+            + juce::String(juce::roundToInt(audioEngine.getMusicRenderProgress() * 100.0f)) + "%", false);
+    }
+
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&keyButton),
+        [this](int result)
+        {
+            int semitones = audioEngine.getMusicSemitones();
+            double tempo = audioEngine.getMusicTempo();
+
+            if (result == removeVocalsId)
+            {
+                removeVocalsFromCurrentTrack();
+                return;
+            }
+
+            if (result == resetId)
+            {
+                semitones = 0;
+                tempo = 1.0;
+            }
+            else if (result >= tempoBaseId)
+                tempo = (result - tempoBaseId) / 100.0;
+            else if (result >= semitoneBaseId)
+                semitones = result - semitoneBaseId - 12;
+            else
+                return;
+
+            audioEngine.setMusicKeyAndTempo(semitones, tempo);
+            updateTexts();
+        });
+}
+
+void TrackPlayerComponent::removeVocalsFromCurrentTrack()
+{
+    auto& lang = LanguageManager::getInstance();
+    const auto source = audioEngine.getCurrentMusicFile();
+
+    const bool started = audioEngine.getVocalRemover().start(source,
+        [safeThis = juce::Component::SafePointer(this), source](const juce::File& instrumental, const juce::String& error)
+        {
+            if (safeThis == nullptr)
+                return;
+
+            if (instrumental == juce::File())
+            {
+                juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon,
+                    LanguageManager::getInstance().get("vocalRemover.failedTitle"), error);
+                return;
+            }
+
+            // Only swap if the user is still on the same song.
+            if (!safeThis->isQueueMode() && safeThis->audioEngine.getCurrentMusicFile() == source)
+                safeThis->audioEngine.replaceMusicTrackFile(instrumental);
+
+            safeThis->updateTexts();
+        });
+
+    if (!started)
+        juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::InfoIcon,
+            lang.get("vocalRemover.failedTitle"), lang.get("vocalRemover.busy"));
+
+    updateTexts();
+}
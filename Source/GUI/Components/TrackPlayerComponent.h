@@ -2,6 +2,8 @@
 
 #include <JuceHeader.h>
 #include "../../Data/LanguageManager/LanguageManager.h"
+#include "WaveformView.h"
+#include "../../AudioEngine/TrackPlayerType.h"
 
 class AudioEngine;
 class RecordingListWindow;
@@ -13,7 +15,7 @@ class TrackPlayerComponent : public juce::Component,
     private juce::ValueTree::Listener
 {
 public:
-    enum class PlayerType { Vocal, Music };
+    using PlayerType = TrackPlayerType;
 
     TrackPlayerComponent(PlayerType type, AudioEngine& engine);
     ~TrackPlayerComponent() override;
@@ -41,6 +43,16 @@ private:
     void loadFile();
     void openTrackRecordingList();
 
+    // Playlist mode (music player only)
+    void showQueueMenu();
+    void addTracksToQueue();
+    void setQueueMode(bool shouldUseQueue);
+    bool isQueueMode() const { return queueMode; }
+
+    // Key / tempo (music player only)
+    void showKeyTempoMenu();
+    void removeVocalsFromCurrentTrack();
+
     PlayerType playerType;
     AudioEngine& audioEngine;
 
@@ -56,6 +68,10 @@ private:
     juce::TextButton listButton;
     juce::TextButton loadButton;
     juce::ToggleButton muteButton;
+    juce::TextButton queueButton;
+    juce::TextButton keyButton;
+    bool queueMode = false;
+    std::unique_ptr<WaveformView> waveformView;
     juce::Slider positionSlider;
     juce::Label currentTimeLabel;
     juce::Label totalTimeLabel;
@@ -0,0 +1,97 @@
+/*
+  ==============================================================================
+
+    WaveformView.cpp
+
+  ==============================================================================
+*/
+
+#include "WaveformView.h"
+
+WaveformView::WaveformView(PeakCache& cacheToUse)
+    : cache(cacheToUse)
+{
+    setInterceptsMouseClicks(false, false);
+    cache.addChangeListener(this);
+}
+
+WaveformView::~WaveformView()
+{
+    cache.removeChangeListener(this);
+}
+
+void WaveformView::setFile(const juce::File& newFile)
+{
+    if (newFile == file)
+        return;
+
+    file = newFile;
+    pyramid = file == juce::File() ? nullptr : cache.getPyramid(file);
+    repaint();
+}
+
+void WaveformView::setVisibleRange(juce::Range<double> newRange)
+{
+    newRange = newRange.getIntersectionWith({ 0.0, 1.0 });
+    if (newRange != visibleRange && !newRange.isEmpty())
+    {
+        visibleRange = newRange;
+        repaint();
+    }
+}
+
+void WaveformView::changeListenerCallback(juce::ChangeBroadcaster* source)
+{
+    // A build finished somewhere; pick ours up if it was the one.
+    if (source == &cache && pyramid == nullptr && file != juce::File())
+    {
+        pyramid = cache.getPyramid(file);
+        if (pyramid != nullptr)
+            repaint();
+    }
+}
+
+void WaveformView::paint(juce::Graphics& g)
+{
+    if (pyramid == nullptr || pyramid->getNumSamples() <= 0)
+        return;
+
+    const int width = getWidth();
+    const float midY = (float)getHeight() * 0.5f;
+    const float halfHeight = midY - 1.0f;
+    const double totalSamples = (double)pyramid->getNumSamples();
+    const double firstSample = visibleRange.getStart() * totalSamples;
+    const double samplesPerPixel = visibleRange.getLength() * totalSamples / juce::jmax(1, width);
+    const int numChannels = pyramid->getNumChannels();
+
+    juce::RectangleList<float> peakRects, rmsRects;
+
+    // One pyramid query per pixel column and channel, whatever the file length.
+    for (int x = 0; x < width; ++x)
+    {
+        const auto start = (juce::int64)(firstSample + x * samplesPerPixel);
+        const auto end = juce::jmax(start + 1, (juce::int64)(firstSample + (x + 1) * samplesPerPixel));
+
+        float minimum = 1.0f, maximum = -1.0f, rms = 0.0f;
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const auto peak = pyramid->getPeak(ch, start, end);
+            minimum = juce::jmin(minimum, peak.minimum);
+            maximum = juce::jmax(maximum, peak.maximum);
+            rms = juce::jmax(rms, peak.rms);
+        }
+
+        if (maximum < minimum)
+            continue;
+
+        peakRects.addWithoutMerging({ (float)x, midY - maximum * halfHeight, 1.0f,
+                                      juce::jmax(1.0f, (maximum - minimum) * halfHeight) });
+        rmsRects.addWithoutMerging({ (float)x, midY - rms * halfHeight, 1.0f,
+                                     juce::jmax(1.0f, 2.0f * rms * halfHeight) });
+    }
+
+    g.setColour(juce::Colour(0xff4ade80).withAlpha(0.25f));
+    g.fillRectList(peakRects);
+    g.setColour(juce::Colour(0xff4ade80).withAlpha(0.45f));
+    g.fillRectList(rmsRects);
+}
@@ -0,0 +1,40 @@
+/*
+  ==============================================================================
+
+    WaveformView.h
+    (Waveform overview drawn behind the players' position sliders)
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../AudioEngine/PeakCache.h"
+
+class WaveformView : public juce::Component,
+                     private juce::ChangeListener
+{
+public:
+    explicit WaveformView(PeakCache& cacheToUse);
+    ~WaveformView() override;
+
+    /** Shows the overview of a file; an empty File clears the view. */
+    void setFile(const juce::File& newFile);
+    const juce::File& getFile() const { return file; }
+
+    /** Portion of the file to show, as fractions of its length (0..1). */
+    void setVisibleRange(juce::Range<double> newRange);
+
+    void paint(juce::Graphics& g) override;
+
+private:
+    void changeListenerCallback(juce::ChangeBroadcaster* source) override;
+
+    PeakCache& cache;
+    juce::File file;
+    PeakPyramid::Ptr pyramid;
+    juce::Range<double> visibleRange{ 0.0, 1.0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WaveformView)
+};
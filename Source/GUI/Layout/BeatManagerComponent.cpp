@@ -1,5 +1,7 @@
 #include "BeatManagerComponent.h"
 #include "../../Components/Helpers.h"
+#include "../../AudioEngine/VocalRemover.h"
+#include "../../Data/BeatSearch.h"
 
 // Lớp Editor tùy chỉnh để bắt sự kiện focus
 class BeatManagerComponent::SearchEditor : public juce::TextEditor
@@ -25,6 +27,7 @@ public:
     {
         addAndMakeVisible(titleLabel);
         addAndMakeVisible(playButton);
+        addAndMakeVisible(removeVocalsButton);
         addAndMakeVisible(deleteButton);
         deleteButton.setButtonText("X");
         deleteButton.setTooltip(LanguageManager::getInstance().get("beatManager.deleteTooltip"));
@@ -38,9 +41,14 @@ public:
 
     void update(const juce::String& beatTitle, const juce::File& beatFile)
     {
-        titleLabel.setText(beatTitle, juce::dontSendNotification);
-        playButton.setButtonText(LanguageManager::getInstance().get("beatManager.playButton"));
+        auto& lang = LanguageManager::getInstance();
+        const auto status = ownerComponent.getVocalRemovalStatus(beatFile);
+        titleLabel.setText(status.isEmpty() ? beatTitle : beatTitle + "  " + status, juce::dontSendNotification);
+        playButton.setButtonText(lang.get("beatManager.playButton"));
         playButton.onClick = [this, beatFile] { ownerComponent.playBeat(beatFile); };
+        removeVocalsButton.setButtonText(lang.get("beatManager.removeVocalsButton"));
+        removeVocalsButton.setTooltip(lang.get("beatManager.removeVocalsTooltip"));
+        removeVocalsButton.onClick = [this, beatFile] { ownerComponent.removeVocals(beatFile); };
     }
 
     void resized() override
@@ -49,6 +57,8 @@ public:
         deleteButton.setBounds(bounds.removeFromRight(30));
         bounds.removeFromRight(5);
         playButton.setBounds(bounds.removeFromRight(80));
+        bounds.removeFromRight(5);
+        removeVocalsButton.setBounds(bounds.removeFromRight(70));
         titleLabel.setBounds(bounds);
     }
 
@@ -56,53 +66,21 @@ private:
     BeatManagerComponent& ownerComponent;
     juce::Label titleLabel;
     juce::TextButton playButton;
+    juce::TextButton removeVocalsButton;
     juce::TextButton deleteButton;
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BeatItemComponent)
 };
 
-static juce::String removeAccents(const juce::String& text)
-{
-    juce::String result = text;
-
-    // Chữ 'a'
-    result = result.replaceCharacters("áàảãạăắằẳẵặâấầẩẫậ", "aaaaaaaaaaaaaaaaa");
-    result = result.replaceCharacters("ÁÀẢÃẠĂẮẰẲẴẶÂẤẦẨẪẬ", "AAAAAAAAAAAAAAAAA");
-
-    // Chữ 'e'
-    result = result.replaceCharacters("éèẻẽẹêếềểễệ", "eeeeeeeeeee");
-    result = result.replaceCharacters("ÉÈẺẼẸÊẾỀỂỄỆ", "EEEEEEEEEEE");
-
-    // Chữ 'i'
-    result = result.replaceCharacters("íìỉĩị", "iiiii");
-    result = result.replaceCharacters("ÍÌỈĨỊ", "IIIII");
-
-    // Chữ 'o'
-    result = result.replaceCharacters("óòỏõọôốồổỗộơớờởỡợ", "ooooooooooooooooo");
-    result = result.replaceCharacters("ÓÒỎÕỌÔỐỒỔỖỘƠỚỜỞỠỢ", "OOOOOOOOOOOOOOOOO");
-
-    // Chữ 'u'
-    result = result.replaceCharacters("úùủũụưứừửữự", "uuuuuuuuuuu");
-    result = result.replaceCharacters("ÚÙỦŨỤƯỨỪỬỮỰ", "UUUUUUUUUUU");
-
-    // Chữ 'y'
-    result = result.replaceCharacters("ýỳỷỹỵ", "yyyyy");
-    result = result.replaceCharacters("ÝỲỶỸỴ", "YYYYY");
-
-    // Chữ 'đ'
-    result = result.replaceCharacters("đ", "d");
-    result = result.replaceCharacters("Đ", "D");
-
-    return result.toLowerCase();
-}
-
 
 //==============================================================================
 // Triển khai các hàm của BeatManagerComponent
 //==============================================================================
 
-BeatManagerComponent::BeatManagerComponent()
+BeatManagerComponent::BeatManagerComponent(VocalRemover& remover)
+    : vocalRemover(remover)
 {
     LanguageManager::getInstance().addChangeListener(this);
+    vocalRemover.addChangeListener(this);
     initialisePaths();
     addAndMakeVisible(titleLabel);
     titleLabel.setFont(IdolUIHelpers::createBoldFont(16.0f));
@@ -131,6 +109,7 @@ BeatManagerComponent::~BeatManagerComponent()
 {
     searchResultsBox.setModel(nullptr);
     LanguageManager::getInstance().removeChangeListener(this);
+    vocalRemover.removeChangeListener(this);
     if (searchEditor)
         searchEditor->removeListener(this);
 }
@@ -253,7 +232,13 @@ void BeatManagerComponent::textEditorReturnKeyPressed(juce::TextEditor& editor)
     }
 }
 
-void BeatManagerComponent::changeListenerCallback(juce::ChangeBroadcaster* source) { if (source == &LanguageManager::getInstance()) updateTexts(); }
+void BeatManagerComponent::changeListenerCallback(juce::ChangeBroadcaster* source)
+{
+    if (source == &LanguageManager::getInstance())
+        updateTexts();
+    else if (source == &vocalRemover)
+        searchResultsBox.updateContent();
+}
 
 void BeatManagerComponent::rescanBeats(juce::File folderToScan)
 {
@@ -306,11 +291,10 @@ void BeatManagerComponent::filterBeats()
     }
     else
     {
-        auto simplifiedSearchTerm = removeAccents(searchTerm);
+        auto simplifiedSearchTerm = BeatSearch::simplify(searchTerm);
         for (const auto& beat : allBeats)
         {
-            auto simplifiedTitle = removeAccents(beat.title);
-            if (simplifiedTitle.contains(simplifiedSearchTerm))
+            if (BeatSearch::matches(beat.title, simplifiedSearchTerm))
             {
                 filteredBeats.add(beat);
             }
@@ -333,6 +317,52 @@ void BeatManagerComponent::playBeat(const juce::File& fileToPlay)
     }
 }
 
+void BeatManagerComponent::removeVocals(const juce::File& beatFile)
+{
+    auto& lang = LanguageManager::getInstance();
+
+    if (VocalRemover::hasCachedInstrumental(beatFile))
+    {
+        VocalRemover::getInstrumentalFileFor(beatFile).revealToUser();
+        return;
+    }
+
+    const bool started = vocalRemover.start(beatFile,
+        [safeThis = juce::Component::SafePointer(this)](const juce::File& instrumental, const juce::String& error)
+        {
+            if (safeThis == nullptr)
+                return;
+
+            auto& lm = LanguageManager::getInstance();
+            if (instrumental == juce::File())
+                juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon, lm.get("vocalRemover.failedTitle"), error);
+            else
+                juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::InfoIcon, lm.get("vocalRemover.doneTitle"),
+                    lm.get("vocalRemover.doneMessage") + "\n" + instrumental.getFullPathName());
+
+            safeThis->searchResultsBox.updateContent();
+        });
+
+    if (!started)
+        juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::InfoIcon,
+            lang.get("vocalRemover.failedTitle"), lang.get("vocalRemover.busy"));
+
+    searchResultsBox.updateContent();
+}
+
+juce::String BeatManagerComponent::getVocalRemovalStatus(const juce::File& beatFile) const
+{
+    auto& lang = LanguageManager::getInstance();
+
+    if (vocalRemover.isBusy() && vocalRemover.getCurrentSource() == beatFile)
+        return "(" + lang.get("vocalRemover.progress") + " " + juce::String(juce::roundToInt(vocalRemover.getProgress() * 100.0f)) + "%)";
+
+    if (VocalRemover::hasCachedInstrumental(beatFile))
+        return lang.get("beatManager.instrumentalReady");
+
+    return {};
+}
+
 void BeatManagerComponent::deleteBeat(int rowNumber)
 {
     if (!isPositiveAndBelow(rowNumber, filteredBeats.size())) return;
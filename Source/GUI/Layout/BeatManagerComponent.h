@@ -4,6 +4,8 @@
 #include "../../Data/LanguageManager/LanguageManager.h"
 #include <functional>
 
+class VocalRemover;
+
 class BeatManagerComponent : public juce::Component,
     private juce::ChangeListener,
     private juce::TextEditor::Listener,
@@ -11,7 +13,7 @@ class BeatManagerComponent : public juce::Component,
     private juce::ListBoxModel
 {
 public:
-    BeatManagerComponent();
+    explicit BeatManagerComponent(VocalRemover& remover);
     ~BeatManagerComponent() override;
 
     void paint(juce::Graphics& g) override;
@@ -40,6 +42,7 @@ private:
     juce::TextButton changeFolderButton;
     juce::ListBox searchResultsBox;
     std::unique_ptr<juce::FileChooser> fileChooser;
+    VocalRemover& vocalRemover;
 
     // Data
     juce::File beatFolder;
@@ -70,4 +73,6 @@ private:
     void loadBeats();
     void filterBeats();
     void playBeat(const juce::File& fileToPlay);
+    void removeVocals(const juce::File& beatFile);
+    juce::String getVocalRemovalStatus(const juce::File& beatFile) const;
 };
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "../../AudioEngine/AudioEngine.h"
 #include "../../Components/Helpers.h"
 #include "../../Data/AppState.h"
+#include "../../Diagnostics/TraceRecorder.h"
 
 // ... (Lớp LogoComponent không thay đổi) ...
 class LogoComponent : public juce::Component
@@ -35,6 +36,7 @@ MenubarComponent::MenubarComponent(juce::AudioDeviceManager& dm, AudioEngine& en
     addAndMakeVisible(asioPanelButton);
     addAndMakeVisible(vmPanelButton);
     addAndMakeVisible(audioSettingsButton);
+    addAndMakeVisible(traceButton);
     // <<< XÓA: outputChannelLabel và outputChannelSelector cũ >>>
 
     // <<< KHỞI TẠO COMPONENT MỚI >>>
@@ -63,6 +65,8 @@ MenubarComponent::MenubarComponent(juce::AudioDeviceManager& dm, AudioEngine& en
         options.launchAsync();
         };
 
+    traceButton.onClick = [this] { toggleTrace(); };
+
     vmPanelButton.onClick = [] {
 #if JUCE_WINDOWS
         juce::File vmPath("C:\\Program Files (x86)\\VB\\Voicemeeter\\voicemeeterpro.exe");
@@ -123,6 +127,8 @@ void MenubarComponent::resized()
     logo->setBounds(bounds.removeFromLeft(300));
     bounds.removeFromLeft(350);
     audioSettingsButton.setBounds(bounds.removeFromLeft(150));
+    bounds.removeFromLeft(5);
+    traceButton.setBounds(bounds.removeFromLeft(110));
 
     languageBox.setBounds(bounds.removeFromRight(120));
     bounds.removeFromRight(10);
@@ -162,6 +168,7 @@ void MenubarComponent::updateTexts()
     asioPanelButton.setButtonText(lang.get("menubar.asioPanel"));
     vmPanelButton.setButtonText(lang.get("menubar.voicemeeterPanel"));
     audioSettingsButton.setButtonText(lang.get("menubar.audioSettings"));
+    traceButton.setButtonText(lang.get(TraceRecorder::isCapturing() ? "menubar.stopTrace" : "menubar.startTrace"));
     // <<< XÓA: Cập nhật text cho các label/combobox cũ >>>
     repaint();
 }
@@ -190,4 +197,33 @@ void MenubarComponent::updateButtonStates()
 #else
     vmPanelButton.setVisible(false);
 #endif
+}
+
+void MenubarComponent::toggleTrace()
+{
+    auto& recorder = TraceRecorder::getInstance();
+    auto& lang = LanguageManager::getInstance();
+
+    if (!TraceRecorder::isCapturing())
+    {
+        recorder.start();
+        updateTexts();
+        return;
+    }
+
+    const auto file = TraceRecorder::getDefaultTraceFile();
+    const bool saved = recorder.writeChromeTrace(file);
+    updateTexts();
+
+    if (saved)
+    {
+        file.revealToUser();
+        juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::InfoIcon, lang.get("menubar.traceSavedTitle"),
+                                               lang.get("menubar.traceSavedMessage") + "\n" + file.getFullPathName());
+    }
+    else
+    {
+        juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon, lang.get("menubar.traceFailedTitle"),
+                                               lang.get("menubar.traceFailedMessage") + "\n" + file.getFullPathName());
+    }
 }
\ No newline at end of file
@@ -24,6 +24,7 @@ public:
 private:
     void updateTexts();
     void updateButtonStates();
+    void toggleTrace();
     // <<< XÓA: populateOutputChannels() và setSelectedOutputChannelPairByName() >>>
 
     juce::AudioDeviceManager& deviceManager;
@@ -35,6 +36,7 @@ private:
     juce::ComboBox languageBox;
     juce::TextButton asioPanelButton, vmPanelButton;
     juce::TextButton audioSettingsButton;
+    juce::TextButton traceButton;
 
     // <<< THAY THẾ CONTROL CŨ BẰNG COMPONENT MỚI >>>
     std::unique_ptr<ChannelSelectorComponent> outputSelector;
@@ -3,26 +3,32 @@
 #include "PluginManagementComponent.h"
 #include "../../Application/Application.h"
 
-// Helper class for the scanning progress window (unchanged)
+// Helper class for the scanning progress window
 class ScanningWindow
 {
 public:
     ScanningWindow(const juce::String& title, const juce::String& message)
     {
         alertWindow = std::make_unique<juce::AlertWindow>(title, message, juce::AlertWindow::NoIcon);
+        alertWindow->addProgressBarComponent(*progress);
         alertWindow->enterModalState(false);
     }
 
     ~ScanningWindow()
     {
-        juce::MessageManager::callAsync([w = std::move(alertWindow)]() mutable {
+        // The progress bar keeps a reference to the value, so it goes with the window.
+        juce::MessageManager::callAsync([w = std::move(alertWindow), p = progress]() mutable {
             if (w != nullptr)
             {
                 w->exitModalState(0);
             }
             });
     }
+
+    void setProgress(double newProgress) { *progress = newProgress; }
+
 private:
+    std::shared_ptr<double> progress = std::make_shared<double>(0.0);
     std::unique_ptr<juce::AlertWindow> alertWindow;
 };
 
@@ -55,87 +61,56 @@ PluginManagementComponent::~PluginManagementComponent() {
 }
 
 
-// <<< NEW: Method to setup and start the non-blocking scan >>>
+// Scanning runs in child processes; this only shows progress and the result.
 void PluginManagementComponent::startScan()
 {
     scanPluginsButton.setEnabled(false);
     auto& lang = LanguageManager::getInstance();
     scanningWindow = std::make_unique<ScanningWindow>(lang.get("scanProcess.title"), lang.get("scanProcess.message"));
 
-    // Reset state
-    filesToScan.clear();
-    nextFileToScan = 0;
-    tempList.clear();
+    const bool started = getSharedPluginManager().scanAndMergeAll([safeThis = juce::Component::SafePointer<PluginManagementComponent>(this)]
+    {
+        if (safeThis != nullptr)
+            safeThis->scanFinished();
+    });
 
-    // 1. Find all VST3 files, just like in the previous robust fix
-    juce::VST3PluginFormat vst3Format;
-    auto searchPaths = vst3Format.getDefaultLocationsToSearch();
-    for (int i = 0; i < searchPaths.getNumPaths(); ++i)
+    if (started)
     {
-        searchPaths[i].findChildFiles(filesToScan, juce::File::findFiles, true, "*.vst3");
+        startTimerHz(10);
+    }
+    else
+    {
+        scanningWindow.reset();
+        scanPluginsButton.setEnabled(true);
     }
-
-    // 2. Start the timer to process files one by one
-    startTimerHz(10); // Process up to 10 files per second
 }
 
-
-// <<< NEW: This is the heart of the non-blocking scan >>>
 void PluginManagementComponent::timerCallback()
 {
-    // This runs on the main message thread, but in small chunks
-
-    if (nextFileToScan < filesToScan.size())
-    {
-        const auto& pluginFile = filesToScan.getReference(nextFileToScan);
+    if (scanningWindow != nullptr)
+        scanningWindow->setProgress(getSharedPluginManager().getScanProgress());
+}
 
-        // Skip waveshells, they will be handled by the dedicated manager
-        if (!pluginFile.getFileName().containsIgnoreCase("WaveShell"))
-        {
-            // Scanning is safe here because we are on the main thread
-            try
-            {
-                juce::VST3PluginFormat vst3Format;
-                juce::OwnedArray<juce::PluginDescription> descs;
-                vst3Format.findAllTypesForFile(descs, pluginFile.getFullPathName());
+void PluginManagementComponent::scanFinished()
+{
+    stopTimer();
+    scanningWindow.reset();
+    scanPluginsButton.setEnabled(true);
 
-                for (auto* desc : descs)
-                    if (desc != nullptr)
-                        tempList.addType(*desc);
-            }
-            catch (...)
-            {
-                DBG("An exception was caught while scanning a non-Waves plugin: " + pluginFile.getFileName() + ". Skipping this file.");
-            }
-        }
+    auto& lang = LanguageManager::getInstance();
+    auto message = lang.get("scanProcess.completeMessage");
 
-        ++nextFileToScan; // Move to the next file
-    }
-    else
+    const auto& failures = getSharedPluginManager().getLastScanFailures();
+    if (failures.size() > 0)
     {
-        // --- All non-Waves files have been scanned ---
-        stopTimer();
-
-        // 3. Now, handle Waves plugins using the dedicated, safe manager.
-        // This is still a blocking call, but it's much faster than a full scan.
-        WavesShellManager::getInstance().scanAndParseShells();
-        for (const auto& wavesDesc : WavesShellManager::getInstance().getScannedPlugins())
-        {
-            tempList.addType(wavesDesc);
-        }
-
-        // 4. Update the actual plugin list in the manager
-        getSharedPluginManager().replaceAllPlugins(tempList);
-
-        // 5. Clean up UI
-        scanningWindow.reset();
-        scanPluginsButton.setEnabled(true);
-
-        auto& lang = LanguageManager::getInstance();
-        juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::InfoIcon,
-            lang.get("scanProcess.completeTitle"),
-            lang.get("scanProcess.completeMessage"));
+        message << "\n\n" << lang.get("scanProcess.blacklistedMessage");
+        for (int i = 0; i < failures.size(); ++i)
+            message << "\n" << juce::File(failures.getAllKeys()[i]).getFileName() << ": " << failures.getAllValues()[i];
     }
+
+    juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::InfoIcon,
+        lang.get("scanProcess.completeTitle"),
+        message);
 }
 
 
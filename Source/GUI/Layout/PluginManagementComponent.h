@@ -9,7 +9,7 @@
 // Forward declare the helper class
 class ScanningWindow;
 
-// <<< MODIFIED: Inherit from juce::Timer to perform non-blocking scan >>>
+// Inherits from juce::Timer to show the progress of the background scan
 class PluginManagementComponent : public juce::Component,
     public juce::ChangeListener,
     public juce::Timer
@@ -22,20 +22,16 @@ public:
     void resized() override;
     void changeListenerCallback(juce::ChangeBroadcaster* source) override;
 
-    // <<< NEW: Timer callback for scanning >>>
+    // Timer callback for the scan progress bar
     void timerCallback() override;
 
 private:
     void updateTexts();
 
-    // <<< NEW: Helper to start the scan >>>
     void startScan();
+    void scanFinished();
 
     juce::TextButton scanPluginsButton, managePluginsButton, addPluginButton;
 
-    // <<< NEW: State variables for the non-blocking scan >>>
     std::unique_ptr<ScanningWindow> scanningWindow;
-    juce::Array<juce::File> filesToScan;
-    int nextFileToScan = 0;
-    juce::KnownPluginList tempList; // A temporary list to build plugins into
 };
\ No newline at end of file
@@ -13,6 +13,7 @@
 #include "../Windows/PresetManagerWindow.h"
 #include "../../Data/AppState.h" 
 #include "../../Data/PresetManager.h"
+#include "../../Data/PresetFile.h"
 
 #include "../MainComponent/MainComponent.h"
 #include "TrackComponent.h"
@@ -130,6 +131,7 @@ void PresetBarComponent::resized()
 void PresetBarComponent::loadPresetTask(const juce::String& presetName)
 {
     if (presetName.isEmpty()) return;
+    IDOL_STALL_OPERATION("Load preset");
 
     auto* mainComp = findParentComponentOfClass<MainComponent>();
     if (mainComp == nullptr) return;
@@ -137,9 +139,18 @@ void PresetBarComponent::loadPresetTask(const juce::String& presetName)
     auto* statusBar = mainComp->getStatusBarComponent();
     if (statusBar == nullptr) return;
 
+    if (audioEngine.isLoadingState())
+    {
+        // Only the newest request matters; it starts once the running load has stopped.
+        pendingPresetName = presetName;
+        audioEngine.cancelStateLoad();
+        statusBar->setStatusMessage("Cancelling the current preset load...", false);
+        return;
+    }
+
     AppState::getInstance().setIsLoadingPreset(true);
 
-    auto presetFile = getSharedPresetManager().getPresetDirectory().getChildFile(presetName + ".xml");
+    auto presetFile = getSharedPresetManager().getPresetFile(presetName);
     if (!presetFile.existsAsFile())
     {
         statusBar->setStatusMessage("Error: Preset file not found!", true);
@@ -147,14 +158,13 @@ void PresetBarComponent::loadPresetTask(const juce::String& presetName)
         return;
     }
 
-    auto xmlDoc = juce::parseXML(presetFile);
-    if (xmlDoc == nullptr || !xmlDoc->hasTagName("Preset"))
+    juce::ValueTree newState = getSharedPresetManager().readPreset(presetFile);
+    if (!newState.isValid())
     {
         statusBar->setStatusMessage("Error: Invalid preset file!", true);
         AppState::getInstance().setIsLoadingPreset(false);
         return;
     }
-    juce::ValueTree newState = juce::ValueTree::fromXml(*xmlDoc);
 
     // Trích xuất thông tin trạng thái khóa từ preset
     const bool isLocked = newState.getProperty(Identifiers::lockState, false);
@@ -177,6 +187,7 @@ void PresetBarComponent::loadPresetTask(const juce::String& presetName)
 
             statusBar->setStatusMessage("Load successful!", false);
             juce::Timer::callAfterDelay(2000, [statusBar]() { if (statusBar) statusBar->setStatusMessage("", false); });
+            juce::Timer::callAfterDelay(100, [] { AppState::getInstance().setIsLoadingPreset(false); });
         }
         else
         {
@@ -189,21 +200,60 @@ void PresetBarComponent::loadPresetTask(const juce::String& presetName)
         statusBar->setStatusMessage("Plugin chain changed, performing full reload...", false);
         performFullReload(newState, presetName, isLocked, passwordHash);
     }
-
-    juce::Timer::callAfterDelay(100, [] { AppState::getInstance().setIsLoadingPreset(false); });
 }
 
 void PresetBarComponent::performFullReload(const juce::ValueTree& newState, const juce::String& presetName, bool isLocked, const juce::String& passwordHash)
 {
     auto* mainComp = findParentComponentOfClass<MainComponent>();
     auto* statusBar = mainComp ? mainComp->getStatusBarComponent() : nullptr;
-    if (mainComp == nullptr || statusBar == nullptr) return;
+    if (mainComp == nullptr || statusBar == nullptr)
+    {
+        AppState::getInstance().setIsLoadingPreset(false);
+        return;
+    }
+
+    // The new chains are built in the background; the UI and the old preset keep running meanwhile.
+    juce::Component::SafePointer<PresetBarComponent> safeThis(this);
+    PresetLoader::Callbacks callbacks;
 
-    bool preparationSuccess = audioEngine.prepareToLoadState(newState);
+    callbacks.onProgress = [safeThis](int numLoaded, int numTotal, const juce::String& pluginName)
+    {
+        if (safeThis == nullptr) return;
+        if (auto* mc = safeThis->findParentComponentOfClass<MainComponent>())
+            if (auto* bar = mc->getStatusBarComponent())
+                bar->setStatusMessage("Loading plugins " + juce::String(numLoaded) + "/" + juce::String(numTotal)
+                                      + ": " + pluginName, false);
+    };
+
+    callbacks.onFinished = [safeThis, presetName, isLocked, passwordHash](const PresetLoader::Result& result)
+    {
+        if (safeThis != nullptr)
+            safeThis->finishFullReload(result, presetName, isLocked, passwordHash);
+        else
+            AppState::getInstance().setIsLoadingPreset(false);
+    };
 
-    if (!preparationSuccess)
+    if (!audioEngine.prepareToLoadState(newState, std::move(callbacks)))
     {
         statusBar->setStatusMessage("Critical Error: Failed to prepare plugins for loading!", true);
+        AppState::getInstance().setIsLoadingPreset(false);
+    }
+}
+
+void PresetBarComponent::finishFullReload(const PresetLoader::Result& result, const juce::String& presetName, bool isLocked, const juce::String& passwordHash)
+{
+    auto* mainComp = findParentComponentOfClass<MainComponent>();
+    auto* statusBar = mainComp ? mainComp->getStatusBarComponent() : nullptr;
+
+    if (!result.succeeded || mainComp == nullptr || statusBar == nullptr)
+    {
+        if (statusBar != nullptr && !result.wasCancelled)
+            statusBar->setStatusMessage("Critical Error: Failed to prepare plugins for loading!", true);
+
+        AppState::getInstance().setIsLoadingPreset(false);
+
+        if (pendingPresetName.isNotEmpty())
+            loadPresetTask(std::exchange(pendingPresetName, {}));
         return;
     }
 
@@ -226,6 +276,10 @@ void PresetBarComponent::performFullReload(const juce::ValueTree& newState, cons
 
     deviceManager.restartLastAudioDevice();
 
+    statusBar->setStatusMessage("Load successful!", false);
+    juce::Timer::callAfterDelay(2000, [statusBar]() { if (statusBar) statusBar->setStatusMessage("", false); });
+    juce::Timer::callAfterDelay(100, [] { AppState::getInstance().setIsLoadingPreset(false); });
+
     juce::Timer::callAfterDelay(500, [this, mainComp, savedVocalInputName, savedMusicInputName, savedOutputName]()
         {
             if (mainComp == nullptr) return;
@@ -247,8 +301,7 @@ void PresetBarComponent::showAssignMenuForSlot(int slotIndex)
     juce::PopupMenu menu;
     auto& lang = LanguageManager::getInstance();
     juce::PopupMenu assignMenu;
-    auto presetDir = getSharedPresetManager().getPresetDirectory();
-    auto presetFiles = presetDir.findChildFiles(juce::File::findFiles, false, "*.xml");
+    auto presetFiles = getSharedPresetManager().getPresetFiles();
     int presetItemId = 1;
     for (const auto& file : presetFiles)
     {
@@ -277,7 +330,8 @@ void PresetBarComponent::showAssignMenuForSlot(int slotIndex)
 void PresetBarComponent::saveAsNewPreset(std::function<void(bool)> onComplete)
 {
     auto& lang = LanguageManager::getInstance();
-    auto fc = std::make_shared<juce::FileChooser>(lang.get("presetbar.saveAsTitle"), getSharedPresetManager().getPresetDirectory(), "*.xml");
+    auto fc = std::make_shared<juce::FileChooser>(lang.get("presetbar.saveAsTitle"), getSharedPresetManager().getPresetDirectory(),
+                                                  juce::String("*") + PresetFile::fileExtension);
     fc->launchAsync(juce::FileBrowserComponent::saveMode,
         [this, fc, onComplete](const juce::FileChooser& chooser)
         {
@@ -285,10 +339,10 @@ void PresetBarComponent::saveAsNewPreset(std::function<void(bool)> onComplete)
             if (resultFile != juce::File{})
             {
                 auto currentState = audioEngine.getFullState();
-                if (auto xml = std::unique_ptr<juce::XmlElement>(currentState.createXml()))
+                if (getSharedPresetManager().writePreset(currentState, resultFile))
                 {
-                    xml->writeTo(resultFile, {});
                     auto newPresetName = resultFile.getFileNameWithoutExtension();
+                    audioEngine.markStateSaved();
                     AppState::getInstance().markAsSaved(newPresetName);
                     if (onComplete) onComplete(true);
                 }
@@ -316,11 +370,11 @@ void PresetBarComponent::handleSaveAction()
             {
                 if (result == 1)
                 {
-                    auto presetFileToOverwrite = getSharedPresetManager().getPresetDirectory().getChildFile(currentPresetName + ".xml");
+                    auto presetFileToOverwrite = getSharedPresetManager().getPresetFile(currentPresetName);
                     auto currentState = audioEngine.getFullState();
-                    if (auto xml = std::unique_ptr<juce::XmlElement>(currentState.createXml()))
+                    if (getSharedPresetManager().writePreset(currentState, presetFileToOverwrite))
                     {
-                        xml->writeTo(presetFileToOverwrite, {});
+                        audioEngine.markStateSaved();
                         AppState::getInstance().markAsSaved(currentPresetName);
                     }
                 }
@@ -385,7 +439,7 @@ void PresetBarComponent::updateTexts()
     managePresetsButton.setButtonText(lang.get("managers.managePresets"));
     auto currentPresetName = AppState::getInstance().getCurrentPresetName();
     presetRunningValue.setText(currentPresetName, juce::dontSendNotification);
-    auto presetFile = getSharedPresetManager().getPresetDirectory().getChildFile(currentPresetName + ".xml");
+    auto presetFile = getSharedPresetManager().getPresetFile(currentPresetName);
     if (currentPresetName.isEmpty() || !presetFile.existsAsFile())
     {
         presetRunningValue.setText(lang.get("presetbar.noPresetLoaded"), juce::dontSendNotification);
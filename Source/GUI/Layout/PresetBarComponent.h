@@ -42,10 +42,14 @@ private:
 
     // <<< FIXED: Updated function signature to match implementation >>>
     void performFullReload(const juce::ValueTree& newState, const juce::String& presetName, bool isLocked, const juce::String& passwordHash);
+    void finishFullReload(const PresetLoader::Result& result, const juce::String& presetName, bool isLocked, const juce::String& passwordHash);
 
     AudioEngine& audioEngine;
 
     juce::Label presetRunningLabel, presetRunningValue, quickChoiceLabel;
     std::array<std::unique_ptr<PresetSlotComponent>, AppState::numQuickSlots> quickLoadSlots;
     juce::TextButton savePresetButton, managePresetsButton;
+
+    // Asked for while another preset was still loading; loaded once that one is cancelled.
+    juce::String pendingPresetName;
 };
\ No newline at end of file
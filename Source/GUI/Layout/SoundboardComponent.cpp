@@ -126,7 +126,7 @@ SoundboardComponent::SoundboardComponent(AudioEngine& engine)
                     const auto& slot = slots.getReference(i);
                     if (!slot.isEmpty())
                     {
-                        audioEngine.getSoundPlayer().play(slot.audioFile, i);
+                        audioEngine.getSoundPlayer().play(slot, i);
                     }
                 }
             };
@@ -135,6 +135,7 @@ SoundboardComponent::SoundboardComponent(AudioEngine& engine)
 
     updateTexts();
     updateButtonLabels();
+    audioEngine.getSoundPlayer().preloadSlots(getSharedSoundboardProfileManager().getCurrentSlots());
 }
 
 SoundboardComponent::~SoundboardComponent()
@@ -193,6 +194,7 @@ void SoundboardComponent::changeListenerCallback(juce::ChangeBroadcaster* source
     }
     else if (source == &getSharedSoundboardProfileManager())
     {
+        audioEngine.getSoundPlayer().preloadSlots(getSharedSoundboardProfileManager().getCurrentSlots());
         updateButtonLabels();
     }
 }
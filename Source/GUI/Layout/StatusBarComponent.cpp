@@ -5,6 +5,7 @@ StatusBarComponent::StatusBarComponent()
 {
     LanguageManager::getInstance().addChangeListener(this);
     addAndMakeVisible(cpuLabel);
+    addAndMakeVisible(dspLabel);
     addAndMakeVisible(latencyLabel);
     addAndMakeVisible(sampleRateLabel);
 
@@ -34,6 +35,7 @@ StatusBarComponent::StatusBarComponent()
     linkButton.setURL(juce::URL("https://github.com/DEVCodeWithAI"));
 
     cpuLabel.setText("CPU: --", juce::dontSendNotification);
+    dspLabel.setText("DSP: --", juce::dontSendNotification);
     latencyLabel.setText("Latency: --", juce::dontSendNotification);
     sampleRateLabel.setText("Rate: --", juce::dontSendNotification);
 }
@@ -81,6 +83,8 @@ void StatusBarComponent::resized() {
     auto leftBounds = bounds;
     cpuLabel.setBounds(leftBounds.removeFromLeft(100));
     leftBounds.removeFromLeft(padding);
+    dspLabel.setBounds(leftBounds.removeFromLeft(170));
+    leftBounds.removeFromLeft(padding);
     latencyLabel.setBounds(leftBounds.removeFromLeft(150));
     leftBounds.removeFromLeft(padding);
     sampleRateLabel.setBounds(leftBounds.removeFromLeft(100));
@@ -103,4 +107,12 @@ void StatusBarComponent::updateStatus(double cpuUsage, double latencyMs, double
     cpuLabel.setText(cpuText, juce::dontSendNotification);
     latencyLabel.setText(latencyText, juce::dontSendNotification);
     sampleRateLabel.setText(rateText, juce::dontSendNotification);
+}
+
+void StatusBarComponent::updateDspLoad(double averageLoad, double peakLoad)
+{
+    dspLabel.setText("DSP: " + IdolUIHelpers::formatLoad(averageLoad) + " (peak " + IdolUIHelpers::formatLoad(peakLoad) + ")",
+                     juce::dontSendNotification);
+    dspLabel.setColour(juce::Label::textColourId, IdolUIHelpers::getLoadColour(peakLoad));
+    dspLabel.setTooltip("Audio callback time against the block deadline");
 }
\ No newline at end of file
@@ -13,11 +13,13 @@ public:
 
     void setStatusMessage(const juce::String& message, bool isError);
     void updateStatus(double cpuUsage, double latencyMs, double sampleRate);
+    /** The audio callback's share of the block deadline (1.0 = all of it). */
+    void updateDspLoad(double averageLoad, double peakLoad);
 
 private:
     void updateTexts();
 
-    juce::Label cpuLabel, latencyLabel, sampleRateLabel;
+    juce::Label cpuLabel, dspLabel, latencyLabel, sampleRateLabel;
     juce::Label statusLabel;
 
     // <<< SỬA: Dùng 2 Label riêng biệt >>>
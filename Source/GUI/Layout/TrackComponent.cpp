@@ -77,6 +77,9 @@ public:
         : owner(ownerComponent), row(rowNumber)
     {
         addAndMakeVisible(nameLabel);
+        addAndMakeVisible(loadLabel);
+        loadLabel.setJustificationType(juce::Justification::centredRight);
+        loadLabel.setFont(IdolUIHelpers::createRegularFont(12.0f));
         addAndMakeVisible(openButton);
         openButton.setButtonText("O");
         openButton.addListener(this);
@@ -115,6 +118,7 @@ public:
         powerButton.setBounds(controlsArea.removeFromRight(50).reduced(2));
         controlsArea.removeFromRight(5);
         openButton.setBounds(controlsArea.removeFromRight(30).reduced(2));
+        loadLabel.setBounds(bounds.removeFromRight(55));
         nameLabel.setBounds(bounds);
     }
 
@@ -150,6 +154,26 @@ public:
             powerButton.setToggleState(!isBypassed, juce::dontSendNotification);
             powerButton.setButtonText(isBypassed ? "OFF" : "ON");
         }
+        updateLoad();
+    }
+
+    // Cột CPU: tải trung bình, màu theo đỉnh
+    void updateLoad()
+    {
+        if (owner.processor == nullptr) return;
+
+        if (owner.processor->isPluginBypassed(row))
+        {
+            loadLabel.setText("--", juce::dontSendNotification);
+            loadLabel.setColour(juce::Label::textColourId, juce::Colours::grey);
+            return;
+        }
+
+        const auto load = owner.processor->getPluginLoad(row);
+        loadLabel.setText(IdolUIHelpers::formatLoad(load.averageLoad), juce::dontSendNotification);
+        loadLabel.setColour(juce::Label::textColourId, IdolUIHelpers::getLoadColour(load.peakLoad));
+        loadLabel.setTooltip("Peak " + IdolUIHelpers::formatLoad(load.peakLoad) + ", "
+                             + juce::String(load.averageMs, 2) + " ms average");
     }
 
     void setLocked(bool shouldBeLocked, bool isSpecialSlot)
@@ -183,6 +207,7 @@ private:
     TrackComponent& owner;
     int row;
     juce::Label nameLabel;
+    juce::Label loadLabel;
     juce::TextButton openButton;
     juce::ToggleButton powerButton;
     juce::TextButton removeButton;
@@ -200,6 +225,7 @@ TrackComponent::TrackComponent(const juce::String& trackNameKey, const juce::Col
     // Logic cho ListBox plugin không đổi
     pluginListBox.setModel(this);
     pluginListBox.setRowHeight(35);
+    startTimerHz(4);
 
     addAndMakeVisible(trackLabel);
 
@@ -262,6 +288,7 @@ TrackComponent::TrackComponent(const juce::String& trackNameKey, const juce::Col
 
 TrackComponent::~TrackComponent()
 {
+    stopTimer();
     closeAllPluginWindows();
 
     LanguageManager::getInstance().removeChangeListener(this);
@@ -450,6 +477,15 @@ void TrackComponent::comboBoxChanged(juce::ComboBox* comboBoxThatHasChanged)
     }
 }
 
+void TrackComponent::timerCallback()
+{
+    if (processor == nullptr || !isShowing()) return;
+
+    for (int row = 0; row < getNumRows(); ++row)
+        if (auto* item = dynamic_cast<PluginItemComponent*>(pluginListBox.getComponentForRowNumber(row)))
+            item->updateLoad();
+}
+
 void TrackComponent::setProcessor(ProcessorBase* proc)
 {
     if (processor)
@@ -475,41 +511,36 @@ void TrackComponent::addSelectedPlugin()
     if (selectedUniqueId == 0)
         return;
 
-    const auto pluginList = getSharedPluginManager().getKnownPlugins();
-
-    for (const auto& desc : pluginList)
+    const auto catalog = getSharedPluginManager().getCatalog();
+    if (const auto* desc = catalog->findByUniqueId(selectedUniqueId))
     {
-        if (desc.uniqueId == selectedUniqueId)
+        const auto spec = processor->getProcessSpec();
+        try
         {
-            const auto spec = processor->getProcessSpec();
-            try
-            {
-                if (auto instance = getSharedPluginManager().createPluginInstance(desc, spec))
-                {
-                    instance->addListener(this);
-                    processor->addPlugin(std::move(instance));
-                }
-                else
-                {
-                    juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon,
-                        "Plugin Error", "Failed to create plugin instance.");
-                }
-            }
-            catch (const std::exception& e)
+            if (auto instance = getSharedPluginManager().createPluginInstance(*desc, spec))
             {
-                juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon,
-                    "Plugin Exception", "Error: " + juce::String(e.what()));
+                instance->addListener(this);
+                processor->addPlugin(std::move(instance));
             }
-            catch (...)
+            else
             {
                 juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon,
-                    "Plugin Exception", "An unknown error occurred while adding plugin.");
+                    "Plugin Error", "Failed to create plugin instance.");
             }
-
-            addPluginSelector.setText({}, juce::dontSendNotification);
-            updatePluginSelector();
-            return;
         }
+        catch (const std::exception& e)
+        {
+            juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon,
+                "Plugin Exception", "Error: " + juce::String(e.what()));
+        }
+        catch (...)
+        {
+            juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon,
+                "Plugin Exception", "An unknown error occurred while adding plugin.");
+        }
+
+        addPluginSelector.setText({}, juce::dontSendNotification);
+        updatePluginSelector();
     }
 }
 
@@ -522,13 +553,13 @@ void TrackComponent::updatePluginSelector(const juce::String& searchText)
 
     addPluginSelector.clear(juce::dontSendNotification);
 
-    const auto pluginList = getSharedPluginManager().getFilteredPlugins(searchText);
+    const auto catalog = getSharedPluginManager().getCatalog();
 
     bool currentSelectionStillExists = false;
-    for (const auto& desc : pluginList)
+    for (const auto* desc : catalog->search(searchText))
     {
-        addPluginSelector.addItem(desc.name, desc.uniqueId);
-        if (desc.uniqueId == currentlySelectedId)
+        addPluginSelector.addItem(desc->name, desc->uniqueId);
+        if (desc->uniqueId == currentlySelectedId)
             currentSelectionStillExists = true;
     }
 
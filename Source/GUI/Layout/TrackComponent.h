@@ -16,7 +16,8 @@ class TrackComponent : public juce::Component,
     public juce::ChangeListener,
     public juce::ListBoxModel,
     public juce::AudioProcessorListener,
-    public juce::ComboBox::Listener
+    public juce::ComboBox::Listener,
+    public juce::Timer
 {
 public:
     enum class ChannelType { Vocal, Music };
@@ -30,6 +31,7 @@ public:
     void comboBoxChanged(juce::ComboBox* comboBoxThatHasChanged) override;
     void audioProcessorParameterChanged(juce::AudioProcessor* changedProcessor, int parameterIndex, float newValue) override;
     void audioProcessorChanged(juce::AudioProcessor* changedProcessor, const ChangeDetails& details) override;
+    void timerCallback() override;
 
     // --- Getters và Setters ---
     void setProcessor(ProcessorBase* proc);
@@ -19,6 +19,7 @@
 #include "../../Application/Application.h"
 #include "../../Data/AppState.h"
 #include "../Components/ProjectManagerComponent.h"
+#include "../../Diagnostics/TraceRecorder.h"
 
 
 #if JUCE_WINDOWS && JUCE_ASIO
@@ -71,7 +72,7 @@ MainComponent::MainComponent()
     presetBar = std::make_unique<PresetBarComponent>(audioEngine);
     vocalTrack = std::make_unique<TrackComponent>("tracks.vocal", juce::Colour(0xff60a5fa), TrackComponent::ChannelType::Vocal);
     musicTrack = std::make_unique<TrackComponent>("tracks.music", juce::Colour(0xff4ade80), TrackComponent::ChannelType::Music);
-    beatManager = std::make_unique<BeatManagerComponent>();
+    beatManager = std::make_unique<BeatManagerComponent>(audioEngine.getVocalRemover());
     masterUtilityColumn = std::make_unique<MasterUtilityComponent>(audioEngine);
     pluginManagement = std::make_unique<PluginManagementComponent>();
     statusBar = std::make_unique<StatusBarComponent>();
@@ -87,13 +88,25 @@ MainComponent::MainComponent()
     addAndMakeVisible(*statusBar);
 
     beatManager->onWantsToExpand = [this] { setBeatManagerExpanded(true); };
+
+    audioEngine.getOverrunWatchdog().onPluginBypassed = [this](const OverrunWatchdog::Trip& trip)
+        {
+            if (statusBar != nullptr)
+                statusBar->setStatusMessage("Auto-bypassed '" + trip.pluginName + "': " + juce::String(trip.numOverruns)
+                                            + " audio dropouts in " + juce::String(trip.windowSeconds, 1) + " s", true);
+        };
     beatManager->onBeatPlayed = [this] { setBeatManagerExpanded(false); };
 
-    audioEngine.linkTrackComponents(*vocalTrack, *musicTrack);
+    // Nối meter và processor của từng track
+    audioEngine.getVocalProcessor().setLevelSource(vocalTrack->getLevelMeter().getLevelSource());
+    audioEngine.getMusicProcessor().setLevelSource(musicTrack->getLevelMeter().getLevelSource());
+    vocalTrack->setProcessor(&audioEngine.getVocalProcessor());
+    musicTrack->setProcessor(&audioEngine.getMusicProcessor());
     vocalTrack->setAudioEngine(&audioEngine, *deviceManager);
     musicTrack->setAudioEngine(&audioEngine, *deviceManager);
     audioEngine.setSelectedOutputChannels(0, 1);
-    audioEngine.linkMasterComponents(*masterUtilityColumn);
+    audioEngine.getMasterProcessor().setLevelSource(masterUtilityColumn->getMasterLevelMeter().getLevelSource());
+    masterUtilityColumn->setMasterProcessor(&audioEngine.getMasterProcessor());
 
     // Trigger the initial update for the hotkey manager
     changeListenerCallback(&getSharedSoundboardProfileManager());
@@ -112,6 +125,7 @@ MainComponent::MainComponent()
 MainComponent::~MainComponent()
 {
     getSharedSoundboardProfileManager().removeChangeListener(this);
+    audioEngine.getOverrunWatchdog().onPluginBypassed = nullptr;
 
     if (deviceManager)
     {
@@ -240,6 +254,7 @@ void MainComponent::resized()
 
 void MainComponent::timerCallback()
 {
+    IDOL_TRACE_SCOPE("message", "Main timer");
     if (auto* device = deviceManager->getCurrentAudioDevice())
     {
         auto cpuUsage = deviceManager->getCpuUsage() * 100.0;
@@ -248,7 +263,12 @@ void MainComponent::timerCallback()
         auto sampleRate = device->getCurrentSampleRate();
 
         if (statusBar != nullptr)
+        {
             statusBar->updateStatus(cpuUsage, latencyMs, sampleRate);
+
+            const auto callbackLoad = audioEngine.getCallbackLoad();
+            statusBar->updateDspLoad(callbackLoad.averageLoad, callbackLoad.peakLoad);
+        }
     }
     else
     {
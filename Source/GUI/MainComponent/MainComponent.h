@@ -10,6 +10,7 @@
 #include "JuceHeader.h"
 #include "../../AudioEngine/AudioEngine.h"
 #include "../../Components/CustomLookAndFeel.h"
+#include "../../Diagnostics/StallDetector.h"
 #include <functional>
 
 // Forward declarations
@@ -52,6 +53,7 @@ public:
     MasterUtilityComponent& getMasterUtilityComponent() { return *masterUtilityColumn; }
     PresetBarComponent& getPresetBar() { return *presetBar; }
     MenubarComponent* getMenubarComponent() { return menubar.get(); }
+    StallDetector& getStallDetector() { return stallDetector; }
 
     // <<< ADDED: Getter for the status bar >>>
     StatusBarComponent* getStatusBarComponent() { return statusBar.get(); }
@@ -82,5 +84,8 @@ private:
     std::unique_ptr<PluginManagementComponent> pluginManagement;
     std::unique_ptr<StatusBarComponent> statusBar;
 
+    // Last, so it stops watching before anything else is torn down.
+    StallDetector stallDetector;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MainComponent)
 };
\ No newline at end of file
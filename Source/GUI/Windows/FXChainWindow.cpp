@@ -73,16 +73,19 @@ public:
         powerButton.setBounds(controlsArea.removeFromRight(50).reduced(2));
         controlsArea.removeFromRight(5);
         openButton.setBounds(controlsArea.removeFromRight(30).reduced(2));
+        loadLabel.setBounds(bounds.removeFromRight(55));
         nameLabel.setBounds(bounds);
     }
 
     void buttonClicked(juce::Button* button) override;
     void update(int newRowNumber);
+    void updateLoad();
 
 private:
     FXChainWindow::Content& ownerComponent;
     int rowNumber;
     juce::Label nameLabel;
+    juce::Label loadLabel;
     juce::TextButton openButton;
     juce::ToggleButton powerButton;
     juce::TextButton removeButton, moveUpButton, moveDownButton;
@@ -95,7 +98,8 @@ class FXChainWindow::Content : public juce::Component,
     public juce::ListBoxModel,
     public juce::ComboBox::Listener,
     public juce::ChangeListener,
-    public juce::AudioProcessorListener
+    public juce::AudioProcessorListener,
+    public juce::Timer
 {
 public:
     Content(ProcessorBase& processor) : processorToControl(processor)
@@ -153,10 +157,12 @@ public:
         addButton.onClick = [this] { addSelectedPlugin(); };
 
         setSize(500, 600);
+        startTimerHz(4);
     }
 
     ~Content() override
     {
+        stopTimer();
         openPluginWindows.clear();
         processorToControl.removeChangeListener(this);
         getSharedPluginManager().removeChangeListener(this);
@@ -233,6 +239,30 @@ public:
 
     ProcessorBase& getProcessor() { return processorToControl; }
 
+    void timerCallback() override
+    {
+        for (int row = 0; row < getNumRows(); ++row)
+            if (auto* item = dynamic_cast<PluginItemComponent*>(pluginListBox.getComponentForRowNumber(row)))
+                item->updateLoad();
+    }
+
+    void deletePlugin(int row)
+    {
+        // The editor window must be gone before the instance is handed to the reaper.
+        if (auto* plugin = processorToControl.getPlugin(row))
+        {
+            plugin->removeListener(this);
+            for (int i = openPluginWindows.size(); --i >= 0;)
+                if (auto* pw = dynamic_cast<PluginWindow*>(openPluginWindows.getUnchecked(i)))
+                    if (&pw->getOwnerPlugin() == plugin)
+                    {
+                        openPluginWindows.removeObject(pw, true);
+                        break;
+                    }
+        }
+        processorToControl.removePlugin(row);
+    }
+
     void comboBoxChanged(juce::ComboBox* cb) override
     {
         if (isUpdatingFromTextChange) return; // <<< ADDED
@@ -281,19 +311,16 @@ public:
         const int selectedId = addPluginSelector.getSelectedId();
         if (selectedId == 0) return;
 
-        for (const auto& desc : getSharedPluginManager().getKnownPlugins())
+        const auto catalog = getSharedPluginManager().getCatalog();
+        if (const auto* desc = catalog->findByUniqueId(selectedId))
         {
-            if (desc.uniqueId == selectedId)
+            auto spec = processorToControl.getProcessSpec();
+            if (auto instance = getSharedPluginManager().createPluginInstance(*desc, spec))
             {
-                auto spec = processorToControl.getProcessSpec();
-                if (auto instance = getSharedPluginManager().createPluginInstance(desc, spec))
-                {
-                    processorToControl.addPlugin(std::move(instance));
-                }
-                addPluginSelector.setText({}, juce::dontSendNotification);
-                updatePluginSelector();
-                return;
+                processorToControl.addPlugin(std::move(instance));
             }
+            addPluginSelector.setText({}, juce::dontSendNotification);
+            updatePluginSelector();
         }
     }
 
@@ -305,10 +332,11 @@ public:
         addPluginSelector.clear(juce::dontSendNotification);
 
         bool currentSelectionStillExists = false;
-        for (const auto& desc : getSharedPluginManager().getFilteredPlugins(searchText))
+        const auto catalog = getSharedPluginManager().getCatalog();
+        for (const auto* desc : catalog->search(searchText))
         {
-            addPluginSelector.addItem(desc.name, desc.uniqueId);
-            if (desc.uniqueId == currentlySelectedId)
+            addPluginSelector.addItem(desc->name, desc->uniqueId);
+            if (desc->uniqueId == currentlySelectedId)
                 currentSelectionStillExists = true;
         }
         if (currentSelectionStillExists)
@@ -365,6 +393,10 @@ PluginItemComponent::PluginItemComponent(FXChainWindow::Content& owner, int row)
 {
     addAndMakeVisible(nameLabel);
 
+    addAndMakeVisible(loadLabel);
+    loadLabel.setJustificationType(juce::Justification::centredRight);
+    loadLabel.setFont(IdolUIHelpers::createRegularFont(12.0f));
+
     addAndMakeVisible(openButton);
     openButton.setButtonText("O");
     openButton.addListener(this);
@@ -395,7 +427,7 @@ void PluginItemComponent::buttonClicked(juce::Button* button)
 {
     if (button == &openButton) ownerComponent.showPluginEditor(rowNumber);
     else if (button == &powerButton) ownerComponent.getProcessor().setPluginBypassed(rowNumber, !ownerComponent.getProcessor().isPluginBypassed(rowNumber));
-    else if (button == &removeButton) ownerComponent.getProcessor().removePlugin(rowNumber);
+    else if (button == &removeButton) ownerComponent.deletePlugin(rowNumber);
     else if (button == &moveUpButton) ownerComponent.getProcessor().movePlugin(rowNumber, rowNumber - 1);
     else if (button == &moveDownButton) ownerComponent.getProcessor().movePlugin(rowNumber, rowNumber + 1);
 }
@@ -411,6 +443,24 @@ void PluginItemComponent::update(int newRowNumber)
         powerButton.setButtonText(isBypassed ? "OFF" : "ON");
         openButton.setEnabled(plugin->hasEditor());
     }
+    updateLoad();
+}
+
+void PluginItemComponent::updateLoad()
+{
+    auto& processor = ownerComponent.getProcessor();
+    if (processor.isPluginBypassed(rowNumber))
+    {
+        loadLabel.setText("--", juce::dontSendNotification);
+        loadLabel.setColour(juce::Label::textColourId, juce::Colours::grey);
+        return;
+    }
+
+    const auto load = processor.getPluginLoad(rowNumber);
+    loadLabel.setText(IdolUIHelpers::formatLoad(load.averageLoad), juce::dontSendNotification);
+    loadLabel.setColour(juce::Label::textColourId, IdolUIHelpers::getLoadColour(load.peakLoad));
+    loadLabel.setTooltip("Peak " + IdolUIHelpers::formatLoad(load.peakLoad) + ", "
+                         + juce::String(load.averageMs, 2) + " ms average");
 }
 
 
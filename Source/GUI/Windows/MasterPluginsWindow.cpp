@@ -282,31 +282,31 @@ void MasterPluginsEditorComponent::addSelectedPlugin()
     if (selectedUniqueId == 0)
         return;
 
-    const auto pluginList = getSharedPluginManager().getKnownPlugins();
-    for (const auto& desc : pluginList)
+    const auto catalog = getSharedPluginManager().getCatalog();
+    if (const auto* desc = catalog->findByUniqueId(selectedUniqueId))
     {
-        if (desc.uniqueId == selectedUniqueId)
-        {
-            const auto spec = masterProcessor.getProcessSpec();
-            if (auto instance = getSharedPluginManager().createPluginInstance(desc, spec))
-                masterProcessor.addPlugin(std::move(instance));
+        const auto spec = masterProcessor.getProcessSpec();
+        if (auto instance = getSharedPluginManager().createPluginInstance(*desc, spec))
+            masterProcessor.addPlugin(std::move(instance));
 
-            addPluginSelector.setText({}, juce::dontSendNotification);
-            updatePluginSelector();
-            return;
-        }
+        addPluginSelector.setText({}, juce::dontSendNotification);
+        updatePluginSelector();
     }
 }
 
 void MasterPluginsEditorComponent::deletePlugin(int row)
 {
     if (auto* plugin = masterProcessor.getPlugin(row))
+    {
+        // The instance outlives this call on the reaper, so stop listening to it now.
+        plugin->removeListener(this);
         for (int i = openPluginWindows.size(); --i >= 0;)
             if (openPluginWindows[i]->getName() == plugin->getName())
             {
                 openPluginWindows.removeObject(openPluginWindows[i], true);
                 break;
             }
+    }
     masterProcessor.removePlugin(row);
 }
 
@@ -351,13 +351,13 @@ void MasterPluginsEditorComponent::updatePluginSelector(const juce::String& sear
 
     addPluginSelector.clear(juce::dontSendNotification);
 
-    const auto pluginList = getSharedPluginManager().getFilteredPlugins(searchText);
+    const auto catalog = getSharedPluginManager().getCatalog();
 
     bool currentSelectionStillExists = false;
-    for (const auto& desc : pluginList)
+    for (const auto* desc : catalog->search(searchText))
     {
-        addPluginSelector.addItem(desc.name, desc.uniqueId);
-        if (desc.uniqueId == currentlySelectedId)
+        addPluginSelector.addItem(desc->name, desc->uniqueId);
+        if (desc->uniqueId == currentlySelectedId)
             currentSelectionStillExists = true;
     }
 
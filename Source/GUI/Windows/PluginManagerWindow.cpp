@@ -37,6 +37,16 @@ PluginManagerContentComponent::PluginManagerContentComponent()
     addAndMakeVisible(removeButton);
     removeButton.onClick = [this] { removeSelectedPlugin(); };
 
+    addAndMakeVisible(exportButton);
+    exportButton.onClick = [] {
+        auto fc = std::make_shared<juce::FileChooser>("Export Plugin List", juce::File{}, "*.xml");
+        fc->launchAsync(juce::FileBrowserComponent::saveMode,
+            [fc](const juce::FileChooser& chooser) {
+                if (!chooser.getResults().isEmpty())
+                    getSharedPluginManager().exportToXml(chooser.getResult().withFileExtension("xml"));
+            });
+        };
+
     updateTexts();
 }
 
@@ -66,12 +76,14 @@ void PluginManagerContentComponent::resized()
     fb.items.add(juce::FlexItem(addButton).withFlex(1.0f));
     fb.items.add(juce::FlexItem().withWidth(10));
     fb.items.add(juce::FlexItem(removeButton).withFlex(1.0f));
+    fb.items.add(juce::FlexItem().withWidth(10));
+    fb.items.add(juce::FlexItem(exportButton).withFlex(1.0f));
     fb.performLayout(buttonArea);
 }
 
 int PluginManagerContentComponent::getNumRows()
 {
-    return getSharedPluginManager().getKnownPlugins().size();
+    return getSharedPluginManager().getCatalog()->size();
 }
 
 void PluginManagerContentComponent::paintListBoxItem(int rowNumber, juce::Graphics& g, int width, int height, bool rowIsSelected)
@@ -80,11 +92,11 @@ void PluginManagerContentComponent::paintListBoxItem(int rowNumber, juce::Graphi
         g.fillAll(juce::Colours::blue.withAlpha(0.3f));
     g.setColour(juce::Colours::white);
 
-    auto plugins = getSharedPluginManager().getKnownPlugins();
+    const auto catalog = getSharedPluginManager().getCatalog();
 
-    if (isPositiveAndBelow(rowNumber, plugins.size()))
+    if (isPositiveAndBelow(rowNumber, catalog->size()))
     {
-        const auto& desc = plugins.getReference(rowNumber);
+        const auto& desc = catalog->getAll().getReference(rowNumber);
         g.drawText(desc.name, 5, 0, width - 10, height, juce::Justification::centredLeft, true);
     }
 }
@@ -104,6 +116,7 @@ void PluginManagerContentComponent::updateTexts()
     scanButton.setButtonText(lang.get("pluginManagerWindow.scan"));
     addButton.setButtonText(lang.get("pluginManagerWindow.add"));
     removeButton.setButtonText(lang.get("pluginManagerWindow.remove"));
+    exportButton.setButtonText(lang.get("pluginManagerWindow.export"));
     pluginListBox.updateContent();
 }
 
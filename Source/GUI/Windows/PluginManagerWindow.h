@@ -29,7 +29,7 @@ private:
     void updateTexts();
     void removeSelectedPlugin();
     juce::ListBox pluginListBox;
-    juce::TextButton scanButton, addButton, removeButton;
+    juce::TextButton scanButton, addButton, removeButton, exportButton;
     juce::Label titleLabel;
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PluginManagerContentComponent)
 };
@@ -21,6 +21,10 @@ public:
 
         addAndMakeVisible(deleteButton);
         deleteButton.addListener(this);
+        addAndMakeVisible(importButton);
+        importButton.addListener(this);
+        addAndMakeVisible(exportButton);
+        exportButton.addListener(this);
 
         updatePresets();
         updateButtonText();
@@ -39,6 +43,11 @@ public:
     void resized() override {
         auto bounds = getLocalBounds().reduced(10);
         deleteButton.setBounds(bounds.removeFromBottom(30));
+        bounds.removeFromBottom(5);
+        auto xmlRow = bounds.removeFromBottom(30);
+        importButton.setBounds(xmlRow.removeFromLeft(xmlRow.getWidth() / 2 - 2));
+        xmlRow.removeFromLeft(4);
+        exportButton.setBounds(xmlRow);
         bounds.removeFromBottom(10);
         listBox.setBounds(bounds);
     }
@@ -82,6 +91,14 @@ public:
                         }));
             }
         }
+        else if (button == &importButton)
+        {
+            importXmlPreset();
+        }
+        else if (button == &exportButton)
+        {
+            exportSelectedPreset();
+        }
     }
 
     // <<< ADDED >>> Callback to handle language changes
@@ -96,18 +113,74 @@ public:
 private:
     void updatePresets()
     {
-        presetFiles = getSharedPresetManager().getPresetDirectory().findChildFiles(juce::File::findFiles, false, "*.xml");
+        presetFiles = getSharedPresetManager().getPresetFiles();
         listBox.updateContent();
         repaint();
     }
 
     void updateButtonText()
     {
-        deleteButton.setButtonText(LanguageManager::getInstance().get("presetManagerWindow.deleteButton"));
+        auto& lang = LanguageManager::getInstance();
+        deleteButton.setButtonText(lang.get("presetManagerWindow.deleteButton"));
+        importButton.setButtonText(lang.get("presetManagerWindow.importButton"));
+        exportButton.setButtonText(lang.get("presetManagerWindow.exportButton"));
+    }
+
+    void importXmlPreset()
+    {
+        auto& lang = LanguageManager::getInstance();
+        auto fc = std::make_shared<juce::FileChooser>(lang.get("presetManagerWindow.importTitle"),
+            juce::File::getSpecialLocation(juce::File::userDocumentsDirectory), "*.xml");
+
+        juce::Component::SafePointer<PresetManagerComponent> safeThis(this);
+        fc->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+            [safeThis, fc](const juce::FileChooser& chooser)
+            {
+                auto file = chooser.getResult();
+                if (safeThis == nullptr || file == juce::File{})
+                    return;
+
+                if (getSharedPresetManager().importXmlPreset(file).isEmpty())
+                    safeThis->showError("presetManagerWindow.importFailed");
+
+                safeThis->updatePresets();
+            });
+    }
+
+    void exportSelectedPreset()
+    {
+        auto selectedRow = listBox.getSelectedRow();
+        if (selectedRow < 0 || selectedRow >= presetFiles.size())
+            return;
+
+        auto& lang = LanguageManager::getInstance();
+        auto presetFile = presetFiles[selectedRow];
+        auto fc = std::make_shared<juce::FileChooser>(lang.get("presetManagerWindow.exportTitle"),
+            juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
+                .getChildFile(presetFile.getFileNameWithoutExtension() + ".xml"), "*.xml");
+
+        juce::Component::SafePointer<PresetManagerComponent> safeThis(this);
+        fc->launchAsync(juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::warnAboutOverwriting,
+            [safeThis, fc, presetFile](const juce::FileChooser& chooser)
+            {
+                auto file = chooser.getResult();
+                if (safeThis == nullptr || file == juce::File{})
+                    return;
+
+                if (!getSharedPresetManager().exportPresetAsXml(presetFile, file))
+                    safeThis->showError("presetManagerWindow.exportFailed");
+            });
+    }
+
+    void showError(const juce::String& messageKey)
+    {
+        auto& lang = LanguageManager::getInstance();
+        juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon,
+            lang.get("presetManagerWindow.errorTitle"), lang.get(messageKey));
     }
 
     juce::ListBox listBox;
-    juce::TextButton deleteButton;
+    juce::TextButton deleteButton, importButton, exportButton;
     juce::Array<juce::File> presetFiles;
 };
 
@@ -113,6 +113,19 @@ QuickKeySettingsContentComponent::QuickKeySettingsContentComponent()
     addAndMakeVisible(setHotkeyButton);
     setHotkeyButton.onClick = [this] { setHotkeyForSlot(selectedSlot); };
 
+    addAndMakeVisible(playModeLabel);
+    addAndMakeVisible(playModeBox);
+    playModeBox.onChange = [this] {
+        slotsToEdit.getReference(selectedSlot).playMode = playModeBox.getSelectedId() == 2 ? SoundboardSlot::PlayMode::OneShot
+                                                                                         : SoundboardSlot::PlayMode::Retrigger;
+        };
+
+    addAndMakeVisible(chokeGroupLabel);
+    addAndMakeVisible(chokeGroupBox);
+    chokeGroupBox.onChange = [this] {
+        slotsToEdit.getReference(selectedSlot).chokeGroup = juce::jmax(0, chokeGroupBox.getSelectedId() - 1);
+        };
+
     addAndMakeVisible(saveButton);
     saveButton.onClick = [this] { saveChanges(); };
 
@@ -218,6 +231,14 @@ void QuickKeySettingsContentComponent::resized()
     editorContentBounds.removeFromTop(rowGap);
     setHotkeyButton.setBounds(editorContentBounds.removeFromTop(rowHeight));
 
+    editorContentBounds.removeFromTop(rowGap);
+    auto modeRow = editorContentBounds.removeFromTop(rowHeight);
+    auto chokeArea = modeRow.removeFromRight(modeRow.getWidth() / 2);
+    playModeLabel.setBounds(modeRow.removeFromLeft(labelWidth).withTrimmedRight(5));
+    playModeBox.setBounds(modeRow.withTrimmedRight(5));
+    chokeGroupLabel.setBounds(chokeArea.removeFromLeft(labelWidth).withTrimmedRight(5));
+    chokeGroupBox.setBounds(chokeArea);
+
     juce::Grid profileGrid;
     profileGrid.templateRows = { Track(Fr(1)), Track(Fr(1)) };
     profileGrid.templateColumns = { Track(Fr(1)), Track(Fr(1)) };
@@ -280,6 +301,9 @@ void QuickKeySettingsContentComponent::showDetailsForSlot(int slotIndex)
 
     setHotkeyButton.setButtonText(hotkeyText);
     setHotkeyButton.setColour(juce::TextButton::buttonColourId, getLookAndFeel().findColour(juce::TextButton::buttonColourId));
+
+    playModeBox.setSelectedId(slot.playMode == SoundboardSlot::PlayMode::OneShot ? 2 : 1, juce::dontSendNotification);
+    chokeGroupBox.setSelectedId(slot.chokeGroup + 1, juce::dontSendNotification);
 }
 
 void QuickKeySettingsContentComponent::chooseFileForSlot(int slotIndex)
@@ -351,6 +375,17 @@ void QuickKeySettingsContentComponent::updateAllUITexts()
     cleanButton.setButtonText(lang.get("quickKeySettingsWindow.cleanProfile"));
     importButton.setButtonText(lang.get("quickKeySettingsWindow.importProfile"));
     exportButton.setButtonText(lang.get("quickKeySettingsWindow.exportProfile"));
+    playModeLabel.setText(lang.get("quickKeySettingsWindow.playModeLabel"), juce::dontSendNotification);
+    chokeGroupLabel.setText(lang.get("quickKeySettingsWindow.chokeGroupLabel"), juce::dontSendNotification);
+
+    playModeBox.clear(juce::dontSendNotification);
+    playModeBox.addItem(lang.get("quickKeySettingsWindow.playModeRetrigger"), 1);
+    playModeBox.addItem(lang.get("quickKeySettingsWindow.playModeOneShot"), 2);
+
+    chokeGroupBox.clear(juce::dontSendNotification);
+    chokeGroupBox.addItem(lang.get("quickKeySettingsWindow.chokeGroupNone"), 1);
+    for (int group = 1; group <= 4; ++group)
+        chokeGroupBox.addItem(juce::String(group), group + 1);
 }
 
 void QuickKeySettingsContentComponent::cancelCaptureMode()
@@ -376,8 +411,8 @@ QuickKeySettingsWindow::QuickKeySettingsWindow(std::function<void()> onWindowClo
     setUsingNativeTitleBar(true);
     setContentOwned(new QuickKeySettingsContentComponent(), true);
     setResizable(true, true);
-    setResizeLimits(600, 350, 900, 500);
-    centreWithSize(600, 350);
+    setResizeLimits(600, 400, 900, 550);
+    centreWithSize(600, 400);
     setVisible(true);
 }
 
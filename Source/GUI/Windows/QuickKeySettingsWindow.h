@@ -60,6 +60,8 @@ private:
     juce::TextEditor nameEditor;
     juce::TextButton assignFileButton;
     juce::TextButton setHotkeyButton;
+    juce::Label playModeLabel, chokeGroupLabel;
+    juce::ComboBox playModeBox, chokeGroupBox;
     juce::TextButton saveButton, cleanButton, importButton, exportButton;
 
     juce::Rectangle<int> editorGroupBounds;
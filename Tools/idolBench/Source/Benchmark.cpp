@@ -0,0 +1,183 @@
+/*
+  ==============================================================================
+
+    Benchmark.cpp
+
+  ==============================================================================
+*/
+
+#include "Benchmark.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+    double median(std::vector<double>& values)
+    {
+        std::sort(values.begin(), values.end());
+        const auto middle = values.size() / 2;
+        return values.size() % 2 != 0 ? values[middle] : 0.5 * (values[middle - 1] + values[middle]);
+    }
+
+    juce::String formatNs(double ns)
+    {
+        if (ns >= 1.0e6) return juce::String(ns / 1.0e6, 3) + " ms";
+        if (ns >= 1.0e3) return juce::String(ns / 1.0e3, 3) + " us";
+        return juce::String(ns, 1) + " ns";
+    }
+
+    juce::String formatRate(double perSecond)
+    {
+        if (perSecond >= 1.0e9) return juce::String(perSecond / 1.0e9, 2) + " G";
+        if (perSecond >= 1.0e6) return juce::String(perSecond / 1.0e6, 2) + " M";
+        if (perSecond >= 1.0e3) return juce::String(perSecond / 1.0e3, 2) + " k";
+        return juce::String(perSecond, 2) + " ";
+    }
+}
+
+BenchmarkRunner::BenchmarkRunner(const Options& runnerOptions)
+    : options(runnerOptions)
+{
+    options.numSamples = juce::jmax(1, options.numSamples);
+}
+
+bool BenchmarkRunner::isSelected(const juce::String& name) const
+{
+    if (options.filters.isEmpty())
+        return true;
+
+    for (const auto& filter : options.filters)
+        if (name.containsIgnoreCase(filter))
+            return true;
+
+    return false;
+}
+
+void BenchmarkRunner::addResult(const juce::String& name, std::vector<double>& samplesNs, juce::int64 opsPerSample,
+                                double itemsPerOp, const juce::String& itemName)
+{
+    BenchmarkResult result;
+    result.name = name;
+    result.nsPerOp = median(samplesNs);
+    result.minNsPerOp = samplesNs.front();
+    result.itemsPerOp = itemsPerOp;
+    result.itemName = itemName;
+    result.numSamples = (int)samplesNs.size();
+    result.opsPerSample = opsPerSample;
+
+    std::vector<double> deviations;
+    deviations.reserve(samplesNs.size());
+    for (auto ns : samplesNs)
+        deviations.push_back(std::abs(ns - result.nsPerOp));
+    result.spreadPercent = result.nsPerOp > 0.0 ? 100.0 * median(deviations) / result.nsPerOp : 0.0;
+
+    results.push_back(result);
+    std::cout << formatResult(result) << std::endl;
+}
+
+juce::String BenchmarkRunner::formatResult(const BenchmarkResult& result)
+{
+    return result.name.paddedRight(' ', 40)
+        + formatNs(result.nsPerOp).paddedLeft(' ', 12)
+        + (" +-" + juce::String(result.spreadPercent, 1) + "%").paddedLeft(' ', 10)
+        + "   " + formatRate(result.getItemsPerSecond()) + result.itemName + "/s";
+}
+
+//==============================================================================
+juce::var BenchmarkRunner::toJson() const
+{
+    auto* machine = new juce::DynamicObject();
+    machine->setProperty("os", juce::SystemStats::getOperatingSystemName());
+    machine->setProperty("cpu", juce::SystemStats::getCpuModel());
+    machine->setProperty("cores", juce::SystemStats::getNumPhysicalCpus());
+    machine->setProperty("hostName", juce::SystemStats::getComputerName());
+
+    juce::Array<juce::var> list;
+    for (const auto& result : results)
+    {
+        auto* object = new juce::DynamicObject();
+        object->setProperty("name", result.name);
+        object->setProperty("nsPerOp", result.nsPerOp);
+        object->setProperty("minNsPerOp", result.minNsPerOp);
+        object->setProperty("spreadPercent", result.spreadPercent);
+        object->setProperty("itemsPerOp", result.itemsPerOp);
+        object->setProperty("itemName", result.itemName);
+        object->setProperty("itemsPerSecond", result.getItemsPerSecond());
+        object->setProperty("samples", result.numSamples);
+        object->setProperty("opsPerSample", result.opsPerSample);
+        list.add(object);
+    }
+
+    auto* json = new juce::DynamicObject();
+    json->setProperty("formatVersion", 1);
+    json->setProperty("time", juce::Time::getCurrentTime().toISO8601(true));
+   #if JUCE_DEBUG
+    json->setProperty("build", "Debug");
+   #else
+    json->setProperty("build", "Release");
+   #endif
+    json->setProperty("machine", machine);
+    json->setProperty("results", list);
+    return json;
+}
+
+std::vector<BenchmarkResult> BenchmarkRunner::resultsFromJson(const juce::var& json)
+{
+    std::vector<BenchmarkResult> list;
+
+    if (auto* array = json["results"].getArray())
+    {
+        for (const auto& item : *array)
+        {
+            BenchmarkResult result;
+            result.name = item["name"].toString();
+            result.nsPerOp = item["nsPerOp"];
+            result.minNsPerOp = item["minNsPerOp"];
+            result.spreadPercent = item["spreadPercent"];
+            result.itemsPerOp = item.getProperty("itemsPerOp", 1.0);
+            result.itemName = item["itemName"].toString();
+            result.numSamples = item["samples"];
+            result.opsPerSample = item["opsPerSample"];
+
+            if (result.name.isNotEmpty() && result.nsPerOp > 0.0)
+                list.push_back(result);
+        }
+    }
+
+    return list;
+}
+
+//==============================================================================
+BaselineComparison BaselineComparison::compare(const std::vector<BenchmarkResult>& current,
+                                               const std::vector<BenchmarkResult>& baseline,
+                                               double thresholdPercent)
+{
+    BaselineComparison comparison;
+
+    for (const auto& result : current)
+    {
+        const auto match = std::find_if(baseline.begin(), baseline.end(),
+                                         [&result](const BenchmarkResult& b) { return b.name == result.name; });
+        if (match == baseline.end())
+        {
+            comparison.missingFromBaseline.add(result.name);
+            continue;
+        }
+
+        Entry entry;
+        entry.name = result.name;
+        entry.baselineNs = match->nsPerOp;
+        entry.currentNs = result.nsPerOp;
+        entry.changePercent = 100.0 * (result.nsPerOp - match->nsPerOp) / match->nsPerOp;
+        entry.regressed = entry.changePercent > thresholdPercent;
+        comparison.entries.push_back(entry);
+    }
+
+    return comparison;
+}
+
+int BaselineComparison::getNumRegressions() const
+{
+    return (int)std::count_if(entries.begin(), entries.end(), [](const Entry& e) { return e.regressed; });
+}
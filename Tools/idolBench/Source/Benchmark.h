@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    Benchmark.h
+    (Timing loop, results and baseline comparison for idolBench)
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+struct BenchmarkResult
+{
+    juce::String name;
+    double nsPerOp = 0.0;           // median of the samples
+    double minNsPerOp = 0.0;
+    double spreadPercent = 0.0;     // median absolute deviation, relative to the median
+    double itemsPerOp = 1.0;
+    juce::String itemName;          // what itemsPerOp counts: samples, bytes, titles...
+    int numSamples = 0;
+    juce::int64 opsPerSample = 0;
+
+    double getItemsPerSecond() const { return nsPerOp > 0.0 ? itemsPerOp * 1.0e9 / nsPerOp : 0.0; }
+};
+
+/**
+    Times small pieces of work the way the audio thread runs them: over and over, on
+    one thread, with warm caches.
+
+    Each benchmark is warmed up, then timed in a number of samples, each running the
+    operation enough times to last sampleSeconds. The median sample is the result, so
+    a sample that lost the CPU to something else doesn't move it.
+*/
+class BenchmarkRunner
+{
+public:
+    struct Options
+    {
+        double warmupSeconds = 0.1;
+        double sampleSeconds = 0.02;
+        int numSamples = 21;
+        juce::StringArray filters;  // run only names containing one of these; empty runs all
+    };
+
+    explicit BenchmarkRunner(const Options& options);
+
+    bool isSelected(const juce::String& name) const;
+
+    /** Times op(). itemsPerOp is how much work one call does, for the throughput column. */
+    template <typename Operation>
+    void run(const juce::String& name, Operation&& op, double itemsPerOp = 1.0, const juce::String& itemName = "ops")
+    {
+        if (!isSelected(name))
+            return;
+
+        // Warm up, and find out roughly how long one call takes.
+        juce::int64 numWarmupOps = 0;
+        const auto warmupStart = juce::Time::getHighResolutionTicks();
+        double warmupElapsed = 0.0;
+        do
+        {
+            op();
+            ++numWarmupOps;
+            warmupElapsed = secondsSince(warmupStart);
+        }
+        while (warmupElapsed < options.warmupSeconds);
+
+        const auto opsPerSample = juce::jmax((juce::int64)1, (juce::int64)(options.sampleSeconds * (double)numWarmupOps / warmupElapsed));
+
+        std::vector<double> samples;
+        samples.reserve((size_t)options.numSamples);
+        for (int i = 0; i < options.numSamples; ++i)
+        {
+            const auto sampleStart = juce::Time::getHighResolutionTicks();
+            for (juce::int64 n = 0; n < opsPerSample; ++n)
+                op();
+            samples.push_back(secondsSince(sampleStart) * 1.0e9 / (double)opsPerSample);
+        }
+
+        addResult(name, samples, opsPerSample, itemsPerOp, itemName);
+    }
+
+    const std::vector<BenchmarkResult>& getResults() const noexcept { return results; }
+
+    /** The results with the machine and build they came from; what --json writes and --baseline reads. */
+    juce::var toJson() const;
+    static std::vector<BenchmarkResult> resultsFromJson(const juce::var& json);
+
+    /** One line per result, for the console. */
+    static juce::String formatResult(const BenchmarkResult& result);
+
+private:
+    static double secondsSince(juce::int64 startTicks) noexcept
+    {
+        return juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+    }
+
+    void addResult(const juce::String& name, std::vector<double>& samplesNs, juce::int64 opsPerSample,
+                   double itemsPerOp, const juce::String& itemName);
+
+    Options options;
+    std::vector<BenchmarkResult> results;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BenchmarkRunner)
+};
+
+/** How a run compares with a baseline; a result slower than the threshold is a regression. */
+struct BaselineComparison
+{
+    struct Entry
+    {
+        juce::String name;
+        double baselineNs = 0.0;
+        double currentNs = 0.0;
+        double changePercent = 0.0; // positive: slower
+        bool regressed = false;
+    };
+
+    std::vector<Entry> entries;
+    juce::StringArray missingFromBaseline;
+
+    static BaselineComparison compare(const std::vector<BenchmarkResult>& current,
+                                      const std::vector<BenchmarkResult>& baseline,
+                                      double thresholdPercent);
+
+    int getNumRegressions() const;
+};
@@ -0,0 +1,436 @@
+/*
+  ==============================================================================
+
+    EngineBenchmarks.cpp
+
+  ==============================================================================
+*/
+
+#include "EngineBenchmarks.h"
+#include "AudioEngine/AudioEngine.h"
+#include "AudioEngine/AudioRecorder.h"
+#include "AudioEngine/DspLoadMeter.h"
+#include "AudioEngine/FileAudioDevice.h"
+#include "AudioEngine/TrackProcessor.h"
+#include "Data/BeatSearch.h"
+#include "Data/PluginManager/PluginManager.h"
+#include "Data/PluginStateStore.h"
+#include "Data/PresetFile.h"
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int defaultBlockSize = 256;
+
+    void fillWithNoise(juce::AudioBuffer<float>& buffer, int seed)
+    {
+        juce::Random random(seed);
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                buffer.setSample(ch, i, random.nextFloat() * 0.5f - 0.25f);
+    }
+
+    bool writeNoiseFile(const juce::File& file, double fileSampleRate, double seconds)
+    {
+        std::unique_ptr<juce::OutputStream> stream(file.createOutputStream());
+        juce::WavAudioFormat wavFormat;
+        std::unique_ptr<juce::AudioFormatWriter> writer;
+        if (stream != nullptr)
+            writer.reset(wavFormat.createWriterFor(stream.get(), fileSampleRate, 2, 24, {}, 0));
+        if (writer == nullptr)
+            return false;
+        stream.release();
+
+        juce::AudioBuffer<float> block(2, 4096);
+        const auto totalSamples = (juce::int64)(seconds * fileSampleRate);
+        for (juce::int64 written = 0; written < totalSamples; written += block.getNumSamples())
+        {
+            fillWithNoise(block, (int)written);
+            if (!writer->writeFromAudioSampleBuffer(block, 0, (int)juce::jmin((juce::int64)block.getNumSamples(), totalSamples - written)))
+                return false;
+        }
+        return true;
+    }
+
+    /** A light plugin: a little arithmetic per sample, no latency, a 16 KB state. */
+    SyntheticPlugin::Config getPluginConfig(int index, int stateSize = 16 * 1024)
+    {
+        SyntheticPlugin::Config config;
+        config.name = "Synthetic " + juce::String(index + 1);
+        config.stateSize = stateSize;
+        return config;
+    }
+
+    juce::Array<ProcessorBase*> getProcessors(AudioEngine& engine)
+    {
+        juce::Array<ProcessorBase*> processors{ &engine.getVocalProcessor(), &engine.getMusicProcessor(), &engine.getMasterProcessor() };
+        for (int i = 0; i < 4; ++i)
+        {
+            processors.add(engine.getFxProcessorForVocal(i));
+            processors.add(engine.getFxProcessorForMusic(i));
+        }
+        return processors;
+    }
+
+    //==============================================================================
+    void benchmarkProcessor(BenchmarkRunner& runner, int numPlugins)
+    {
+        const auto name = "processor/plugins=" + juce::String(numPlugins);
+        if (!runner.isSelected(name))
+            return;
+
+        TrackProcessor processor(juce::Identifier("BenchTrack"));
+        processor.prepare({ sampleRate, (juce::uint32)defaultBlockSize, 2 });
+        for (int i = 0; i < numPlugins; ++i)
+            processor.addPlugin(std::make_unique<SyntheticPlugin>(getPluginConfig(i)));
+
+        // Metered, as every chain in the app is.
+        std::atomic<float> level{ 0.0f };
+        processor.setLevelSource(&level);
+
+        juce::AudioBuffer<float> buffer(2, defaultBlockSize);
+        fillWithNoise(buffer, 1);
+
+        runner.run(name, [&] { processor.process(buffer); }, defaultBlockSize, "samples");
+        processor.setLevelSource(nullptr);
+    }
+
+    /** The whole audio callback, with a live vocal and music input and pluginsPerChain
+        plugins on the vocal, music and master chains. */
+    void benchmarkCallback(BenchmarkRunner& runner, int blockSize, int pluginsPerChain)
+    {
+        auto name = "callback/block=" + juce::String(blockSize);
+        if (pluginsPerChain > 0)
+            name << "/plugins=" << pluginsPerChain;
+        if (!runner.isSelected(name))
+            return;
+
+        juce::AudioDeviceManager deviceManager;
+        AudioEngine engine(deviceManager);
+
+        FileAudioDevice::Options options;
+        options.sampleRate = sampleRate;
+        options.blockSize = blockSize;
+        FileAudioDevice device(options);
+        if (device.open({}, {}, sampleRate, blockSize).isNotEmpty())
+            return;
+
+        // Only to prepare the engine for the block size; the callback is called directly.
+        device.start(&engine);
+
+        const juce::Array<ProcessorBase*> chains{ &engine.getVocalProcessor(), &engine.getMusicProcessor(), &engine.getMasterProcessor() };
+        for (auto* processor : chains)
+            for (int i = 0; i < pluginsPerChain; ++i)
+                processor->addPlugin(std::make_unique<SyntheticPlugin>(getPluginConfig(i)));
+
+        engine.setVocalInputChannel(0);
+        engine.setMusicInputChannel(1);
+        engine.setSelectedOutputChannels(0, 1);
+
+        juce::AudioBuffer<float> inputs(3, blockSize);
+        juce::AudioBuffer<float> outputs(2, blockSize);
+        fillWithNoise(inputs, 2);
+
+        runner.run(name, [&]
+            {
+                engine.audioDeviceIOCallbackWithContext(inputs.getArrayOfReadPointers(), inputs.getNumChannels(),
+                                                        outputs.getArrayOfWritePointers(), outputs.getNumChannels(),
+                                                        blockSize, {});
+            }, blockSize, "samples");
+
+        device.stop();
+    }
+
+    /** The callback's summing of eleven stereo buses into the mix, and an FX send and return. */
+    void benchmarkMixing(BenchmarkRunner& runner)
+    {
+        const int blockSize = defaultBlockSize;
+        std::vector<juce::AudioBuffer<float>> buses(11, juce::AudioBuffer<float>(2, blockSize));
+        for (size_t i = 0; i < buses.size(); ++i)
+            fillWithNoise(buses[i], (int)i);
+
+        juce::AudioBuffer<float> mix(2, blockSize);
+        runner.run("mix/sum-11-stereo-buses", [&]
+            {
+                mix.clear();
+                for (const auto& bus : buses)
+                {
+                    mix.addFrom(0, 0, bus, 0, 0, blockSize);
+                    mix.addFrom(1, 0, bus, 1, 0, blockSize);
+                }
+            }, blockSize, "samples");
+
+        juce::AudioBuffer<float> send(2, blockSize), fxReturn(2, blockSize);
+        runner.run("mix/fx-send-return", [&]
+            {
+                send.copyFrom(0, 0, buses[0], 0, 0, blockSize);
+                send.copyFrom(1, 0, buses[0], 1, 0, blockSize);
+                send.applyGain(0.5f);
+                fxReturn.copyFrom(0, 0, send, 0, 0, blockSize);
+                fxReturn.copyFrom(1, 0, send, 1, 0, blockSize);
+                fxReturn.applyGain(0.8f);
+            }, blockSize, "samples");
+    }
+
+    void benchmarkMetering(BenchmarkRunner& runner)
+    {
+        const int blockSize = defaultBlockSize;
+        juce::AudioBuffer<float> buffer(2, blockSize);
+        fillWithNoise(buffer, 3);
+
+        std::atomic<float> level{ 0.0f };
+        runner.run("meter/rms-stereo", [&]
+            {
+                level.store(juce::jmax(buffer.getRMSLevel(0, 0, blockSize), buffer.getRMSLevel(1, 0, blockSize)));
+            }, blockSize, "samples");
+
+        DspLoadMeter meter;
+        const double blockSeconds = blockSize / sampleRate;
+        runner.run("meter/dsp-load-measurement", [&] { meter.addMeasurement(blockSeconds * 0.3, blockSeconds); }, 1, "blocks");
+        runner.run("meter/dsp-load-snapshot", [&] { juce::ignoreUnused(meter.getSnapshot()); }, 1, "snapshots");
+    }
+
+    /** A second of recording, from start() opening the file through handing the blocks to
+        the writer thread to stop() flushing and closing it. */
+    void benchmarkRecorder(BenchmarkRunner& runner, const juce::File& tempFolder)
+    {
+        juce::AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+        AudioRecorder recorder(formatManager, "idolBench");
+        recorder.prepare(sampleRate);
+
+        const auto file = tempFolder.getChildFile("Recording.wav");
+        const int blockSize = defaultBlockSize;
+        const int numBlocks = (int)(sampleRate / blockSize);
+
+        juce::AudioBuffer<float> buffer(2, blockSize);
+        fillWithNoise(buffer, 4);
+
+        runner.run("recorder/record-1s", [&]
+            {
+                recorder.startRecording(file);
+                for (int i = 0; i < numBlocks; ++i)
+                    recorder.processBlock(buffer);
+                recorder.stop();
+
+                // The recorder won't write over an existing file.
+                file.deleteFile();
+            }, (double)numBlocks * blockSize, "samples");
+    }
+
+    /** Reading a track the way the engine's track players do: no read-ahead, straight
+        from the file on the audio thread, resampled when the file's rate differs. */
+    void benchmarkTransport(BenchmarkRunner& runner, const juce::File& tempFolder, double fileSampleRate)
+    {
+        const auto name = juce::String(juce::approximatelyEqual(fileSampleRate, sampleRate) ? "transport/read" : "transport/read-resampled");
+        if (!runner.isSelected(name))
+            return;
+
+        const auto file = tempFolder.getChildFile("Track-" + juce::String((int)fileSampleRate) + ".wav");
+        if (!writeNoiseFile(file, fileSampleRate, 20.0))
+            return;
+
+        juce::AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+        auto* reader = formatManager.createReaderFor(file);
+        if (reader == nullptr)
+            return;
+
+        const double readerRate = reader->sampleRate;
+        juce::AudioFormatReaderSource readerSource(reader, true);
+        juce::AudioTransportSource transport;
+        transport.setSource(&readerSource, 0, nullptr, readerRate);
+        transport.prepareToPlay(defaultBlockSize, sampleRate);
+        transport.start();
+
+        juce::AudioBuffer<float> buffer(2, defaultBlockSize);
+        runner.run(name, [&]
+            {
+                juce::AudioSourceChannelInfo info(&buffer, 0, defaultBlockSize);
+                transport.getNextAudioBlock(info);
+                if (transport.hasStreamFinished())
+                {
+                    transport.setPosition(0.0);
+                    transport.start();
+                }
+            }, defaultBlockSize, "samples");
+
+        transport.setSource(nullptr);
+    }
+
+    /** A full preset: two plugins with 64 KB states on each of the eleven processors. */
+    void benchmarkPresets(BenchmarkRunner& runner, const juce::File& tempFolder)
+    {
+        constexpr int stateSize = 64 * 1024;
+
+        juce::AudioDeviceManager deviceManager;
+        AudioEngine engine(deviceManager);
+
+        FileAudioDevice::Options options;
+        options.sampleRate = sampleRate;
+        options.blockSize = defaultBlockSize;
+        FileAudioDevice device(options);
+        if (device.open({}, {}, sampleRate, defaultBlockSize).isNotEmpty())
+            return;
+
+        // Loading needs prepared processors, and the plugins in the catalog.
+        device.start(&engine);
+
+        int numPlugins = 0;
+        for (auto* processor : getProcessors(engine))
+        {
+            for (int i = 0; i < 2; ++i)
+            {
+                const auto config = getPluginConfig(numPlugins++, stateSize);
+                getSharedPluginManager().registerSyntheticPlugin(config);
+                processor->addPlugin(std::make_unique<SyntheticPlugin>(config));
+            }
+        }
+
+        const double stateBytes = (double)numPlugins * (double)stateSize;
+        runner.run("preset/capture", [&] { juce::ignoreUnused(engine.getFullState()); }, stateBytes, "bytes");
+
+        const auto preset = engine.getFullState();
+        PluginStateStore store(tempFolder.getChildFile("States"));
+        const auto storedFile = tempFolder.getChildFile(juce::String("Stored") + PresetFile::fileExtension);
+        const auto inlineFile = tempFolder.getChildFile(juce::String("Inline") + PresetFile::fileExtension);
+
+        runner.run("preset/serialize", [&] { PresetFile::save(preset, inlineFile); }, stateBytes, "bytes");
+        runner.run("preset/serialize-to-store", [&] { PresetFile::save(preset, storedFile, &store); }, stateBytes, "bytes");
+
+        if (!PresetFile::save(preset, inlineFile) || !PresetFile::save(preset, storedFile, &store))
+            return;
+
+        runner.run("preset/parse", [&] { juce::ignoreUnused(PresetFile::load(inlineFile)); }, stateBytes, "bytes");
+        runner.run("preset/parse-from-store", [&] { juce::ignoreUnused(PresetFile::load(storedFile, &store)); }, stateBytes, "bytes");
+
+        // The whole switch the app makes: chains built on the loader's workers, then swapped in.
+        const auto loadedPreset = PresetFile::load(storedFile, &store);
+        runner.run("preset/load-" + juce::String(numPlugins) + "-plugins", [&]
+            {
+                bool finished = false;
+                PresetLoader::Callbacks callbacks;
+                callbacks.onFinished = [&finished](const PresetLoader::Result&) { finished = true; };
+
+                if (!engine.prepareToLoadState(loadedPreset, std::move(callbacks)))
+                    return;
+
+                while (!finished)
+                    juce::MessageManager::getInstance()->runDispatchLoopUntil(1);
+
+                engine.commitStateLoad();
+            }, numPlugins, "plugins");
+
+        device.stop();
+    }
+
+    /** A catalog the size of a big Waves install. */
+    void benchmarkCatalog(BenchmarkRunner& runner)
+    {
+        const char* manufacturers[] = { "FabFilter", "Waves", "Valhalla DSP", "Soundtoys", "iZotope",
+                                        "Universal Audio", "Slate Digital", "Plugin Alliance" };
+        const char* kinds[] = { "Compressor", "Reverb", "Delay", "Equalizer", "Limiter",
+                                "DeEsser", "Saturator", "Chorus", "Gate", "Tuner" };
+
+        juce::Array<juce::PluginDescription> types;
+        for (int i = 0; i < 5000; ++i)
+        {
+            juce::PluginDescription description;
+            description.manufacturerName = manufacturers[i % juce::numElementsInArray(manufacturers)];
+            description.category = kinds[(i / 3) % juce::numElementsInArray(kinds)];
+            description.name = description.category + " " + juce::String(i / 30 + 1) + (i % 2 == 0 ? " Stereo" : " Mono");
+            description.descriptiveName = description.name;
+            description.pluginFormatName = "VST3";
+            description.fileOrIdentifier = "/usr/lib/vst3/" + description.manufacturerName + "/" + description.name + ".vst3";
+            description.uniqueId = 0x10000 + i * 7;
+            types.add(description);
+        }
+
+        runner.run("catalog/build", [&] { PluginCatalog catalog(types); }, types.size(), "plugins");
+
+        const PluginCatalog catalog(types);
+        int next = 0;
+        runner.run("catalog/find-by-id", [&]
+            {
+                juce::ignoreUnused(catalog.findByUniqueId(types.getReference(next).uniqueId));
+                next = (next + 1) % types.size();
+            }, 1, "lookups");
+
+        runner.run("catalog/find-by-file", [&]
+            {
+                juce::ignoreUnused(catalog.findByFileOrIdentifier(types.getReference(next).fileOrIdentifier));
+                next = (next + 1) % types.size();
+            }, 1, "lookups");
+
+        runner.run("catalog/search", [&] { juce::ignoreUnused(catalog.search("waves compressor", 50)); }, 1, "searches");
+        runner.run("catalog/search-typo", [&] { juce::ignoreUnused(catalog.search("compresor", 50)); }, 1, "searches");
+    }
+
+    /** The beat manager's search box over a few thousand Vietnamese titles. */
+    void benchmarkBeatSearch(BenchmarkRunner& runner)
+    {
+        const juce::StringArray words{ juce::String::fromUTF8("\xc4\x90\xc3\xaam"),             // Đêm
+                                       juce::String::fromUTF8("\xc4\x90\xc3\xb4ng"),            // Đông
+                                       juce::String::fromUTF8("M\xc6\xb0""a"),                  // Mưa
+                                       juce::String::fromUTF8("Chi\xe1\xbb\x81u"),              // Chiều
+                                       juce::String::fromUTF8("T\xc3\xacnh"),                   // Tình
+                                       juce::String::fromUTF8("Y\xc3\xaau"),                    // Yêu
+                                       juce::String::fromUTF8("Ng\xc6\xb0\xe1\xbb\x9di"),       // Người
+                                       juce::String::fromUTF8("Xu\xc3\xa2n"),                   // Xuân
+                                       juce::String::fromUTF8("Nh\xe1\xbb\x9b"),                // Nhớ
+                                       juce::String::fromUTF8("Qu\xc3\xaa H\xc6\xb0\xc6\xa1ng"), // Quê Hương
+                                       "Em", "Anh", "Bolero", "Remix" };
+        const juce::StringArray suffixes{ " - Beat Tone Nam", juce::String::fromUTF8(" - Beat Tone N\xe1\xbb\xaf"), " (Karaoke)", "" };
+
+        juce::Random random(5);
+        juce::StringArray titles;
+        for (int i = 0; i < 5000; ++i)
+        {
+            juce::StringArray title;
+            for (int n = 2 + random.nextInt(4); --n >= 0;)
+                title.add(words[random.nextInt(words.size())]);
+            titles.add(title.joinIntoString(" ") + suffixes[random.nextInt(suffixes.size())]);
+        }
+
+        int next = 0;
+        runner.run("beats/simplify-title", [&]
+            {
+                juce::ignoreUnused(BeatSearch::simplify(titles[next]));
+                next = (next + 1) % titles.size();
+            }, 1, "titles");
+
+        const auto searchText = juce::String::fromUTF8("\xc4\x91\xc3\xaam \xc4\x91\xc3\xb4ng"); // đêm đông
+        int numMatches = 0;
+        runner.run("beats/filter", [&]
+            {
+                // As BeatManagerComponent::filterBeats does on every keystroke.
+                const auto term = BeatSearch::simplify(searchText);
+                numMatches = 0;
+                for (const auto& title : titles)
+                    if (BeatSearch::matches(title, term))
+                        ++numMatches;
+            }, titles.size(), "titles");
+
+        juce::ignoreUnused(numMatches);
+    }
+}
+
+void runEngineBenchmarks(BenchmarkRunner& runner, const juce::File& tempFolder)
+{
+    for (int numPlugins : { 0, 1, 4, 16 })
+        benchmarkProcessor(runner, numPlugins);
+
+    for (int blockSize : { 32, 64, 128, 256, 512, 1024 })
+        benchmarkCallback(runner, blockSize, 0);
+    benchmarkCallback(runner, 64, 4);
+    benchmarkCallback(runner, 256, 4);
+
+    benchmarkMixing(runner);
+    benchmarkMetering(runner);
+    benchmarkRecorder(runner, tempFolder);
+    benchmarkTransport(runner, tempFolder, sampleRate);
+    benchmarkTransport(runner, tempFolder, 44100.0);
+    benchmarkPresets(runner, tempFolder);
+    benchmarkCatalog(runner);
+    benchmarkBeatSearch(runner);
+}
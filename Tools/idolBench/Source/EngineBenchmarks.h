@@ -0,0 +1,15 @@
+/*
+  ==============================================================================
+
+    EngineBenchmarks.h
+    (The engine's hot paths, as idolBench times them)
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "Benchmark.h"
+
+/** Runs every benchmark the runner's filters select. Needs a message thread. */
+void runEngineBenchmarks(BenchmarkRunner& runner, const juce::File& tempFolder);
@@ -0,0 +1,175 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    idolBench: microbenchmarks of the engine's hot paths.
+
+    Runs without plugins or an audio device, writes the results as JSON, and
+    compares them with an earlier run so a slower build fails.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include "Benchmark.h"
+#include "EngineBenchmarks.h"
+#include "Data/PluginManager/PluginManager.h"
+
+namespace
+{
+    enum ExitCode
+    {
+        passed = 0,
+        regressed = 1,
+        failed = 2
+    };
+
+    PluginManager* sharedPluginManager = nullptr;
+
+    void printUsage()
+    {
+        std::cout <<
+            "idolBench: time the engine's hot paths\n\n"
+            "  --filter <a,b,...>      only benchmarks whose name contains one of these\n"
+            "  --json <file>           write the results as JSON\n"
+            "  --baseline <file>       compare with the JSON of an earlier run\n"
+            "  --threshold <percent>   slower than the baseline by more than this fails, default 10\n"
+            "  --samples <n>           timed samples per benchmark, default 21\n"
+            "  --quick                 a few short samples, to check everything runs\n\n"
+            "No baseline is committed: timings only compare on the machine that made them.\n"
+            "Make one from a Release build of the commit to compare against, then run the\n"
+            "changed build on the same machine:\n\n"
+            "  idolBench --json baseline.json\n"
+            "  idolBench --baseline baseline.json --threshold 10\n\n"
+            "The threshold applies to each benchmark's median time per operation. Keep it\n"
+            "well above the +-% spread both runs print, or noise will fail the comparison.\n"
+            "Benchmarks the baseline doesn't have are listed but don't fail it.\n\n"
+            "Exit code 1 means a benchmark regressed against the baseline, 2 that something failed.\n";
+    }
+
+    double getNumberOption(const juce::ArgumentList& args, const juce::String& option, double defaultValue)
+    {
+        const auto value = args.getValueForOption(option);
+        return value.isNotEmpty() ? value.getDoubleValue() : defaultValue;
+    }
+
+    int compareWithBaseline(const std::vector<BenchmarkResult>& results, const juce::File& baselineFile, double thresholdPercent)
+    {
+        if (!baselineFile.existsAsFile())
+        {
+            std::cerr << "No baseline at " << baselineFile.getFullPathName() << "\n";
+            return failed;
+        }
+
+        const auto json = juce::JSON::parse(baselineFile);
+        const auto baseline = BenchmarkRunner::resultsFromJson(json);
+        if (baseline.empty())
+        {
+            std::cerr << "No results in baseline " << baselineFile.getFullPathName() << "\n";
+            return failed;
+        }
+
+        if (json["machine"]["cpu"].toString() != juce::SystemStats::getCpuModel())
+            std::cout << "\nThe baseline was run on another CPU (" << json["machine"]["cpu"].toString()
+                      << "); differences may be the machine, not the code.\n";
+
+        const auto comparison = BaselineComparison::compare(results, baseline, thresholdPercent);
+
+        std::cout << "\nAgainst " << baselineFile.getFileName() << " (fails above +" << juce::String(thresholdPercent, 1) << "%):\n";
+        for (const auto& entry : comparison.entries)
+        {
+            std::cout << (entry.regressed ? "  REGRESSED " : "            ") << entry.name.paddedRight(' ', 40)
+                      << juce::String(entry.baselineNs, 1).paddedLeft(' ', 12) << " ns ->"
+                      << juce::String(entry.currentNs, 1).paddedLeft(' ', 12) << " ns  "
+                      << (entry.changePercent >= 0.0 ? "+" : "") << juce::String(entry.changePercent, 1) << "%\n";
+        }
+
+        if (!comparison.missingFromBaseline.isEmpty())
+            std::cout << "Not in the baseline: " << comparison.missingFromBaseline.joinIntoString(", ") << "\n";
+
+        const int numRegressions = comparison.getNumRegressions();
+        std::cout << numRegressions << " of " << (int)comparison.entries.size() << " benchmarks regressed\n";
+        return numRegressions > 0 ? regressed : passed;
+    }
+
+    int run(const juce::ArgumentList& args)
+    {
+       #if JUCE_DEBUG
+        std::cout << "This is a debug build; its timings say little about a release build.\n\n";
+       #endif
+
+        BenchmarkRunner::Options options;
+        options.numSamples = (int)getNumberOption(args, "--samples", options.numSamples);
+        if (args.containsOption("--quick"))
+        {
+            options.warmupSeconds = 0.01;
+            options.sampleSeconds = 0.002;
+            options.numSamples = 3;
+        }
+        options.filters.addTokens(args.getValueForOption("--filter"), ",", {});
+        options.filters.trim();
+        options.filters.removeEmptyStrings();
+
+        const auto tempFolder = juce::File::getSpecialLocation(juce::File::tempDirectory)
+            .getNonexistentChildFile("idolBench", {}, false);
+        if (!tempFolder.createDirectory())
+        {
+            std::cerr << "Could not create " << tempFolder.getFullPathName() << "\n";
+            return failed;
+        }
+
+        // A list of its own, so only the synthetic plugins the benchmarks register are in it.
+        PluginManager pluginManager(tempFolder.getChildFile("knownPlugins.bin"));
+        sharedPluginManager = &pluginManager;
+
+        BenchmarkRunner runner(options);
+        runEngineBenchmarks(runner, tempFolder);
+
+        sharedPluginManager = nullptr;
+        tempFolder.deleteRecursively();
+
+        if (runner.getResults().empty())
+        {
+            std::cerr << "No benchmark matches the filter\n";
+            return failed;
+        }
+
+        if (args.containsOption("--json"))
+        {
+            const auto jsonFile = args.getFileForOption("--json");
+            if (!jsonFile.replaceWithText(juce::JSON::toString(runner.toJson())))
+            {
+                std::cerr << "Could not write " << jsonFile.getFullPathName() << "\n";
+                return failed;
+            }
+        }
+
+        if (args.containsOption("--baseline"))
+            return compareWithBaseline(runner.getResults(), args.getFileForOption("--baseline"),
+                                       getNumberOption(args, "--threshold", 10.0));
+
+        return passed;
+    }
+}
+
+PluginManager& getSharedPluginManager()
+{
+    jassert(sharedPluginManager != nullptr);
+    return *sharedPluginManager;
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    const juce::ArgumentList args(argc, argv);
+    if (args.containsOption("--help|-h"))
+    {
+        printUsage();
+        return passed;
+    }
+
+    // The engine's plugin state trackers and recorders expect a message thread.
+    const juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    return run(args);
+}
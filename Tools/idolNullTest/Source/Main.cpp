@@ -0,0 +1,271 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    idolNullTest: checks that a change to the engine leaves its output alone.
+
+    Renders fixed scenarios with synthetic plugins on generated test signals and
+    subtracts every tap from a golden recording made before the change; whatever
+    is left over is reported per tap. Any allocation, lock or blocking call the
+    audio thread makes along the way fails the scenario too.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include "NullTest.h"
+#include "Data/PluginManager/PluginManager.h"
+#include "Diagnostics/RealtimeChecker.h"
+
+namespace
+{
+    enum ExitCode
+    {
+        passed = 0,
+        differed = 1,
+        failed = 2
+    };
+
+    constexpr double sampleRate = 48000.0;
+    constexpr double renderSeconds = 3.0;
+
+    PluginManager* sharedPluginManager = nullptr;
+
+    void printUsage()
+    {
+        std::cout <<
+            "idolNullTest: compare the engine's output with golden recordings\n\n"
+            "  --golden <folder>       where the golden recordings are, one folder per scenario\n"
+            "  --record                write the goldens from this build instead of comparing\n"
+            "  --tolerance <dB>        a residual peak up to this passes; without it only\n"
+            "                          bit-identical output passes\n"
+            "  --scenario <a,b,...>    only these scenarios\n"
+            "  --report <file>         write the residuals as JSON\n"
+            "  --list                  print the scenarios and their taps\n"
+            "  --unit-tests            run the unit tests (metrics, plugin scanner) instead\n\n"
+            "Exit code 1 means a tap differed from its golden, the audio thread allocated,\n"
+            "locked or blocked, or a unit test failed; 2 that something failed, including\n"
+            "a scenario or tap with no golden to compare against.\n";
+    }
+
+    juce::String formatDb(double db)
+    {
+        return std::isfinite(db) ? juce::String(db, 1) + " dB" : juce::String("-inf");
+    }
+
+    juce::var residualToJson(const TapResidual& residual)
+    {
+        auto* object = new juce::DynamicObject();
+        object->setProperty("scenario", residual.scenario);
+        object->setProperty("tap", residual.tap);
+        object->setProperty("passed", residual.passed);
+        object->setProperty("identical", residual.isIdentical());
+        if (residual.error.isNotEmpty())
+            object->setProperty("error", residual.error);
+
+        // JSON has no infinity; an identical tap has no residual level at all.
+        if (std::isfinite(residual.peakDb)) object->setProperty("peakDb", residual.peakDb);
+        if (std::isfinite(residual.rmsDb))  object->setProperty("rmsDb", residual.rmsDb);
+        if (residual.firstDifferentSample >= 0)
+            object->setProperty("firstDifferentSample", residual.firstDifferentSample);
+        return object;
+    }
+
+    void printResidual(const TapResidual& residual)
+    {
+        std::cout << (residual.passed ? "           " : "  DIFFERED ") << residual.tap.paddedRight(' ', 10);
+
+        if (residual.error.isNotEmpty())
+            std::cout << residual.error;
+        else if (residual.isIdentical())
+            std::cout << "identical";
+        else
+            std::cout << "peak " << formatDb(residual.peakDb) << ", rms " << formatDb(residual.rmsDb)
+                      << ", from sample " << residual.firstDifferentSample;
+
+        std::cout << "\n";
+    }
+
+    int runUnitTests()
+    {
+        juce::UnitTestRunner runner;
+        runner.setAssertOnFailure(false);
+        runner.runTestsInCategory("idolLiveAudio");
+
+        int numFailures = 0;
+        for (int i = 0; i < runner.getNumResults(); ++i)
+            numFailures += runner.getResult(i)->failures;
+
+        std::cout << (numFailures > 0 ? juce::String(numFailures) + " unit test checks failed" : juce::String("Unit tests passed")) << "\n";
+        return numFailures > 0 ? differed : passed;
+    }
+
+    int run(const juce::ArgumentList& args)
+    {
+        if (args.containsOption("--unit-tests"))
+            return runUnitTests();
+
+        auto scenarios = getNullTestScenarios();
+
+        juce::StringArray selected;
+        selected.addTokens(args.getValueForOption("--scenario"), ",", {});
+        selected.trim();
+        selected.removeEmptyStrings();
+        if (!selected.isEmpty())
+        {
+            scenarios.erase(std::remove_if(scenarios.begin(), scenarios.end(),
+                                           [&selected](const NullTestScenario& s) { return !selected.contains(s.name); }),
+                            scenarios.end());
+            if (scenarios.empty())
+            {
+                std::cerr << "No scenario is called " << selected.joinIntoString(" or ") << "\n";
+                return failed;
+            }
+        }
+
+        if (args.containsOption("--list"))
+        {
+            for (const auto& scenario : scenarios)
+                std::cout << scenario.name << " (block " << scenario.blockSize << ")\n";
+
+            juce::StringArray taps;
+            for (int i = 0; i < TapCapture::numTaps; ++i)
+                taps.add(AudioEngine::getTapName((AudioEngine::Tap)i));
+            std::cout << "\nTaps: " << taps.joinIntoString(", ") << "\n";
+            return passed;
+        }
+
+        if (!args.containsOption("--golden"))
+        {
+            printUsage();
+            return failed;
+        }
+
+        const auto goldenRoot = args.getFileForOption("--golden");
+        const bool record = args.containsOption("--record");
+
+        // No goldens is a failure, never a pass: a typo in the path must not turn the check off.
+        if (!record && !goldenRoot.isDirectory())
+        {
+            std::cerr << "No goldens in " << goldenRoot.getFullPathName()
+                      << "; record them from a build before the change with --record\n";
+            return failed;
+        }
+        const double toleranceDb = args.containsOption("--tolerance")
+            ? args.getValueForOption("--tolerance").getDoubleValue()
+            : -std::numeric_limits<double>::infinity();
+
+        const auto tempFolder = juce::File::getSpecialLocation(juce::File::tempDirectory)
+            .getNonexistentChildFile("idolNullTest", {}, false);
+        const auto vocalFile = tempFolder.getChildFile("vocal.wav");
+        const auto musicFile = tempFolder.getChildFile("music.wav");
+        if (!tempFolder.createDirectory() || !NullTest::writeTestSignals(vocalFile, musicFile, sampleRate, renderSeconds))
+        {
+            std::cerr << "Could not write the test signals to " << tempFolder.getFullPathName() << "\n";
+            return failed;
+        }
+
+        // A list of its own, so an installed app's plugins never get near the render.
+        PluginManager pluginManager(tempFolder.getChildFile("knownPlugins.bin"));
+        sharedPluginManager = &pluginManager;
+
+        int exitCode = passed;
+        juce::Array<juce::var> report;
+        auto& realtimeChecker = RealtimeChecker::getInstance();
+        juce::uint64 numRealtimeViolations = 0;
+
+        if (!RealtimeChecker::isAvailable())
+            std::cout << "This build has no realtime checks (IDOL_ENABLE_REALTIME_CHECKS=0)\n";
+
+        for (const auto& scenario : scenarios)
+        {
+            std::cout << scenario.name << "\n";
+
+            TapCapture capture;
+            juce::String error;
+            realtimeChecker.clear();
+            if (!NullTest::render(scenario, vocalFile, musicFile, sampleRate, renderSeconds, capture, error))
+            {
+                std::cerr << "  could not render: " << error << "\n";
+                exitCode = failed;
+                continue;
+            }
+
+            if (const auto numViolations = realtimeChecker.getNumViolations(); numViolations > 0)
+            {
+                std::cout << "  REALTIME  " << (juce::int64)numViolations << " calls that allocate, lock or block\n";
+                std::cerr << realtimeChecker.getReport() << "\n";
+                numRealtimeViolations += numViolations;
+                exitCode = juce::jmax(exitCode, (int)differed);
+            }
+
+            const auto goldenFolder = goldenRoot.getChildFile(scenario.name);
+            if (record)
+            {
+                if (!NullTest::writeGolden(capture, goldenFolder))
+                {
+                    std::cerr << "  could not write " << goldenFolder.getFullPathName() << "\n";
+                    exitCode = failed;
+                }
+                continue;
+            }
+
+            for (const auto& residual : NullTest::compare(scenario, capture, goldenFolder, toleranceDb))
+            {
+                printResidual(residual);
+                report.add(residualToJson(residual));
+
+                if (!residual.passed)
+                    exitCode = juce::jmax(exitCode, residual.error.isNotEmpty() ? (int)failed : (int)differed);
+            }
+        }
+
+        sharedPluginManager = nullptr;
+        tempFolder.deleteRecursively();
+
+        if (!record && args.containsOption("--report"))
+        {
+            auto* root = new juce::DynamicObject();
+            root->setProperty("time", juce::Time::getCurrentTime().toISO8601(true));
+            root->setProperty("toleranceDb", std::isfinite(toleranceDb) ? juce::var(toleranceDb) : juce::var("exact"));
+            root->setProperty("residuals", report);
+            root->setProperty("realtimeViolations", (juce::int64)numRealtimeViolations);
+
+            const auto reportFile = args.getFileForOption("--report");
+            if (!reportFile.replaceWithText(juce::JSON::toString(juce::var(root))))
+            {
+                std::cerr << "Could not write " << reportFile.getFullPathName() << "\n";
+                return failed;
+            }
+        }
+
+        if (record && exitCode == passed)
+            std::cout << "Recorded " << (int)scenarios.size() << " scenarios in " << goldenRoot.getFullPathName() << "\n";
+
+        return exitCode;
+    }
+}
+
+PluginManager& getSharedPluginManager()
+{
+    jassert(sharedPluginManager != nullptr);
+    return *sharedPluginManager;
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    const juce::ArgumentList args(argc, argv);
+    if (args.containsOption("--help|-h"))
+    {
+        printUsage();
+        return passed;
+    }
+
+    // The engine's plugin state trackers and recorders expect a message thread.
+    const juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    return run(args);
+}
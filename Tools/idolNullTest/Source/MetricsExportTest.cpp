@@ -0,0 +1,455 @@
+/*
+  ==============================================================================
+
+    MetricsExportTest.cpp
+    (Reads MetricsExporter's file and endpoint back and parses the exposition)
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <map>
+#include <vector>
+#include "AudioEngine/AudioRecorder.h"
+#include "Diagnostics/MetricsExporter.h"
+#include "Diagnostics/MetricsRegistry.h"
+
+namespace
+{
+    /** A Prometheus text exposition (version 0.0.4), parsed strictly enough to catch
+        anything a scraper would reject. */
+    struct Exposition
+    {
+        struct Sample
+        {
+            juce::String name;
+            std::map<juce::String, juce::String> labels;
+            double value = 0.0;
+        };
+
+        std::vector<Sample> samples;
+        std::map<juce::String, juce::String> types;     // family -> type
+        juce::StringArray errors;
+
+        const Sample* find(const juce::String& name, const juce::String& labelName = {}, const juce::String& labelValue = {}) const
+        {
+            for (const auto& sample : samples)
+            {
+                if (sample.name != name)
+                    continue;
+
+                if (labelName.isEmpty())
+                    return &sample;
+
+                if (const auto label = sample.labels.find(labelName); label != sample.labels.end() && label->second == labelValue)
+                    return &sample;
+            }
+            return nullptr;
+        }
+    };
+
+    bool isMetricName(const juce::String& name)
+    {
+        return name.isNotEmpty()
+            && juce::String("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_:").containsChar(name[0])
+            && name.containsOnly("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_:");
+    }
+
+    bool parseValue(const juce::String& text, double& value)
+    {
+        if (text == "+Inf") { value = std::numeric_limits<double>::infinity(); return true; }
+        if (text == "-Inf") { value = -std::numeric_limits<double>::infinity(); return true; }
+        if (text == "NaN")  { value = std::numeric_limits<double>::quiet_NaN(); return true; }
+
+        const auto utf8 = text.toStdString();
+        char* end = nullptr;
+        value = std::strtod(utf8.c_str(), &end);
+        return !utf8.empty() && end == utf8.c_str() + utf8.size();
+    }
+
+    /** The family a sample belongs to: histograms add _bucket, _sum and _count. */
+    juce::String getFamily(const juce::String& sampleName, const std::map<juce::String, juce::String>& types)
+    {
+        for (const auto* suffix : { "_bucket", "_sum", "_count" })
+        {
+            const auto base = sampleName.upToLastOccurrenceOf(suffix, false, false);
+            if (sampleName.endsWith(suffix) && types.count(base) > 0 && types.at(base) == "histogram")
+                return base;
+        }
+        return sampleName;
+    }
+
+    bool parseSample(const juce::String& line, const std::map<juce::String, juce::String>& types,
+                     Exposition::Sample& sample, juce::String& error)
+    {
+        auto p = line.getCharPointer();
+
+        while (!p.isEmpty() && *p != '{' && *p != ' ')
+            sample.name += p.getAndAdvance();
+
+        if (!isMetricName(sample.name)) { error = "bad metric name"; return false; }
+
+        if (*p == '{')
+        {
+            ++p;
+            while (*p != '}')
+            {
+                juce::String labelName, labelValue;
+                while (!p.isEmpty() && *p != '=')
+                    labelName += p.getAndAdvance();
+
+                if (!isMetricName(labelName) || labelName.containsChar(':')) { error = "bad label name"; return false; }
+                if (p.getAndAdvance() != '=' || p.getAndAdvance() != '"') { error = "label value isn't quoted"; return false; }
+
+                for (;;)
+                {
+                    if (p.isEmpty()) { error = "unterminated label value"; return false; }
+
+                    auto c = p.getAndAdvance();
+                    if (c == '"')
+                        break;
+
+                    if (c == '\\')
+                    {
+                        c = p.getAndAdvance();
+                        if (c == 'n') c = '\n';
+                        else if (c != '\\' && c != '"') { error = "bad escape in label value"; return false; }
+                    }
+                    labelValue += c;
+                }
+
+                if (sample.labels.count(labelName) > 0) { error = "label given twice"; return false; }
+                sample.labels[labelName] = labelValue;
+
+                if (*p == ',')
+                    ++p;
+                else if (*p != '}') { error = "expected , or } after a label"; return false; }
+            }
+            ++p;
+        }
+
+        if (p.getAndAdvance() != ' ') { error = "expected a space before the value"; return false; }
+
+        const auto fields = juce::StringArray::fromTokens(juce::String(p), " ", {});
+        if (fields.size() < 1 || fields.size() > 2 || !parseValue(fields[0], sample.value))
+        {
+            error = "bad value";
+            return false;
+        }
+
+        if (fields.size() == 2 && !fields[1].containsOnly("-0123456789"))
+        {
+            error = "bad timestamp";
+            return false;
+        }
+
+        if (types.count(getFamily(sample.name, types)) == 0)
+        {
+            error = "sample before its # TYPE";
+            return false;
+        }
+
+        return true;
+    }
+
+    Exposition parseExposition(const juce::String& text)
+    {
+        Exposition exposition;
+        juce::StringArray seenFamilies;
+        juce::String currentFamily;
+
+        if (text.isNotEmpty() && !text.endsWithChar('\n'))
+            exposition.errors.add("the last line has no newline");
+
+        auto lines = juce::StringArray::fromLines(text);
+        if (lines.size() > 0 && lines[lines.size() - 1].isEmpty())
+            lines.remove(lines.size() - 1);
+
+        for (int i = 0; i < lines.size(); ++i)
+        {
+            const auto& line = lines[i];
+            const auto where = "line " + juce::String(i + 1) + ": ";
+
+            if (line.trim().isEmpty())
+                continue;
+
+            if (line.startsWith("#"))
+            {
+                const auto tokens = juce::StringArray::fromTokens(line, " ", {});
+                if (tokens[1] == "TYPE")
+                {
+                    const auto family = tokens[2];
+                    if (!isMetricName(family) || tokens.size() != 4
+                        || !juce::StringArray{ "counter", "gauge", "histogram", "summary", "untyped" }.contains(tokens[3]))
+                        exposition.errors.add(where + "bad # TYPE");
+                    else if (exposition.types.count(family) > 0)
+                        exposition.errors.add(where + "second # TYPE for " + family);
+                    else
+                        exposition.types[family] = tokens[3];
+                }
+                else if (tokens[1] == "HELP" && !isMetricName(tokens[2]))
+                {
+                    exposition.errors.add(where + "bad # HELP");
+                }
+                continue;
+            }
+
+            Exposition::Sample sample;
+            juce::String error;
+            if (!parseSample(line, exposition.types, sample, error))
+            {
+                exposition.errors.add(where + error);
+                continue;
+            }
+
+            // A family's samples must all be together.
+            const auto family = getFamily(sample.name, exposition.types);
+            if (family != currentFamily)
+            {
+                if (seenFamilies.contains(family))
+                    exposition.errors.add(where + family + " is split up");
+
+                seenFamilies.add(family);
+                currentFamily = family;
+            }
+
+            exposition.samples.push_back(std::move(sample));
+        }
+
+        // Histogram buckets are cumulative and end at +Inf, which equals _count.
+        for (const auto& [family, type] : exposition.types)
+        {
+            if (type != "histogram")
+                continue;
+
+            std::map<juce::String, std::vector<const Exposition::Sample*>> bucketsBySeries;
+            for (const auto& sample : exposition.samples)
+            {
+                if (sample.name != family + "_bucket")
+                    continue;
+
+                auto series = sample.labels;
+                series.erase("le");
+                juce::String key;
+                for (const auto& [name, value] : series)
+                    key << name << "=" << value << ",";
+                bucketsBySeries[key].push_back(&sample);
+            }
+
+            for (const auto& [series, buckets] : bucketsBySeries)
+            {
+                double previousBound = -std::numeric_limits<double>::infinity(), previousCount = 0.0;
+                for (const auto* bucket : buckets)
+                {
+                    double bound = 0.0;
+                    const auto le = bucket->labels.find("le");
+                    if (le == bucket->labels.end() || !parseValue(le->second, bound) || bound <= previousBound || bucket->value < previousCount)
+                        exposition.errors.add(family + ": buckets aren't cumulative and in order");
+
+                    previousBound = bound;
+                    previousCount = bucket->value;
+                }
+
+                if (!std::isinf(previousBound))
+                    exposition.errors.add(family + ": no +Inf bucket");
+
+                const auto* count = exposition.find(family + "_count");
+                if (count == nullptr || exposition.find(family + "_sum") == nullptr)
+                    exposition.errors.add(family + ": no _sum or _count");
+                else if (series.isEmpty() && count->value != previousCount)
+                    exposition.errors.add(family + ": +Inf bucket isn't _count");
+            }
+        }
+
+        return exposition;
+    }
+
+    /** GET over a plain socket, so the server is tested and not an HTTP client. */
+    bool httpGet(int port, const juce::String& path, juce::String& statusLine, juce::String& headers, juce::String& body)
+    {
+        juce::StreamingSocket socket;
+        if (!socket.connect("127.0.0.1", port, 2000))
+            return false;
+
+        const auto request = "GET " + path + " HTTP/1.1\r\nHost: 127.0.0.1\r\nConnection: close\r\n\r\n";
+        if (socket.write(request.toRawUTF8(), (int)request.getNumBytesAsUTF8()) < 0)
+            return false;
+
+        juce::MemoryBlock response;
+        char buffer[4096];
+        while (socket.waitUntilReady(true, 2000) == 1)
+        {
+            const int numRead = socket.read(buffer, (int)sizeof(buffer), false);
+            if (numRead <= 0)
+                break;
+
+            response.append(buffer, (size_t)numRead);
+        }
+
+        const auto text = response.toString();
+        const auto head = text.upToFirstOccurrenceOf("\r\n\r\n", false, false);
+        statusLine = head.upToFirstOccurrenceOf("\r\n", false, false);
+        headers = head.fromFirstOccurrenceOf("\r\n", false, false);
+        body = text.fromFirstOccurrenceOf("\r\n\r\n", false, false);
+        return text.contains("\r\n\r\n");
+    }
+}
+
+//==============================================================================
+class MetricsExportTest : public juce::UnitTest
+{
+public:
+    MetricsExportTest() : juce::UnitTest("Metrics export", "idolLiveAudio") {}
+
+    void runTest() override
+    {
+        auto& registry = MetricsRegistry::getInstance();
+        auto& exports = registry.addCounter("idol_test_exports_total", "Exports the test made.");
+        auto& level = registry.addGauge("idol_test_level", "A level with a label.", "chain=\"vocal\"");
+        auto& otherLevel = registry.addGauge("idol_test_level", "A level with a label.", "chain=\"music\"");
+        auto& seconds = registry.addHistogram("idol_test_seconds", "Observations in two buckets.", { 1.0, 5.0 });
+
+        exports.setTotal(3);
+        level.set(0.25);
+        otherLevel.set(-1.5);
+        seconds.observe(0.5);
+        seconds.observe(2.0);
+
+        const auto folder = juce::File::getSpecialLocation(juce::File::tempDirectory)
+            .getNonexistentChildFile("idolMetricsTest", {}, false);
+        const auto file = folder.getChildFile("idol.prom");
+
+        MetricsExporter exporter;
+        MetricsExporter::Settings settings;
+        settings.enabled = true;
+        settings.file = file;
+        settings.writeFile = true;
+
+        // Any free port will do; a busy one just means trying another.
+        juce::Random random;
+        for (int attempt = 0; attempt < 20 && exporter.getListeningPort() == 0; ++attempt)
+        {
+            settings.httpPort = 20000 + random.nextInt(40000);
+            exporter.setSettings(settings);
+        }
+
+        beginTest("File");
+        {
+            expect(file.existsAsFile(), "the export wasn't written");
+            expect(!file.getSiblingFile(file.getFileName() + ".tmp").exists(), "the temporary file was left behind");
+
+            const auto text = file.loadFileAsString();
+            expectEquals(text, exporter.getLatestText());
+            checkExposition(parseExposition(text), 0.25);
+        }
+
+        beginTest("File replaced");
+        {
+            level.set(0.75);
+            expect(exporter.exportNow());
+            checkExposition(parseExposition(file.loadFileAsString()), 0.75);
+        }
+
+        beginTest("Endpoint");
+        {
+            const int port = exporter.getListeningPort();
+            expect(port > 0, "the server isn't listening");
+
+            juce::String statusLine, headers, body;
+            expect(httpGet(port, "/metrics", statusLine, headers, body), "no response from /metrics");
+            expectEquals(statusLine, juce::String("HTTP/1.1 200 OK"));
+            expect(headers.contains("Content-Type: text/plain; version=0.0.4"), "wrong content type: " + headers);
+            expectEquals(body, exporter.getLatestText());
+            checkExposition(parseExposition(body), 0.75);
+
+            expect(httpGet(port, "/other", statusLine, headers, body), "no response from /other");
+            expectEquals(statusLine, juce::String("HTTP/1.1 404 Not Found"));
+        }
+
+        beginTest("Recorder FIFO fill");
+        {
+            juce::AudioFormatManager formats;
+            formats.registerBasicFormats();
+            AudioRecorder recorder(formats, "MetricsTest");
+            recorder.prepare(48000.0);
+            recorder.startRecording(folder.getChildFile("recording.wav"));
+
+            juce::AudioBuffer<float> block(2, 4096);
+            block.clear();
+            for (int i = 0; i < 4; ++i)
+                recorder.processBlock(block);
+
+            // The writer thread drains whenever it likes, so only the range is certain here.
+            expect(exporter.exportNow());
+            const auto exposition = parseExposition(file.loadFileAsString());
+            const auto type = exposition.types.find("idol_recorder_fifo_fill");
+            expect(type != exposition.types.end() && type->second == "gauge", "idol_recorder_fifo_fill isn't a gauge");
+
+            const auto* fill = exposition.find("idol_recorder_fifo_fill", "recorder", "metricstest");
+            expect(fill != nullptr, "the recorder's FIFO fill is missing");
+            if (fill != nullptr)
+                expect(fill->value >= 0.0 && fill->value <= 1.0, "FIFO fill out of range: " + juce::String(fill->value));
+
+            // Stopping flushes the FIFO.
+            recorder.stop();
+            expect(exporter.exportNow());
+            expectValue(parseExposition(file.loadFileAsString()), "idol_recorder_fifo_fill", "recorder", "metricstest", 0.0);
+        }
+
+        exporter.setSettings({});
+        folder.deleteRecursively();
+    }
+
+private:
+    void checkExposition(const Exposition& exposition, double expectedLevel)
+    {
+        expect(exposition.errors.isEmpty(), exposition.errors.joinIntoString("\n"));
+
+        expectValue(exposition, "idol_test_exports_total", {}, {}, 3.0);
+        expectValue(exposition, "idol_test_level", "chain", "vocal", expectedLevel);
+        expectValue(exposition, "idol_test_level", "chain", "music", -1.5);
+        expectBucket(exposition, "idol_test_seconds", 1.0, 1.0);
+        expectBucket(exposition, "idol_test_seconds", 5.0, 2.0);
+        expectBucket(exposition, "idol_test_seconds", std::numeric_limits<double>::infinity(), 2.0);
+        expectValue(exposition, "idol_test_seconds_sum", {}, {}, 2.5);
+        expectValue(exposition, "idol_test_seconds_count", {}, {}, 2.0);
+
+        const auto type = exposition.types.find("idol_test_seconds");
+        expect(type != exposition.types.end() && type->second == "histogram", "idol_test_seconds isn't a histogram");
+        expect(exposition.find("idol_uptime_seconds") != nullptr, "the exporter's own metrics are missing");
+    }
+
+    void expectValue(const Exposition& exposition, const juce::String& name,
+                     const juce::String& labelName, const juce::String& labelValue, double expected)
+    {
+        const auto* sample = exposition.find(name, labelName, labelValue);
+        const auto description = name + (labelName.isNotEmpty() ? "{" + labelName + "=\"" + labelValue + "\"}" : juce::String());
+
+        if (sample == nullptr)
+            expect(false, description + " is missing");
+        else
+            expectWithinAbsoluteError(sample->value, expected, 1.0e-9, description);
+    }
+
+    /** Bounds are compared as numbers, since "5" and "5.0" are the same bucket. */
+    void expectBucket(const Exposition& exposition, const juce::String& family, double bound, double expected)
+    {
+        for (const auto& sample : exposition.samples)
+        {
+            double le = 0.0;
+            const auto label = sample.labels.find("le");
+            if (sample.name == family + "_bucket" && label != sample.labels.end() && parseValue(label->second, le) && le == bound)
+            {
+                expectWithinAbsoluteError(sample.value, expected, 1.0e-9, family + " bucket le=" + juce::String(bound));
+                return;
+            }
+        }
+
+        expect(false, family + " has no bucket le=" + juce::String(bound));
+    }
+};
+
+static MetricsExportTest metricsExportTest;
@@ -0,0 +1,394 @@
+/*
+  ==============================================================================
+
+    NullTest.cpp
+
+  ==============================================================================
+*/
+
+#include "NullTest.h"
+#include <cmath>
+#include "AudioEngine/FileAudioDevice.h"
+#include "Data/PluginManager/SyntheticPlugin.h"
+
+namespace
+{
+    const char* const manifestName = "scenario.json";
+
+    double toDecibels(double gain)
+    {
+        return gain > 0.0 ? 20.0 * std::log10(gain) : -std::numeric_limits<double>::infinity();
+    }
+
+    SyntheticPlugin::Config makeConfig(const juce::String& name, int latencySamples, float gain,
+                                       SyntheticPlugin::Layout layout = SyntheticPlugin::Layout::stereo)
+    {
+        SyntheticPlugin::Config config;
+        config.name = name;
+        config.workPerSample = 1;   // the cost doesn't matter here, only the audio
+        config.latencySamples = latencySamples;
+        config.gain = gain;
+        config.layout = layout;
+        return config;
+    }
+
+    void addSynthetic(ProcessorBase& processor, const SyntheticPlugin::Config& config)
+    {
+        processor.addPlugin(std::make_unique<SyntheticPlugin>(config));
+    }
+
+    /** A plugin on each of the vocal, music and master chains, none of them neutral. */
+    void configureChains(AudioEngine& engine)
+    {
+        addSynthetic(engine.getVocalProcessor(), makeConfig("Vocal A", 0, 0.5f));
+        addSynthetic(engine.getVocalProcessor(), makeConfig("Vocal B", 0, 1.25f));
+        addSynthetic(engine.getMusicProcessor(), makeConfig("Music", 0, 0.8f));
+        addSynthetic(engine.getMasterProcessor(), makeConfig("Master", 0, 0.9f));
+    }
+
+    bool isSilent(const juce::AudioBuffer<float>& buffer)
+    {
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            const auto* data = buffer.getReadPointer(ch);
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                if (data[i] != 0.0f)
+                    return false;
+        }
+        return true;
+    }
+
+    bool writeFloatWav(const juce::File& file, const juce::AudioBuffer<float>& buffer, int numChannels, double sampleRate)
+    {
+        file.deleteFile();
+        std::unique_ptr<juce::OutputStream> stream(file.createOutputStream());
+        if (stream == nullptr)
+            return false;
+
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(stream.get(), sampleRate,
+                                                                            (unsigned int)numChannels, 32, {}, 0));
+        if (writer == nullptr)
+            return false;
+
+        stream.release();
+        return writer->writeFromAudioSampleBuffer(buffer, 0, buffer.getNumSamples());
+    }
+
+    bool readWav(const juce::File& file, juce::AudioBuffer<float>& result, double& sampleRate)
+    {
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatReader> reader(wav.createReaderFor(file.createInputStream().release(), true));
+        if (reader == nullptr)
+            return false;
+
+        sampleRate = reader->sampleRate;
+        result.setSize((int)reader->numChannels, (int)reader->lengthInSamples);
+        return reader->read(&result, 0, (int)reader->lengthInSamples, 0, true, true);
+    }
+
+    /** Copies every tap into buffers sized for the whole render, so nothing is allocated
+        on the audio thread. */
+    class TapRecorder : public AudioEngine::TapListener
+    {
+    public:
+        TapRecorder(TapCapture& captureToFill, int totalSamples)
+            : capture(captureToFill)
+        {
+            for (auto& buffer : capture.taps)
+            {
+                buffer.setSize(2, totalSamples);
+                buffer.clear();
+            }
+            positions.fill(0);
+        }
+
+        void tapped(AudioEngine::Tap tap, const juce::AudioBuffer<float>& buffer, int numSamples) override
+        {
+            auto& destination = capture.taps[(size_t)tap];
+            auto& position = positions[(size_t)tap];
+            const int numToCopy = juce::jmin(numSamples, destination.getNumSamples() - position);
+            if (numToCopy <= 0)
+                return;
+
+            for (int ch = 0; ch < destination.getNumChannels(); ++ch)
+                destination.copyFrom(ch, position, buffer, ch, 0, numToCopy);
+
+            position += numToCopy;
+        }
+
+    private:
+        TapCapture& capture;
+        std::array<int, (size_t)TapCapture::numTaps> positions;
+    };
+}
+
+//==============================================================================
+std::vector<NullTestScenario> getNullTestScenarios()
+{
+    using Layout = SyntheticPlugin::Layout;
+    std::vector<NullTestScenario> scenarios;
+
+    // The signal path with nothing on it.
+    scenarios.push_back({ "dry", 256, [](AudioEngine&) {} });
+
+    scenarios.push_back({ "gains", 256, [](AudioEngine& engine)
+        {
+            engine.getVocalProcessor().setGain(-6.0f);
+            engine.getMusicProcessor().setGain(3.0f);
+            engine.getMasterProcessor().setGain(-1.5f);
+        } });
+
+    scenarios.push_back({ "chains", 256, configureChains });
+
+    // Odd and small blocks catch state carried wrongly from one block to the next.
+    scenarios.push_back({ "chains-block32", 32, configureChains });
+    scenarios.push_back({ "chains-block441", 441, configureChains });
+
+    scenarios.push_back({ "latency", 256, [](AudioEngine& engine)
+        {
+            addSynthetic(engine.getVocalProcessor(), makeConfig("Vocal delay", 64, 1.0f));
+            addSynthetic(engine.getMusicProcessor(), makeConfig("Music delay", 301, 1.0f));
+            addSynthetic(engine.getMasterProcessor(), makeConfig("Master delay", 17, 1.0f));
+        } });
+
+    scenarios.push_back({ "layouts", 256, [](AudioEngine& engine)
+        {
+            addSynthetic(engine.getVocalProcessor(), makeConfig("Mono", 0, 0.7f, Layout::mono));
+            addSynthetic(engine.getVocalProcessor(), makeConfig("Mono to stereo", 5, 1.0f, Layout::monoToStereo));
+            addSynthetic(engine.getVocalProcessor(), makeConfig("Stereo", 0, 1.1f, Layout::stereo));
+        } });
+
+    scenarios.push_back({ "fx-sends", 256, [](AudioEngine& engine)
+        {
+            for (int i = 0; i < 4; ++i)
+            {
+                if (auto* fx = engine.getFxProcessorForVocal(i))
+                {
+                    addSynthetic(*fx, makeConfig("Vocal FX " + juce::String(i + 1), 128 * (i + 1), 0.6f));
+                    fx->setSendLevel(0.2f * (float)(i + 1));
+                    fx->setReturnLevel(0.8f);
+                }
+
+                if (auto* fx = engine.getFxProcessorForMusic(i))
+                {
+                    addSynthetic(*fx, makeConfig("Music FX " + juce::String(i + 1), 37 * (i + 1), 0.5f));
+                    fx->setSendLevel(0.1f * (float)(i + 1));
+                    fx->setReturnLevel(0.5f);
+                }
+            }
+            addSynthetic(engine.getMasterProcessor(), makeConfig("Master", 0, 0.7f));
+        } });
+
+    return scenarios;
+}
+
+//==============================================================================
+bool NullTest::writeTestSignals(const juce::File& vocalFile, const juce::File& musicFile, double sampleRate, double seconds)
+{
+    const int numSamples = juce::roundToInt(seconds * sampleRate);
+    const double twoPi = juce::MathConstants<double>::twoPi;
+
+    // Vocal: a log sweep from 80 Hz to 8 kHz at -12 dBFS, with an impulse every half second
+    // and a stretch of silence in the middle, so gates and tails are exercised too.
+    juce::AudioBuffer<float> vocal(1, numSamples);
+    {
+        auto* data = vocal.getWritePointer(0);
+        const double startHz = 80.0, endHz = 8000.0;
+        const double k = std::log(endHz / startHz) / seconds;
+        const int impulseSpacing = juce::roundToInt(sampleRate * 0.5);
+        const juce::Range<int> silence(numSamples * 2 / 5, numSamples / 2);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const double t = i / sampleRate;
+            const double phase = twoPi * startHz * (std::exp(k * t) - 1.0) / k;
+            data[i] = silence.contains(i) ? 0.0f : (float)(0.25 * std::sin(phase));
+            if (i % impulseSpacing == 0)
+                data[i] = 0.9f;
+        }
+    }
+
+    // Music: different seeded noise on each side under a 440 Hz tone on the left and
+    // 660 Hz on the right, so a swapped or summed channel shows.
+    juce::AudioBuffer<float> music(2, numSamples);
+    {
+        juce::Random random(0x1d01);
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            auto* data = music.getWritePointer(ch);
+            const double hz = ch == 0 ? 440.0 : 660.0;
+            for (int i = 0; i < numSamples; ++i)
+                data[i] = (float)(0.2 * std::sin(twoPi * hz * i / sampleRate)) + (random.nextFloat() - 0.5f) * 0.1f;
+        }
+    }
+
+    return writeFloatWav(vocalFile, vocal, 1, sampleRate)
+        && writeFloatWav(musicFile, music, 2, sampleRate);
+}
+
+bool NullTest::render(const NullTestScenario& scenario, const juce::File& vocalFile, const juce::File& musicFile,
+                      double sampleRate, double seconds, TapCapture& result, juce::String& error)
+{
+    FileAudioDevice::Options options;
+    options.inputFiles.add(vocalFile);
+    options.inputFiles.add(musicFile);
+    options.sampleRate = sampleRate;
+    options.blockSize = scenario.blockSize;
+    options.lengthSeconds = seconds;
+
+    juce::AudioDeviceManager deviceManager;
+    AudioEngine engine(deviceManager);
+    FileAudioDevice device(options);
+
+    error = device.open({}, {}, sampleRate, scenario.blockSize);
+    if (error.isNotEmpty())
+        return false;
+
+    // Bypassing a plugin because a render ran slow would make the output depend on the machine.
+    auto rule = engine.getOverrunWatchdog().getRule();
+    rule.enabled = false;
+    engine.getOverrunWatchdog().setRule(rule);
+
+    engine.setVocalInputChannel(device.getInputChannels(0).getStart());
+    engine.setMusicInputChannel(device.getInputChannels(1).getStart());
+    engine.setSelectedOutputChannels(0, 1);
+    device.start(&engine);
+
+    if (scenario.configure != nullptr)
+        scenario.configure(engine);
+
+    result.sampleRate = sampleRate;
+    result.blockSize = scenario.blockSize;
+    TapRecorder recorder(result, juce::roundToInt(seconds * sampleRate));
+    engine.setTapListener(&recorder);
+
+    const bool rendered = device.render();
+    engine.setTapListener(nullptr);
+    device.stop();
+
+    if (!rendered)
+        error = device.getLastError();
+    return rendered;
+}
+
+bool NullTest::writeGolden(const TapCapture& capture, const juce::File& folder)
+{
+    if (!folder.createDirectory())
+        return false;
+
+    juce::Array<juce::var> silentTaps;
+    for (int i = 0; i < TapCapture::numTaps; ++i)
+    {
+        const auto tap = (AudioEngine::Tap)i;
+        const auto& buffer = capture.taps[(size_t)i];
+        const auto file = folder.getChildFile(AudioEngine::getTapName(tap) + ".wav");
+
+        if (isSilent(buffer))
+        {
+            // Most scenarios leave the FX returns silent; no need to keep seconds of zeros.
+            file.deleteFile();
+            silentTaps.add(AudioEngine::getTapName(tap));
+        }
+        else if (!writeFloatWav(file, buffer, buffer.getNumChannels(), capture.sampleRate))
+        {
+            return false;
+        }
+    }
+
+    auto* manifest = new juce::DynamicObject();
+    manifest->setProperty("sampleRate", capture.sampleRate);
+    manifest->setProperty("blockSize", capture.blockSize);
+    manifest->setProperty("numSamples", capture.getNumSamples());
+    manifest->setProperty("silentTaps", silentTaps);
+    manifest->setProperty("recorded", juce::Time::getCurrentTime().toISO8601(true));
+    return folder.getChildFile(manifestName).replaceWithText(juce::JSON::toString(juce::var(manifest)));
+}
+
+std::vector<TapResidual> NullTest::compare(const NullTestScenario& scenario, const TapCapture& capture,
+                                           const juce::File& goldenFolder, double toleranceDb)
+{
+    std::vector<TapResidual> residuals;
+
+    const auto manifest = juce::JSON::parse(goldenFolder.getChildFile(manifestName));
+    if (!manifest.isObject())
+    {
+        TapResidual missing;
+        missing.scenario = scenario.name;
+        missing.error = "no golden recording in " + goldenFolder.getFullPathName() + " (record it with --record)";
+        missing.passed = false;
+        residuals.push_back(missing);
+        return residuals;
+    }
+
+    juce::StringArray silentTaps;
+    if (const auto* tapNames = manifest["silentTaps"].getArray())
+        for (const auto& name : *tapNames)
+            silentTaps.add(name.toString());
+
+    const int numSamples = capture.getNumSamples();
+
+    for (int i = 0; i < TapCapture::numTaps; ++i)
+    {
+        const auto tap = (AudioEngine::Tap)i;
+        const auto& current = capture.taps[(size_t)i];
+
+        TapResidual residual;
+        residual.scenario = scenario.name;
+        residual.tap = AudioEngine::getTapName(tap);
+
+        juce::AudioBuffer<float> golden(current.getNumChannels(), numSamples);
+        golden.clear();
+
+        if (!silentTaps.contains(residual.tap))
+        {
+            double goldenRate = 0.0;
+            if (!readWav(goldenFolder.getChildFile(residual.tap + ".wav"), golden, goldenRate))
+                residual.error = "its golden file is missing or unreadable";
+            else if (goldenRate != capture.sampleRate)
+                residual.error = "the golden was recorded at " + juce::String(goldenRate) + " Hz";
+            else if (golden.getNumSamples() != numSamples || golden.getNumChannels() != current.getNumChannels())
+                residual.error = "the golden has " + juce::String(golden.getNumChannels()) + " channels of "
+                               + juce::String(golden.getNumSamples()) + " samples, the render "
+                               + juce::String(current.getNumChannels()) + " of " + juce::String(numSamples);
+        }
+
+        if (residual.error.isNotEmpty())
+        {
+            residual.passed = false;
+            residuals.push_back(residual);
+            continue;
+        }
+
+        double peak = 0.0, sumOfSquares = 0.0;
+        for (int ch = 0; ch < current.getNumChannels(); ++ch)
+        {
+            const auto* a = current.getReadPointer(ch);
+            const auto* b = golden.getReadPointer(ch);
+            for (int s = 0; s < numSamples; ++s)
+            {
+                // Compared as floats, so -0 against +0 or NaN against NaN is not a difference
+                // a bit comparison would call one, while a new NaN is.
+                if (a[s] == b[s] || (std::isnan(a[s]) && std::isnan(b[s])))
+                    continue;
+
+                const double difference = std::isfinite(a[s]) && std::isfinite(b[s])
+                    ? (double)a[s] - (double)b[s]
+                    : std::numeric_limits<double>::infinity();
+
+                if (residual.firstDifferentSample < 0 || s < residual.firstDifferentSample)
+                    residual.firstDifferentSample = s;
+
+                peak = juce::jmax(peak, std::abs(difference));
+                sumOfSquares += difference * difference;
+            }
+        }
+
+        residual.peakDb = toDecibels(peak);
+        residual.rmsDb = toDecibels(std::sqrt(sumOfSquares / juce::jmax(1, numSamples * current.getNumChannels())));
+        residual.passed = residual.isIdentical() || residual.peakDb <= toleranceDb;
+        residuals.push_back(residual);
+    }
+
+    return residuals;
+}
@@ -0,0 +1,73 @@
+/*
+  ==============================================================================
+
+    NullTest.h
+    (Renders fixed engine setups and compares every tap with a golden recording)
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <functional>
+#include <vector>
+#include "AudioEngine/AudioEngine.h"
+
+/** One fixed setup of the engine: what is in its chains and how it is run. */
+struct NullTestScenario
+{
+    juce::String name;
+    int blockSize = 256;
+    /** Called once the engine is prepared, before the render starts. */
+    std::function<void(AudioEngine&)> configure;
+};
+
+/** Every scenario idolNullTest knows; their names are the golden folders' names. */
+std::vector<NullTestScenario> getNullTestScenarios();
+
+/** The signal at each of the engine's taps over a whole render. */
+struct TapCapture
+{
+    static constexpr int numTaps = (int)AudioEngine::Tap::numTaps;
+
+    double sampleRate = 48000.0;
+    int blockSize = 0;
+    std::array<juce::AudioBuffer<float>, (size_t)numTaps> taps;
+
+    int getNumSamples() const { return taps[0].getNumSamples(); }
+};
+
+/** How far one tap is from its golden recording. */
+struct TapResidual
+{
+    juce::String scenario;
+    juce::String tap;
+    double peakDb = -std::numeric_limits<double>::infinity();  // of current minus golden
+    double rmsDb = -std::numeric_limits<double>::infinity();
+    int firstDifferentSample = -1;                              // -1: identical
+    bool passed = true;
+    juce::String error;                                         // the golden couldn't be compared at all
+
+    bool isIdentical() const { return firstDifferentSample < 0 && error.isEmpty(); }
+};
+
+namespace NullTest
+{
+    /** The vocal (mono) and music (stereo) inputs every scenario is fed: a sweep, noise,
+        tones and impulses, the same on every run. */
+    bool writeTestSignals(const juce::File& vocalFile, const juce::File& musicFile, double sampleRate, double seconds);
+
+    /** Runs a fresh engine on the test signals and records all its taps. */
+    bool render(const NullTestScenario& scenario, const juce::File& vocalFile, const juce::File& musicFile,
+                double sampleRate, double seconds, TapCapture& result, juce::String& error);
+
+    /** Writes the taps as 32-bit float WAVs, one per tap; silent taps are only listed. */
+    bool writeGolden(const TapCapture& capture, const juce::File& folder);
+
+    /** toleranceDb: the loudest residual a tap may have and still pass; minus infinity
+        asks for bit-identical output. */
+    std::vector<TapResidual> compare(const NullTestScenario& scenario, const TapCapture& capture,
+                                     const juce::File& goldenFolder, double toleranceDb);
+}
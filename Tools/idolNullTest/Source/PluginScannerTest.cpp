@@ -0,0 +1,123 @@
+/*
+  ==============================================================================
+
+    PluginScannerTest.cpp
+    (Runs PluginScanner against stub workers that crash, hang or succeed)
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <map>
+#include "Data/PluginManager/PluginScanner.h"
+
+#if JUCE_LINUX || JUCE_MAC
+
+namespace
+{
+    constexpr int stubTimeoutMs = 1000;
+
+    /** Stands in for "<executable> --scan-plugin <file> <output>". What it does depends on
+        the plugin file's name, so one script covers every case. */
+    juce::String createStubWorkerScript(const juce::File& resultFile)
+    {
+        return "#!/bin/sh\n"
+               "case \"$2\" in\n"
+               "    *Crash*) kill -ABRT $$ ;;\n"
+               "    *Hang*) exec sleep 60 ;;\n"
+               "    *) cp \"" + resultFile.getFullPathName() + "\" \"$3\" ;;\n"
+               "esac\n";
+    }
+}
+
+//==============================================================================
+class PluginScannerTest : public juce::UnitTest
+{
+public:
+    PluginScannerTest()
+        : juce::UnitTest("Plugin scanner", "idolLiveAudio")
+    {
+    }
+
+    void runTest() override
+    {
+        const auto root = juce::File::getSpecialLocation(juce::File::SpecialLocationType::tempDirectory)
+                              .getNonexistentChildFile("idolPluginScannerTest", {}, false);
+        expect(root.createDirectory());
+
+        juce::PluginDescription description;
+        description.name = "Good";
+        description.pluginFormatName = "VST3";
+        description.fileOrIdentifier = root.getChildFile("Good.vst3").getFullPathName();
+        description.uniqueId = 0x1d01;
+
+        juce::XmlElement result("SCAN_RESULT");
+        result.addChildElement(description.createXml().release());
+        const auto resultFile = root.getChildFile("result.xml");
+        expect(result.writeTo(resultFile));
+
+        const auto worker = root.getChildFile("stubWorker.sh");
+        expect(worker.replaceWithText(createStubWorkerScript(resultFile)));
+        expect(worker.setExecutePermission(true));
+
+        const juce::Array<juce::File> files{ root.getChildFile("Crash.vst3"),
+                                             root.getChildFile("Hang.vst3"),
+                                             root.getChildFile("Good.vst3") };
+
+        std::map<juce::String, juce::String> failures;
+        std::map<juce::String, juce::Array<juce::PluginDescription>> scanned;
+        bool finished = false, wasCancelled = true;
+
+        PluginScanner::Callbacks callbacks;
+        callbacks.onFileScanned = [&](const juce::File& file, const juce::Array<juce::PluginDescription>& found) { scanned[file.getFileName()] = found; };
+        callbacks.onFileFailed = [&](const juce::File& file, const juce::String& reason) { failures[file.getFileName()] = reason; };
+        callbacks.onFinished = [&](bool cancelled) { finished = true; wasCancelled = cancelled; };
+
+        beginTest("Scan");
+        PluginScanner scanner;
+        scanner.setWorker(worker, stubTimeoutMs);
+        expect(scanner.start(files, callbacks));
+        expect(!scanner.start(files, {}), "a second scan started while one was running");
+
+        // Results are posted to the message thread, which is this one.
+        const auto giveUpAt = juce::Time::getMillisecondCounter() + (juce::uint32)(stubTimeoutMs * 20);
+        while (!finished && juce::Time::getMillisecondCounter() < giveUpAt)
+            juce::MessageManager::getInstance()->runDispatchLoopUntil(20);
+
+        expect(finished, "the scan never finished");
+        expect(!wasCancelled);
+        expect(!scanner.isScanning());
+        expectEquals(scanner.getProgress(), 1.0);
+
+        beginTest("Crashing worker");
+        expect(failures.count("Crash.vst3") > 0, "no failure for the crashing worker");
+        expect(failures["Crash.vst3"].startsWith("Crashed while scanning"), failures["Crash.vst3"]);
+        expect(scanned.count("Crash.vst3") == 0);
+
+        beginTest("Hanging worker");
+        expect(failures.count("Hang.vst3") > 0, "no failure for the hanging worker");
+        expectEquals(failures["Hang.vst3"], juce::String("Timed out after 1 seconds"));
+        expect(scanned.count("Hang.vst3") == 0);
+
+        beginTest("Good worker");
+        expect(failures.count("Good.vst3") == 0, failures["Good.vst3"]);
+        expect(scanned.count("Good.vst3") > 0, "no result for the good worker");
+
+        if (const auto& found = scanned["Good.vst3"]; found.size() == 1)
+        {
+            expectEquals(found.getReference(0).name, description.name);
+            expectEquals(found.getReference(0).uniqueId, description.uniqueId);
+            expect(found.getReference(0).isDuplicateOf(description));
+        }
+        else
+        {
+            expectEquals(found.size(), 1);
+        }
+
+        root.deleteRecursively();
+    }
+};
+
+static PluginScannerTest pluginScannerTest;
+
+#endif
@@ -0,0 +1,343 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    idolRender: runs the engine on files instead of an audio device.
+
+    Loads a preset, feeds WAV files into the vocal and music inputs, renders the
+    mix to a WAV file faster than realtime and reports how long every block took.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include "AudioEngine/AudioEngine.h"
+#include "AudioEngine/FileAudioDevice.h"
+#include "Diagnostics/MetricsRegistry.h"
+#include "Diagnostics/RealtimeChecker.h"
+#include "Data/PresetFile.h"
+#include "Data/PluginStateStore.h"
+#include "Data/PluginManager/PluginManager.h"
+
+namespace
+{
+    // The app these files belong to; this tool's own ProjectInfo names the tool.
+    const juce::String appName("idolLiveAudio");
+
+    PluginManager* sharedPluginManager = nullptr;
+
+    void printUsage()
+    {
+        std::cout <<
+            "idolRender: render a preset offline\n\n"
+            "  --vocal <file>          vocal input (its first channel is used)\n"
+            "  --music <file>          music input (stereo)\n"
+            "  --preset <file>         preset to load (.ilpreset or .xml)\n"
+            "  --out <file.wav>        where to write the mix (optional)\n"
+            "  --rate <hz>             sample rate, default 48000\n"
+            "  --block <samples>       block size, default 256\n"
+            "  --length <seconds>      render length, default the longest input\n"
+            "  --tail <seconds>        extra time after the inputs end, default 0\n"
+            "  --states <dir>          the preset state store, default the app's\n"
+            "  --plugin-list <file>    the known plugin list, default the app's\n"
+            "  --report <file.json>    write the timings as JSON\n"
+            "  --block-times <file>    write every block's time (ms), one per line\n"
+            "  --metrics <file.prom>   write the engine's metrics in Prometheus text format\n"
+            "  --allow-realtime-violations\n"
+            "                          don't fail when the audio thread allocates, locks or blocks\n\n"
+            "Exit code 1 means the render failed; 3 that it worked, but the audio thread\n"
+            "allocated, locked or blocked (the calls and their stacks go to stderr).\n";
+    }
+
+    juce::File getAppDataFolder()
+    {
+        return juce::File::getSpecialLocation(juce::File::SpecialLocationType::userApplicationDataDirectory)
+            .getChildFile(ProjectInfo::companyName)
+            .getChildFile(appName);
+    }
+
+    juce::File getAppStateStore()
+    {
+        return juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
+            .getChildFile(ProjectInfo::companyName)
+            .getChildFile(appName)
+            .getChildFile("Presets")
+            .getChildFile("States");
+    }
+
+    juce::File getFileOption(const juce::ArgumentList& args, const juce::String& option)
+    {
+        return args.containsOption(option) ? args.getFileForOption(option) : juce::File();
+    }
+
+    double getNumberOption(const juce::ArgumentList& args, const juce::String& option, double defaultValue)
+    {
+        const auto value = args.getValueForOption(option);
+        return value.isNotEmpty() ? value.getDoubleValue() : defaultValue;
+    }
+
+    /** Loads the preset through the same background loader the app uses. */
+    bool loadPreset(AudioEngine& engine, const juce::File& presetFile, const juce::File& stateStoreFolder)
+    {
+        PluginStateStore store(stateStoreFolder);
+        const auto preset = PresetFile::load(presetFile, &store);
+        if (!preset.hasType(Identifiers::Preset))
+        {
+            std::cerr << "Could not read preset " << presetFile.getFullPathName() << "\n";
+            return false;
+        }
+
+        bool finished = false;
+        PresetLoader::Result loadResult;
+
+        PresetLoader::Callbacks callbacks;
+        callbacks.onFinished = [&](const PresetLoader::Result& result)
+        {
+            loadResult = result;
+            finished = true;
+        };
+
+        if (!engine.prepareToLoadState(preset, std::move(callbacks)))
+            return false;
+
+        // Workers hand some plugins to the message thread, and the result comes back on it.
+        while (!finished)
+            juce::MessageManager::getInstance()->runDispatchLoopUntil(10);
+
+        if (!loadResult.succeeded)
+        {
+            std::cerr << "Preset failed to load: " << loadResult.failedProcessors.joinIntoString(", ") << "\n";
+            return false;
+        }
+
+        engine.commitStateLoad();
+
+        std::cout << "Loaded " << presetFile.getFileName() << ": " << (int)loadResult.timings.size() << " plugins in "
+                  << juce::String(loadResult.totalMs, 1) << " ms\n";
+        for (const auto& timing : loadResult.timings)
+            std::cout << "    " << timing.processorId << " / " << timing.pluginName << ": create "
+                      << juce::String(timing.createMs, 1) << " ms, restore " << juce::String(timing.restoreMs, 1) << " ms\n";
+
+        return true;
+    }
+
+    juce::Array<ProcessorBase*> getProcessors(AudioEngine& engine)
+    {
+        juce::Array<ProcessorBase*> processors{ &engine.getVocalProcessor(), &engine.getMusicProcessor(), &engine.getMasterProcessor() };
+        for (int i = 0; i < 4; ++i)
+        {
+            processors.add(engine.getFxProcessorForVocal(i));
+            processors.add(engine.getFxProcessorForMusic(i));
+        }
+        return processors;
+    }
+
+    juce::var loadToVar(const DspLoadMeter::Snapshot& load)
+    {
+        auto* object = new juce::DynamicObject();
+        object->setProperty("averageMs", load.averageMs);
+        object->setProperty("peakMs", load.peakMs);
+        object->setProperty("averageLoad", load.averageLoad);
+        object->setProperty("peakLoad", load.peakLoad);
+        object->setProperty("overruns", (juce::int64)load.numOverruns);
+        return object;
+    }
+
+    juce::var createReport(AudioEngine& engine, const FileAudioDevice& device, const FileAudioDevice::Options& options)
+    {
+        const auto& stats = device.getStats();
+
+        auto* report = new juce::DynamicObject();
+        report->setProperty("sampleRate", options.sampleRate);
+        report->setProperty("blockSize", options.blockSize);
+        report->setProperty("blocks", stats.numBlocks);
+        report->setProperty("blockMs", stats.blockMs);
+        report->setProperty("audioSeconds", stats.audioSeconds);
+        report->setProperty("renderSeconds", stats.renderSeconds);
+        report->setProperty("realtimeFactor", stats.getRealtimeFactor());
+        report->setProperty("averageMs", stats.averageMs);
+        report->setProperty("medianMs", stats.medianMs);
+        report->setProperty("p95Ms", stats.p95Ms);
+        report->setProperty("p99Ms", stats.p99Ms);
+        report->setProperty("maxMs", stats.maxMs);
+        report->setProperty("overruns", stats.numOverruns);
+        report->setProperty("realtimeViolations", (juce::int64)RealtimeChecker::getInstance().getNumViolations());
+
+        auto* stages = new juce::DynamicObject();
+        for (int i = 0; i < (int)AudioEngine::Stage::numStages; ++i)
+        {
+            const auto stage = (AudioEngine::Stage)i;
+            stages->setProperty(AudioEngine::getStageName(stage), loadToVar(engine.getStageLoad(stage)));
+        }
+        report->setProperty("stages", stages);
+
+        juce::Array<juce::var> plugins;
+        for (auto* processor : getProcessors(engine))
+        {
+            for (int slot = 0; slot < processor->getNumPlugins(); ++slot)
+            {
+                auto plugin = loadToVar(processor->getPluginLoad(slot));
+                plugin.getDynamicObject()->setProperty("processor", processor->getProcessorId().toString());
+                plugin.getDynamicObject()->setProperty("slot", slot);
+                if (auto* instance = processor->getPlugin(slot))
+                    plugin.getDynamicObject()->setProperty("name", instance->getName());
+                plugins.add(plugin);
+            }
+        }
+        report->setProperty("plugins", plugins);
+
+        return report;
+    }
+
+    void printStats(const FileAudioDevice::Stats& stats)
+    {
+        std::cout << "Rendered " << juce::String(stats.audioSeconds, 2) << " s in " << juce::String(stats.renderSeconds, 2)
+                  << " s (" << juce::String(stats.getRealtimeFactor(), 1) << "x realtime), " << stats.numBlocks << " blocks of "
+                  << juce::String(stats.blockMs, 3) << " ms\n"
+                  << "Per block: average " << juce::String(stats.averageMs, 3) << " ms, median " << juce::String(stats.medianMs, 3)
+                  << " ms, p95 " << juce::String(stats.p95Ms, 3) << " ms, p99 " << juce::String(stats.p99Ms, 3)
+                  << " ms, max " << juce::String(stats.maxMs, 3) << " ms, " << stats.numOverruns << " over deadline\n";
+    }
+
+    int run(const juce::ArgumentList& args)
+    {
+        FileAudioDevice::Options options;
+        options.sampleRate = getNumberOption(args, "--rate", 48000.0);
+        options.blockSize = (int)getNumberOption(args, "--block", 256.0);
+        options.lengthSeconds = getNumberOption(args, "--length", 0.0);
+        options.tailSeconds = getNumberOption(args, "--tail", 0.0);
+        options.outputFile = getFileOption(args, "--out");
+
+        const auto vocalFile = getFileOption(args, "--vocal");
+        const auto musicFile = getFileOption(args, "--music");
+        if (vocalFile != juce::File()) options.inputFiles.add(vocalFile);
+        if (musicFile != juce::File()) options.inputFiles.add(musicFile);
+
+        auto pluginList = getFileOption(args, "--plugin-list");
+        if (pluginList == juce::File())
+            pluginList = getAppDataFolder().getChildFile("knownPlugins.bin");
+
+        auto stateStore = getFileOption(args, "--states");
+        if (stateStore == juce::File())
+            stateStore = getAppStateStore();
+
+        PluginManager pluginManager(pluginList);
+        sharedPluginManager = &pluginManager;
+
+        int exitCode = 0;
+        {
+            // Never opened: the engine only needs one to ask about devices, and there are none.
+            juce::AudioDeviceManager deviceManager;
+            AudioEngine engine(deviceManager);
+            FileAudioDevice device(options);
+
+            const auto error = device.open({}, {}, options.sampleRate, options.blockSize);
+            if (error.isNotEmpty())
+            {
+                std::cerr << error << "\n";
+                return 1;
+            }
+
+            if (vocalFile != juce::File())
+                engine.setVocalInputChannel(device.getInputChannels(0).getStart());
+
+            if (musicFile != juce::File())
+            {
+                const auto channels = device.getInputChannels(options.inputFiles.size() - 1);
+                if (channels.getLength() < 2)
+                    std::cerr << "The music input isn't stereo; it is left out of the mix\n";
+                else
+                    engine.setMusicInputChannel(channels.getStart());
+            }
+
+            engine.setSelectedOutputChannels(0, 1);
+            device.start(&engine);
+
+            const auto presetFile = getFileOption(args, "--preset");
+            if (presetFile != juce::File() && !loadPreset(engine, presetFile, stateStore))
+                exitCode = 1;
+
+            if (exitCode == 0)
+            {
+                int lastPercent = -1;
+                const bool rendered = device.render([&lastPercent](double progress)
+                    {
+                        const int percent = (int)(progress * 100.0);
+                        if (percent / 10 != lastPercent / 10)
+                            std::cout << percent << "%\n";
+                        lastPercent = percent;
+                        return true;
+                    });
+
+                if (!rendered)
+                {
+                    std::cerr << device.getLastError() << "\n";
+                    exitCode = 1;
+                }
+                else
+                {
+                    printStats(device.getStats());
+
+                    auto& realtimeChecker = RealtimeChecker::getInstance();
+                    if (realtimeChecker.getNumViolations() > 0)
+                    {
+                        std::cerr << realtimeChecker.getReport();
+                        if (!args.containsOption("--allow-realtime-violations"))
+                            exitCode = 3;
+                    }
+
+                    const auto reportFile = getFileOption(args, "--report");
+                    if (reportFile != juce::File()
+                        && !reportFile.replaceWithText(juce::JSON::toString(createReport(engine, device, options))))
+                        std::cerr << "Could not write " << reportFile.getFullPathName() << "\n";
+
+                    const auto metricsFile = getFileOption(args, "--metrics");
+                    if (metricsFile != juce::File())
+                    {
+                        auto& metrics = MetricsRegistry::getInstance();
+                        metrics.collectAll();
+                        if (!metricsFile.replaceWithText(metrics.toPrometheusText()))
+                            std::cerr << "Could not write " << metricsFile.getFullPathName() << "\n";
+                    }
+
+                    const auto blockTimesFile = getFileOption(args, "--block-times");
+                    if (blockTimesFile != juce::File())
+                    {
+                        juce::StringArray lines;
+                        for (auto ms : device.getBlockTimesMs())
+                            lines.add(juce::String(ms, 4));
+                        if (!blockTimesFile.replaceWithText(lines.joinIntoString("\n") + "\n"))
+                            std::cerr << "Could not write " << blockTimesFile.getFullPathName() << "\n";
+                    }
+                }
+            }
+
+            device.stop();
+        }
+
+        sharedPluginManager = nullptr;
+        return exitCode;
+    }
+}
+
+PluginManager& getSharedPluginManager()
+{
+    jassert(sharedPluginManager != nullptr);
+    return *sharedPluginManager;
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    const juce::ArgumentList args(argc, argv);
+    if (args.size() == 0 || args.containsOption("--help|-h"))
+    {
+        printUsage();
+        return 0;
+    }
+
+    // The message thread is this one: preset loading and plugins need one.
+    const juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    return run(args);
+}